@@ -10,10 +10,14 @@ if not exist "build_msvc" mkdir build_msvc
 pushd build_msvc
 cl %* -I../ -nologo -EHsc -FC -Oi -O2 -Zi ..\meow_example.cpp
 cl %* -I../ -nologo -EHsc -FC -Oi -O2 -Zi ..\more\meow_more_example.cpp
-REM cl %* -I../ -nologo -EHsc -FC -Oi -O2 -Zi ..\more\megapaw_example.cpp
-cl %* -I../ -nologo -EHsc -FC -Oi -O2 -Zi ..\more\meow_test.cpp
+cl %* -I../ -nologo -EHsc -FC -Oi -O2 -Zi ..\more\megapaw_example.cpp
+cl %* -I../ -nologo -EHsc -FC -Oi -O2 -Zi -std:c++20 ..\more\meow_cpp_example.cpp
+cl %* -I../ -nologo -EHsc -FC -Oi -O2 -Zi -std:c++17 ..\more\meow_test.cpp
 cl %* -I../ -nologo -FC -Oi /O2 -Zi -arch:AVX ..\more\meow_search.cpp
+cl %* -I../ -nologo -EHsc -FC -Oi /O2 -Zi -arch:AVX ..\more\meow_near.cpp
 cl %* -I../ -nologo -FC -Oi /O2 -Zi -arch:AVX2 ..\more\meow_bench.cpp
+cl %* -I../ -nologo -FC -Oi /O2 -Zi -arch:AVX ..\more\meow_kernel_bench.cpp
+cl %* -I../ -nologo -EHsc -FC -Oi /O2 -Zi -arch:AVX -std:c++17 ..\more\meow_map_bench.cpp
 popd
 
 :SkipMSVC
@@ -29,10 +33,14 @@ if not exist "build_clang" mkdir build_clang
 pushd build_clang
 clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -msse4 ..\meow_example.cpp -o meow_example.exe
 clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -msse4 ..\more\meow_more_example.cpp -o meow_more_example.exe
-REM clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -msse4 ..\more\megapaw_example.cpp -o megapaw_example.exe
-clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -msse4 ..\more\meow_test.cpp -o meow_test.exe
+clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -msse4 ..\more\megapaw_example.cpp -o megapaw_example.exe
+clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -msse4 -std=c++20 ..\more\meow_cpp_example.cpp -o meow_cpp_example.exe
+clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -msse4 -std=c++17 ..\more\meow_test.cpp -o meow_test.exe
 clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -mavx ..\more\meow_search.cpp -o meow_search.exe
+clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -mavx ..\more\meow_near.cpp -o meow_near.exe
 clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -mavx2 ..\more\meow_bench.cpp -o meow_bench.exe
+clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -mavx ..\more\meow_kernel_bench.cpp -o meow_kernel_bench.exe
+clang++ %* -I../ -Wno-deprecated-declarations -g -O3 -maes -mavx -std=c++17 ..\more\meow_map_bench.cpp -o meow_map_bench.exe
 popd
 
 echo -------------------
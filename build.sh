@@ -7,6 +7,11 @@ CXX=${CXX:-clang++}
 mkdir -p build
 ${CXX} $* -I. meow_example.cpp -O3 -mavx -maes -o build/meow_example
 ${CXX} $* -I. more/meow_more_example.cpp -O3 -mavx -maes -o build/meow_more_example
-${CXX} $* -I. more/meow_test.cpp -O3 -mavx -maes -o build/meow_test
+${CXX} $* -I. more/megapaw_example.cpp -O3 -mavx -maes -o build/megapaw_example
+${CXX} $* -I. more/meow_cpp_example.cpp -std=c++20 -O3 -mavx -maes -pthread -o build/meow_cpp_example
+${CXX} $* -I. more/meow_test.cpp -std=c++17 -O3 -mavx -maes -pthread -o build/meow_test
 ${CXX} $* -I. more/meow_search.cpp -O3 -mavx -maes -o build/meow_search
+${CXX} $* -I. more/meow_near.cpp -O3 -mavx -maes -pthread -o build/meow_near
 ${CXX} $* -I. more/meow_bench.cpp -O3 -mavx2 -maes -o build/meow_bench
+${CXX} $* -I. more/meow_kernel_bench.cpp -O3 -mavx -maes -o build/meow_kernel_bench
+${CXX} $* -I. more/meow_map_bench.cpp -std=c++17 -O3 -mavx -maes -pthread -o build/meow_map_bench
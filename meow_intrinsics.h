@@ -96,6 +96,8 @@
 #define Meow128_Set64x2(Low64, High64) _mm_set_epi64x((High64), (Low64))
 #define Meow128_Set64x2_State(Low64, High64) Meow128_Set64x2(Low64, High64)
 #define Meow128_GetAESConstant(Ptr) (*(meow_u128 *)(Ptr))
+#define Meow128_Loadu(Ptr) _mm_loadu_si128((meow_u128 *)(Ptr))
+#define MeowPrefetch(Ptr) _mm_prefetch((char const *)(Ptr), _MM_HINT_T0)
 
 #define Meow128_And_Mem(A,B) _mm_and_si128((A),_mm_loadu_si128((meow_u128 *)(B)))
 #define Meow128_Shuffle_Mem(Mem,Control) _mm_shuffle_epi8(_mm_loadu_si128((meow_u128 *)(Mem)),_mm_loadu_si128((meow_u128 *)(Control)))
@@ -104,18 +106,26 @@
 #define Meow128_Zero() _mm_setzero_si128()
 
 #define Meow256_AESDEC(Prior, XOr) _mm256_aesdec_epi128((Prior), (XOr))
-#define Meow256_AESDEC_Mem(Prior, XOr) _mm256_aesdec_epi128((Prior), *(meow_u256 *)(XOr))
+#define Meow256_AESDEC_Mem(Prior, XOr) _mm256_aesdec_epi128((Prior), _mm256_loadu_si256((meow_u256 *)(XOr)))
 #define Meow256_Zero() _mm256_setzero_si256()
+#define Meow256_Broadcast128(A) _mm256_broadcastsi128_si256((A))
 #define Meow256_PartialLoad(A, B) _mm256_mask_loadu_epi8(_mm256_setzero_si256(), _cvtu32_mask32((1UL<<(B)) - 1), (A))
 #define Meow128_FromLow(A) _mm256_extracti128_si256((A), 0)
 #define Meow128_FromHigh(A) _mm256_extracti128_si256((A), 1)
+#define Meow256_SetHigh(A, High) _mm256_inserti128_si256((A), (High), 1)
 
 #define Meow512_AESDEC(Prior, XOr) _mm512_aesdec_epi128((Prior), (XOr))
-#define Meow512_AESDEC_Mem(Prior, XOr) _mm512_aesdec_epi128((Prior), *(meow_u512 *)(XOr))
+#define Meow512_AESDEC_Mem(Prior, XOr) _mm512_aesdec_epi128((Prior), _mm512_loadu_si512((meow_u512 *)(XOr)))
 #define Meow512_Zero() _mm512_setzero_si512()
+// NOTE: The unmasked broadcast/extract intrinsics pass an _mm512_undefined_*
+// register through as the merge source, which GCC flags as uninitialized.
+// The zero-masked forms with every lane selected compile to the same instructions.
+#define Meow512_Broadcast128(A) _mm512_maskz_broadcast_i32x4((__mmask16)0xFFFF, (A))
 #define Meow512_PartialLoad(A, B) _mm512_mask_loadu_epi8(_mm512_setzero_si512(), _cvtu64_mask64((1ULL<<(B)) - 1), (A))
-#define Meow256_FromLow(A) _mm512_extracti64x4_epi64((A), 0)
-#define Meow256_FromHigh(A) _mm512_extracti64x4_epi64((A), 1)
+#define Meow256_FromLow(A) _mm512_maskz_extracti64x4_epi64((__mmask8)0xF, (A), 0)
+#define Meow256_FromHigh(A) _mm512_maskz_extracti64x4_epi64((__mmask8)0xF, (A), 1)
+#define Meow128_FromLane(A, I) _mm512_maskz_extracti32x4_epi32((__mmask8)0xF, (A), (I))
+#define Meow512_SetLane(A, I, Lane) _mm512_inserti32x4((A), (Lane), (I))
 
 //
 // NOTE(casey): Operations for ARM processors
@@ -218,6 +228,12 @@ Meow128_Set64x2_State(meow_u64 Low64, meow_u64 High64)
    return(R);
 }
 
+#define Meow128_Loadu(Ptr) vld1q_u8((meow_u8 *)(Ptr))
+#if _MSC_VER
+#define MeowPrefetch(Ptr) __prefetch((Ptr))
+#else
+#define MeowPrefetch(Ptr) __builtin_prefetch((Ptr))
+#endif
 #define Meow128_And_Mem(A,B) vandq_u8((A), vld1q_u8((meow_u8 *)B))
 #define Meow128_Shuffle_Mem(Mem,Control) vqtbl1q_u8(vld1q_u8((meow_u8 *)(Mem)),vld1q_u8((meow_u8 *)(Control)))
 
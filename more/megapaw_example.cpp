@@ -21,7 +21,7 @@
 //
 
 #include "meow_intrinsics.h" // NOTE(casey): Platform prerequisites for the Megapaw hash code (replace with your own, if you want)
-#include "megapaw_hash.h" // NOTE(casey): The Megapaw hash code itself
+#include "more/megapaw_hash.h" // NOTE(casey): The Megapaw hash code itself
 
 //
 // NOTE(casey): Step 2 - detect which Megapaw hash the CPU can run
@@ -31,31 +31,14 @@ static meow_hash_implementation *MegapawHash = MegapawHash_128Wide;
 
 int MegapawHashSpecializeForCPU(void)
 {
-    int Result = 0;
-    
-    try
-    {
-        char Garbage[64];
-        MegapawHash_512Wide(0, sizeof(Garbage), Garbage);
-        MegapawHash = MegapawHash_512Wide;
-        Result = 512;
-    }
-    catch(...)
+    // NOTE: Ask CPUID rather than trying each version and catching the
+    // fault, since an illegal instruction is not a C++ exception everywhere
+    int Result = MegapawHashCPUWidth();
+    switch(Result)
     {
-        try
-        {
-            char Garbage[64];
-            MegapawHash_256Wide(0, sizeof(Garbage), Garbage);
-            MegapawHash = MegapawHash_256Wide;
-            Result = 256;
-        }
-        catch(...)
-        {
-            char Garbage[64];
-            MegapawHash_128Wide(0, sizeof(Garbage), Garbage);
-            MegapawHash = MegapawHash_128Wide;
-            Result = 128;
-        }
+        case 512: MegapawHash = MegapawHash_512Wide; break;
+        case 256: MegapawHash = MegapawHash_256Wide; break;
+        default: MegapawHash = MegapawHash_128Wide; break;
     }
     
     return(Result);
@@ -84,14 +67,13 @@ static entire_file ReadEntireFile(char *Filename);
 static void FreeEntireFile(entire_file *File);
 
 static void
-PrintHash(meow_u128 Hash)
+PrintHash(meow_hash Hash)
 {
-    meow_u32 *HashU32 = (meow_u32 *)&Hash;
     printf("    %08X-%08X-%08X-%08X\n",
-           HashU32[3],
-           HashU32[2],
-           HashU32[1],
-           HashU32[0]);
+           MeowU32From(Hash, 3),
+           MeowU32From(Hash, 2),
+           MeowU32From(Hash, 1),
+           MeowU32From(Hash, 0));
 }
 
 static void
@@ -108,11 +90,11 @@ HashTestBuffer(void)
     }
     
     // NOTE(casey): Ask Megapaw for the hash
-    meow_u128 Hash = MegapawHash(0, Size, Buffer);
+    meow_hash Hash = MegapawHash(0, 0, Size, Buffer);
     
     // NOTE(casey): Extract example smaller hash sizes you might want:
-    long long unsigned Hash64 = MeowU64From(Hash);
-    int unsigned Hash32 = MeowU32From(Hash);
+    long long unsigned Hash64 = MeowU64From(Hash, 0);
+    int unsigned Hash32 = MeowU32From(Hash, 0);
     
     // NOTE(casey): Print the hash
     printf("  Hash of a test buffer:\n");
@@ -129,7 +111,7 @@ HashOneFile(char *FilenameA)
     if(A.Contents)
     {
         // NOTE(casey): Ask Megapaw for the hash
-        meow_u128 HashA = MegapawHash(0, A.Size, A.Contents);
+        meow_hash HashA = MegapawHash(0, 0, A.Size, A.Contents);
         
         // NOTE(casey): Print the hash
         printf("  Hash of \"%s\":\n", FilenameA);
@@ -148,8 +130,8 @@ CompareTwoFiles(char *FilenameA, char *FilenameB)
     if(A.Contents && B.Contents)
     {
         // NOTE(casey): Hash both files
-        meow_u128 HashA = MegapawHash(0, A.Size, A.Contents);
-        meow_u128 HashB = MegapawHash(0, B.Size, B.Contents);
+        meow_hash HashA = MegapawHash(0, 0, A.Size, A.Contents);
+        meow_hash HashB = MegapawHash(0, 0, B.Size, B.Contents);
         
         // NOTE(casey): Check for match
         int HashesMatch = MeowHashesAreEqual(HashA, HashB);
@@ -198,7 +180,7 @@ int
 main(int ArgCount, char **Args)
 {
     // NOTE(casey): Print the banner
-    printf("megapaw_example %s - basic usage example of the Megapaw hash\n", MEOW_HASH_VERSION_NAME);
+    printf("megapaw_example %s - basic usage example of the Megapaw hash\n", MEGAPAW_HASH_VERSION_NAME);
     printf("(C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)\n");
     printf("See https://mollyrocket.com/meowhash for details.\n");
     printf("\n");
@@ -1,48 +1,99 @@
 /* ========================================================================
-
+   
    Megapaw - Speculative hash function for future VAES-enabled CPUs
    (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
    
    See https://mollyrocket.com/meowhash for details.
    
-   ======================================================================== */
+   ========================================================================
    
-//
-// NOTE(casey): 128-wide AES-NI Megapaw (maximum of 16 bytes/clock single threaded)
-//
+   USAGE
+   
+   Megapaw runs 16 lanes of one AESDEC per 16 bytes over 256-byte blocks.
+   There are three implementations of the same hash, which all produce
+   identical output:
+   
+       MegapawHash_128Wide - AES-NI, any x64 or ARMv8 CPU that runs Meow
+       MegapawHash_256Wide - AVX2 + VAES
+       MegapawHash_512Wide - AVX-512 (F/BW/VL) + VAES
+   
+   They all have the same signature as MeowHash_Accelerated, including the
+   128-bit seed, so they can be used through a meow_hash_implementation
+   pointer.  MegapawHashCPUWidth() uses CPUID to report the widest one the
+   current CPU (and OS) can run, so a program compiled for plain AES-NI can
+   still pick up the wide kernels at runtime:
+   
+       meow_hash_implementation *MegapawHash = MegapawHash_128Wide;
+       switch(MegapawHashCPUWidth())
+       {
+           case 512: MegapawHash = MegapawHash_512Wide; break;
+           case 256: MegapawHash = MegapawHash_256Wide; break;
+       }
+   
+   The streaming construction works the same way.  MegapawHashAbsorb1 runs
+   anywhere, and MegapawHashAbsorb256/512 keep the streams in wide registers
+   across blocks.  MegapawHashAbsorbForCPU() returns the widest one that is
+   supported, and all of them produce the same state for MegapawHashEnd:
+   
+       megapaw_absorb_implementation *MegapawAbsorb = MegapawHashAbsorbForCPU();
+       megapaw_hash_state State;
+       MegapawHashBegin(&State, Seed1, Seed2, TotalLengthInBytes);
+       for(each chunk) MegapawAbsorb(&State, ChunkLen, Chunk);
+       meow_hash Hash = MegapawHashEnd(&State, Seed1, Seed2);
+   
+   Megapaw is NOT the same hash as Meow, and its values should not be mixed
+   with Meow values.
+   
+   ======================================================================== */
 
+#define MEGAPAW_HASH_VERSION_NAME "0.4/megapaw"
 #define MEGAPAW_HASH_BLOCK_SIZE_SHIFT 8
 
 static const unsigned char MegapawShiftAdjust[31] = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,128,128,128,128,128,128,128,128,128,128,128,128,128,128,128};
 static const unsigned char MegapawMaskLen[32] = {255,255,255,255, 255,255,255,255, 255,255,255,255, 255,255,255,255, 0,0,0,0, 0,0,0,0, 0,0,0,0, 0,0,0,0};
 
 //
-// NOTE(casey): 128-wide AES-NI Meow (maximum of 16 bytes/clock single threaded)
+// NOTE(casey): 128-wide AES-NI Megapaw (maximum of 16 bytes/clock single threaded)
+//
+// NOTE: This is the reference definition of Megapaw.  The 256 and 512-wide
+// versions below must match it bit-for-bit, including the order of the
+// reduction tree:
+//
+//   - all 16 lanes start as the Mixer (seed and length)
+//   - every 256-byte block does one AESDEC per lane
+//   - leftover full 16-byte lanes go into S0, S1, ... in order
+//   - leftover individual bytes (zero-padded) go into SF
+//   - lane I is folded with lane I+8, then I+4, then S0/S1 with S2/S3,
+//     then S0 with S1, with the Mixer after every level except the third
 //
 
-static meow_u128
-MegapawHash_128Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit)
+static meow_hash
+MegapawHash_128Wide(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, void *SourceInit)
 {
     //
-    // NOTE(casey): Initialize all 16 streams to 0
+    // NOTE(casey): Initialize all 16 streams to the mixer
     //
     
-    meow_aes_128 S0 = Meow128_ZeroState();
-    meow_aes_128 S1 = Meow128_ZeroState();
-    meow_aes_128 S2 = Meow128_ZeroState();
-    meow_aes_128 S3 = Meow128_ZeroState();
-    meow_aes_128 S4 = Meow128_ZeroState();
-    meow_aes_128 S5 = Meow128_ZeroState();
-    meow_aes_128 S6 = Meow128_ZeroState();
-    meow_aes_128 S7 = Meow128_ZeroState();
-    meow_aes_128 S8 = Meow128_ZeroState();
-    meow_aes_128 S9 = Meow128_ZeroState();
-    meow_aes_128 SA = Meow128_ZeroState();
-    meow_aes_128 SB = Meow128_ZeroState();
-    meow_aes_128 SC = Meow128_ZeroState();
-    meow_aes_128 SD = Meow128_ZeroState();
-    meow_aes_128 SE = Meow128_ZeroState();
-    meow_aes_128 SF = Meow128_ZeroState();
+    // TODO(casey): There needs to be a solid idea behind the mixing vector here.
+    // Before Meow v1, we need some definitive analysis of what it should be.
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - TotalLengthInBytes, Seed2 + TotalLengthInBytes + 1);
+    
+    meow_aes_128 S0 = Meow128_Set64x2_State(Seed1 - TotalLengthInBytes, Seed2 + TotalLengthInBytes + 1);
+    meow_aes_128 S1 = S0;
+    meow_aes_128 S2 = S0;
+    meow_aes_128 S3 = S0;
+    meow_aes_128 S4 = S0;
+    meow_aes_128 S5 = S0;
+    meow_aes_128 S6 = S0;
+    meow_aes_128 S7 = S0;
+    meow_aes_128 S8 = S0;
+    meow_aes_128 S9 = S0;
+    meow_aes_128 SA = S0;
+    meow_aes_128 SB = S0;
+    meow_aes_128 SC = S0;
+    meow_aes_128 SD = S0;
+    meow_aes_128 SE = S0;
+    meow_aes_128 SF = S0;
     
     //
     // NOTE(casey): Handle as many full 256-byte blocks as possible (16 cycles per block)
@@ -103,10 +154,6 @@ MegapawHash_128Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit
     // NOTE(casey): Start as much of the mixdown as we can before handling the overhang
     //
     
-    // TODO(casey): There needs to be a solid idea behind the mixing vector here.
-    // Before Meow v1, we need some definitive analysis of what it should be.
-    meow_u128 Mixer = Meow128_Set64x2(Seed - TotalLengthInBytes, Seed + TotalLengthInBytes + 1);
-    
     S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S8));
     S1 = Meow128_AESDEC(S1, Meow128_AESDEC_Finalize(S9));
     S2 = Meow128_AESDEC(S2, Meow128_AESDEC_Finalize(SA));
@@ -145,10 +192,10 @@ MegapawHash_128Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit
             Align = 0;
         }
         
-        meow_aes_128 PartialState = Meow128_Shuffle_Mem(Source - Align, &MegapawShiftAdjust[Align]);
+        meow_u128 Partial = Meow128_Shuffle_Mem(Source - Align, &MegapawShiftAdjust[Align]);
         
-        PartialState = Meow128_And_Mem( PartialState, &MegapawMaskLen[16 - Len] );
-        SF = Meow128_AESDEC(PartialState, Meow128_AESDEC_Finalize(SF));
+        Partial = Meow128_And_Mem( Partial, &MegapawMaskLen[16 - Len] );
+        SF = Meow128_AESDEC(SF, Partial);
     }
     
     //
@@ -176,25 +223,55 @@ MegapawHash_128Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit
     S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S1));
     S0 = Meow128_AESDEC(S0, Mixer);
     
-    meow_u128 Result = Meow128_AESDEC_Finalize(S0);
+    meow_hash Result;
+    Meow128_CopyToHash(Meow128_AESDEC_Finalize(S0), Result);
+    
     return(Result);
 }
 
+#if MEOW_HASH_INTEL
+
+//
+// NOTE: The wide versions are compiled for their instruction sets with
+// target attributes, so they can live in the same binary as the 128-wide
+// version and be selected at runtime with MegapawHashCPUWidth().
+//
+
+#if _MSC_VER
+#define MEGAPAW_TARGET_256
+#define MEGAPAW_TARGET_512
+#else
+#define MEGAPAW_TARGET_256 __attribute__((target("aes,avx2,vaes")))
+#define MEGAPAW_TARGET_512 __attribute__((target("aes,avx2,vaes,avx512f,avx512bw,avx512vl")))
+#endif
+
+// NOTE: AESDEC only the low 128-bit lane of a 256-bit pair
+#define Megapaw256_AESDEC_LowMem(Prior, XOr) \
+    _mm256_blend_epi32((Prior), _mm256_castsi128_si256(Meow128_AESDEC_Mem(_mm256_castsi256_si128(Prior), (XOr))), 0x0F)
+
+// NOTE: AESDEC only the lanes of a 512-bit quad selected by Mask (two bits per lane);
+// the masked load never touches memory past the selected lanes
+#define Megapaw512_AESDEC_MaskMem(Prior, Mask, XOr) \
+    _mm512_mask_blend_epi64((Mask), (Prior), Meow512_AESDEC((Prior), _mm512_maskz_loadu_epi64((Mask), (XOr))))
+
 //
-// NOTE(casey): 256-wide VAES Meow (maximum of 32 bytes/clock single threaded)
+// NOTE(casey): 256-wide VAES Megapaw (maximum of 32 bytes/clock single threaded)
 //
 
-static meow_u128
-MegapawHash_256Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit)
+MEGAPAW_TARGET_256 static meow_hash
+MegapawHash_256Wide(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, void *SourceInit)
 {
-    meow_u256 S01 = Meow256_Zero();
-    meow_u256 S23 = Meow256_Zero();
-    meow_u256 S45 = Meow256_Zero();
-    meow_u256 S67 = Meow256_Zero();
-    meow_u256 S89 = Meow256_Zero();
-    meow_u256 SAB = Meow256_Zero();
-    meow_u256 SCD = Meow256_Zero();
-    meow_u256 SEF = Meow256_Zero();
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - TotalLengthInBytes, Seed2 + TotalLengthInBytes + 1);
+    meow_u256 Mixer2 = Meow256_Broadcast128(Mixer);
+    
+    meow_aes_256 S01 = Mixer2;
+    meow_aes_256 S23 = Mixer2;
+    meow_aes_256 S45 = Mixer2;
+    meow_aes_256 S67 = Mixer2;
+    meow_aes_256 S89 = Mixer2;
+    meow_aes_256 SAB = Mixer2;
+    meow_aes_256 SCD = Mixer2;
+    meow_aes_256 SEF = Mixer2;
     
     //
     // NOTE(casey): Handle as many full 256-byte blocks as possible (4 cycles per block)
@@ -244,51 +321,108 @@ MegapawHash_256Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit
         default:;
     }
     
-    if(Len & 0x1f)
+    //
+    // NOTE: An odd full 16-byte lane goes into the low half of the next pair
+    //
+    
+    if(Len & 16)
+    {
+        meow_u8 *Lane = Source + (Len & 0xE0);
+        switch(Len >> 5)
+        {
+            case 0: S01 = Megapaw256_AESDEC_LowMem(S01, Lane); break;
+            case 1: S23 = Megapaw256_AESDEC_LowMem(S23, Lane); break;
+            case 2: S45 = Megapaw256_AESDEC_LowMem(S45, Lane); break;
+            case 3: S67 = Megapaw256_AESDEC_LowMem(S67, Lane); break;
+            case 4: S89 = Megapaw256_AESDEC_LowMem(S89, Lane); break;
+            case 5: SAB = Megapaw256_AESDEC_LowMem(SAB, Lane); break;
+            case 6: SCD = Megapaw256_AESDEC_LowMem(SCD, Lane); break;
+            case 7: SEF = Megapaw256_AESDEC_LowMem(SEF, Lane); break;
+        }
+    }
+    Source += (Len & 0xF0);
+    
+    //
+    // NOTE(casey): Deal with individual bytes
+    //
+    
+    if(Len & 15)
     {
-        meow_u256 Partial = Meow256_PartialLoad(Source + (Len & 0xE0), Len & 0x1F);
-        SEF = Meow256_AESDEC(Partial, SEF);
+        int Align = ((int)(meow_umm)Source) & 15;
+        int End = ((int)(meow_umm)Source) & (MEOW_PAGESIZE - 1);
+        Len &= 15;
+        
+        // NOTE(jeffr): If we are nowhere near the page end, use full unaligned load (cmov to set)
+        if (End <= (MEOW_PAGESIZE - 16))
+        {
+            Align = 0;
+        }
+        
+        // NOTE(jeffr): If we will read over the page end, use a full unaligned load (cmov to set)
+        if ((End + Len) > MEOW_PAGESIZE)
+        {
+            Align = 0;
+        }
+        
+        meow_u128 Partial = Meow128_Shuffle_Mem(Source - Align, &MegapawShiftAdjust[Align]);
+        
+        Partial = Meow128_And_Mem( Partial, &MegapawMaskLen[16 - Len] );
+        meow_aes_128 SF = Meow128_AESDEC(Meow128_FromHigh(SEF), Partial);
+        SEF = Meow256_SetHigh(SEF, SF);
     }
     
+    //
+    // NOTE: Same reduction tree as the 128-wide version, two lanes at a time
+    //
+    
     S01 = Meow256_AESDEC(S01, S89);
     S23 = Meow256_AESDEC(S23, SAB);
     S45 = Meow256_AESDEC(S45, SCD);
     S67 = Meow256_AESDEC(S67, SEF);
     
-    S01 = Meow256_AESDEC(S01, Mixer4);
-    S23 = Meow256_AESDEC(S23, Mixer4);
-    S45 = Meow256_AESDEC(S45, Mixer4);
-    S67 = Meow256_AESDEC(S67, Mixer4);
+    S01 = Meow256_AESDEC(S01, Mixer2);
+    S23 = Meow256_AESDEC(S23, Mixer2);
+    S45 = Meow256_AESDEC(S45, Mixer2);
+    S67 = Meow256_AESDEC(S67, Mixer2);
     
     S01 = Meow256_AESDEC(S01, S45);
     S23 = Meow256_AESDEC(S23, S67);
     
+    S01 = Meow256_AESDEC(S01, Mixer2);
+    S23 = Meow256_AESDEC(S23, Mixer2);
+    
     S01 = Meow256_AESDEC(S01, S23);
     
-    meow_u128 S0 = Meow128_FromLow(S01);
-    meow_u128 S1 = Meow128_FromHigh(S01);
+    meow_aes_128 S0 = Meow128_FromLow(S01);
+    meow_aes_128 S1 = Meow128_FromHigh(S01);
     
     S0 = Meow128_AESDEC(S0, S1);
-    S0 = Meow128_AESDEC(S0, Mixer1);
+    S0 = Meow128_AESDEC(S0, Mixer);
     
-    return(S0);
+    meow_hash Result;
+    Meow128_CopyToHash(S0, Result);
+    
+    return(Result);
 }
 
 //
-// NOTE(casey): 512-wide VAES Meow (maximum of 64 bytes/clock single threaded)
+// NOTE(casey): 512-wide VAES Megapaw (maximum of 64 bytes/clock single threaded)
 //
 
-static meow_u128
-MegapawHash_512Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit)
+MEGAPAW_TARGET_512 static meow_hash
+MegapawHash_512Wide(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, void *SourceInit)
 {
     //
-    // NOTE(casey): Initialize all 16 streams to 0
+    // NOTE(casey): Initialize all 16 streams to the mixer
     //
     
-    meow_u512 S0123 = Meow512_Zero();
-    meow_u512 S4567 = Meow512_Zero();
-    meow_u512 S89AB = Meow512_Zero();
-    meow_u512 SCDEF = Meow512_Zero();
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - TotalLengthInBytes, Seed2 + TotalLengthInBytes + 1);
+    meow_u512 Mixer4 = Meow512_Broadcast128(Mixer);
+    
+    meow_aes_512 S0123 = Mixer4;
+    meow_aes_512 S4567 = Mixer4;
+    meow_aes_512 S89AB = Mixer4;
+    meow_aes_512 SCDEF = Mixer4;
     
     //
     // NOTE(casey): Handle as many full 256-byte blocks as possible (4 cycles per block)
@@ -323,12 +457,40 @@ MegapawHash_512Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit
         default:;
     }
     
-    if(Len & 0x3f)
+    //
+    // NOTE: One to three remaining full 16-byte lanes go into the next quad
+    //
+    
+    if(Len & 0x30)
     {
-        meow_u512 Partial = Meow512_PartialLoad(Source + (Len & 0xC0), Len & 0x3F);
-        SCDEF = Meow512_AESDEC(Partial, SCDEF);
+        __mmask8 Mask = (__mmask8)((1 << ((Len >> 3) & 6)) - 1);
+        meow_u8 *Lanes = Source + (Len & 0xC0);
+        switch(Len >> 6)
+        {
+            case 0: S0123 = Megapaw512_AESDEC_MaskMem(S0123, Mask, Lanes); break;
+            case 1: S4567 = Megapaw512_AESDEC_MaskMem(S4567, Mask, Lanes); break;
+            case 2: S89AB = Megapaw512_AESDEC_MaskMem(S89AB, Mask, Lanes); break;
+            case 3: SCDEF = Megapaw512_AESDEC_MaskMem(SCDEF, Mask, Lanes); break;
+        }
+    }
+    Source += (Len & 0xF0);
+    
+    //
+    // NOTE: Individual bytes - the masked load suppresses faults on the
+    // bytes it doesn't read, so there's no need for the page-end checks
+    //
+    
+    if(Len & 15)
+    {
+        meow_u128 Partial = _mm_maskz_loadu_epi8((__mmask16)((1 << (Len & 15)) - 1), Source);
+        meow_aes_128 SF = Meow128_AESDEC(Meow128_FromLane(SCDEF, 3), Partial);
+        SCDEF = Meow512_SetLane(SCDEF, 3, SF);
     }
     
+    //
+    // NOTE: Same reduction tree as the 128-wide version, four lanes at a time
+    //
+    
     S0123 = Meow512_AESDEC(S0123, S89AB);
     S4567 = Meow512_AESDEC(S4567, SCDEF);
     
@@ -336,25 +498,110 @@ MegapawHash_512Wide(meow_u64 Seed, meow_u64 TotalLengthInBytes, void *SourceInit
     S4567 = Meow512_AESDEC(S4567, Mixer4);
     
     S0123 = Meow512_AESDEC(S0123, S4567);
+    S0123 = Meow512_AESDEC(S0123, Mixer4);
     
-    meow_u256 S01 = Meow256_FromLow(S0123);
-    meow_u256 S23 = Meow256_FromHigh(S0123);
+    meow_aes_256 S01 = Meow256_FromLow(S0123);
+    meow_aes_256 S23 = Meow256_FromHigh(S0123);
     S01 = Meow256_AESDEC(S01, S23);
     
-    meow_u128 S0 = Meow128_FromLow(S01);
-    meow_u128 S1 = Meow128_FromHigh(S01);
+    meow_aes_128 S0 = Meow128_FromLow(S01);
+    meow_aes_128 S1 = Meow128_FromHigh(S01);
     
     S0 = Meow128_AESDEC(S0, S1);
-    S0 = Meow128_AESDEC(S0, Mixer1);
+    S0 = Meow128_AESDEC(S0, Mixer);
     
-    return(S0);
+    meow_hash Result;
+    Meow128_CopyToHash(S0, Result);
+    
+    return(Result);
 }
 
+//
+// NOTE: CPUID-based selection of the widest Megapaw the CPU can run.  This
+// checks both the instruction set bits and that the OS saves the YMM/ZMM
+// registers (XCR0), since a CPU can report AVX-512 while the OS has it off.
+//
+
+static void
+MegapawCPUID(int unsigned *Regs, int unsigned Leaf, int unsigned SubLeaf)
+{
+#if _MSC_VER
+    __cpuidex((int *)Regs, (int)Leaf, (int)SubLeaf);
+#else
+    __asm__ __volatile__("cpuid"
+                         : "=a"(Regs[0]), "=b"(Regs[1]), "=c"(Regs[2]), "=d"(Regs[3])
+                         : "a"(Leaf), "c"(SubLeaf));
+#endif
+}
+
+static meow_u64
+MegapawXCR0(void)
+{
+#if _MSC_VER
+    meow_u64 Result = _xgetbv(0);
+#else
+    int unsigned Lo, Hi;
+    __asm__ __volatile__("xgetbv" : "=a"(Lo), "=d"(Hi) : "c"(0));
+    meow_u64 Result = ((meow_u64)Hi << 32) | Lo;
+#endif
+    return(Result);
+}
+
+static int
+MegapawHashCPUWidth(void)
+{
+    int Result = 128;
+    
+    int unsigned Regs[4];
+    MegapawCPUID(Regs, 0, 0);
+    int unsigned MaxLeaf = Regs[0];
+    
+    MegapawCPUID(Regs, 1, 0);
+    int HasAES = (Regs[2] >> 25) & 1;
+    int HasOSXSAVE = (Regs[2] >> 27) & 1;
+    int HasAVX = (Regs[2] >> 28) & 1;
+    
+    if(HasAES && HasOSXSAVE && HasAVX && (MaxLeaf >= 7))
+    {
+        meow_u64 XCR0 = MegapawXCR0();
+        int OSHasYMM = ((XCR0 & 0x6) == 0x6);
+        int OSHasZMM = ((XCR0 & 0xE6) == 0xE6);
+        
+        MegapawCPUID(Regs, 7, 0);
+        int HasAVX2 = (Regs[1] >> 5) & 1;
+        int HasAVX512F = (Regs[1] >> 16) & 1;
+        int HasAVX512BW = (Regs[1] >> 30) & 1;
+        int HasAVX512VL = (Regs[1] >> 31) & 1;
+        int HasVAES = (Regs[2] >> 9) & 1;
+        
+        if(OSHasYMM && HasAVX2 && HasVAES)
+        {
+            Result = 256;
+            if(OSHasZMM && HasAVX512F && HasAVX512BW && HasAVX512VL)
+            {
+                Result = 512;
+            }
+        }
+    }
+    
+    return(Result);
+}
+
+#else
+
+static int
+MegapawHashCPUWidth(void)
+{
+    return(128);
+}
+
+#endif
+
 //
 // NOTE(casey): Streaming construction (optional)
 //
 
-typedef struct meow_hash_state
+typedef struct megapaw_hash_state
 {
     union
     {
@@ -377,7 +624,8 @@ typedef struct meow_hash_state
             meow_aes_128 SE;
             meow_aes_128 SF;
         };
-        
+
+#if MEOW_HASH_INTEL
         struct
         {
             meow_aes_256 S01;
@@ -397,44 +645,49 @@ typedef struct meow_hash_state
             meow_aes_512 S89AB;
             meow_aes_512 SCDEF;
         };
+#endif
     };
     
     meow_u64 TotalLengthInBytes;
     
     meow_u8 Buffer[1 << MEGAPAW_HASH_BLOCK_SIZE_SHIFT];
     int unsigned BufferLen;
-} meow_hash_state;
+} megapaw_hash_state;
 
-static void
-MegapawHashBegin(meow_hash_state *State)
+typedef void megapaw_absorb_implementation(megapaw_hash_state *State, meow_u64 Len, void *Source);
+
+static inline void
+MegapawHashBegin(megapaw_hash_state *State, meow_u64 Seed1, meow_u64 Seed2, meow_u64 length)
 {
     //
-    // NOTE(casey): Initialize all 16 streams to 0
-    //
-    
-    State->S0 = Meow128_ZeroState();
-    State->S1 = Meow128_ZeroState();
-    State->S2 = Meow128_ZeroState();
-    State->S3 = Meow128_ZeroState();
-    State->S4 = Meow128_ZeroState();
-    State->S5 = Meow128_ZeroState();
-    State->S6 = Meow128_ZeroState();
-    State->S7 = Meow128_ZeroState();
-    State->S8 = Meow128_ZeroState();
-    State->S9 = Meow128_ZeroState();
-    State->SA = Meow128_ZeroState();
-    State->SB = Meow128_ZeroState();
-    State->SC = Meow128_ZeroState();
-    State->SD = Meow128_ZeroState();
-    State->SE = Meow128_ZeroState();
-    State->SF = Meow128_ZeroState();
+    // NOTE(casey): Initialize all 16 streams to the mixer
+    //
+    
+    meow_aes_128 Mixer = Meow128_Set64x2_State(Seed1 - length, Seed2 + length + 1);
+    
+    State->S0 = Mixer;
+    State->S1 = Mixer;
+    State->S2 = Mixer;
+    State->S3 = Mixer;
+    State->S4 = Mixer;
+    State->S5 = Mixer;
+    State->S6 = Mixer;
+    State->S7 = Mixer;
+    State->S8 = Mixer;
+    State->S9 = Mixer;
+    State->SA = Mixer;
+    State->SB = Mixer;
+    State->SC = Mixer;
+    State->SD = Mixer;
+    State->SE = Mixer;
+    State->SF = Mixer;
     
     State->TotalLengthInBytes = 0;
     State->BufferLen = 0;
 }
 
 static void
-MegapawHashAbsorbBlocks1(meow_hash_state *State, meow_u64 BlockCount, meow_u8 *Source)
+MegapawHashAbsorbBlocks1(megapaw_hash_state *State, meow_u64 BlockCount, meow_u8 *Source)
 {
     meow_aes_128 S0 = State->S0;
     meow_aes_128 S1 = State->S1;
@@ -494,7 +747,7 @@ MegapawHashAbsorbBlocks1(meow_hash_state *State, meow_u64 BlockCount, meow_u8 *S
 }
 
 static void
-MegapawHashAbsorb1(meow_hash_state *State, meow_u64 Len, void *SourceInit)
+MegapawHashAbsorb1(megapaw_hash_state *State, meow_u64 Len, void *SourceInit)
 {
     State->TotalLengthInBytes += Len;
     meow_u8 *Source = (meow_u8 *)SourceInit;
@@ -536,8 +789,230 @@ MegapawHashAbsorb1(meow_hash_state *State, meow_u64 Len, void *SourceInit)
     }
 }
 
-static meow_u128
-MegapawHashEnd(meow_hash_state *State, meow_u64 Seed)
+#if MEOW_HASH_INTEL
+
+//
+// NOTE: Wide streaming absorbs.  These keep the 16 streams in eight 256-bit
+// or four 512-bit registers for the whole run of blocks and only go back
+// through the state once per call, so they ingest at the same rate as the
+// one-shot versions.  The state layout is shared, so they can be mixed
+// freely with MegapawHashAbsorb1 and all finish with MegapawHashEnd.
+//
+
+MEGAPAW_TARGET_256 static void
+MegapawCopy256(meow_u8 *Dest, meow_u8 *Source, int unsigned Len)
+{
+    while(Len >= 32)
+    {
+        _mm256_storeu_si256((meow_u256 *)Dest, _mm256_loadu_si256((meow_u256 *)Source));
+        Dest += 32;
+        Source += 32;
+        Len -= 32;
+    }
+    
+    if(Len >= 16)
+    {
+        _mm_storeu_si128((meow_u128 *)Dest, _mm_loadu_si128((meow_u128 *)Source));
+        Dest += 16;
+        Source += 16;
+        Len -= 16;
+    }
+    
+    while(Len--)
+    {
+        *Dest++ = *Source++;
+    }
+}
+
+MEGAPAW_TARGET_256 static void
+MegapawHashAbsorbBlocks256(megapaw_hash_state *State, meow_u64 BlockCount, meow_u8 *Source)
+{
+    meow_aes_256 S01 = State->S01;
+    meow_aes_256 S23 = State->S23;
+    meow_aes_256 S45 = State->S45;
+    meow_aes_256 S67 = State->S67;
+    meow_aes_256 S89 = State->S89;
+    meow_aes_256 SAB = State->SAB;
+    meow_aes_256 SCD = State->SCD;
+    meow_aes_256 SEF = State->SEF;
+    
+    while(BlockCount--)
+    {
+        S01 = Meow256_AESDEC_Mem(S01, Source);
+        S23 = Meow256_AESDEC_Mem(S23, Source + 32);
+        
+        S45 = Meow256_AESDEC_Mem(S45, Source + 64);
+        S67 = Meow256_AESDEC_Mem(S67, Source + 96);
+        
+        S89 = Meow256_AESDEC_Mem(S89, Source + 128);
+        SAB = Meow256_AESDEC_Mem(SAB, Source + 160);
+        
+        SCD = Meow256_AESDEC_Mem(SCD, Source + 192);
+        SEF = Meow256_AESDEC_Mem(SEF, Source + 224);
+        
+        Source += (1 << MEGAPAW_HASH_BLOCK_SIZE_SHIFT);
+    }
+    
+    State->S01 = S01;
+    State->S23 = S23;
+    State->S45 = S45;
+    State->S67 = S67;
+    State->S89 = S89;
+    State->SAB = SAB;
+    State->SCD = SCD;
+    State->SEF = SEF;
+}
+
+MEGAPAW_TARGET_256 static void
+MegapawHashAbsorb256(megapaw_hash_state *State, meow_u64 Len, void *SourceInit)
+{
+    State->TotalLengthInBytes += Len;
+    meow_u8 *Source = (meow_u8 *)SourceInit;
+    
+    // NOTE(casey): Handle any buffered residual
+    if(State->BufferLen)
+    {
+        int unsigned Fill = (sizeof(State->Buffer) - State->BufferLen);
+        if(Fill > Len)
+        {
+            Fill = (int unsigned)Len;
+        }
+        
+        MegapawCopy256(State->Buffer + State->BufferLen, Source, Fill);
+        State->BufferLen += Fill;
+        Source += Fill;
+        Len -= Fill;
+        
+        if(State->BufferLen == sizeof(State->Buffer))
+        {
+            MegapawHashAbsorbBlocks256(State, 1, State->Buffer);
+            State->BufferLen = 0;
+        }
+    }
+    
+    // NOTE(casey): Handle any full blocks
+    meow_u64 BlockCount = (Len >> MEGAPAW_HASH_BLOCK_SIZE_SHIFT);
+    meow_u64 Advance = (BlockCount << MEGAPAW_HASH_BLOCK_SIZE_SHIFT);
+    MegapawHashAbsorbBlocks256(State, BlockCount, Source);
+    
+    Len -= Advance;
+    Source += Advance;
+    
+    // NOTE(casey): Store residual
+    MegapawCopy256(State->Buffer + State->BufferLen, Source, (int unsigned)Len);
+    State->BufferLen += (int unsigned)Len;
+}
+
+MEGAPAW_TARGET_512 static void
+MegapawCopy512(meow_u8 *Dest, meow_u8 *Source, int unsigned Len)
+{
+    while(Len >= 64)
+    {
+        _mm512_storeu_si512((meow_u512 *)Dest, _mm512_loadu_si512((meow_u512 *)Source));
+        Dest += 64;
+        Source += 64;
+        Len -= 64;
+    }
+    
+    // NOTE: Masked lanes are neither read nor written, so this never touches past either end
+    if(Len)
+    {
+        __mmask64 Mask = _cvtu64_mask64((1ULL << Len) - 1);
+        _mm512_mask_storeu_epi8(Dest, Mask, _mm512_maskz_loadu_epi8(Mask, Source));
+    }
+}
+
+MEGAPAW_TARGET_512 static void
+MegapawHashAbsorbBlocks512(megapaw_hash_state *State, meow_u64 BlockCount, meow_u8 *Source)
+{
+    meow_aes_512 S0123 = State->S0123;
+    meow_aes_512 S4567 = State->S4567;
+    meow_aes_512 S89AB = State->S89AB;
+    meow_aes_512 SCDEF = State->SCDEF;
+    
+    while(BlockCount--)
+    {
+        S0123 = Meow512_AESDEC_Mem(S0123, Source);
+        S4567 = Meow512_AESDEC_Mem(S4567, Source + 64);
+        S89AB = Meow512_AESDEC_Mem(S89AB, Source + 128);
+        SCDEF = Meow512_AESDEC_Mem(SCDEF, Source + 192);
+        
+        Source += (1 << MEGAPAW_HASH_BLOCK_SIZE_SHIFT);
+    }
+    
+    State->S0123 = S0123;
+    State->S4567 = S4567;
+    State->S89AB = S89AB;
+    State->SCDEF = SCDEF;
+}
+
+MEGAPAW_TARGET_512 static void
+MegapawHashAbsorb512(megapaw_hash_state *State, meow_u64 Len, void *SourceInit)
+{
+    State->TotalLengthInBytes += Len;
+    meow_u8 *Source = (meow_u8 *)SourceInit;
+    
+    // NOTE(casey): Handle any buffered residual
+    if(State->BufferLen)
+    {
+        int unsigned Fill = (sizeof(State->Buffer) - State->BufferLen);
+        if(Fill > Len)
+        {
+            Fill = (int unsigned)Len;
+        }
+        
+        MegapawCopy512(State->Buffer + State->BufferLen, Source, Fill);
+        State->BufferLen += Fill;
+        Source += Fill;
+        Len -= Fill;
+        
+        if(State->BufferLen == sizeof(State->Buffer))
+        {
+            MegapawHashAbsorbBlocks512(State, 1, State->Buffer);
+            State->BufferLen = 0;
+        }
+    }
+    
+    // NOTE(casey): Handle any full blocks
+    meow_u64 BlockCount = (Len >> MEGAPAW_HASH_BLOCK_SIZE_SHIFT);
+    meow_u64 Advance = (BlockCount << MEGAPAW_HASH_BLOCK_SIZE_SHIFT);
+    MegapawHashAbsorbBlocks512(State, BlockCount, Source);
+    
+    Len -= Advance;
+    Source += Advance;
+    
+    // NOTE(casey): Store residual
+    MegapawCopy512(State->Buffer + State->BufferLen, Source, (int unsigned)Len);
+    State->BufferLen += (int unsigned)Len;
+}
+
+#endif
+
+//
+// NOTE: Picks the widest absorb the CPU supports, to match MegapawHashCPUWidth()
+//
+
+static inline megapaw_absorb_implementation *
+MegapawHashAbsorbForCPU(void)
+{
+    megapaw_absorb_implementation *Result = MegapawHashAbsorb1;
+#if MEOW_HASH_INTEL
+    int Width = MegapawHashCPUWidth();
+    if(Width >= 512)
+    {
+        Result = MegapawHashAbsorb512;
+    }
+    else if(Width >= 256)
+    {
+        Result = MegapawHashAbsorb256;
+    }
+#endif
+    
+    return(Result);
+}
+
+static inline meow_hash
+MegapawHashEnd(megapaw_hash_state *State, meow_u64 Seed1, meow_u64 Seed2)
 {
     meow_aes_128 S0 = State->S0;
     meow_aes_128 S1 = State->S1;
@@ -602,15 +1077,15 @@ MegapawHashEnd(meow_hash_state *State, meow_u64 Seed)
             Align = 0;
         }
         
-        meow_aes_128 PartialState = Meow128_Shuffle_Mem(Source - Align, &MegapawShiftAdjust[Align]);
+        meow_u128 Partial = Meow128_Shuffle_Mem(Source - Align, &MegapawShiftAdjust[Align]);
         
-        PartialState = Meow128_And_Mem( PartialState, &MegapawMaskLen[16 - Len] );
-        SF = Meow128_AESDEC(PartialState, Meow128_AESDEC_Finalize(SF));
+        Partial = Meow128_And_Mem( Partial, &MegapawMaskLen[16 - Len] );
+        SF = Meow128_AESDEC(SF, Partial);
     }
     
-    meow_u128 Mixer = Meow128_Set64x2(Seed - State->TotalLengthInBytes,
-                                      Seed + State->TotalLengthInBytes + 1);
-                                      
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - State->TotalLengthInBytes,
+                                      Seed2 + State->TotalLengthInBytes + 1);
+    
     S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S8));
     S1 = Meow128_AESDEC(S1, Meow128_AESDEC_Finalize(S9));
     S2 = Meow128_AESDEC(S2, Meow128_AESDEC_Finalize(SA));
@@ -645,42 +1120,8 @@ MegapawHashEnd(meow_hash_state *State, meow_u64 Seed)
     S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S1));
     S0 = Meow128_AESDEC(S0, Mixer);
     
-    meow_u128 Result = Meow128_AESDEC_Finalize(S0);
-    return(Result);
-}
-
-#if !defined(MEOW_HELPERS)
-//
-// NOTE(casey): Smaller hash extraction
-//
-
-static meow_u64
-MeowU64From(meow_u128 Hash)
-{
-    // TODO(casey): It is probably worth it to use the cvt intrinsics here
-    // TODO(mmozeiko): use vgetq_lane_u64 on ARMv8
-    meow_u64 Result = *(meow_u64 *)&Hash;
-    return(Result);
-}
-
-static meow_u32
-MeowU32From(meow_u128 Hash)
-{
-    // TODO(casey): It is probably worth it to use the cvt intrinsics here
-    // TODO(mmozeiko): use vgetq_lane_u32 on ARMv8
-    meow_u32 Result = *(meow_u32 *)&Hash;
-    return(Result);
-}
-
-//
-// NOTE(casey): "Fast" comparison (using SSE or NEON)
-//
-
-static int
-MeowHashesAreEqual(meow_u128 A, meow_u128 B)
-{
-    int Result = Meow128_AreEqual(A, B);
+    meow_hash Result;
+    Meow128_CopyToHash(Meow128_AESDEC_Finalize(S0), Result);
+    
     return(Result);
 }
-#define MEOW_HELPERS
-#endif
@@ -0,0 +1,425 @@
+/* ========================================================================
+   
+   meow_bloom.h - cache-line-blocked Bloom filter driven by one Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   A Bloom filter answers "definitely not seen" or "probably seen" in a few
+   bits per key, which makes it a cheap gate in front of something more
+   expensive, like a fingerprint store on disk:
+   
+       meow_umm BlockCount = MeowBloomBlockCount(ExpectedCount, 10);   // 10 bits per key
+       meow_bloom Bloom;
+       MeowBloomInit(&Bloom, malloc(MeowBloomSize(BlockCount)), BlockCount, Seed1, Seed2);
+   
+       MeowBloomInsertKey(&Bloom, Len, Key);
+       if(MeowBloomContainsKey(&Bloom, Len, Key)) {...}   // NOTE: Maybe
+   
+   The filter is split into 64-byte blocks, and every key lives entirely in
+   one of them, so inserting or testing a key touches a single cache line.
+   Everything comes out of one 128-bit Meow hash: 32-bit lanes 0 and 1
+   pick the block, and lanes 2 and 3 are the H1 and H2 of double hashing
+   (Kirsch-Mitzenmacher), giving probe I the value H1 + I*H2.  There are
+   MEOW_BLOOM_PROBES probes, and probe I sets one bit in word 2I or 2I+1 of
+   the block's sixteen 32-bit words, so all of a key's bits are built and
+   tested as four 128-bit masks with no loops over bits.
+   
+   The false positive rate is about 3% at 8 bits per key, 1.2% at 10 and
+   0.16% at 16 - a little worse than an unblocked filter of the same size,
+   in exchange for one cache miss per lookup instead of one per probe.
+   
+   The hash forms take a meow_hash that was made with the filter's seeds
+   (the key forms do that themselves).  The batch forms work through
+   MEOW_BLOOM_BATCH hashes at a time, prefetching all of their blocks
+   before touching any, so a batch's cache misses overlap.
+   
+   The memory is a header followed by the blocks, and is the serialized
+   form as-is: write it out, and MeowBloomFromMemory on a mapping of the
+   file gives the filter back (read-only, if the mapping is).  Filters with
+   the same block count and seeds can be merged with MeowBloomMerge, which
+   ORs one into the other and gives the filter of the union of their keys.
+   
+   Up to 2^32 - 1 blocks (256GB).  The memory must be 64-byte aligned for
+   the blocks to sit on cache lines, but any 16-byte alignment works.
+   
+   Include meow_intrinsics.h and meow_hash.h first.
+   
+   ======================================================================== */
+
+#include <string.h>
+
+#define MEOW_BLOOM_MAGIC 0x314D4C4257454F4Dull // NOTE: "MEOWBLM1"
+#define MEOW_BLOOM_VERSION 1
+#define MEOW_BLOOM_BLOCK 64
+#define MEOW_BLOOM_PROBES 8
+#define MEOW_BLOOM_BATCH 16
+
+typedef struct meow_bloom_header
+{
+    meow_u64 Magic;
+    meow_u32 Version;
+    meow_u32 Probes;
+    meow_u64 BlockCount;
+    meow_u64 Seed1;
+    meow_u64 Seed2;
+    meow_u64 Reserved[3];
+} meow_bloom_header;
+
+typedef struct meow_bloom
+{
+    meow_bloom_header *Header;
+    meow_u8 *Blocks;
+    meow_u64 BlockCount;
+} meow_bloom;
+
+static meow_umm
+MeowBloomBlockCount(meow_u64 ExpectedCount, meow_u32 BitsPerKey)
+{
+    meow_u64 Bits = ExpectedCount*BitsPerKey;
+    meow_umm Result = (meow_umm)((Bits + 8*MEOW_BLOOM_BLOCK - 1) / (8*MEOW_BLOOM_BLOCK));
+    if(Result == 0)
+    {
+        Result = 1;
+    }
+    return(Result);
+}
+
+static meow_umm
+MeowBloomSize(meow_umm BlockCount)
+{
+    meow_umm Result = sizeof(meow_bloom_header) + BlockCount*MEOW_BLOOM_BLOCK;
+    return(Result);
+}
+
+static void
+MeowBloomInit(meow_bloom *Bloom, void *Memory, meow_umm BlockCount, meow_u64 Seed1, meow_u64 Seed2)
+{
+    memset(Memory, 0, MeowBloomSize(BlockCount));
+    
+    meow_bloom_header *Header = (meow_bloom_header *)Memory;
+    Header->Magic = MEOW_BLOOM_MAGIC;
+    Header->Version = MEOW_BLOOM_VERSION;
+    Header->Probes = MEOW_BLOOM_PROBES;
+    Header->BlockCount = BlockCount;
+    Header->Seed1 = Seed1;
+    Header->Seed2 = Seed2;
+    
+    Bloom->Header = Header;
+    Bloom->Blocks = (meow_u8 *)Memory + sizeof(meow_bloom_header);
+    Bloom->BlockCount = BlockCount;
+}
+
+static int
+MeowBloomFromMemory(meow_bloom *Bloom, void *Memory, meow_umm Size)
+{
+    memset(Bloom, 0, sizeof(*Bloom));
+    
+    meow_bloom_header *Header = (meow_bloom_header *)Memory;
+    int Result = (Memory &&
+                  (Size >= sizeof(meow_bloom_header)) &&
+                  (Header->Magic == MEOW_BLOOM_MAGIC) &&
+                  (Header->Version == MEOW_BLOOM_VERSION) &&
+                  (Header->Probes == MEOW_BLOOM_PROBES) &&
+                  (Header->BlockCount > 0) &&
+                  (Header->BlockCount < ((meow_u64)1 << 32)) &&
+                  (Header->BlockCount <= (Size - sizeof(meow_bloom_header)) / MEOW_BLOOM_BLOCK));
+    if(Result)
+    {
+        Bloom->Header = Header;
+        Bloom->Blocks = (meow_u8 *)Memory + sizeof(meow_bloom_header);
+        Bloom->BlockCount = Header->BlockCount;
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Lanes 0 and 1 (the low 64 bits) scaled onto [0, BlockCount) with
+// two 32-bit multiplies, which is exact for any BlockCount below 2^32
+//
+
+static meow_u8 *
+MeowBloomBlock(meow_bloom *Bloom, meow_hash Hash)
+{
+    meow_u64 Low = MeowU64From(Hash, 0);
+    meow_u64 Scaled = ((Low >> 32)*Bloom->BlockCount + (((Low & 0xFFFFFFFF)*Bloom->BlockCount) >> 32)) >> 32;
+    meow_u8 *Result = Bloom->Blocks + Scaled*MEOW_BLOOM_BLOCK;
+    return(Result);
+}
+
+//
+// NOTE: The probe masks.  Probe I is V = H1 + I*H2; its top bit picks word
+// 2I or 2I+1, and the next five bits pick the bit in that word.  Each
+// 128-bit quarter of the block covers two probes, so the probe values are
+// duplicated into word pairs, and each word keeps its bit only if its
+// parity matches the probe's top bit.
+//
+
+#if MEOW_HASH_INTEL
+
+typedef struct meow_bloom_mask
+{
+    __m128i Quarter[4];
+} meow_bloom_mask;
+
+static __m128i
+MeowBloomQuarterMask(__m128i Probes)
+{
+    __m128i Parity = _mm_set_epi32(-1, 0, -1, 0);
+    __m128i Keep = _mm_cmpeq_epi32(_mm_srai_epi32(Probes, 31), Parity);
+    
+    // NOTE: 1 << Bit by building the float 2^Bit and truncating it.  2^31
+    // overflows the conversion, which gives 0x80000000 - exactly 1 << 31.
+    __m128i Bit = _mm_srli_epi32(_mm_slli_epi32(Probes, 1), 27);
+    __m128i Power = _mm_cvttps_epi32(_mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(Bit, _mm_set1_epi32(127)), 23)));
+    
+    __m128i Result = _mm_and_si128(Power, Keep);
+    return(Result);
+}
+
+static void
+MeowBloomMaskOf(meow_hash Hash, meow_bloom_mask *Mask)
+{
+    meow_u32 H1 = MeowU32From(Hash, 2);
+    meow_u32 H2 = MeowU32From(Hash, 3);
+    
+    __m128i Step = _mm_set1_epi32((int)(4*H2));
+    __m128i Probes0 = _mm_add_epi32(_mm_set1_epi32((int)H1), _mm_set_epi32((int)(3*H2), (int)(2*H2), (int)H2, 0));
+    __m128i Probes1 = _mm_add_epi32(Probes0, Step);
+    
+    Mask->Quarter[0] = MeowBloomQuarterMask(_mm_unpacklo_epi32(Probes0, Probes0));
+    Mask->Quarter[1] = MeowBloomQuarterMask(_mm_unpackhi_epi32(Probes0, Probes0));
+    Mask->Quarter[2] = MeowBloomQuarterMask(_mm_unpacklo_epi32(Probes1, Probes1));
+    Mask->Quarter[3] = MeowBloomQuarterMask(_mm_unpackhi_epi32(Probes1, Probes1));
+}
+
+static int
+MeowBloomBlockHas(meow_u8 *Block, meow_bloom_mask *Mask)
+{
+    __m128i Missing = _mm_setzero_si128();
+    for(int Quarter = 0;
+        Quarter < 4;
+        ++Quarter)
+    {
+        __m128i Bits = _mm_loadu_si128((__m128i *)Block + Quarter);
+        Missing = _mm_or_si128(Missing, _mm_andnot_si128(Bits, Mask->Quarter[Quarter]));
+    }
+    
+    int Result = (_mm_movemask_epi8(_mm_cmpeq_epi32(Missing, _mm_setzero_si128())) == 0xFFFF);
+    return(Result);
+}
+
+static void
+MeowBloomBlockSet(meow_u8 *Block, meow_bloom_mask *Mask)
+{
+    for(int Quarter = 0;
+        Quarter < 4;
+        ++Quarter)
+    {
+        __m128i *Bits = (__m128i *)Block + Quarter;
+        _mm_storeu_si128(Bits, _mm_or_si128(_mm_loadu_si128(Bits), Mask->Quarter[Quarter]));
+    }
+}
+
+static void
+MeowBloomOr(meow_u8 *Dest, meow_u8 *Source, meow_umm Size)
+{
+    for(meow_umm At = 0;
+        At < Size;
+        At += 16)
+    {
+        __m128i Bits = _mm_or_si128(_mm_loadu_si128((__m128i *)(Dest + At)), _mm_loadu_si128((__m128i *)(Source + At)));
+        _mm_storeu_si128((__m128i *)(Dest + At), Bits);
+    }
+}
+
+#elif MEOW_HASH_ARMV8
+
+typedef struct meow_bloom_mask
+{
+    uint32x4_t Quarter[4];
+} meow_bloom_mask;
+
+static uint32x4_t
+MeowBloomQuarterMask(uint32x4_t Probes)
+{
+    static meow_u32 const ParityValues[4] = {0, 0xFFFFFFFF, 0, 0xFFFFFFFF};
+    uint32x4_t Keep = vceqq_u32(vreinterpretq_u32_s32(vshrq_n_s32(vreinterpretq_s32_u32(Probes), 31)), vld1q_u32(ParityValues));
+    int32x4_t Bit = vreinterpretq_s32_u32(vshrq_n_u32(vshlq_n_u32(Probes, 1), 27));
+    uint32x4_t Result = vandq_u32(vshlq_u32(vdupq_n_u32(1), Bit), Keep);
+    return(Result);
+}
+
+static void
+MeowBloomMaskOf(meow_hash Hash, meow_bloom_mask *Mask)
+{
+    meow_u32 H1 = MeowU32From(Hash, 2);
+    meow_u32 H2 = MeowU32From(Hash, 3);
+    
+    meow_u32 const Multiples[4] = {0, H2, 2*H2, 3*H2};
+    uint32x4_t Probes0 = vaddq_u32(vdupq_n_u32(H1), vld1q_u32(Multiples));
+    uint32x4_t Probes1 = vaddq_u32(Probes0, vdupq_n_u32(4*H2));
+    
+    Mask->Quarter[0] = MeowBloomQuarterMask(vzip1q_u32(Probes0, Probes0));
+    Mask->Quarter[1] = MeowBloomQuarterMask(vzip2q_u32(Probes0, Probes0));
+    Mask->Quarter[2] = MeowBloomQuarterMask(vzip1q_u32(Probes1, Probes1));
+    Mask->Quarter[3] = MeowBloomQuarterMask(vzip2q_u32(Probes1, Probes1));
+}
+
+static int
+MeowBloomBlockHas(meow_u8 *Block, meow_bloom_mask *Mask)
+{
+    uint32x4_t Missing = vdupq_n_u32(0);
+    for(int Quarter = 0;
+        Quarter < 4;
+        ++Quarter)
+    {
+        uint32x4_t Bits = vld1q_u32((meow_u32 *)Block + 4*Quarter);
+        Missing = vorrq_u32(Missing, vbicq_u32(Mask->Quarter[Quarter], Bits));
+    }
+    
+    int Result = (vmaxvq_u32(Missing) == 0);
+    return(Result);
+}
+
+static void
+MeowBloomBlockSet(meow_u8 *Block, meow_bloom_mask *Mask)
+{
+    for(int Quarter = 0;
+        Quarter < 4;
+        ++Quarter)
+    {
+        meow_u32 *Bits = (meow_u32 *)Block + 4*Quarter;
+        vst1q_u32(Bits, vorrq_u32(vld1q_u32(Bits), Mask->Quarter[Quarter]));
+    }
+}
+
+static void
+MeowBloomOr(meow_u8 *Dest, meow_u8 *Source, meow_umm Size)
+{
+    for(meow_umm At = 0;
+        At < Size;
+        At += 16)
+    {
+        vst1q_u8(Dest + At, vorrq_u8(vld1q_u8(Dest + At), vld1q_u8(Source + At)));
+    }
+}
+
+#endif
+
+//
+// NOTE: Single keys
+//
+
+static void
+MeowBloomInsert(meow_bloom *Bloom, meow_hash Hash)
+{
+    meow_bloom_mask Mask;
+    MeowBloomMaskOf(Hash, &Mask);
+    MeowBloomBlockSet(MeowBloomBlock(Bloom, Hash), &Mask);
+}
+
+static int
+MeowBloomContains(meow_bloom *Bloom, meow_hash Hash)
+{
+    meow_bloom_mask Mask;
+    MeowBloomMaskOf(Hash, &Mask);
+    int Result = MeowBloomBlockHas(MeowBloomBlock(Bloom, Hash), &Mask);
+    return(Result);
+}
+
+static void
+MeowBloomInsertKey(meow_bloom *Bloom, meow_umm Len, void *Key)
+{
+    MeowBloomInsert(Bloom, MeowHash_Accelerated(Bloom->Header->Seed1, Bloom->Header->Seed2, Len, Key));
+}
+
+static int
+MeowBloomContainsKey(meow_bloom *Bloom, meow_umm Len, void *Key)
+{
+    int Result = MeowBloomContains(Bloom, MeowHash_Accelerated(Bloom->Header->Seed1, Bloom->Header->Seed2, Len, Key));
+    return(Result);
+}
+
+//
+// NOTE: Batches
+//
+
+static void
+MeowBloomInsertBatch(meow_bloom *Bloom, meow_umm Count, meow_hash *Hashes)
+{
+    meow_u8 *Blocks[MEOW_BLOOM_BATCH];
+    for(meow_umm Base = 0;
+        Base < Count;
+        Base += MEOW_BLOOM_BATCH)
+    {
+        meow_umm BatchCount = ((Count - Base) < MEOW_BLOOM_BATCH) ? (Count - Base) : MEOW_BLOOM_BATCH;
+        
+        for(meow_umm Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            Blocks[Index] = MeowBloomBlock(Bloom, Hashes[Base + Index]);
+            MeowPrefetch(Blocks[Index]);
+        }
+        
+        for(meow_umm Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            meow_bloom_mask Mask;
+            MeowBloomMaskOf(Hashes[Base + Index], &Mask);
+            MeowBloomBlockSet(Blocks[Index], &Mask);
+        }
+    }
+}
+
+// NOTE: Results[N] is set to 1 for maybe and 0 for no
+static void
+MeowBloomContainsBatch(meow_bloom *Bloom, meow_umm Count, meow_hash *Hashes, meow_u8 *Results)
+{
+    meow_u8 *Blocks[MEOW_BLOOM_BATCH];
+    for(meow_umm Base = 0;
+        Base < Count;
+        Base += MEOW_BLOOM_BATCH)
+    {
+        meow_umm BatchCount = ((Count - Base) < MEOW_BLOOM_BATCH) ? (Count - Base) : MEOW_BLOOM_BATCH;
+        
+        for(meow_umm Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            Blocks[Index] = MeowBloomBlock(Bloom, Hashes[Base + Index]);
+            MeowPrefetch(Blocks[Index]);
+        }
+        
+        for(meow_umm Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            meow_bloom_mask Mask;
+            MeowBloomMaskOf(Hashes[Base + Index], &Mask);
+            Results[Base + Index] = (meow_u8)MeowBloomBlockHas(Blocks[Index], &Mask);
+        }
+    }
+}
+
+// NOTE: Returns 0, and leaves Dest alone, if the filters are not the same shape and seeds
+static int
+MeowBloomMerge(meow_bloom *Dest, meow_bloom *Source)
+{
+    int Result = ((Dest->BlockCount == Source->BlockCount) &&
+                  (Dest->Header->Seed1 == Source->Header->Seed1) &&
+                  (Dest->Header->Seed2 == Source->Header->Seed2));
+    if(Result)
+    {
+        MeowBloomOr(Dest->Blocks, Source->Blocks, Dest->BlockCount*MEOW_BLOOM_BLOCK);
+    }
+    
+    return(Result);
+}
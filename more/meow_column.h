@@ -0,0 +1,623 @@
+/* ========================================================================
+   
+   meow_column.h - hashing whole columns of keys with the Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Calling MeowHash_Accelerated once per key pays for the setup, the tail
+   and the whole reduction tree every time, and for short keys that is a
+   single dependent chain of AESDECs which leaves most of the AES pipeline
+   idle.  These routines hash many keys per call instead, running several
+   keys through the pipeline at once.  Every key hashes EXACTLY the same as
+   MeowHash_Accelerated(Seed1, Seed2, Width, Key) would, so the values can
+   be mixed freely with ones computed one at a time.
+   
+   MeowHashRows hashes Count fixed-width rows, Stride bytes apart (row-major
+   records, or one field of an array of structs):
+   
+       MeowHashRows(Seed1, Seed2, Base, Stride, Width, Count, OutBits, Out);
+   
+   OutBits picks the output column: 32 (meow_u32 *), 64 (meow_u64 *) or
+   128 (meow_hash *).  The 32 and 64-bit outputs are the low bits of the
+   hash, ie. MeowU32From(Hash, 0) and MeowU64From(Hash, 0).
+   
+   Rows whose 16-byte tail load could run past the end of the last row are
+   hashed with MeowHash_Accelerated, so no byte past Base + (Count - 1)*Stride
+   + Width is ever read by the batched code.
+   
+   MeowHashStringColumn32/64 hash an Arrow-style string column: Count + 1
+   offsets (32 or 64-bit) into one contiguous Data buffer, where string i
+   is Data[Offsets[i]] .. Data[Offsets[i + 1] - 1]:
+   
+       MeowHashStringColumn32(Seed1, Seed2, Offsets, Data, Count, OutBits, Out);
+   
+   Each chunk of 256 strings is first sorted into classes whose tails have
+   the same shape, then each class is hashed a group at a time.  Only strings whose tail
+   load would run past Data + Offsets[Count] need the page-end checks, so
+   those (and strings of 64 bytes or more) go through MeowHash_Accelerated.
+   Arrow's signed int32/int64 offsets can be passed as they are.
+   
+   MeowHashBatch hashes Count unrelated buffers, each with its own length
+   and seeds, into a meow_hash array, the same way:
+   
+       MeowHashBatch(Count, Sources, Lens, Seeds1, Seeds2, Hashes);
+   
+   Include meow_intrinsics.h and meow_hash.h first.
+   
+   ======================================================================== */
+
+#define MEOW_COLUMN_ROWS 4
+
+#if _MSC_VER
+#define MEOW_COLUMN_INLINE __forceinline
+#else
+#define MEOW_COLUMN_INLINE inline __attribute__((always_inline))
+#endif
+
+//
+// NOTE: Everything about a hash that depends only on the seed and the length.
+// All keys of one length start from the same lanes, and a lane that none of
+// their bytes land in stays constant all the way through its part of the
+// reduction tree, so that part is computed once here rather than per key.
+//
+
+struct meow_column_constants
+{
+    meow_u128 Mixer;
+    
+    meow_aes_128 Lane[4];   // NOTE: Lane i XORed with the mixer, before any input
+    meow_aes_128 Mixed[4];  // NOTE: Lane i with no input, AESDECed with the mixer
+    meow_aes_128 Folded01;  // NOTE: Lane 0 after folding in lane 1, with no input in either
+    meow_aes_128 Folded23;  // NOTE: Lane 2 after folding in lane 3 and the mixer, with no input in either
+};
+
+static void
+MeowColumnConstants(meow_column_constants *Constants, meow_u64 Seed1, meow_u64 Seed2, meow_u64 Len)
+{
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - Len, Seed2 + Len + 1);
+    Constants->Mixer = Mixer;
+    
+    Constants->Lane[0] = Meow128_GetAESConstant(MeowS0Init);
+    Constants->Lane[1] = Meow128_GetAESConstant(MeowS1Init);
+    Constants->Lane[2] = Meow128_GetAESConstant(MeowS2Init);
+    Constants->Lane[3] = Meow128_GetAESConstant(MeowS3Init);
+    for(int LaneIndex = 0;
+        LaneIndex < 4;
+        ++LaneIndex)
+    {
+        Constants->Lane[LaneIndex] ^= Mixer;
+        Constants->Mixed[LaneIndex] = Meow128_AESDEC(Constants->Lane[LaneIndex], Mixer);
+    }
+    
+    Constants->Folded01 = Meow128_AESDEC(Constants->Mixed[0], Meow128_AESDEC_Finalize(Constants->Mixed[1]));
+    Constants->Folded23 = Meow128_AESDEC(Constants->Mixed[2], Meow128_AESDEC_Finalize(Constants->Mixed[3]));
+    Constants->Folded23 = Meow128_AESDEC(Constants->Folded23, Mixer);
+}
+
+static void
+MeowColumnStore(void *Out, int OutBits, meow_umm Index, meow_hash Hash)
+{
+    switch(OutBits)
+    {
+        case 32: ((meow_u32 *)Out)[Index] = MeowU32From(Hash, 0); break;
+        case 64: ((meow_u64 *)Out)[Index] = MeowU64From(Hash, 0); break;
+        default: ((meow_hash *)Out)[Index] = Hash; break;
+    }
+}
+
+//
+// NOTE: Hashes MEOW_COLUMN_ROWS keys of the same Len, interleaved so that
+// their AESDEC chains overlap.  This is MeowHash_Accelerated step for step.
+// It is always inlined, so when Len is a constant every length test below
+// folds away and only the lanes the key actually touches are computed.
+//
+// The partial tail is a plain 16-byte load, so the caller must make sure
+// 16 bytes starting at Source[Row] + (Len & ~15) are readable.
+//
+
+static MEOW_COLUMN_INLINE void
+MeowHashColumnGroup(meow_column_constants *Constants, meow_u64 Len, meow_u8 **Source, meow_hash *Hashes)
+{
+    meow_u128 Mixer = Constants->Mixer;
+    int unsigned Len8 = Len & 15;
+    int unsigned Len128 = Len & 48;
+    
+    int Touched0 = (Len >= 64) || (Len128 >= 16);
+    int Touched1 = (Len >= 64) || (Len128 >= 32);
+    int Touched2 = (Len >= 64) || (Len128 >= 48);
+    int Touched3 = (Len >= 64) || (Len8 != 0);
+    
+    meow_aes_128 S0[MEOW_COLUMN_ROWS];
+    meow_aes_128 S1[MEOW_COLUMN_ROWS];
+    meow_aes_128 S2[MEOW_COLUMN_ROWS];
+    meow_aes_128 S3[MEOW_COLUMN_ROWS];
+    meow_u8 *At[MEOW_COLUMN_ROWS];
+    for(int Row = 0;
+        Row < MEOW_COLUMN_ROWS;
+        ++Row)
+    {
+        S0[Row] = Constants->Lane[0];
+        S1[Row] = Constants->Lane[1];
+        S2[Row] = Constants->Lane[2];
+        S3[Row] = Constants->Lane[3];
+        At[Row] = Source[Row];
+    }
+    
+    //
+    // NOTE: Full 64-byte blocks
+    //
+    
+    for(meow_u64 Block = (Len >> 6);
+        Block;
+        --Block)
+    {
+        for(int Row = 0;
+            Row < MEOW_COLUMN_ROWS;
+            ++Row)
+        {
+            S0[Row] = Meow128_AESDEC_Memx2(S0[Row], At[Row]);
+            S1[Row] = Meow128_AESDEC_Memx2(S1[Row], At[Row] + 16);
+            S2[Row] = Meow128_AESDEC_Memx2(S2[Row], At[Row] + 32);
+            S3[Row] = Meow128_AESDEC_Memx2(S3[Row], At[Row] + 48);
+            At[Row] += 64;
+        }
+    }
+    
+    //
+    // NOTE: Overhanging bytes and full 128-bit lanes
+    //
+    
+    for(int Row = 0;
+        Row < MEOW_COLUMN_ROWS;
+        ++Row)
+    {
+        if(Len8)
+        {
+            meow_u128 Partial = Meow128_And_Mem(Meow128_Loadu(At[Row] + Len128), &MeowMaskLen[16 - Len8]);
+            S3[Row] = Meow128_AESDECx2(S3[Row], Partial);
+        }
+        if(Len128 >= 48)
+        {
+            S2[Row] = Meow128_AESDEC_Memx2(S2[Row], At[Row] + 32);
+        }
+        if(Len128 >= 32)
+        {
+            S1[Row] = Meow128_AESDEC_Memx2(S1[Row], At[Row] + 16);
+        }
+        if(Len128 >= 16)
+        {
+            S0[Row] = Meow128_AESDEC_Memx2(S0[Row], At[Row]);
+        }
+    }
+    
+    //
+    // NOTE: Mix the four lanes down to one 128-bit hash, taking the untouched
+    // lanes from the constants
+    //
+    
+    for(int Row = 0;
+        Row < MEOW_COLUMN_ROWS;
+        ++Row)
+    {
+        meow_aes_128 Upper = Constants->Folded23;
+        if(Touched2 || Touched3)
+        {
+            meow_aes_128 M3 = Touched3 ? Meow128_AESDEC(S3[Row], Mixer) : Constants->Mixed[3];
+            meow_aes_128 M2 = Touched2 ? Meow128_AESDEC(S2[Row], Mixer) : Constants->Mixed[2];
+            Upper = Meow128_AESDEC(M2, Meow128_AESDEC_Finalize(M3));
+            Upper = Meow128_AESDEC(Upper, Mixer);
+        }
+        
+        meow_aes_128 Lower = Constants->Folded01;
+        if(Touched0 || Touched1)
+        {
+            meow_aes_128 M1 = Touched1 ? Meow128_AESDEC(S1[Row], Mixer) : Constants->Mixed[1];
+            meow_aes_128 M0 = Touched0 ? Meow128_AESDEC(S0[Row], Mixer) : Constants->Mixed[0];
+            Lower = Meow128_AESDEC(M0, Meow128_AESDEC_Finalize(M1));
+        }
+        
+        Lower = Meow128_AESDEC(Lower, Meow128_AESDEC_Finalize(Upper));
+        Lower = Meow128_AESDEC(Lower, Mixer);
+        
+        Meow128_CopyToHash(Meow128_AESDEC_Finalize(Lower), Hashes[Row]);
+    }
+}
+
+static MEOW_COLUMN_INLINE void
+MeowHashRowsWidth(meow_column_constants *Constants, meow_u8 *Base, meow_umm Stride, meow_u64 Width,
+                  meow_umm Count, int OutBits, void *Out)
+{
+    meow_hash Hashes[MEOW_COLUMN_ROWS];
+    meow_u8 *Source[MEOW_COLUMN_ROWS];
+    for(meow_umm RowIndex = 0;
+        (RowIndex + MEOW_COLUMN_ROWS) <= Count;
+        RowIndex += MEOW_COLUMN_ROWS)
+    {
+        for(int Row = 0;
+            Row < MEOW_COLUMN_ROWS;
+            ++Row)
+        {
+            Source[Row] = Base + (RowIndex + Row)*Stride;
+        }
+        
+        MeowHashColumnGroup(Constants, Width, Source, Hashes);
+        
+        for(int Row = 0;
+            Row < MEOW_COLUMN_ROWS;
+            ++Row)
+        {
+            MeowColumnStore(Out, OutBits, RowIndex + Row, Hashes[Row]);
+        }
+    }
+}
+
+static inline void
+MeowHashRows(meow_u64 Seed1, meow_u64 Seed2, void *BaseInit, meow_umm Stride, meow_u64 Width,
+             meow_umm Count, int OutBits, void *Out)
+{
+    meow_u8 *Base = (meow_u8 *)BaseInit;
+    
+    //
+    // NOTE: The partial load reads 16 bytes from the last 16-byte boundary of
+    // the row, which is only safe while that stays inside the rows after it
+    //
+    
+    meow_umm BatchCount = Count;
+    int unsigned Len8 = Width & 15;
+    if(Len8)
+    {
+        meow_umm OverRead = 16 - Len8;
+        meow_umm UnsafeRows = Stride ? ((OverRead + Stride - 1) / Stride) : Count;
+        BatchCount = (Count > UnsafeRows) ? (Count - UnsafeRows) : 0;
+    }
+    BatchCount -= BatchCount % MEOW_COLUMN_ROWS;
+    
+    meow_column_constants Constants;
+    MeowColumnConstants(&Constants, Seed1, Seed2, Width);
+    
+    // NOTE: Common key widths get their own copy of the loop with Width folded in
+    switch(Width)
+    {
+        case 4: MeowHashRowsWidth(&Constants, Base, Stride, 4, BatchCount, OutBits, Out); break;
+        case 8: MeowHashRowsWidth(&Constants, Base, Stride, 8, BatchCount, OutBits, Out); break;
+        case 12: MeowHashRowsWidth(&Constants, Base, Stride, 12, BatchCount, OutBits, Out); break;
+        case 16: MeowHashRowsWidth(&Constants, Base, Stride, 16, BatchCount, OutBits, Out); break;
+        case 20: MeowHashRowsWidth(&Constants, Base, Stride, 20, BatchCount, OutBits, Out); break;
+        case 24: MeowHashRowsWidth(&Constants, Base, Stride, 24, BatchCount, OutBits, Out); break;
+        case 32: MeowHashRowsWidth(&Constants, Base, Stride, 32, BatchCount, OutBits, Out); break;
+        case 40: MeowHashRowsWidth(&Constants, Base, Stride, 40, BatchCount, OutBits, Out); break;
+        case 48: MeowHashRowsWidth(&Constants, Base, Stride, 48, BatchCount, OutBits, Out); break;
+        case 64: MeowHashRowsWidth(&Constants, Base, Stride, 64, BatchCount, OutBits, Out); break;
+        
+        // NOTE: Other widths still get Width & 48 folded in, since that decides
+        // which lanes are live in the tail and the reduction
+        default:
+        {
+            switch(Width & 48)
+            {
+                case 0: MeowHashRowsWidth(&Constants, Base, Stride, Width & ~48ULL, BatchCount, OutBits, Out); break;
+                case 16: MeowHashRowsWidth(&Constants, Base, Stride, (Width & ~48ULL) | 16, BatchCount, OutBits, Out); break;
+                case 32: MeowHashRowsWidth(&Constants, Base, Stride, (Width & ~48ULL) | 32, BatchCount, OutBits, Out); break;
+                case 48: MeowHashRowsWidth(&Constants, Base, Stride, (Width & ~48ULL) | 48, BatchCount, OutBits, Out); break;
+            }
+        } break;
+    }
+    
+    for(meow_umm RowIndex = BatchCount;
+        RowIndex < Count;
+        ++RowIndex)
+    {
+        meow_hash Hash = MeowHash_Accelerated(Seed1, Seed2, Width, Base + RowIndex*Stride);
+        MeowColumnStore(Out, OutBits, RowIndex, Hash);
+    }
+}
+
+//
+// NOTE: Variable-length strings.  Every string has its own length, and so its
+// own mixer, so nothing can be shared between them the way it is for rows.
+// What does carry over is the shape: strings under 64 bytes with the same
+// Len & 48 and the same (Len & 15) != 0 touch the same lanes the same way,
+// so they can run through the pipeline together with no branches at all.
+//
+
+#define MEOW_COLUMN_STRING_CLASSES 8
+#define MEOW_COLUMN_STRING_CHUNK 256
+
+static MEOW_COLUMN_INLINE meow_u32
+MeowColumnStringClass(meow_u64 Len)
+{
+    meow_u32 Result = (meow_u32)(((Len & 48) >> 4) | ((Len & 15) ? 4 : 0));
+    return(Result);
+}
+
+static MEOW_COLUMN_INLINE void
+MeowHashStringGroup(meow_u64 *Seed1, meow_u64 *Seed2, int unsigned Len128, int HasPartial,
+                    meow_u8 **Source, meow_u64 *Len, meow_hash *Hashes)
+{
+    meow_aes_128 Init0 = Meow128_GetAESConstant(MeowS0Init);
+    meow_aes_128 Init1 = Meow128_GetAESConstant(MeowS1Init);
+    meow_aes_128 Init2 = Meow128_GetAESConstant(MeowS2Init);
+    meow_aes_128 Init3 = Meow128_GetAESConstant(MeowS3Init);
+    
+    for(int Row = 0;
+        Row < MEOW_COLUMN_ROWS;
+        ++Row)
+    {
+        meow_u128 Mixer = Meow128_Set64x2(Seed1[Row] - Len[Row], Seed2[Row] + Len[Row] + 1);
+        meow_aes_128 S0 = Init0;
+        meow_aes_128 S1 = Init1;
+        meow_aes_128 S2 = Init2;
+        meow_aes_128 S3 = Init3;
+        S0 ^= Mixer;
+        S1 ^= Mixer;
+        S2 ^= Mixer;
+        S3 ^= Mixer;
+        
+        if(HasPartial)
+        {
+            int unsigned Len8 = Len[Row] & 15;
+            meow_u128 Partial = Meow128_And_Mem(Meow128_Loadu(Source[Row] + Len128), &MeowMaskLen[16 - Len8]);
+            S3 = Meow128_AESDECx2(S3, Partial);
+        }
+        if(Len128 >= 48)
+        {
+            S2 = Meow128_AESDEC_Memx2(S2, Source[Row] + 32);
+        }
+        if(Len128 >= 32)
+        {
+            S1 = Meow128_AESDEC_Memx2(S1, Source[Row] + 16);
+        }
+        if(Len128 >= 16)
+        {
+            S0 = Meow128_AESDEC_Memx2(S0, Source[Row]);
+        }
+        
+        S3 = Meow128_AESDEC(S3, Mixer);
+        S2 = Meow128_AESDEC(S2, Mixer);
+        S1 = Meow128_AESDEC(S1, Mixer);
+        S0 = Meow128_AESDEC(S0, Mixer);
+        
+        S2 = Meow128_AESDEC(S2, Meow128_AESDEC_Finalize(S3));
+        S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S1));
+        
+        S2 = Meow128_AESDEC(S2, Mixer);
+        
+        S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S2));
+        S0 = Meow128_AESDEC(S0, Mixer);
+        
+        Meow128_CopyToHash(Meow128_AESDEC_Finalize(S0), Hashes[Row]);
+    }
+}
+
+//
+// NOTE: Hashes every string of one class in a chunk, MEOW_COLUMN_ROWS at a
+// time.  A short last group is padded by hashing its last string again.
+//
+
+static MEOW_COLUMN_INLINE void
+MeowHashStringClassRun(meow_u64 Seed1, meow_u64 Seed2, int unsigned Len128, int HasPartial,
+                       meow_u8 *Data, meow_u64 *Starts, meow_u64 *Lens, meow_u16 *Members, meow_u32 MemberCount,
+                       meow_umm ChunkStart, int OutBits, void *Out)
+{
+    for(meow_u32 MemberIndex = 0;
+        MemberIndex < MemberCount;
+        MemberIndex += MEOW_COLUMN_ROWS)
+    {
+        meow_u32 Rows[MEOW_COLUMN_ROWS];
+        meow_u8 *Source[MEOW_COLUMN_ROWS];
+        meow_u64 GroupLens[MEOW_COLUMN_ROWS];
+        meow_u64 Seeds1[MEOW_COLUMN_ROWS];
+        meow_u64 Seeds2[MEOW_COLUMN_ROWS];
+        for(int Row = 0;
+            Row < MEOW_COLUMN_ROWS;
+            ++Row)
+        {
+            meow_u32 Member = MemberIndex + Row;
+            Rows[Row] = Members[(Member < MemberCount) ? Member : (MemberCount - 1)];
+            Source[Row] = Data + Starts[Rows[Row]];
+            GroupLens[Row] = Lens[Rows[Row]];
+            Seeds1[Row] = Seed1;
+            Seeds2[Row] = Seed2;
+        }
+        
+        meow_hash Hashes[MEOW_COLUMN_ROWS];
+        MeowHashStringGroup(Seeds1, Seeds2, Len128, HasPartial, Source, GroupLens, Hashes);
+        
+        for(int Row = 0;
+            Row < MEOW_COLUMN_ROWS;
+            ++Row)
+        {
+            MeowColumnStore(Out, OutBits, ChunkStart + Rows[Row], Hashes[Row]);
+        }
+    }
+}
+
+static MEOW_COLUMN_INLINE void
+MeowHashStringColumnOffsets(meow_u64 Seed1, meow_u64 Seed2, void *OffsetsInit, int OffsetBytes,
+                            void *DataInit, meow_umm Count, int OutBits, void *Out)
+{
+    meow_u8 *Data = (meow_u8 *)DataInit;
+    meow_u32 *Offsets32 = (meow_u32 *)OffsetsInit;
+    meow_u64 *Offsets64 = (meow_u64 *)OffsetsInit;
+    
+    //
+    // NOTE: Strings are back to back in Data, so a 16-byte tail load can only
+    // leave the column past the last string.  That is the one place checked.
+    //
+    
+    meow_u64 DataEnd = (OffsetBytes == 4) ? Offsets32[Count] : Offsets64[Count];
+    
+    meow_u64 Starts[MEOW_COLUMN_STRING_CHUNK];
+    meow_u64 Lens[MEOW_COLUMN_STRING_CHUNK];
+    meow_u16 Members[MEOW_COLUMN_STRING_CLASSES + 1][MEOW_COLUMN_STRING_CHUNK];
+    for(meow_umm ChunkStart = 0;
+        ChunkStart < Count;
+        ChunkStart += MEOW_COLUMN_STRING_CHUNK)
+    {
+        meow_u32 ChunkCount = MEOW_COLUMN_STRING_CHUNK;
+        if(ChunkCount > (Count - ChunkStart))
+        {
+            ChunkCount = (meow_u32)(Count - ChunkStart);
+        }
+        
+        //
+        // NOTE: Sort the chunk into classes first, so each class below runs
+        // as one loop with no data-dependent branches
+        //
+        
+        meow_u32 MemberCount[MEOW_COLUMN_STRING_CLASSES + 1] = {};
+        for(meow_u32 Index = 0;
+            Index < ChunkCount;
+            ++Index)
+        {
+            meow_umm At = ChunkStart + Index;
+            meow_u64 Start = (OffsetBytes == 4) ? Offsets32[At] : Offsets64[At];
+            meow_u64 End = (OffsetBytes == 4) ? Offsets32[At + 1] : Offsets64[At + 1];
+            meow_u64 Len = End - Start;
+            Starts[Index] = Start;
+            Lens[Index] = Len;
+            
+            // NOTE: Long strings keep all four lanes busy on their own, and the
+            // last few strings need MeowHash_Accelerated's page-safe tail
+            meow_u32 Class = MEOW_COLUMN_STRING_CLASSES;
+            if((Len < 64) && ((Start + (Len & 48) + 16) <= DataEnd))
+            {
+                Class = MeowColumnStringClass(Len);
+            }
+            Members[Class][MemberCount[Class]++] = (meow_u16)Index;
+        }
+        
+        MeowHashStringClassRun(Seed1, Seed2, 0, 0, Data, Starts, Lens, Members[0], MemberCount[0], ChunkStart, OutBits, Out);
+        MeowHashStringClassRun(Seed1, Seed2, 16, 0, Data, Starts, Lens, Members[1], MemberCount[1], ChunkStart, OutBits, Out);
+        MeowHashStringClassRun(Seed1, Seed2, 32, 0, Data, Starts, Lens, Members[2], MemberCount[2], ChunkStart, OutBits, Out);
+        MeowHashStringClassRun(Seed1, Seed2, 48, 0, Data, Starts, Lens, Members[3], MemberCount[3], ChunkStart, OutBits, Out);
+        MeowHashStringClassRun(Seed1, Seed2, 0, 1, Data, Starts, Lens, Members[4], MemberCount[4], ChunkStart, OutBits, Out);
+        MeowHashStringClassRun(Seed1, Seed2, 16, 1, Data, Starts, Lens, Members[5], MemberCount[5], ChunkStart, OutBits, Out);
+        MeowHashStringClassRun(Seed1, Seed2, 32, 1, Data, Starts, Lens, Members[6], MemberCount[6], ChunkStart, OutBits, Out);
+        MeowHashStringClassRun(Seed1, Seed2, 48, 1, Data, Starts, Lens, Members[7], MemberCount[7], ChunkStart, OutBits, Out);
+        
+        meow_u16 *Others = Members[MEOW_COLUMN_STRING_CLASSES];
+        for(meow_u32 MemberIndex = 0;
+            MemberIndex < MemberCount[MEOW_COLUMN_STRING_CLASSES];
+            ++MemberIndex)
+        {
+            meow_u16 Index = Others[MemberIndex];
+            meow_hash Hash = MeowHash_Accelerated(Seed1, Seed2, Lens[Index], Data + Starts[Index]);
+            MeowColumnStore(Out, OutBits, ChunkStart + Index, Hash);
+        }
+    }
+}
+
+static inline void
+MeowHashStringColumn32(meow_u64 Seed1, meow_u64 Seed2, meow_u32 *Offsets, void *Data,
+                       meow_umm Count, int OutBits, void *Out)
+{
+    MeowHashStringColumnOffsets(Seed1, Seed2, Offsets, 4, Data, Count, OutBits, Out);
+}
+
+static inline void
+MeowHashStringColumn64(meow_u64 Seed1, meow_u64 Seed2, meow_u64 *Offsets, void *Data,
+                       meow_umm Count, int OutBits, void *Out)
+{
+    MeowHashStringColumnOffsets(Seed1, Seed2, Offsets, 8, Data, Count, OutBits, Out);
+}
+
+//
+// NOTE: A batch of unrelated buffers, each with its own length and seeds, such
+// as a queue of small hash requests.  The strings are not next to each other
+// here, so a tail load is only batched when it stays inside the page its
+// first byte is in; anything else goes through MeowHash_Accelerated.
+//
+
+static MEOW_COLUMN_INLINE void
+MeowHashBatchClassRun(int unsigned Len128, int HasPartial, void **Sources, meow_u64 *Lens,
+                      meow_u64 *Seeds1, meow_u64 *Seeds2, meow_u16 *Members, meow_u32 MemberCount,
+                      meow_umm ChunkStart, meow_hash *Out)
+{
+    for(meow_u32 MemberIndex = 0;
+        MemberIndex < MemberCount;
+        MemberIndex += MEOW_COLUMN_ROWS)
+    {
+        meow_umm Rows[MEOW_COLUMN_ROWS];
+        meow_u8 *Source[MEOW_COLUMN_ROWS];
+        meow_u64 GroupLens[MEOW_COLUMN_ROWS];
+        meow_u64 GroupSeeds1[MEOW_COLUMN_ROWS];
+        meow_u64 GroupSeeds2[MEOW_COLUMN_ROWS];
+        for(int Row = 0;
+            Row < MEOW_COLUMN_ROWS;
+            ++Row)
+        {
+            meow_u32 Member = MemberIndex + Row;
+            Rows[Row] = ChunkStart + Members[(Member < MemberCount) ? Member : (MemberCount - 1)];
+            Source[Row] = (meow_u8 *)Sources[Rows[Row]];
+            GroupLens[Row] = Lens[Rows[Row]];
+            GroupSeeds1[Row] = Seeds1[Rows[Row]];
+            GroupSeeds2[Row] = Seeds2[Rows[Row]];
+        }
+        
+        meow_hash Hashes[MEOW_COLUMN_ROWS];
+        MeowHashStringGroup(GroupSeeds1, GroupSeeds2, Len128, HasPartial, Source, GroupLens, Hashes);
+        
+        for(int Row = 0;
+            Row < MEOW_COLUMN_ROWS;
+            ++Row)
+        {
+            Out[Rows[Row]] = Hashes[Row];
+        }
+    }
+}
+
+static void
+MeowHashBatch(meow_umm Count, void **Sources, meow_u64 *Lens, meow_u64 *Seeds1, meow_u64 *Seeds2, meow_hash *Out)
+{
+    meow_u16 Members[MEOW_COLUMN_STRING_CLASSES + 1][MEOW_COLUMN_STRING_CHUNK];
+    for(meow_umm ChunkStart = 0;
+        ChunkStart < Count;
+        ChunkStart += MEOW_COLUMN_STRING_CHUNK)
+    {
+        meow_u32 ChunkCount = MEOW_COLUMN_STRING_CHUNK;
+        if(ChunkCount > (Count - ChunkStart))
+        {
+            ChunkCount = (meow_u32)(Count - ChunkStart);
+        }
+        
+        meow_u32 MemberCount[MEOW_COLUMN_STRING_CLASSES + 1] = {};
+        for(meow_u32 Index = 0;
+            Index < ChunkCount;
+            ++Index)
+        {
+            meow_u64 Len = Lens[ChunkStart + Index];
+            meow_umm Tail = (meow_umm)Sources[ChunkStart + Index] + (Len & 48);
+            
+            meow_u32 Class = MEOW_COLUMN_STRING_CLASSES;
+            if((Len < 64) && (((Len & 15) == 0) || ((Tail & (MEOW_PAGESIZE - 1)) <= (MEOW_PAGESIZE - 16))))
+            {
+                Class = MeowColumnStringClass(Len);
+            }
+            Members[Class][MemberCount[Class]++] = (meow_u16)Index;
+        }
+        
+        MeowHashBatchClassRun(0, 0, Sources, Lens, Seeds1, Seeds2, Members[0], MemberCount[0], ChunkStart, Out);
+        MeowHashBatchClassRun(16, 0, Sources, Lens, Seeds1, Seeds2, Members[1], MemberCount[1], ChunkStart, Out);
+        MeowHashBatchClassRun(32, 0, Sources, Lens, Seeds1, Seeds2, Members[2], MemberCount[2], ChunkStart, Out);
+        MeowHashBatchClassRun(48, 0, Sources, Lens, Seeds1, Seeds2, Members[3], MemberCount[3], ChunkStart, Out);
+        MeowHashBatchClassRun(0, 1, Sources, Lens, Seeds1, Seeds2, Members[4], MemberCount[4], ChunkStart, Out);
+        MeowHashBatchClassRun(16, 1, Sources, Lens, Seeds1, Seeds2, Members[5], MemberCount[5], ChunkStart, Out);
+        MeowHashBatchClassRun(32, 1, Sources, Lens, Seeds1, Seeds2, Members[6], MemberCount[6], ChunkStart, Out);
+        MeowHashBatchClassRun(48, 1, Sources, Lens, Seeds1, Seeds2, Members[7], MemberCount[7], ChunkStart, Out);
+        
+        meow_u16 *Others = Members[MEOW_COLUMN_STRING_CLASSES];
+        for(meow_u32 MemberIndex = 0;
+            MemberIndex < MemberCount[MEOW_COLUMN_STRING_CLASSES];
+            ++MemberIndex)
+        {
+            meow_umm Index = ChunkStart + Others[MemberIndex];
+            Out[Index] = MeowHash_Accelerated(Seeds1[Index], Seeds2[Index], Lens[Index], Sources[Index]);
+        }
+    }
+}
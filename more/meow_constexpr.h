@@ -0,0 +1,291 @@
+/* ========================================================================
+   
+   meow_constexpr.h - compile-time (constexpr) version of the Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   This is the Meow hash written as C++14 constexpr code, so string literals
+   and static tables can be hashed by the compiler.  Its values are
+   bit-for-bit identical to MeowHash_Accelerated for the same seeds and
+   bytes, so a hash computed at runtime can be compared directly against
+   one computed at compile time:
+   
+       switch(MeowU64From(MeowHash_Accelerated(0, 0, Len, Name), 0))
+       {
+           case MeowHashLiteral64_Constexpr("position"): ...
+           case MeowHashLiteral64_Constexpr("normal"): ...
+       }
+   
+       constexpr meow_constexpr_hash Hash = MeowHashLiteral_Constexpr(Seed1, Seed2, "literal");
+       constexpr meow_constexpr_hash Hash = MeowHash_Constexpr(Seed1, Seed2, Len, Bytes);
+   
+   Literals are hashed WITHOUT their terminating zero, so they match hashing
+   the same std::string or string_view at runtime.  Sources may be char,
+   signed char or unsigned char arrays.
+   
+   It only needs meow_intrinsics.h (for the meow_uXX types), and the AES
+   tables are generated by the compiler rather than pulled from meow_more.h.
+   It is a software AES, so while it works at runtime too, it runs at about
+   the speed of MeowHash_C - use MeowHash_Accelerated for runtime hashing.
+   As with MeowHash_C, a little-endian target is assumed.
+   
+   ======================================================================== */
+
+struct meow_constexpr_tables
+{
+    meow_u32 Box0[256];
+};
+
+struct meow_constexpr_lane
+{
+    meow_u32 W[4];
+};
+
+struct meow_constexpr_hash
+{
+    meow_u32 u32[4];
+};
+
+static constexpr meow_u8
+MeowConstexprGFMul(meow_u8 A, meow_u8 B)
+{
+    meow_u8 Result = 0;
+    while(B)
+    {
+        if(B & 1)
+        {
+            Result ^= A;
+        }
+        A = (meow_u8)((A << 1) ^ ((A & 0x80) ? 0x1B : 0));
+        B >>= 1;
+    }
+    
+    return(Result);
+}
+
+static constexpr meow_u8
+MeowConstexprRotl8(meow_u8 Value, int Count)
+{
+    meow_u8 Result = (meow_u8)((Value << Count) | (Value >> (8 - Count)));
+    return(Result);
+}
+
+static constexpr meow_u32
+MeowConstexprRotr32(meow_u32 Value, int Count)
+{
+    meow_u32 Result = (Value >> Count) | (Value << (32 - Count));
+    return(Result);
+}
+
+//
+// NOTE: Builds MeowAESBox0 from meow_more.h: the inverse S-box followed by
+// InvMixColumns for a byte in row 0.  MeowAESBox1..3 are just this rotated
+// right by 8, 16 and 24 bits, so they are not stored.
+//
+
+static constexpr meow_constexpr_tables
+MeowConstexprBuildTables(void)
+{
+    // NOTE: Logarithms to base 3 give cheap GF(2^8) inverses
+    meow_u8 Exp[256] = {};
+    meow_u8 Log[256] = {};
+    meow_u8 X = 1;
+    for(int Index = 0;
+        Index < 255;
+        ++Index)
+    {
+        Exp[Index] = X;
+        Log[X] = (meow_u8)Index;
+        X = MeowConstexprGFMul(X, 3);
+    }
+    
+    meow_u8 InvSBox[256] = {};
+    for(int A = 0;
+        A < 256;
+        ++A)
+    {
+        meow_u8 B = A ? Exp[(255 - Log[A]) % 255] : 0;
+        meow_u8 S = (meow_u8)(B ^
+                              MeowConstexprRotl8(B, 1) ^
+                              MeowConstexprRotl8(B, 2) ^
+                              MeowConstexprRotl8(B, 3) ^
+                              MeowConstexprRotl8(B, 4) ^
+                              0x63);
+        InvSBox[S] = (meow_u8)A;
+    }
+    
+    meow_constexpr_tables Result = {};
+    for(int Y = 0;
+        Y < 256;
+        ++Y)
+    {
+        meow_u8 S = InvSBox[Y];
+        Result.Box0[Y] = (((meow_u32)MeowConstexprGFMul(S, 0x0E) <<  0) |
+                          ((meow_u32)MeowConstexprGFMul(S, 0x09) <<  8) |
+                          ((meow_u32)MeowConstexprGFMul(S, 0x0D) << 16) |
+                          ((meow_u32)MeowConstexprGFMul(S, 0x0B) << 24));
+    }
+    
+    return(Result);
+}
+
+static constexpr meow_constexpr_tables MeowConstexprTables = MeowConstexprBuildTables();
+
+static constexpr meow_u32
+MeowConstexprColumn(meow_u32 S0, meow_u32 S1, meow_u32 S2, meow_u32 S3)
+{
+    meow_u32 Result = (MeowConstexprTables.Box0[S0 & 0xFF] ^
+                       MeowConstexprRotr32(MeowConstexprTables.Box0[S1 >> 24], 8) ^
+                       MeowConstexprRotr32(MeowConstexprTables.Box0[(S2 >> 16) & 0xFF], 16) ^
+                       MeowConstexprRotr32(MeowConstexprTables.Box0[(S3 >> 8) & 0xFF], 24));
+    return(Result);
+}
+
+// NOTE: Same as Meow128_AESDEC_C in meow_more.h
+static constexpr meow_constexpr_lane
+MeowConstexprAESDEC(meow_constexpr_lane State, meow_constexpr_lane Key)
+{
+    meow_constexpr_lane Result = {};
+    Result.W[0] = MeowConstexprColumn(State.W[0], State.W[1], State.W[2], State.W[3]) ^ Key.W[0];
+    Result.W[1] = MeowConstexprColumn(State.W[1], State.W[2], State.W[3], State.W[0]) ^ Key.W[1];
+    Result.W[2] = MeowConstexprColumn(State.W[2], State.W[3], State.W[0], State.W[1]) ^ Key.W[2];
+    Result.W[3] = MeowConstexprColumn(State.W[3], State.W[0], State.W[1], State.W[2]) ^ Key.W[3];
+    return(Result);
+}
+
+static constexpr meow_constexpr_lane
+MeowConstexprAESDECx2(meow_constexpr_lane State, meow_constexpr_lane Key)
+{
+    State = MeowConstexprAESDEC(State, Key);
+    State = MeowConstexprAESDEC(State, Key);
+    return(State);
+}
+
+static constexpr meow_constexpr_lane
+MeowConstexprXor(meow_constexpr_lane A, meow_constexpr_lane B)
+{
+    meow_constexpr_lane Result = {{A.W[0] ^ B.W[0], A.W[1] ^ B.W[1], A.W[2] ^ B.W[2], A.W[3] ^ B.W[3]}};
+    return(Result);
+}
+
+// NOTE: Loads Count (at most 16) bytes into a lane, zero-filling the rest
+template<typename byte>
+static constexpr meow_constexpr_lane
+MeowConstexprLoad(byte const *Source, meow_u64 Count)
+{
+    meow_constexpr_lane Result = {};
+    for(meow_u64 Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        Result.W[Index >> 2] |= ((meow_u32)(meow_u8)Source[Index] << (8*(Index & 3)));
+    }
+    
+    return(Result);
+}
+
+// NOTE: The MEOW_Sn_INIT constants, which are just the bytes 16*n .. 16*n + 15
+static constexpr meow_constexpr_lane
+MeowConstexprInit(meow_u32 Lane)
+{
+    meow_constexpr_lane Result = {};
+    for(meow_u32 Word = 0;
+        Word < 4;
+        ++Word)
+    {
+        meow_u32 Byte = 16*Lane + 4*Word;
+        Result.W[Word] = (Byte | ((Byte + 1) << 8) | ((Byte + 2) << 16) | ((Byte + 3) << 24));
+    }
+    
+    return(Result);
+}
+
+template<typename byte>
+static constexpr meow_constexpr_hash
+MeowHash_Constexpr(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, byte const *Source)
+{
+    meow_u64 MixerLow = Seed1 - TotalLengthInBytes;
+    meow_u64 MixerHigh = Seed2 + TotalLengthInBytes + 1;
+    meow_constexpr_lane Mixer = {{(meow_u32)MixerLow, (meow_u32)(MixerLow >> 32),
+                                  (meow_u32)MixerHigh, (meow_u32)(MixerHigh >> 32)}};
+    
+    meow_constexpr_lane S0 = MeowConstexprXor(MeowConstexprInit(0), Mixer);
+    meow_constexpr_lane S1 = MeowConstexprXor(MeowConstexprInit(1), Mixer);
+    meow_constexpr_lane S2 = MeowConstexprXor(MeowConstexprInit(2), Mixer);
+    meow_constexpr_lane S3 = MeowConstexprXor(MeowConstexprInit(3), Mixer);
+    
+    meow_u64 Len = TotalLengthInBytes;
+    while(Len >= 64)
+    {
+        S0 = MeowConstexprAESDECx2(S0, MeowConstexprLoad(Source, 16));
+        S1 = MeowConstexprAESDECx2(S1, MeowConstexprLoad(Source + 16, 16));
+        S2 = MeowConstexprAESDECx2(S2, MeowConstexprLoad(Source + 32, 16));
+        S3 = MeowConstexprAESDECx2(S3, MeowConstexprLoad(Source + 48, 16));
+        
+        Len -= 64;
+        Source += 64;
+    }
+    
+    if(Len >= 48)
+    {
+        S2 = MeowConstexprAESDECx2(S2, MeowConstexprLoad(Source + 32, 16));
+    }
+    if(Len >= 32)
+    {
+        S1 = MeowConstexprAESDECx2(S1, MeowConstexprLoad(Source + 16, 16));
+    }
+    if(Len >= 16)
+    {
+        S0 = MeowConstexprAESDECx2(S0, MeowConstexprLoad(Source, 16));
+    }
+    if(Len & 15)
+    {
+        S3 = MeowConstexprAESDECx2(S3, MeowConstexprLoad(Source + (Len & 0x30), Len & 15));
+    }
+    
+    S3 = MeowConstexprAESDEC(S3, Mixer);
+    S2 = MeowConstexprAESDEC(S2, Mixer);
+    S1 = MeowConstexprAESDEC(S1, Mixer);
+    S0 = MeowConstexprAESDEC(S0, Mixer);
+    
+    S2 = MeowConstexprAESDEC(S2, S3);
+    S0 = MeowConstexprAESDEC(S0, S1);
+    
+    S2 = MeowConstexprAESDEC(S2, Mixer);
+    
+    S0 = MeowConstexprAESDEC(S0, S2);
+    S0 = MeowConstexprAESDEC(S0, Mixer);
+    
+    meow_constexpr_hash Result = {{S0.W[0], S0.W[1], S0.W[2], S0.W[3]}};
+    return(Result);
+}
+
+static constexpr meow_u64
+MeowConstexprU64From(meow_constexpr_hash Hash, int Index)
+{
+    meow_u64 Result = ((meow_u64)Hash.u32[2*Index] | ((meow_u64)Hash.u32[2*Index + 1] << 32));
+    return(Result);
+}
+
+// NOTE: String literals, without their terminating zero
+template<typename byte, size_t Count>
+static constexpr meow_constexpr_hash
+MeowHashLiteral_Constexpr(meow_u64 Seed1, meow_u64 Seed2, byte const (&Literal)[Count])
+{
+    meow_constexpr_hash Result = MeowHash_Constexpr(Seed1, Seed2, Count - 1, Literal);
+    return(Result);
+}
+
+// NOTE: Low 64 bits of the unseeded hash, ie. MeowU64From(MeowHash_Accelerated(0, 0, ...), 0)
+template<typename byte, size_t Count>
+static constexpr meow_u64
+MeowHashLiteral64_Constexpr(byte const (&Literal)[Count])
+{
+    meow_u64 Result = MeowConstexprU64From(MeowHash_Constexpr(0, 0, Count - 1, Literal), 0);
+    return(Result);
+}
@@ -0,0 +1,198 @@
+/* ========================================================================
+   
+   meow_cpp.h - header-only C++17 wrapper for the Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Include meow_intrinsics.h, meow_hash.h and more/meow_more.h first, then
+   this file.  Everything lives in namespace meow:
+   
+       meow::hasher Hasher(Seed1, Seed2);
+       meow_hash A = Hasher(Data, Size);        // raw bytes
+       meow_hash B = Hasher(std::string_view);  // also std::string, char const *
+       meow_hash C = Hasher(Vertex);            // any bytewise-hashable value
+       meow_hash D = Hasher(std::span(Array));  // C++20, when <span> exists
+   
+   meow::hash is a drop-in std::hash replacement that returns the low 64
+   bits of the Meow hash.  It is marked is_transparent, and all string-like
+   keys hash the same way, so std::string keys can be found with a
+   std::string_view or char const * (C++20 unordered containers, absl and
+   most other open-addressing tables) without building a temporary string:
+   
+       std::unordered_map<std::string, int, meow::hash, std::equal_to<>> Map;
+       Map.find(std::string_view("key"));
+   
+   meow::stream wraps meow_hash_state.  Meow needs the total length up front,
+   so it is passed to the constructor:
+   
+       meow::stream Stream(TotalLengthInBytes);
+       Stream.Absorb(Header).Absorb(Payload, PayloadSize);
+       meow_hash Hash = Stream.End();
+   
+   A value is "bytewise hashable" if hashing its object representation
+   is the same as hashing its value: trivially copyable, no padding bits
+   (std::has_unique_object_representations), and not a pointer or an array.
+   Those are hashed in place, with no copy.  Floating-point types are not
+   bytewise hashable (+0 and -0 compare equal), so hash them explicitly if
+   that is what you want.  Arrays decay to pointers, so a string literal
+   hashes the same as the equivalent std::string.
+   
+   ======================================================================== */
+
+#include <stddef.h>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(__has_include)
+#if __has_include(<span>) && (__cplusplus >= 202002L)
+#include <span>
+#define MEOW_CPP_SPAN 1
+#endif
+#endif
+
+namespace meow
+{
+
+template<typename T>
+struct is_bytewise_hashable : std::integral_constant<bool,
+    std::is_trivially_copyable<T>::value &&
+    std::has_unique_object_representations<T>::value &&
+    !std::is_pointer<T>::value &&
+    !std::is_array<T>::value>
+{
+};
+
+class hasher
+{
+public:
+    explicit hasher(meow_u64 Seed1Init = 0, meow_u64 Seed2Init = 0)
+        : Seed1(Seed1Init), Seed2(Seed2Init)
+    {
+    }
+    
+    meow_hash
+    operator()(void const *Data, size_t Size) const
+    {
+        meow_hash Result = MeowHash_Accelerated(Seed1, Seed2, Size, (void *)Data);
+        return(Result);
+    }
+    
+    meow_hash
+    operator()(std::string_view Value) const
+    {
+        meow_hash Result = (*this)(Value.data(), Value.size());
+        return(Result);
+    }
+    
+    meow_hash
+    operator()(char const *Value) const
+    {
+        meow_hash Result = (*this)(std::string_view(Value));
+        return(Result);
+    }
+    
+    template<typename T, typename = typename std::enable_if<is_bytewise_hashable<T>::value>::type>
+    meow_hash
+    operator()(T const &Value) const
+    {
+        meow_hash Result = (*this)(&Value, sizeof(Value));
+        return(Result);
+    }
+    
+#if MEOW_CPP_SPAN
+    template<typename T, size_t Extent, typename = typename std::enable_if<is_bytewise_hashable<T>::value>::type>
+    meow_hash
+    operator()(std::span<T, Extent> Values) const
+    {
+        meow_hash Result = (*this)(Values.data(), Values.size_bytes());
+        return(Result);
+    }
+#endif
+    
+    meow_u64 Seed1;
+    meow_u64 Seed2;
+};
+
+//
+// NOTE: std::hash-compatible functor.  Meow is designed to be truncated, so
+// the low 64 bits are as good a table hash as the full 128.
+//
+
+struct hash
+{
+    typedef void is_transparent;
+    
+    hash(meow_u64 Seed1 = 0, meow_u64 Seed2 = 0)
+        : Hasher(Seed1, Seed2)
+    {
+    }
+    
+    template<typename T>
+    size_t
+    operator()(T const &Value) const
+    {
+        meow_hash Hash = Hasher(Value);
+        size_t Result = (size_t)MeowU64From(Hash, 0);
+        return(Result);
+    }
+    
+    hasher Hasher;
+};
+
+//
+// NOTE: Streaming construction.  The state is set up by the constructor and
+// cannot be copied halfway through, so there is no way to use it un-begun.
+//
+
+class stream
+{
+public:
+    explicit stream(meow_u64 TotalLengthInBytes, meow_u64 Seed1Init = 0, meow_u64 Seed2Init = 0)
+        : Seed1(Seed1Init), Seed2(Seed2Init)
+    {
+        MeowHashBegin(&State, Seed1, Seed2, TotalLengthInBytes);
+    }
+    
+    stream(stream const &) = delete;
+    stream &operator=(stream const &) = delete;
+    
+    stream &
+    Absorb(void const *Data, size_t Size)
+    {
+        MeowHashAbsorb(&State, Size, (void *)Data);
+        return(*this);
+    }
+    
+    stream &
+    Absorb(std::string_view Value)
+    {
+        return(Absorb(Value.data(), Value.size()));
+    }
+    
+    template<typename T, typename = typename std::enable_if<is_bytewise_hashable<T>::value>::type>
+    stream &
+    Absorb(T const &Value)
+    {
+        return(Absorb(&Value, sizeof(Value)));
+    }
+    
+    meow_hash
+    End(void)
+    {
+        meow_hash Result = MeowHashEnd(&State, Seed1, Seed2);
+        return(Result);
+    }
+    
+private:
+    meow_hash_state State;
+    meow_u64 Seed1;
+    meow_u64 Seed2;
+};
+
+}
@@ -0,0 +1,163 @@
+/* ========================================================================
+   
+   meow_cpp_example.cpp - C++ usage examples of the Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ======================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <memory.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <functional>
+#include <vector>
+#include <future>
+#include <atomic>
+
+//
+// NOTE(casey): Step 1 - include an intrinsics header, then include meow_hash.h
+// and the streaming header, then the C++ wrapper
+//
+
+#include "meow_intrinsics.h"
+#include "meow_hash.h"
+#include "more/meow_more.h"
+#include "more/meow_cpp.h"
+#include "more/meow_column.h"
+#include "more/meow_service.h"
+
+struct vertex
+{
+    meow_u32 Position[3];
+    meow_u32 Color;
+};
+
+static void
+PrintHash(meow_hash Hash)
+{
+    printf("    %08X-%08X-%08X-%08X\n",
+           MeowU32From(Hash, 3),
+           MeowU32From(Hash, 2),
+           MeowU32From(Hash, 1),
+           MeowU32From(Hash, 0));
+}
+
+int
+main(int ArgCount, char **Args)
+{
+    // NOTE(casey): Print the banner
+    printf("meow_cpp_example %s - C++ usage example of the Meow hash\n", MEOW_HASH_VERSION_NAME);
+    printf("(C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)\n");
+    printf("See https://mollyrocket.com/meowhash for details.\n");
+    printf("\n");
+    
+    //
+    // NOTE: Strings, raw bytes and plain structs all go through meow::hasher
+    //
+    
+    meow::hasher Hasher;
+    std::string Text = "The quick brown fox jumps over the lazy dog";
+    printf("Hash of \"%s\":\n", Text.c_str());
+    PrintHash(Hasher(Text));
+    
+    vertex Vertex = {{1, 2, 3}, 0xFF00FF00};
+    printf("Hash of a vertex (hashed in place):\n");
+    PrintHash(Hasher(Vertex));
+    
+    //
+    // NOTE: Streaming gives the same answer as hashing all at once
+    //
+    
+    meow::stream Stream(Text.size());
+    Stream.Absorb(std::string_view(Text).substr(0, 10)).Absorb(std::string_view(Text).substr(10));
+    printf("Streamed hash of the same string %s the one-shot hash\n",
+           MeowHashesAreEqual(Stream.End(), Hasher(Text)) ? "matches" : "DOES NOT MATCH");
+    
+    //
+    // NOTE: meow::hash in an unordered_map, with lookups that never build a std::string
+    //
+    
+    std::unordered_map<std::string, int, meow::hash, std::equal_to<>> Counts;
+    char const *Words[] = {"meow", "purr", "meow", "hiss", "meow", "purr"};
+    for(int WordIndex = 0;
+        WordIndex < (int)(sizeof(Words)/sizeof(Words[0]));
+        ++WordIndex)
+    {
+        ++Counts[Words[WordIndex]];
+    }
+    
+    std::string_view Key = "meow";
+    meow::hash Hash;
+    printf("Hashes of \"meow\" as std::string, std::string_view and char const * %s\n",
+           ((Hash(std::string("meow")) == Hash(Key)) && (Hash(Key) == Hash("meow"))) ? "match" : "DO NOT MATCH");
+#if __cpp_lib_generic_unordered_lookup
+    // NOTE: C++20 unordered containers use is_transparent for heterogeneous lookup
+    auto Found = Counts.find(Key);
+#else
+    auto Found = Counts.find(std::string(Key));
+#endif
+    printf("\"meow\" was seen %d times\n", Found->second);
+    
+    //
+    // NOTE: meow::hash_service hashes jobs from any thread on a pool of
+    // workers.  Small jobs come back through futures, here a big one comes
+    // back through a callback, and they all match hashing them directly.
+    //
+    
+    {
+        std::vector<std::string> Keys;
+        for(int KeyIndex = 0;
+            KeyIndex < 1000;
+            ++KeyIndex)
+        {
+            Keys.push_back("key number " + std::to_string(KeyIndex*KeyIndex));
+        }
+        
+        std::vector<meow_u8> Big(8 << 20);
+        for(size_t ByteIndex = 0;
+            ByteIndex < Big.size();
+            ++ByteIndex)
+        {
+            Big[ByteIndex] = (meow_u8)(ByteIndex*7 + (ByteIndex >> 13));
+        }
+        
+        std::atomic<int> BigMatched{-1};
+        int Matched = 0;
+        {
+            meow::hash_service Service;
+            
+            Service.Submit(Big.data(), Big.size(), 1, 2, [&](meow_hash Result)
+            {
+                BigMatched = MeowHashesAreEqual(Result, MeowHash_Accelerated(1, 2, Big.size(), Big.data()));
+            });
+            
+            std::vector<meow::hash_future> Futures;
+            for(size_t KeyIndex = 0;
+                KeyIndex < Keys.size();
+                ++KeyIndex)
+            {
+                Futures.push_back(Service.Submit(Keys[KeyIndex].data(), Keys[KeyIndex].size(), KeyIndex));
+            }
+            
+            for(size_t KeyIndex = 0;
+                KeyIndex < Keys.size();
+                ++KeyIndex)
+            {
+                meow_hash Expected = MeowHash_Accelerated(KeyIndex, 0, Keys[KeyIndex].size(), (void *)Keys[KeyIndex].data());
+                Matched += MeowHashesAreEqual(Futures[KeyIndex].get(), Expected);
+            }
+            
+            printf("meow::hash_service with %u workers:\n", Service.GetWorkerCount());
+        }
+        
+        printf("    %d of %d small hashes match\n", Matched, (int)Keys.size());
+        printf("    8MB hash %s\n", (BigMatched == 1) ? "matches" : "DOES NOT MATCH");
+    }
+    
+    return(0);
+}
@@ -0,0 +1,652 @@
+/* ========================================================================
+   
+   meow_fingerprint_set.h - lock-free concurrent set of 128-bit Meow hashes
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   meow::fingerprint_set holds full 128-bit meow_hash values, and any number
+   of threads can insert into it and query it at once without a lock:
+   
+       meow::fingerprint_set Seen;
+   
+       // NOTE: On any thread
+       if(Seen.Insert(MeowHash_Accelerated(0, 0, BlockSize, Block)))
+       {
+           // NOTE: First time this block has been seen, by any thread
+       }
+   
+       bool Known = Seen.Contains(Hash);
+       size_t Count = Seen.GetCount();
+   
+   Insert is insert-if-absent: exactly one of any number of racing inserts of
+   the same fingerprint returns true.  There is no erase.
+   
+   The table is open addressing with linear probing.  Slots are 16 bytes,
+   so four share a 64-byte cache line, and a probe starts at the beginning
+   of the line the fingerprint maps to, which keeps most probes inside one
+   line.  Empty slots are claimed with a 128-bit compare-and-swap (cmpxchg16b
+   on x64, a 16-byte exclusive pair on ARMv8), so a slot only ever goes from
+   empty to one whole fingerprint.
+   
+   Growing does not stop the world.  Once a table is half full, a table
+   twice the size is linked in behind it, and every thread that inserts
+   after that copies one MEOW_FINGERPRINT_CHUNK of the old table across
+   before doing its own insert.  Old slots that are still empty get sealed
+   as they are copied, and anyone who runs into a sealed slot carries on in
+   the new table, so inserts never wait on the copy.  Old tables are freed
+   with the set, which at most doubles the memory in use.
+   
+   Counts are kept in per-cache-line stripes rather than one shared counter,
+   so threads inserting different fingerprints never write the same line
+   except when they collide in the table itself.
+   
+   NUMA placement is a hint in config: NumaNode asks for the table memory
+   to be placed on one node (for a set used by threads on that node), and
+   Interleave spreads it over all of them (for a set shared by the whole
+   machine).  It uses mbind on Linux and VirtualAllocExNuma on Windows, and
+   is ignored anywhere the OS says no.
+   
+   Include meow_intrinsics.h and meow_hash.h first.  x64 and ARMv8 only (it
+   needs a 16-byte compare-and-swap).  Needs C++17 and threads.
+   
+   ======================================================================== */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <new>
+#include <thread>
+
+#if _WIN32
+#include <windows.h>
+#elif __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#define MEOW_FINGERPRINT_LINE_SLOTS 4
+#define MEOW_FINGERPRINT_CHUNK 4096
+#define MEOW_FINGERPRINT_STRIPES 64
+#define MEOW_FINGERPRINT_MIN_CAPACITY 1024
+
+//
+// NOTE: 16-byte compare-and-swap.  On failure, Expected is updated to what
+// was actually there, the same as _InterlockedCompareExchange128.
+//
+
+#if _MSC_VER
+
+static int
+MeowCAS128(meow_u64 volatile *Dest, meow_u64 *Expected, meow_u64 Low, meow_u64 High)
+{
+    int Result = _InterlockedCompareExchange128((__int64 volatile *)Dest, (__int64)High, (__int64)Low, (__int64 *)Expected);
+    return(Result);
+}
+
+#elif MEOW_HASH_INTEL && MEOW_64BIT
+
+// NOTE: Inline so the build does not need -mcx16 or libatomic
+static int
+MeowCAS128(meow_u64 volatile *Dest, meow_u64 *Expected, meow_u64 Low, meow_u64 High)
+{
+    bool Result;
+    __asm__ __volatile__("lock cmpxchg16b %1"
+                         : "=@ccz"(Result), "+m"(*Dest), "+a"(Expected[0]), "+d"(Expected[1])
+                         : "b"(Low), "c"(High)
+                         : "memory");
+    return(Result);
+}
+
+#elif MEOW_HASH_ARMV8
+
+static int
+MeowCAS128(meow_u64 volatile *Dest, meow_u64 *Expected, meow_u64 Low, meow_u64 High)
+{
+    unsigned __int128 Compare = ((unsigned __int128)Expected[1] << 64) | Expected[0];
+    unsigned __int128 Exchange = ((unsigned __int128)High << 64) | Low;
+    unsigned __int128 Was = __sync_val_compare_and_swap((unsigned __int128 volatile *)Dest, Compare, Exchange);
+    Expected[0] = (meow_u64)Was;
+    Expected[1] = (meow_u64)(Was >> 64);
+    int Result = (Was == Compare);
+    return(Result);
+}
+
+#else
+#error meow_fingerprint_set.h needs a 64-bit x64 or ARMv8 target
+#endif
+
+namespace meow
+{
+
+class fingerprint_set
+{
+public:
+    struct config
+    {
+        size_t InitialCapacity = 1 << 16;  // NOTE: Slots, rounded up to a power of two
+        int NumaNode = -1;                 // NOTE: -1 means wherever the OS likes
+        bool Interleave = false;           // NOTE: Spread pages over every node instead
+    };
+    
+    fingerprint_set()
+        : fingerprint_set(config())
+    {
+    }
+    
+    explicit fingerprint_set(config ConfigInit)
+        : Config(ConfigInit)
+    {
+        if(Config.NumaNode >= 1024)
+        {
+            Config.NumaNode = -1;
+        }
+        
+        size_t Capacity = MEOW_FINGERPRINT_MIN_CAPACITY;
+        while(Capacity < Config.InitialCapacity)
+        {
+            Capacity *= 2;
+        }
+        Current.store(CreateTable(Capacity, 0));
+    }
+    
+    fingerprint_set(fingerprint_set const &) = delete;
+    fingerprint_set &operator=(fingerprint_set const &) = delete;
+    
+    ~fingerprint_set()
+    {
+        table *Table = Current.load();
+        while(IsTable(Table->Next.load()))
+        {
+            Table = Table->Next.load();
+        }
+        
+        while(Table)
+        {
+            table *Older = Table->Older;
+            FreeTable(Table);
+            Table = Older;
+        }
+    }
+    
+    // NOTE: True if Hash was not in the set before this call
+    bool
+    Insert(meow_hash Hash)
+    {
+        meow_u64 Low = MeowU64From(Hash, 0);
+        meow_u64 High = MeowU64From(Hash, 1);
+        
+        bool Result;
+        int Reserved = ReservedIndex(Low, High);
+        if(Reserved >= 0)
+        {
+            Result = !HasReserved[Reserved].exchange(true);
+        }
+        else
+        {
+            Result = InsertFrom(Current.load(std::memory_order_acquire), Low, High, true);
+        }
+        
+        if(Result)
+        {
+            Counts[Low % MEOW_FINGERPRINT_STRIPES].Value.fetch_add(1, std::memory_order_relaxed);
+        }
+        
+        return(Result);
+    }
+    
+    bool
+    Contains(meow_hash Hash) const
+    {
+        meow_u64 Low = MeowU64From(Hash, 0);
+        meow_u64 High = MeowU64From(Hash, 1);
+        
+        bool Result = false;
+        int Reserved = ReservedIndex(Low, High);
+        if(Reserved >= 0)
+        {
+            Result = HasReserved[Reserved].load();
+        }
+        else
+        {
+            table *Table = Current.load(std::memory_order_acquire);
+            for(;;)
+            {
+                int Status = Find(Table, Low, High, false);
+                if(Status != Slot_Moved)
+                {
+                    Result = (Status == Slot_Found);
+                    break;
+                }
+                
+                // NOTE: No successor yet means the table filled up before the
+                // resize got going, and nothing has made it past the full table
+                table *Next = Table->Next.load(std::memory_order_acquire);
+                if(!IsTable(Next))
+                {
+                    break;
+                }
+                Table = Next;
+            }
+        }
+        
+        return(Result);
+    }
+    
+    size_t
+    GetCount(void) const
+    {
+        size_t Result = 0;
+        for(int Stripe = 0;
+            Stripe < MEOW_FINGERPRINT_STRIPES;
+            ++Stripe)
+        {
+            Result += Counts[Stripe].Value.load(std::memory_order_relaxed);
+        }
+        
+        return(Result);
+    }
+    
+    size_t
+    GetCapacity(void) const
+    {
+        table *Table = Current.load(std::memory_order_acquire);
+        while(IsTable(Table->Next.load(std::memory_order_acquire)))
+        {
+            Table = Table->Next.load(std::memory_order_acquire);
+        }
+        
+        return(Table->Capacity);
+    }
+
+private:
+    // NOTE: Two fingerprints mark slot states, so they are kept out of the table
+    enum
+    {
+        Reserved_Empty,
+        Reserved_Moved,
+    };
+    
+    enum
+    {
+        Slot_Found,
+        Slot_Inserted,
+        Slot_Missing,
+        Slot_Moved,
+    };
+    
+    struct alignas(16) slot
+    {
+        meow_u64 volatile Half[2];
+    };
+    
+    struct alignas(64) stripe
+    {
+        std::atomic<size_t> Value{0};
+    };
+    
+    struct table
+    {
+        size_t Capacity;
+        size_t Mask;
+        slot *Slots;
+        table *Older;
+        
+        std::atomic<table *> Next{0};
+        std::atomic<size_t> MigrateCursor{0};
+        std::atomic<size_t> MigrateDone{0};
+        stripe Counts[MEOW_FINGERPRINT_STRIPES];
+    };
+    
+    static int
+    ReservedIndex(meow_u64 Low, meow_u64 High)
+    {
+        int Result = -1;
+        if((Low == 0) && (High == 0))
+        {
+            Result = Reserved_Empty;
+        }
+        else if((Low == ~0ull) && (High == ~0ull))
+        {
+            Result = Reserved_Moved;
+        }
+        return(Result);
+    }
+    
+    // NOTE: Stands in for Next while the winning thread is allocating it
+    static table *
+    Building(void)
+    {
+        return((table *)(size_t)1);
+    }
+    
+    static bool
+    IsTable(table *Table)
+    {
+        bool Result = ((size_t)Table > 1);
+        return(Result);
+    }
+    
+    // NOTE: Two plain 8-byte loads, which is almost always enough.  A slot only
+    // ever goes from all zeros to all of a fingerprint (or all ones), so a read
+    // that straddles the write shows up as exactly one zero half, and only then
+    // is the slot re-read atomically with a compare-and-swap.
+    static void
+    LoadSlot(slot *Slot, meow_u64 *Value)
+    {
+        Value[0] = Slot->Half[0];
+        Value[1] = Slot->Half[1];
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if((Value[0] == 0) != (Value[1] == 0))
+        {
+            MeowCAS128(Slot->Half, Value, Value[0], Value[1]);
+        }
+    }
+    
+    // NOTE: Looks for Low/High in one table, claiming an empty slot for it if
+    // Claim is set.  Slot_Moved means the table has been sealed where the
+    // fingerprint would go, so the answer is in the next table.
+    static int
+    Find(table *Table, meow_u64 Low, meow_u64 High, bool Claim)
+    {
+        size_t Index = Low & Table->Mask & ~(size_t)(MEOW_FINGERPRINT_LINE_SLOTS - 1);
+        for(size_t Probe = 0;
+            Probe < Table->Capacity;
+            ++Probe)
+        {
+            slot *Slot = Table->Slots + Index;
+            meow_u64 Value[2];
+            LoadSlot(Slot, Value);
+            for(;;)
+            {
+                if((Value[0] == Low) && (Value[1] == High))
+                {
+                    return(Slot_Found);
+                }
+                else if((Value[0] == ~0ull) && (Value[1] == ~0ull))
+                {
+                    return(Slot_Moved);
+                }
+                else if((Value[0] == 0) && (Value[1] == 0))
+                {
+                    if(!Claim)
+                    {
+                        return(Slot_Missing);
+                    }
+                    if(MeowCAS128(Slot->Half, Value, Low, High))
+                    {
+                        return(Slot_Inserted);
+                    }
+                    
+                    // NOTE: Lost the race for this slot - look at what won it
+                    continue;
+                }
+                
+                break;
+            }
+            
+            Index = (Index + 1) & Table->Mask;
+        }
+        
+        // NOTE: Full all the way round, which can only happen if a burst of
+        // inserts beat the resize - treat it as sealed and move on
+        return(Slot_Moved);
+    }
+    
+    bool
+    InsertFrom(table *Table, meow_u64 Low, meow_u64 High, bool Help)
+    {
+        for(;;)
+        {
+            if(Help)
+            {
+                HelpMigrate(Table);
+            }
+            
+            int Status = Find(Table, Low, High, true);
+            if(Status == Slot_Inserted)
+            {
+                stripe &Stripe = Table->Counts[(Low >> 32) % MEOW_FINGERPRINT_STRIPES];
+                size_t StripeCount = Stripe.Value.fetch_add(1, std::memory_order_relaxed) + 1;
+                if(StripeCount > Table->Capacity / (2*MEOW_FINGERPRINT_STRIPES))
+                {
+                    StartResize(Table);
+                }
+                return(true);
+            }
+            else if(Status == Slot_Found)
+            {
+                return(false);
+            }
+            
+            StartResize(Table);
+            Table = WaitForNext(Table);
+        }
+    }
+    
+    void
+    StartResize(table *Table)
+    {
+        table *Expected = 0;
+        if(!Table->Next.load(std::memory_order_acquire) &&
+           Table->Next.compare_exchange_strong(Expected, Building()))
+        {
+            Table->Next.store(CreateTable(2*Table->Capacity, Table), std::memory_order_release);
+        }
+    }
+    
+    static table *
+    WaitForNext(table *Table)
+    {
+        table *Result = Table->Next.load(std::memory_order_acquire);
+        while(!IsTable(Result))
+        {
+            std::this_thread::yield();
+            Result = Table->Next.load(std::memory_order_acquire);
+        }
+        
+        return(Result);
+    }
+    
+    // NOTE: Copies one chunk of a table that has a successor.  Empty slots are
+    // sealed so nothing new lands behind the copy; full ones never change, so
+    // they can be copied at leisure, and a fingerprint that got into the next
+    // table some other way is simply found there.
+    void
+    HelpMigrate(table *Table)
+    {
+        table *Next = Table->Next.load(std::memory_order_acquire);
+        if(IsTable(Next))
+        {
+            size_t Start = Table->MigrateCursor.fetch_add(MEOW_FINGERPRINT_CHUNK, std::memory_order_relaxed);
+            if(Start < Table->Capacity)
+            {
+                size_t End = Start + MEOW_FINGERPRINT_CHUNK;
+                if(End > Table->Capacity)
+                {
+                    End = Table->Capacity;
+                }
+                
+                for(size_t Index = Start;
+                    Index < End;
+                    ++Index)
+                {
+                    slot *Slot = Table->Slots + Index;
+                    meow_u64 Value[2];
+                    LoadSlot(Slot, Value);
+                    while((Value[0] == 0) && (Value[1] == 0))
+                    {
+                        if(MeowCAS128(Slot->Half, Value, ~0ull, ~0ull))
+                        {
+                            Value[0] = Value[1] = ~0ull;
+                        }
+                    }
+                    
+                    if((Value[0] != ~0ull) || (Value[1] != ~0ull))
+                    {
+                        InsertFrom(Next, Value[0], Value[1], false);
+                    }
+                }
+                
+                size_t Done = Table->MigrateDone.fetch_add(End - Start, std::memory_order_acq_rel) + (End - Start);
+                if(Done == Table->Capacity)
+                {
+                    table *Expected = Table;
+                    Current.compare_exchange_strong(Expected, Next);
+                }
+            }
+        }
+    }
+    
+    table *
+    CreateTable(size_t Capacity, table *Older)
+    {
+        table *Result = new table;
+        Result->Capacity = Capacity;
+        Result->Mask = Capacity - 1;
+        Result->Older = Older;
+        Result->Slots = (slot *)AllocateSlots(Capacity*sizeof(slot));
+        return(Result);
+    }
+    
+    static void
+    FreeTable(table *Table)
+    {
+        FreeSlots(Table->Slots, Table->Capacity*sizeof(slot));
+        delete Table;
+    }
+    
+    // NOTE: Zeroed memory, placed according to the NUMA hints
+    void *
+    AllocateSlots(size_t Size)
+    {
+        void *Result = 0;
+#if _WIN32
+        if(Config.NumaNode >= 0)
+        {
+            Result = VirtualAllocExNuma(GetCurrentProcess(), 0, Size, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE, (DWORD)Config.NumaNode);
+        }
+        if(!Result)
+        {
+            Result = VirtualAlloc(0, Size, MEM_RESERVE|MEM_COMMIT, PAGE_READWRITE);
+        }
+#elif __linux__
+        // NOTE: Without a placement hint, fault the pages in up front - that is
+        // much cheaper than faulting them one random insert at a time.  With a
+        // hint they have to wait for the first touch after mbind.
+        bool Placed = (Config.Interleave || (Config.NumaNode >= 0));
+        Result = mmap(0, Size, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|(Placed ? 0 : MAP_POPULATE), -1, 0);
+        if(Result == MAP_FAILED)
+        {
+            Result = 0;
+        }
+        else if(Placed)
+        {
+            // NOTE: Straight to the syscall, so there is no libnuma dependency.
+            // MPOL_PREFERRED is 1 and MPOL_INTERLEAVE is 3.
+            unsigned long NodeMask[16];
+            int Mode;
+            if(Config.Interleave)
+            {
+                OnlineNodes(NodeMask, sizeof(NodeMask) / sizeof(NodeMask[0]));
+                Mode = 3;
+            }
+            else
+            {
+                memset(NodeMask, 0, sizeof(NodeMask));
+                NodeMask[Config.NumaNode / 64] |= 1ul << (Config.NumaNode % 64);
+                Mode = 1;
+            }
+            syscall(SYS_mbind, Result, Size, Mode, NodeMask, 8*sizeof(NodeMask) + 1, 0);
+        }
+#else
+        Result = ::operator new(Size, std::align_val_t(64));
+        memset(Result, 0, Size);
+#endif
+        if(!Result)
+        {
+            throw std::bad_alloc();
+        }
+        return(Result);
+    }
+    
+#if __linux__
+    // NOTE: Sets a bit for every node in /sys/devices/system/node/online
+    // ("0-3,6" style).  mbind rejects a mask with bits past the kernel's
+    // node count, so an all-ones mask only works on kernels built for 1024
+    // nodes.  If the list cannot be read, this falls back to node 0.
+    static void
+    OnlineNodes(unsigned long *NodeMask, size_t WordCount)
+    {
+        memset(NodeMask, 0, WordCount*sizeof(unsigned long));
+        size_t MaxNode = 64*WordCount;
+        
+        bool Found = false;
+        char List[256];
+        ssize_t Length = -1;
+        int File = open("/sys/devices/system/node/online", O_RDONLY);
+        if(File >= 0)
+        {
+            Length = read(File, List, sizeof(List) - 1);
+            close(File);
+        }
+        
+        if(Length > 0)
+        {
+            List[Length] = 0;
+            char *At = List;
+            while((*At >= '0') && (*At <= '9'))
+            {
+                size_t First = strtoul(At, &At, 10);
+                size_t Last = First;
+                if(*At == '-')
+                {
+                    Last = strtoul(At + 1, &At, 10);
+                }
+                for(size_t Node = First;
+                    (Node <= Last) && (Node < MaxNode);
+                    ++Node)
+                {
+                    NodeMask[Node / 64] |= 1ul << (Node % 64);
+                    Found = true;
+                }
+                if(*At == ',')
+                {
+                    ++At;
+                }
+            }
+        }
+        
+        if(!Found)
+        {
+            NodeMask[0] = 1;
+        }
+    }
+#endif
+    
+    static void
+    FreeSlots(void *Memory, size_t Size)
+    {
+#if _WIN32
+        VirtualFree(Memory, 0, MEM_RELEASE);
+#elif __linux__
+        munmap(Memory, Size);
+#else
+        ::operator delete(Memory, std::align_val_t(64));
+#endif
+    }
+    
+    config Config;
+    std::atomic<table *> Current{0};
+    std::atomic<bool> HasReserved[2] = {{false}, {false}};
+    stripe Counts[MEOW_FINGERPRINT_STRIPES];
+};
+    
+}
@@ -0,0 +1,565 @@
+/* ========================================================================
+   
+   meow_index.h - memory-mapped immutable index of Meow hashes
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   A meow index is a file holding a sorted array of 128-bit Meow hashes,
+   each with an optional 64-bit payload (a file offset, a row number), for
+   answering "have I seen this hash, and where" over huge sets:
+   
+       MeowIndexWrite("blocks.meowidx", Count, Hashes, Payloads, -1);  // Payloads may be 0
+   
+       meow_index Index;
+       if(MeowIndexOpen(&Index, "blocks.meowidx"))
+       {
+           meow_u64 Payload;
+           if(MeowIndexFind(&Index, Hash, &Payload)) {...}
+           MeowIndexClose(&Index);
+       }
+   
+   The file is laid out exactly as it is used, so opening it is one mmap
+   and a check of the header - nothing is read or parsed up front, and a
+   billion-entry index opens as fast as an empty one.  If the bytes are
+   already in memory (embedded, or mapped some other way), MeowIndexFromMemory
+   does the same thing on a pointer.
+   
+   Meow output is close to uniform, so the position of a hash in the sorted
+   array can be predicted from its value.  The top DirectoryBits of each
+   hash pick a bucket from a small directory of start positions, and inside
+   the bucket an interpolation search guesses where the hash should be,
+   looks, and refines the guess from what it found.  That usually lands
+   within a cache line or two after one or two guesses, so a lookup costs
+   one directory read and one or two touches of the hash array, where a
+   binary search would cost about log2(Count).
+   
+   MeowIndexFindBatch looks up many hashes at once, prefetching each one's
+   directory entry and then its first guess before any of them are
+   searched, so the page faults and cache misses of a batch overlap.
+   
+   Passing -1 for DirectoryBits picks about 1024 hashes per bucket.
+   Duplicate hashes are stored once; if they had different payloads, which
+   one is kept is not defined.  The file is little-endian, and stores each
+   hash as its two 64-bit halves, low half first, exactly as meow_hash
+   holds it in memory on x64 and ARM.
+   
+   Include meow_intrinsics.h, meow_hash.h and more/meow_radix.h first.
+   
+   ======================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#define MEOW_INDEX_MAGIC 0x3158444957454F4Dull // NOTE: "MEOWIDX1"
+#define MEOW_INDEX_VERSION 1
+#define MEOW_INDEX_ALIGN 64
+#define MEOW_INDEX_SCAN 8
+#define MEOW_INDEX_MAX_GUESSES 6
+#define MEOW_INDEX_BATCH 16
+
+typedef struct meow_index_header
+{
+    meow_u64 Magic;
+    meow_u32 Version;
+    meow_u32 DirectoryBits;
+    meow_u64 Count;
+    meow_u64 DirectoryOffset;  // NOTE: (1 << DirectoryBits) + 1 start positions
+    meow_u64 HashOffset;       // NOTE: Count hashes, as Low, High pairs of meow_u64
+    meow_u64 PayloadOffset;    // NOTE: Count meow_u64s, or 0 if there are none
+    meow_u64 FileSize;
+} meow_index_header;
+
+typedef struct meow_index
+{
+    meow_index_header *Header;
+    meow_u64 *Directory;
+    meow_u64 *Hashes;
+    meow_u64 *Payloads;
+    meow_u32 BucketShift;
+    
+    // NOTE: Only set by MeowIndexOpen
+    void *Mapping;
+    meow_umm MappingSize;
+} meow_index;
+
+//
+// NOTE: Hashes sort by their high half, then their low half, so the top
+// bits of the high half are both the bucket and the interpolation key
+//
+
+static meow_u64
+MeowIndexBucket(meow_u64 High, meow_u32 BucketShift)
+{
+    // NOTE: Shifting by 64 is undefined, so zero bits is done by hand
+    meow_u64 Result = (BucketShift < 64) ? (High >> BucketShift) : 0;
+    return(Result);
+}
+
+static meow_u64
+MeowIndexAlign(meow_u64 Offset)
+{
+    meow_u64 Result = (Offset + (MEOW_INDEX_ALIGN - 1)) & ~(meow_u64)(MEOW_INDEX_ALIGN - 1);
+    return(Result);
+}
+
+// NOTE: Pads from *At up to Offset with zeroes, then writes Data
+static int
+MeowIndexWriteAt(FILE *File, meow_u64 *At, meow_u64 Offset, void const *Data, meow_umm Size)
+{
+    int Result = 1;
+    
+    meow_u8 Zero[MEOW_INDEX_ALIGN] = {0};
+    while(Result && (*At < Offset))
+    {
+        meow_umm Pad = (meow_umm)(((Offset - *At) < MEOW_INDEX_ALIGN) ? (Offset - *At) : MEOW_INDEX_ALIGN);
+        Result = (fwrite(Zero, 1, Pad, File) == Pad);
+        *At += Pad;
+    }
+    
+    Result = Result && ((Size == 0) || (fwrite(Data, 1, Size, File) == Size));
+    *At += Size;
+    
+    return(Result);
+}
+
+// NOTE: Returns non-zero on success
+static int
+MeowIndexWrite(char const *FileName, meow_umm Count, meow_hash *Hashes, meow_u64 *Payloads, int DirectoryBits)
+{
+    int Result = 0;
+    
+    if(DirectoryBits < 0)
+    {
+        DirectoryBits = 0;
+        while((DirectoryBits < 24) && ((Count >> (DirectoryBits + 10)) != 0))
+        {
+            ++DirectoryBits;
+        }
+    }
+    if(DirectoryBits > 32)
+    {
+        DirectoryBits = 32;
+    }
+    
+    meow_radix_entry *Entries = (meow_radix_entry *)malloc((Count ? Count : 1)*sizeof(meow_radix_entry));
+    meow_u64 DirectorySize = ((meow_u64)1 << DirectoryBits) + 1;
+    meow_u64 *Directory = (meow_u64 *)malloc(DirectorySize*sizeof(meow_u64));
+    FILE *File = fopen(FileName, "wb");
+    if(Entries && Directory && File)
+    {
+        for(meow_umm Index = 0;
+            Index < Count;
+            ++Index)
+        {
+            Entries[Index].Low = MeowU64From(Hashes[Index], 0);
+            Entries[Index].High = MeowU64From(Hashes[Index], 1);
+            Entries[Index].Payload = Payloads ? Payloads[Index] : 0;
+        }
+        int Sorted = MeowRadixSort(Entries, Count, 0, 0);
+        
+        meow_umm Unique = 0;
+        for(meow_umm Index = 0;
+            Index < Count;
+            ++Index)
+        {
+            if((Unique == 0) ||
+               (Entries[Index].Low != Entries[Unique - 1].Low) ||
+               (Entries[Index].High != Entries[Unique - 1].High))
+            {
+                Entries[Unique++] = Entries[Index];
+            }
+        }
+        
+        meow_u32 BucketShift = 64 - DirectoryBits;
+        meow_umm Position = 0;
+        for(meow_u64 Bucket = 0;
+            Bucket < DirectorySize;
+            ++Bucket)
+        {
+            while((Position < Unique) && (MeowIndexBucket(Entries[Position].High, BucketShift) < Bucket))
+            {
+                ++Position;
+            }
+            Directory[Bucket] = Position;
+        }
+        
+        meow_index_header Header = {};
+        Header.Magic = MEOW_INDEX_MAGIC;
+        Header.Version = MEOW_INDEX_VERSION;
+        Header.DirectoryBits = DirectoryBits;
+        Header.Count = Unique;
+        Header.DirectoryOffset = MeowIndexAlign(sizeof(Header));
+        Header.HashOffset = MeowIndexAlign(Header.DirectoryOffset + DirectorySize*sizeof(meow_u64));
+        Header.PayloadOffset = Payloads ? MeowIndexAlign(Header.HashOffset + Unique*2*sizeof(meow_u64)) : 0;
+        Header.FileSize = Payloads ? (Header.PayloadOffset + Unique*sizeof(meow_u64)) : (Header.HashOffset + Unique*2*sizeof(meow_u64));
+        
+        meow_u64 At = 0;
+        Result = (Sorted &&
+                  MeowIndexWriteAt(File, &At, 0, &Header, sizeof(Header)) &&
+                  MeowIndexWriteAt(File, &At, Header.DirectoryOffset, Directory, DirectorySize*sizeof(meow_u64)));
+        
+        // NOTE: Hashes and then payloads, pulled out of the sorted entries a block at a time
+        meow_u64 Block[2*1024];
+        for(int Pass = 0;
+            Result && (Pass < (Payloads ? 2 : 1));
+            ++Pass)
+        {
+            meow_u64 Offset = Pass ? Header.PayloadOffset : Header.HashOffset;
+            for(meow_umm Base = 0;
+                Result && (Base < Unique);
+                Base += 1024)
+            {
+                meow_umm BlockCount = ((Unique - Base) < 1024) ? (Unique - Base) : 1024;
+                meow_umm BlockSize = 0;
+                for(meow_umm Index = 0;
+                    Index < BlockCount;
+                    ++Index)
+                {
+                    meow_radix_entry *Entry = Entries + Base + Index;
+                    if(Pass)
+                    {
+                        Block[BlockSize++] = Entry->Payload;
+                    }
+                    else
+                    {
+                        Block[BlockSize++] = Entry->Low;
+                        Block[BlockSize++] = Entry->High;
+                    }
+                }
+                
+                Result = MeowIndexWriteAt(File, &At, Offset, Block, BlockSize*sizeof(meow_u64));
+                Offset += BlockSize*sizeof(meow_u64);
+            }
+        }
+        
+        // NOTE: An empty index still has its padding, so FileSize is the real size
+        Result = Result && MeowIndexWriteAt(File, &At, Header.FileSize, 0, 0);
+    }
+    
+    if(File)
+    {
+        Result = (fclose(File) == 0) && Result;
+    }
+    free(Directory);
+    free(Entries);
+    
+    return(Result);
+}
+
+// NOTE: True if Count elements of ElementSize bytes starting at Offset fit
+// in Limit bytes and are 8-byte aligned, written so that nothing can overflow
+static int
+MeowIndexFits(meow_u64 Offset, meow_u64 Count, meow_u64 ElementSize, meow_u64 Limit)
+{
+    int Result = (((Offset % sizeof(meow_u64)) == 0) &&
+                  (Offset <= Limit) &&
+                  (Count <= ((Limit - Offset) / ElementSize)));
+    return(Result);
+}
+
+// NOTE: Checks that the header describes something that fits in Size bytes.
+// The directory entries themselves are not read here; searches clamp them
+// to Count instead.
+static int
+MeowIndexFromMemory(meow_index *Index, void *Memory, meow_umm Size)
+{
+    memset(Index, 0, sizeof(*Index));
+    
+    meow_index_header *Header = (meow_index_header *)Memory;
+    int Result = (Memory &&
+                  ((((meow_umm)Memory) % sizeof(meow_u64)) == 0) &&
+                  (Size >= sizeof(meow_index_header)) &&
+                  (Header->Magic == MEOW_INDEX_MAGIC) &&
+                  (Header->Version == MEOW_INDEX_VERSION) &&
+                  (Header->DirectoryBits <= 32) &&
+                  (Header->FileSize <= Size) &&
+                  MeowIndexFits(Header->DirectoryOffset, ((meow_u64)1 << Header->DirectoryBits) + 1, sizeof(meow_u64), Header->FileSize) &&
+                  MeowIndexFits(Header->HashOffset, Header->Count, 2*sizeof(meow_u64), Header->FileSize) &&
+                  (!Header->PayloadOffset || MeowIndexFits(Header->PayloadOffset, Header->Count, sizeof(meow_u64), Header->FileSize)));
+    if(Result)
+    {
+        meow_u8 *Base = (meow_u8 *)Memory;
+        Index->Header = Header;
+        Index->Directory = (meow_u64 *)(Base + Header->DirectoryOffset);
+        Index->Hashes = (meow_u64 *)(Base + Header->HashOffset);
+        Index->Payloads = Header->PayloadOffset ? (meow_u64 *)(Base + Header->PayloadOffset) : 0;
+        Index->BucketShift = 64 - Header->DirectoryBits;
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Read-only file mapping, also used by anything that keeps files
+// alongside an index
+//
+
+// NOTE: Returns 0 for a missing or empty file
+static void *
+MeowIndexMapFile(char const *FileName, meow_umm *SizeResult)
+{
+    void *Mapping = 0;
+    meow_umm Size = 0;
+
+#if _WIN32
+    HANDLE File = CreateFileA(FileName, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, 0, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, 0);
+    if(File != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER FileSize;
+        if(GetFileSizeEx(File, &FileSize))
+        {
+            HANDLE Map = CreateFileMappingA(File, 0, PAGE_READONLY, 0, 0, 0);
+            if(Map)
+            {
+                Mapping = MapViewOfFile(Map, FILE_MAP_READ, 0, 0, 0);
+                Size = (meow_umm)FileSize.QuadPart;
+                CloseHandle(Map);
+            }
+        }
+        CloseHandle(File);
+    }
+#else
+    int File = open(FileName, O_RDONLY);
+    if(File >= 0)
+    {
+        struct stat Stat;
+        if((fstat(File, &Stat) == 0) && (Stat.st_size > 0))
+        {
+            Mapping = mmap(0, (size_t)Stat.st_size, PROT_READ, MAP_SHARED, File, 0);
+            if(Mapping == MAP_FAILED)
+            {
+                Mapping = 0;
+            }
+            Size = (meow_umm)Stat.st_size;
+        }
+        close(File);
+    }
+#endif
+    
+    *SizeResult = Mapping ? Size : 0;
+    return(Mapping);
+}
+
+static void
+MeowIndexUnmapFile(void *Mapping, meow_umm Size)
+{
+    if(Mapping)
+    {
+#if _WIN32
+        UnmapViewOfFile(Mapping);
+#else
+        munmap(Mapping, Size);
+#endif
+    }
+}
+
+static void
+MeowIndexClose(meow_index *Index)
+{
+    MeowIndexUnmapFile(Index->Mapping, Index->MappingSize);
+    memset(Index, 0, sizeof(*Index));
+}
+
+static int
+MeowIndexOpen(meow_index *Index, char const *FileName)
+{
+    meow_umm Size;
+    void *Mapping = MeowIndexMapFile(FileName, &Size);
+    
+    int Result = MeowIndexFromMemory(Index, Mapping, Size);
+    Index->Mapping = Mapping;
+    Index->MappingSize = Size;
+    if(!Result)
+    {
+        MeowIndexClose(Index);
+    }
+    
+    return(Result);
+}
+
+static meow_umm
+MeowIndexCount(meow_index *Index)
+{
+    meow_umm Result = Index->Header ? (meow_umm)Index->Header->Count : 0;
+    return(Result);
+}
+
+//
+// NOTE: Search state for one hash: the range [Lo, Hi) it must be in, and
+// the High values just outside that range, which is what the next guess is
+// interpolated between.  Before anything has been read, those are just the
+// bucket's limits.
+//
+
+typedef struct meow_index_search
+{
+    meow_u64 Low;
+    meow_u64 High;
+    meow_u64 Lo;
+    meow_u64 Hi;
+    meow_u64 LoValue;
+    meow_u64 HiValue;
+} meow_index_search;
+
+static void
+MeowIndexSearchBegin(meow_index *Index, meow_index_search *Search, meow_hash Hash)
+{
+    Search->Low = MeowU64From(Hash, 0);
+    Search->High = MeowU64From(Hash, 1);
+    
+    // NOTE: Clamped, so a corrupt directory can only make a search miss,
+    // never read outside the hashes
+    meow_u64 Count = Index->Header->Count;
+    meow_u64 Bucket = MeowIndexBucket(Search->High, Index->BucketShift);
+    Search->Hi = Index->Directory[Bucket + 1];
+    Search->Hi = (Search->Hi < Count) ? Search->Hi : Count;
+    Search->Lo = Index->Directory[Bucket];
+    Search->Lo = (Search->Lo < Search->Hi) ? Search->Lo : Search->Hi;
+    Search->LoValue = (Index->BucketShift < 64) ? (Bucket << Index->BucketShift) : 0;
+    Search->HiValue = Search->LoValue + ((Index->BucketShift < 64) ? ((~0ull) >> (64 - Index->BucketShift)) : ~0ull);
+}
+
+static meow_u64
+MeowIndexGuess(meow_index_search *Search)
+{
+    meow_u64 Result = Search->Lo;
+    if((Search->HiValue > Search->LoValue) && (Search->High > Search->LoValue))
+    {
+        double Fraction = (double)(Search->High - Search->LoValue) / (double)(Search->HiValue - Search->LoValue);
+        Result += (meow_u64)(Fraction*(double)(Search->Hi - Search->Lo));
+    }
+    if(Result >= Search->Hi)
+    {
+        Result = Search->Hi - 1;
+    }
+    
+    return(Result);
+}
+
+// NOTE: Returns the position of the hash, or ~0 if it is not there
+static meow_u64
+MeowIndexSearchEnd(meow_index *Index, meow_index_search *Search)
+{
+    meow_u64 *Hashes = Index->Hashes;
+    for(int GuessIndex = 0;
+        (Search->Hi - Search->Lo) > MEOW_INDEX_SCAN;
+        ++GuessIndex)
+    {
+        // NOTE: Interpolation is near-perfect on uniform hashes, but binary
+        // steps after a few guesses keep a bad run from costing more than log2
+        meow_u64 Guess = (GuessIndex < MEOW_INDEX_MAX_GUESSES) ? MeowIndexGuess(Search) : (Search->Lo + (Search->Hi - Search->Lo)/2);
+        meow_u64 GuessLow = Hashes[2*Guess];
+        meow_u64 GuessHigh = Hashes[2*Guess + 1];
+        if((GuessHigh < Search->High) || ((GuessHigh == Search->High) && (GuessLow < Search->Low)))
+        {
+            Search->Lo = Guess + 1;
+            Search->LoValue = GuessHigh;
+        }
+        else if((GuessHigh == Search->High) && (GuessLow == Search->Low))
+        {
+            return(Guess);
+        }
+        else
+        {
+            Search->Hi = Guess;
+            Search->HiValue = GuessHigh;
+        }
+    }
+    
+    for(meow_u64 Position = Search->Lo;
+        Position < Search->Hi;
+        ++Position)
+    {
+        if((Hashes[2*Position] == Search->Low) && (Hashes[2*Position + 1] == Search->High))
+        {
+            return(Position);
+        }
+    }
+    
+    return(~0ull);
+}
+
+static int
+MeowIndexFind(meow_index *Index, meow_hash Hash, meow_u64 *Payload)
+{
+    int Result = 0;
+    if(Index->Header)
+    {
+        meow_index_search Search;
+        MeowIndexSearchBegin(Index, &Search, Hash);
+        meow_u64 Position = MeowIndexSearchEnd(Index, &Search);
+        Result = (Position != ~0ull);
+        if(Result && Payload)
+        {
+            *Payload = Index->Payloads ? Index->Payloads[Position] : 0;
+        }
+    }
+    
+    return(Result);
+}
+
+// NOTE: Found[N] is set to 1 or 0; Payloads may be 0
+static void
+MeowIndexFindBatch(meow_index *Index, meow_umm Count, meow_hash *Hashes, meow_u8 *Found, meow_u64 *Payloads)
+{
+    if(!Index->Header)
+    {
+        memset(Found, 0, Count);
+        return;
+    }
+    
+    meow_index_search Searches[MEOW_INDEX_BATCH];
+    for(meow_umm Base = 0;
+        Base < Count;
+        Base += MEOW_INDEX_BATCH)
+    {
+        meow_umm BatchCount = ((Count - Base) < MEOW_INDEX_BATCH) ? (Count - Base) : MEOW_INDEX_BATCH;
+        
+        for(meow_umm Item = 0;
+            Item < BatchCount;
+            ++Item)
+        {
+            meow_u64 High = MeowU64From(Hashes[Base + Item], 1);
+            MeowPrefetch(Index->Directory + MeowIndexBucket(High, Index->BucketShift));
+        }
+        
+        for(meow_umm Item = 0;
+            Item < BatchCount;
+            ++Item)
+        {
+            meow_index_search *Search = Searches + Item;
+            MeowIndexSearchBegin(Index, Search, Hashes[Base + Item]);
+            if(Search->Hi > Search->Lo)
+            {
+                MeowPrefetch(Index->Hashes + 2*MeowIndexGuess(Search));
+            }
+        }
+        
+        for(meow_umm Item = 0;
+            Item < BatchCount;
+            ++Item)
+        {
+            meow_u64 Position = MeowIndexSearchEnd(Index, Searches + Item);
+            Found[Base + Item] = (Position != ~0ull);
+            if(Payloads)
+            {
+                Payloads[Base + Item] = ((Position != ~0ull) && Index->Payloads) ? Index->Payloads[Position] : 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,464 @@
+/* ========================================================================
+   
+   meow_intern.h - arena-backed string interning keyed by Meow hashes
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   meow::interner turns strings into 32-bit ids and back, storing each
+   distinct string once, for pipelines that see the same few million
+   hostnames or metric names billions of times:
+   
+       meow::interner Strings;
+   
+       // NOTE: On any thread
+       meow_u32 Id = Strings.Intern("db-17.example.com");
+       std::string_view Name = Strings.Get(Id);
+   
+       meow_u32 Existing;
+       if(Strings.Find("db-17.example.com", &Existing)) {...}
+   
+   Ids never change and the bytes behind Get never move, for the life of
+   the interner.  Ids are not dense: an id is where the string sits in its
+   shard's arena (the shard in the top ShardBits, the position in 4-byte
+   units below), which is what lets Get find the bytes without a table.
+   
+   Each string is hashed once with MeowHash_Accelerated.  The top bits of
+   the hash pick a shard, and each shard has its own lock, its own index
+   and its own arena, so threads inserting different strings rarely wait
+   on each other.  Find and Get never lock, and neither does Intern when
+   the string is already there, which is almost always - only a string
+   the shard has never seen takes the lock.
+   
+   The index is open addressing with linear probing over 8-byte slots:
+   32 bits of the hash as a tag next to the 32-bit id, so a probe only
+   touches the string itself on a tag match.  The slot position comes from
+   the top bits of the tag, which means growing just re-spreads the slots
+   without hashing any string again.  Indexes grow at 3/4 full: a miss
+   (a Find that fails, or the first Intern of a string) has to walk to the
+   end of its cluster, which averages about 8 slots at 3/4 but 32 at 7/8,
+   and near 7/8 the slowest clusters get much longer than that.  The
+   outgrown index is kept, since a reader may still be probing it, until
+   FreeRetiredIndexes is called at a point where no other thread is using
+   the interner.
+   
+   Strings are copied into append-only arena pages (config.PageSize,
+   256KB by default) behind a 1-byte length (5 bytes past 254), padded to
+   4 bytes.  A string too long for a page gets a run of pages of its own.
+   So a string costs its bytes, about 3 bytes of length and padding, and
+   one 8-byte slot at an index load between 3/8 and 3/4 - 14 to 24 bytes
+   on top of the string, plus the unused end of each shard's last page,
+   which only matters for small interners.
+   
+   A shard's arena holds 4 << (32 - ShardBits) bytes - 1GB at the default
+   16 shards - and Intern throws std::bad_alloc when that or memory runs
+   out.
+   
+   Include meow_intrinsics.h and meow_hash.h first.  Needs C++17.
+   
+   ======================================================================== */
+
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <string_view>
+#include <vector>
+
+#define MEOW_INTERN_MIN_CAPACITY 1024
+
+namespace meow
+{
+
+class interner
+{
+public:
+    struct config
+    {
+        int ShardBits = 4;              // NOTE: 1 << ShardBits shards, from 1 to 10 bits
+        size_t PageSize = 1 << 18;      // NOTE: Arena page bytes, rounded up to a power of two
+        size_t ExpectedCount = 0;       // NOTE: Distinct strings, to size the indexes up front
+    };
+    
+    interner()
+        : interner(config())
+    {
+    }
+    
+    explicit interner(config ConfigInit)
+        : Config(ConfigInit)
+    {
+        Config.ShardBits = (Config.ShardBits < 1) ? 1 : (Config.ShardBits > 10) ? 10 : Config.ShardBits;
+        ShardCount = (size_t)1 << Config.ShardBits;
+        UnitBits = 32 - Config.ShardBits;
+        
+        PageUnitBits = 10;
+        while((PageUnitBits < UnitBits) && (((size_t)4 << PageUnitBits) < Config.PageSize))
+        {
+            ++PageUnitBits;
+        }
+        Config.PageSize = (size_t)4 << PageUnitBits;
+        
+        size_t Capacity = MEOW_INTERN_MIN_CAPACITY;
+        while((Capacity < ((size_t)1 << 31)) && (3*Capacity < 4*(Config.ExpectedCount / ShardCount)))
+        {
+            Capacity *= 2;
+        }
+        
+        Shards = new shard[ShardCount];
+        for(size_t ShardIndex = 0;
+            ShardIndex < ShardCount;
+            ++ShardIndex)
+        {
+            shard &Shard = Shards[ShardIndex];
+            Shard.Index.store(CreateIndex(Capacity, 0));
+            Shard.Pages = new std::atomic<char *>[(size_t)1 << (UnitBits - PageUnitBits)]();
+            Shard.MemoryUsed.store(Capacity*sizeof(meow_u64));
+        }
+    }
+    
+    interner(interner const &) = delete;
+    interner &operator=(interner const &) = delete;
+    
+    ~interner()
+    {
+        for(size_t ShardIndex = 0;
+            ShardIndex < ShardCount;
+            ++ShardIndex)
+        {
+            shard &Shard = Shards[ShardIndex];
+            for(index *Index = Shard.Index.load();
+                Index;)
+            {
+                index *Older = Index->Older;
+                FreeIndex(Index);
+                Index = Older;
+            }
+            
+            for(size_t Allocation = 0;
+                Allocation < Shard.Allocations.size();
+                ++Allocation)
+            {
+                free(Shard.Allocations[Allocation]);
+            }
+            delete[] Shard.Pages;
+        }
+        delete[] Shards;
+    }
+    
+    meow_u32
+    Intern(void const *Bytes, size_t Length)
+    {
+        meow_u32 Tag;
+        shard &Shard = ShardFor(Bytes, Length, &Tag);
+        
+        meow_u32 Result;
+        size_t Slot;
+        if(!Probe(Shard.Index.load(std::memory_order_acquire), Tag, Bytes, Length, &Result, &Slot))
+        {
+            std::lock_guard<std::mutex> Lock(Shard.Mutex);
+            
+            // NOTE: Someone may have beaten us here, or grown the index since
+            index *Index = Shard.Index.load(std::memory_order_relaxed);
+            if(!Probe(Index, Tag, Bytes, Length, &Result, &Slot))
+            {
+                Result = Append(Shard, (meow_u32)(&Shard - Shards), Bytes, Length);
+                Index->Slots[Slot].store(((meow_u64)Tag << 32) | Result, std::memory_order_release);
+                
+                size_t Count = Shard.Count.load(std::memory_order_relaxed) + 1;
+                Shard.Count.store(Count, std::memory_order_relaxed);
+                if((4*Count > 3*Index->Capacity) && (Index->Capacity < ((size_t)1 << 31)))
+                {
+                    Grow(Shard, Index);
+                }
+            }
+        }
+        
+        return(Result);
+    }
+    
+    meow_u32
+    Intern(std::string_view String)
+    {
+        return(Intern(String.data(), String.size()));
+    }
+    
+    bool
+    Find(void const *Bytes, size_t Length, meow_u32 *Id) const
+    {
+        meow_u32 Tag;
+        shard &Shard = ShardFor(Bytes, Length, &Tag);
+        
+        size_t Slot;
+        bool Result = Probe(Shard.Index.load(std::memory_order_acquire), Tag, Bytes, Length, Id, &Slot);
+        return(Result);
+    }
+    
+    bool
+    Find(std::string_view String, meow_u32 *Id) const
+    {
+        return(Find(String.data(), String.size(), Id));
+    }
+    
+    // NOTE: Id must have come from Intern or Find on this interner
+    std::string_view
+    Get(meow_u32 Id) const
+    {
+        shard &Shard = Shards[Id >> UnitBits];
+        meow_u32 Unit = Id & (((meow_u32)1 << UnitBits) - 1);
+        char *Record = Shard.Pages[Unit >> PageUnitBits].load(std::memory_order_acquire) +
+            4*(size_t)(Unit & (((meow_u32)1 << PageUnitBits) - 1));
+        
+        meow_u32 Length = (meow_u8)Record[0];
+        char *Bytes = Record + 1;
+        if(Length == 255)
+        {
+            memcpy(&Length, Record + 1, sizeof(Length));
+            Bytes += sizeof(Length);
+        }
+        
+        std::string_view Result(Bytes, Length);
+        return(Result);
+    }
+    
+    size_t
+    GetCount(void) const
+    {
+        size_t Result = 0;
+        for(size_t ShardIndex = 0;
+            ShardIndex < ShardCount;
+            ++ShardIndex)
+        {
+            Result += Shards[ShardIndex].Count.load(std::memory_order_relaxed);
+        }
+        
+        return(Result);
+    }
+    
+    // NOTE: Arena pages, indexes (retired ones included) and page tables, in bytes
+    size_t
+    GetMemoryUsed(void) const
+    {
+        size_t Result = ShardCount*(sizeof(shard) + sizeof(std::atomic<char *>)*((size_t)1 << (UnitBits - PageUnitBits)));
+        for(size_t ShardIndex = 0;
+            ShardIndex < ShardCount;
+            ++ShardIndex)
+        {
+            Result += Shards[ShardIndex].MemoryUsed.load(std::memory_order_relaxed);
+        }
+        
+        return(Result);
+    }
+    
+    // NOTE: Only safe while no other thread is calling anything on the interner
+    void
+    FreeRetiredIndexes(void)
+    {
+        for(size_t ShardIndex = 0;
+            ShardIndex < ShardCount;
+            ++ShardIndex)
+        {
+            shard &Shard = Shards[ShardIndex];
+            std::lock_guard<std::mutex> Lock(Shard.Mutex);
+            
+            index *Index = Shard.Index.load(std::memory_order_relaxed);
+            while(Index->Older)
+            {
+                index *Older = Index->Older;
+                Index->Older = Older->Older;
+                Shard.MemoryUsed.fetch_sub(Older->Capacity*sizeof(meow_u64), std::memory_order_relaxed);
+                FreeIndex(Older);
+            }
+        }
+    }
+
+private:
+    struct index
+    {
+        size_t Capacity;
+        size_t Mask;
+        int Shift;
+        index *Older;
+        std::atomic<meow_u64> *Slots;   // NOTE: Tag in the top half, id in the bottom, 0 when empty
+    };
+    
+    // NOTE: Everything but the atomics belongs to whoever holds Mutex
+    struct alignas(64) shard
+    {
+        std::mutex Mutex;
+        std::atomic<index *> Index{0};
+        std::atomic<char *> *Pages = 0;
+        std::atomic<size_t> Count{0};
+        std::atomic<size_t> MemoryUsed{0};
+        meow_u32 Cursor = 0;            // NOTE: Next free unit
+        meow_u32 Allocated = 0;         // NOTE: Units below this have pages
+        std::vector<char *> Allocations;
+    };
+    
+    shard &
+    ShardFor(void const *Bytes, size_t Length, meow_u32 *Tag) const
+    {
+        meow_hash Hash = MeowHash_Accelerated(0, 0, Length, (void *)Bytes);
+        meow_u64 Low = MeowU64From(Hash, 0);
+        meow_u64 High = MeowU64From(Hash, 1);
+        
+        // NOTE: The low bit makes every tag nonzero, so a used slot never reads as empty
+        *Tag = (meow_u32)(Low >> 32) | 1;
+        shard &Result = Shards[High >> (64 - Config.ShardBits)];
+        return(Result);
+    }
+    
+    // NOTE: On a miss, *Slot is the empty slot where the string would go
+    bool
+    Probe(index *Index, meow_u32 Tag, void const *Bytes, size_t Length, meow_u32 *Id, size_t *Slot) const
+    {
+        bool Result = false;
+        size_t At = Tag >> Index->Shift;
+        for(;;)
+        {
+            meow_u64 Value = Index->Slots[At].load(std::memory_order_acquire);
+            if(Value == 0)
+            {
+                *Slot = At;
+                break;
+            }
+            
+            if((meow_u32)(Value >> 32) == Tag)
+            {
+                std::string_view Found = Get((meow_u32)Value);
+                if((Found.size() == Length) && (memcmp(Found.data(), Bytes, Length) == 0))
+                {
+                    *Id = (meow_u32)Value;
+                    Result = true;
+                    break;
+                }
+            }
+            
+            At = (At + 1) & Index->Mask;
+        }
+        
+        return(Result);
+    }
+    
+    // NOTE: Copies the string into the shard's arena and returns its id
+    meow_u32
+    Append(shard &Shard, meow_u32 ShardIndex, void const *Bytes, size_t Length)
+    {
+        size_t Prefix = (Length < 255) ? 1 : 5;
+        size_t Units = (Prefix + Length + 3) / 4;
+        size_t PageUnits = (size_t)1 << PageUnitBits;
+        size_t ShardUnits = (size_t)1 << UnitBits;
+        
+        if((Length > 0xFFFFFFFFull) || (Units > ShardUnits))
+        {
+            throw std::bad_alloc();
+        }
+        
+        if(Shard.Cursor + Units > Shard.Allocated)
+        {
+            // NOTE: Records never straddle an allocation, so the tail of the last one is left over
+            size_t PageCount = (Units + PageUnits - 1) / PageUnits;
+            if(Shard.Allocated + PageCount*PageUnits > ShardUnits)
+            {
+                throw std::bad_alloc();
+            }
+            
+            char *Memory = (char *)malloc(PageCount*Config.PageSize);
+            if(!Memory)
+            {
+                throw std::bad_alloc();
+            }
+            Shard.Allocations.push_back(Memory);
+            Shard.MemoryUsed.fetch_add(PageCount*Config.PageSize, std::memory_order_relaxed);
+            
+            Shard.Cursor = Shard.Allocated;
+            for(size_t Page = 0;
+                Page < PageCount;
+                ++Page)
+            {
+                Shard.Pages[(Shard.Allocated >> PageUnitBits) + Page].store(Memory + Page*Config.PageSize, std::memory_order_release);
+            }
+            Shard.Allocated += (meow_u32)(PageCount*PageUnits);
+        }
+        
+        meow_u32 Unit = Shard.Cursor;
+        char *Record = Shard.Pages[Unit >> PageUnitBits].load(std::memory_order_relaxed) + 4*(size_t)(Unit & (PageUnits - 1));
+        if(Prefix == 1)
+        {
+            Record[0] = (char)Length;
+        }
+        else
+        {
+            meow_u32 Length32 = (meow_u32)Length;
+            Record[0] = (char)255;
+            memcpy(Record + 1, &Length32, sizeof(Length32));
+        }
+        memcpy(Record + Prefix, Bytes, Length);
+        Shard.Cursor += (meow_u32)Units;
+        
+        meow_u32 Result = (ShardIndex << UnitBits) | Unit;
+        return(Result);
+    }
+    
+    // NOTE: Positions come from the tags, so the slots move over without touching a string
+    void
+    Grow(shard &Shard, index *Old)
+    {
+        index *New = CreateIndex(2*Old->Capacity, Old);
+        for(size_t At = 0;
+            At < Old->Capacity;
+            ++At)
+        {
+            meow_u64 Value = Old->Slots[At].load(std::memory_order_relaxed);
+            if(Value)
+            {
+                size_t To = (meow_u32)(Value >> 32) >> New->Shift;
+                while(New->Slots[To].load(std::memory_order_relaxed))
+                {
+                    To = (To + 1) & New->Mask;
+                }
+                New->Slots[To].store(Value, std::memory_order_relaxed);
+            }
+        }
+        
+        Shard.MemoryUsed.fetch_add(New->Capacity*sizeof(meow_u64), std::memory_order_relaxed);
+        Shard.Index.store(New, std::memory_order_release);
+    }
+    
+    static index *
+    CreateIndex(size_t Capacity, index *Older)
+    {
+        index *Result = new index;
+        Result->Capacity = Capacity;
+        Result->Mask = Capacity - 1;
+        Result->Shift = 32;
+        while(((size_t)1 << (32 - Result->Shift)) < Capacity)
+        {
+            --Result->Shift;
+        }
+        Result->Older = Older;
+        Result->Slots = new std::atomic<meow_u64>[Capacity]();
+        return(Result);
+    }
+    
+    static void
+    FreeIndex(index *Index)
+    {
+        delete[] Index->Slots;
+        delete Index;
+    }
+    
+    config Config;
+    size_t ShardCount;
+    int UnitBits;
+    int PageUnitBits;
+    shard *Shards;
+};
+    
+}
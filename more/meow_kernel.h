@@ -0,0 +1,614 @@
+/* ========================================================================
+   
+   meow_kernel.h - template-generated family of Meow-style kernels
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Every Meow-style hash is built the same way: some number of lanes, each
+   running a few AESDECs per 16 bytes over blocks of 16*Lanes bytes, then a
+   tail and a reduction tree.  This file writes that down once, as C++
+   templates, and generates the one-shot, streaming and ANSI-C versions of
+   any configuration from it:
+   
+       meow_kernel<Lanes, Rounds, Width>::Hash(Seed1, Seed2, Len, Source);
+   
+       meow_kernel<Lanes, Rounds, Width>::state State;
+       meow_kernel<Lanes, Rounds, Width>::Begin(&State, Seed1, Seed2, Len);
+       meow_kernel<Lanes, Rounds, Width>::Absorb(&State, ChunkLen, Chunk);
+       meow_kernel<Lanes, Rounds, Width>::End(&State, Seed1, Seed2);
+   
+       meow_kernel<Lanes, Rounds, 128, meow_kernel_c>::Hash(...); // NOTE: ANSI-C
+   
+   Lanes is 2, 4, 8 or 16, Rounds is the number of AESDECs per 16 bytes, and
+   Width (128, 256 or 512) is the register width the block loop runs at.
+   Width only changes how the block loop is compiled, never the output, so
+   all widths of one configuration produce identical hashes.  The 256 and
+   512-wide loops are compiled with target attributes, so check the CPU
+   first (see MegapawHashCPUWidth in megapaw_hash.h).
+   
+   The family is defined so that meow_kernel<4, 2> IS Meow - it produces
+   exactly what MeowHash_Accelerated does.  Every configuration uses the
+   same rules:
+   
+       - Lane i starts as bytes 16*i .. 16*i + 15, XORed with the mixer
+       - Full blocks do Rounds AESDECs on every lane with its 16 bytes
+       - Full 16-byte lanes of the tail go into lanes 0, 1, 2, ...
+       - The partial bytes go into the last lane, also with Rounds AESDECs
+       - Every lane is AESDECed with the mixer, then lanes are folded in
+         pairs (1 into 0, 3 into 2, ...) and the right-hand lane of each
+         later pair is AESDECed with the mixer before it is folded in
+       - Lane 0 is AESDECed with the mixer once more
+   
+   Other configurations are NOT Meow (or Megapaw, or Meow Wide) and their
+   values should only be compared with themselves.  See meow_kernel_bench
+   for a sweep of their throughput and latency.
+   
+   ======================================================================== */
+
+#define MEOW_KERNEL_MAX_LANES 16
+
+static const unsigned char MeowKernelInit[16*MEOW_KERNEL_MAX_LANES] =
+{
+      0,   1,   2,   3,   4,   5,   6,   7,   8,   9,  10,  11,  12,  13,  14,  15,
+     16,  17,  18,  19,  20,  21,  22,  23,  24,  25,  26,  27,  28,  29,  30,  31,
+     32,  33,  34,  35,  36,  37,  38,  39,  40,  41,  42,  43,  44,  45,  46,  47,
+     48,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,  61,  62,  63,
+     64,  65,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,  77,  78,  79,
+     80,  81,  82,  83,  84,  85,  86,  87,  88,  89,  90,  91,  92,  93,  94,  95,
+     96,  97,  98,  99, 100, 101, 102, 103, 104, 105, 106, 107, 108, 109, 110, 111,
+    112, 113, 114, 115, 116, 117, 118, 119, 120, 121, 122, 123, 124, 125, 126, 127,
+    128, 129, 130, 131, 132, 133, 134, 135, 136, 137, 138, 139, 140, 141, 142, 143,
+    144, 145, 146, 147, 148, 149, 150, 151, 152, 153, 154, 155, 156, 157, 158, 159,
+    160, 161, 162, 163, 164, 165, 166, 167, 168, 169, 170, 171, 172, 173, 174, 175,
+    176, 177, 178, 179, 180, 181, 182, 183, 184, 185, 186, 187, 188, 189, 190, 191,
+    192, 193, 194, 195, 196, 197, 198, 199, 200, 201, 202, 203, 204, 205, 206, 207,
+    208, 209, 210, 211, 212, 213, 214, 215, 216, 217, 218, 219, 220, 221, 222, 223,
+    224, 225, 226, 227, 228, 229, 230, 231, 232, 233, 234, 235, 236, 237, 238, 239,
+    240, 241, 242, 243, 244, 245, 246, 247, 248, 249, 250, 251, 252, 253, 254, 255,
+};
+
+//
+// NOTE: Engines.  An engine supplies the 128-bit lane type and the handful of
+// AES operations the kernel needs; the kernel itself never touches a lane
+// any other way.
+//
+
+struct meow_kernel_aesni
+{
+    typedef meow_aes_128 lane;
+    
+    static lane
+    Constant(int LaneIndex)
+    {
+        lane Result = Meow128_GetAESConstant(MeowKernelInit + 16*LaneIndex);
+        return(Result);
+    }
+    
+    static lane
+    Mixer(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes)
+    {
+        lane Result = Meow128_Set64x2(Seed1 - TotalLengthInBytes, Seed2 + TotalLengthInBytes + 1);
+        return(Result);
+    }
+    
+    static lane
+    Xor(lane A, lane B)
+    {
+        lane Result = A ^ B;
+        return(Result);
+    }
+    
+    static lane
+    AESDEC(lane Prior, lane Key)
+    {
+        lane Result = Meow128_AESDEC(Prior, Key);
+        return(Result);
+    }
+    
+    static lane
+    AESDEC_Mem(lane Prior, meow_u8 *Key)
+    {
+        lane Result = Meow128_AESDEC_Mem(Prior, Key);
+        return(Result);
+    }
+    
+    static lane
+    Finalize(lane A)
+    {
+        lane Result = Meow128_AESDEC_Finalize(A);
+        return(Result);
+    }
+    
+    static lane
+    Partial(meow_u8 *Overhang, int unsigned Len8)
+    {
+        int Align = ((int)(meow_umm)Overhang) & 15;
+        int End = ((int)(meow_umm)Overhang) & (MEOW_PAGESIZE - 1);
+        
+        // NOTE(jeffr): If we are nowhere near the page end, use full unaligned load (cmov to set)
+        if (End <= (MEOW_PAGESIZE - 16))
+        {
+            Align = 0;
+        }
+        
+        // NOTE(jeffr): If we will read over the page end, use a full unaligned load (cmov to set)
+        if ((End + Len8) > MEOW_PAGESIZE)
+        {
+            Align = 0;
+        }
+        
+        lane Result = Meow128_Shuffle_Mem(Overhang - Align, &MeowShiftAdjust[Align]);
+        Result = Meow128_And_Mem(Result, &MeowMaskLen[16 - Len8]);
+        return(Result);
+    }
+    
+    static meow_hash
+    ToHash(lane A)
+    {
+        meow_hash Result;
+        Meow128_CopyToHash(Meow128_AESDEC_Finalize(A), Result);
+        return(Result);
+    }
+};
+
+#if MEOW_INCLUDE_C
+
+//
+// NOTE: ANSI-C engine, using the AES tables from meow_more.h (include that first)
+//
+
+struct meow_kernel_c
+{
+    struct lane
+    {
+        meow_u32 W[4];
+    };
+    
+    static lane
+    Constant(int LaneIndex)
+    {
+        lane Result;
+        memcpy(Result.W, MeowKernelInit + 16*LaneIndex, sizeof(Result.W));
+        return(Result);
+    }
+    
+    static lane
+    Mixer(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes)
+    {
+        meow_u64 Mixer[2] = {Seed1 - TotalLengthInBytes, Seed2 + TotalLengthInBytes + 1};
+        lane Result;
+        memcpy(Result.W, Mixer, sizeof(Result.W));
+        return(Result);
+    }
+    
+    static lane
+    Xor(lane A, lane B)
+    {
+        Meow128_Cxor(A.W, B.W);
+        return(A);
+    }
+    
+    static lane
+    AESDEC(lane Prior, lane Key)
+    {
+        Meow128_AESDEC_C(Prior.W, Key.W);
+        return(Prior);
+    }
+    
+    static lane
+    AESDEC_Mem(lane Prior, meow_u8 *Key)
+    {
+        Meow128_AESDEC_C(Prior.W, Key);
+        return(Prior);
+    }
+    
+    static lane
+    Finalize(lane A)
+    {
+        return(A);
+    }
+    
+    static lane
+    Partial(meow_u8 *Overhang, int unsigned Len8)
+    {
+        meow_u8 Buffer[16] = {};
+        while(Len8--)
+        {
+            Buffer[Len8] = Overhang[Len8];
+        }
+        
+        lane Result;
+        memcpy(Result.W, Buffer, sizeof(Result.W));
+        return(Result);
+    }
+    
+    static meow_hash
+    ToHash(lane A)
+    {
+        meow_hash Result;
+        Result.u32[0] = A.W[0];
+        Result.u32[1] = A.W[1];
+        Result.u32[2] = A.W[2];
+        Result.u32[3] = A.W[3];
+        return(Result);
+    }
+};
+
+#endif
+
+//
+// NOTE: The single definition of the family: lane setup, one lane's worth of
+// absorption, and the tail plus reduction tree.  Everything below is built
+// out of these.
+//
+
+template<typename engine, int Lanes, int Rounds>
+struct meow_kernel_core
+{
+    typedef typename engine::lane lane;
+    
+    static_assert((Lanes >= 2) && (Lanes <= MEOW_KERNEL_MAX_LANES) && !(Lanes & (Lanes - 1)),
+                  "Meow kernels need a power-of-two lane count from 2 to 16");
+    static_assert(Rounds >= 1, "Meow kernels need at least one round");
+    
+    static void
+    Init(lane *S, lane Mixer)
+    {
+        for(int LaneIndex = 0;
+            LaneIndex < Lanes;
+            ++LaneIndex)
+        {
+            S[LaneIndex] = engine::Xor(engine::Constant(LaneIndex), Mixer);
+        }
+    }
+    
+    static lane
+    AbsorbLane(lane S, lane Key)
+    {
+        for(int Round = 0;
+            Round < Rounds;
+            ++Round)
+        {
+            S = engine::AESDEC(S, Key);
+        }
+        
+        return(S);
+    }
+    
+    static lane
+    AbsorbLane(lane S, meow_u8 *Source)
+    {
+        for(int Round = 0;
+            Round < Rounds;
+            ++Round)
+        {
+            S = engine::AESDEC_Mem(S, Source);
+        }
+        
+        return(S);
+    }
+    
+    static void
+    AbsorbBlocks(lane *State, meow_u64 BlockCount, meow_u8 *Source)
+    {
+        lane S[Lanes];
+        for(int LaneIndex = 0;
+            LaneIndex < Lanes;
+            ++LaneIndex)
+        {
+            S[LaneIndex] = State[LaneIndex];
+        }
+        
+        while(BlockCount--)
+        {
+            for(int LaneIndex = 0;
+                LaneIndex < Lanes;
+                ++LaneIndex)
+            {
+                S[LaneIndex] = AbsorbLane(S[LaneIndex], Source + 16*LaneIndex);
+            }
+            
+            Source += 16*Lanes;
+        }
+        
+        for(int LaneIndex = 0;
+            LaneIndex < Lanes;
+            ++LaneIndex)
+        {
+            State[LaneIndex] = S[LaneIndex];
+        }
+    }
+    
+    // NOTE: Len must be less than one block (16*Lanes bytes)
+    static meow_hash
+    Finish(lane *S, lane Mixer, int unsigned Len, meow_u8 *Source)
+    {
+        //
+        // NOTE(casey): Overhanging individual bytes
+        //
+        
+        int unsigned Len8 = (Len & 15);
+        if(Len8)
+        {
+            lane Partial = engine::Partial(Source + (Len & ~15), Len8);
+            S[Lanes - 1] = AbsorbLane(S[Lanes - 1], Partial);
+        }
+        
+        //
+        // NOTE(casey): Overhanging full 128-bit lanes
+        //
+        
+        for(int unsigned LaneIndex = 0;
+            LaneIndex < (Len >> 4);
+            ++LaneIndex)
+        {
+            S[LaneIndex] = AbsorbLane(S[LaneIndex], Source + 16*LaneIndex);
+        }
+        
+        //
+        // NOTE(casey): Mix the lanes down to one 128-bit hash
+        //
+        
+        for(int LaneIndex = 0;
+            LaneIndex < Lanes;
+            ++LaneIndex)
+        {
+            S[LaneIndex] = engine::AESDEC(S[LaneIndex], Mixer);
+        }
+        
+        for(int Stride = 1;
+            Stride < Lanes;
+            Stride *= 2)
+        {
+            for(int LaneIndex = 0;
+                LaneIndex < Lanes;
+                LaneIndex += 2*Stride)
+            {
+                if(Stride > 1)
+                {
+                    S[LaneIndex + Stride] = engine::AESDEC(S[LaneIndex + Stride], Mixer);
+                }
+                S[LaneIndex] = engine::AESDEC(S[LaneIndex], engine::Finalize(S[LaneIndex + Stride]));
+            }
+        }
+        
+        S[0] = engine::AESDEC(S[0], Mixer);
+        
+        meow_hash Result = engine::ToHash(S[0]);
+        return(Result);
+    }
+};
+
+//
+// NOTE: Block loops.  The generic one runs on the engine's own lanes, and the
+// AES-NI engine gets 256 and 512-wide specializations that pack two or four
+// lanes per register.  Only the block loop is specialized - the tail and the
+// reduction always run on 128-bit lanes, so the output cannot depend on Width.
+//
+
+template<typename engine, int Lanes, int Rounds, int Width>
+struct meow_kernel_blocks
+{
+    static_assert(Width == 128, "Only the AES-NI engine has wide block loops");
+    
+    typedef typename engine::lane lane;
+    
+    static void
+    Absorb(lane *State, meow_u64 BlockCount, meow_u8 *Source)
+    {
+        meow_kernel_core<engine, Lanes, Rounds>::AbsorbBlocks(State, BlockCount, Source);
+    }
+};
+
+#if MEOW_HASH_INTEL
+
+#if _MSC_VER
+#define MEOW_KERNEL_TARGET_256
+#define MEOW_KERNEL_TARGET_512
+#else
+#define MEOW_KERNEL_TARGET_256 __attribute__((target("aes,avx2,vaes")))
+#define MEOW_KERNEL_TARGET_512 __attribute__((target("aes,avx2,vaes,avx512f,avx512bw,avx512vl")))
+#endif
+
+template<int Lanes, int Rounds>
+struct meow_kernel_blocks<meow_kernel_aesni, Lanes, Rounds, 256>
+{
+    static_assert((Lanes % 2) == 0, "256-wide kernels need a multiple of 2 lanes");
+    
+    MEOW_KERNEL_TARGET_256 static void
+    Absorb(meow_aes_128 *State, meow_u64 BlockCount, meow_u8 *Source)
+    {
+        meow_aes_256 S[Lanes/2];
+        for(int PairIndex = 0;
+            PairIndex < Lanes/2;
+            ++PairIndex)
+        {
+            S[PairIndex] = _mm256_loadu_si256((meow_u256 *)(State + 2*PairIndex));
+        }
+        
+        while(BlockCount--)
+        {
+            for(int PairIndex = 0;
+                PairIndex < Lanes/2;
+                ++PairIndex)
+            {
+                meow_u256 Key = _mm256_loadu_si256((meow_u256 *)(Source + 32*PairIndex));
+                for(int Round = 0;
+                    Round < Rounds;
+                    ++Round)
+                {
+                    S[PairIndex] = Meow256_AESDEC(S[PairIndex], Key);
+                }
+            }
+            
+            Source += 16*Lanes;
+        }
+        
+        for(int PairIndex = 0;
+            PairIndex < Lanes/2;
+            ++PairIndex)
+        {
+            _mm256_storeu_si256((meow_u256 *)(State + 2*PairIndex), S[PairIndex]);
+        }
+    }
+};
+
+template<int Lanes, int Rounds>
+struct meow_kernel_blocks<meow_kernel_aesni, Lanes, Rounds, 512>
+{
+    static_assert((Lanes % 4) == 0, "512-wide kernels need a multiple of 4 lanes");
+    
+    MEOW_KERNEL_TARGET_512 static void
+    Absorb(meow_aes_128 *State, meow_u64 BlockCount, meow_u8 *Source)
+    {
+        meow_aes_512 S[Lanes/4];
+        for(int QuadIndex = 0;
+            QuadIndex < Lanes/4;
+            ++QuadIndex)
+        {
+            S[QuadIndex] = _mm512_loadu_si512((meow_u512 *)(State + 4*QuadIndex));
+        }
+        
+        while(BlockCount--)
+        {
+            for(int QuadIndex = 0;
+                QuadIndex < Lanes/4;
+                ++QuadIndex)
+            {
+                meow_u512 Key = _mm512_loadu_si512((meow_u512 *)(Source + 64*QuadIndex));
+                for(int Round = 0;
+                    Round < Rounds;
+                    ++Round)
+                {
+                    S[QuadIndex] = Meow512_AESDEC(S[QuadIndex], Key);
+                }
+            }
+            
+            Source += 16*Lanes;
+        }
+        
+        for(int QuadIndex = 0;
+            QuadIndex < Lanes/4;
+            ++QuadIndex)
+        {
+            _mm512_storeu_si512((meow_u512 *)(State + 4*QuadIndex), S[QuadIndex]);
+        }
+    }
+};
+
+#endif
+
+//
+// NOTE: The generated one-shot and streaming versions
+//
+
+template<int Lanes, int Rounds, int Width = 128, typename engine = meow_kernel_aesni>
+struct meow_kernel
+{
+    typedef typename engine::lane lane;
+    typedef meow_kernel_core<engine, Lanes, Rounds> core;
+    typedef meow_kernel_blocks<engine, Lanes, Rounds, Width> blocks;
+    
+    enum {BlockSize = 16*Lanes};
+    
+    struct state
+    {
+        lane S[Lanes];
+        
+        meow_u64 TotalLengthInBytes;
+        
+        meow_u8 Buffer[BlockSize];
+        int unsigned BufferLen;
+    };
+    
+    static meow_hash
+    Hash(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, void *SourceInit)
+    {
+        lane Mixer = engine::Mixer(Seed1, Seed2, TotalLengthInBytes);
+        lane S[Lanes];
+        core::Init(S, Mixer);
+        
+        meow_u8 *Source = (meow_u8 *)SourceInit;
+        meow_u64 BlockCount = (TotalLengthInBytes / BlockSize);
+        if(BlockCount)
+        {
+            blocks::Absorb(S, BlockCount, Source);
+            Source += BlockCount*BlockSize;
+        }
+        
+        meow_hash Result = core::Finish(S, Mixer, (int unsigned)(TotalLengthInBytes % BlockSize), Source);
+        return(Result);
+    }
+    
+    static void
+    Begin(state *State, meow_u64 Seed1, meow_u64 Seed2, meow_u64 length)
+    {
+        core::Init(State->S, engine::Mixer(Seed1, Seed2, length));
+        State->TotalLengthInBytes = 0;
+        State->BufferLen = 0;
+    }
+    
+    static void
+    Absorb(state *State, meow_u64 Len, void *SourceInit)
+    {
+        State->TotalLengthInBytes += Len;
+        meow_u8 *Source = (meow_u8 *)SourceInit;
+        
+        // NOTE(casey): Handle any buffered residual
+        if(State->BufferLen)
+        {
+            int unsigned Fill = (sizeof(State->Buffer) - State->BufferLen);
+            if(Fill > Len)
+            {
+                Fill = (int unsigned)Len;
+            }
+            
+            memcpy(State->Buffer + State->BufferLen, Source, Fill);
+            State->BufferLen += Fill;
+            Source += Fill;
+            Len -= Fill;
+            
+            if(State->BufferLen == sizeof(State->Buffer))
+            {
+                blocks::Absorb(State->S, 1, State->Buffer);
+                State->BufferLen = 0;
+            }
+        }
+        
+        // NOTE(casey): Handle any full blocks
+        meow_u64 BlockCount = (Len / BlockSize);
+        if(BlockCount)
+        {
+            blocks::Absorb(State->S, BlockCount, Source);
+            Source += BlockCount*BlockSize;
+            Len -= BlockCount*BlockSize;
+        }
+        
+        // NOTE(casey): Store residual
+        memcpy(State->Buffer + State->BufferLen, Source, (size_t)Len);
+        State->BufferLen += (int unsigned)Len;
+    }
+    
+    static meow_hash
+    End(state *State, meow_u64 Seed1, meow_u64 Seed2)
+    {
+        lane S[Lanes];
+        for(int LaneIndex = 0;
+            LaneIndex < Lanes;
+            ++LaneIndex)
+        {
+            S[LaneIndex] = State->S[LaneIndex];
+        }
+        
+        // NOTE: The residual is in State->Buffer, which is a full block long, so
+        // the partial load never leaves the buffer
+        lane Mixer = engine::Mixer(Seed1, Seed2, State->TotalLengthInBytes);
+        meow_hash Result = core::Finish(S, Mixer, State->BufferLen, State->Buffer);
+        return(Result);
+    }
+};
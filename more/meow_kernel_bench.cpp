@@ -0,0 +1,267 @@
+/* ========================================================================
+   
+   meow_kernel_bench.cpp - RDTSC-based sweep of the Meow kernel family
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ======================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __aarch64__
+// NOTE(mmozeiko): On ARM you normally cannot access cycle counter from user-space.
+// Download & build following kernel module that enables access to PMU cycle counter
+// from user-space code: https://github.com/zhiyisun/enable_arm_pmu
+#include <stdint.h>
+#include "enable_arm_pmu/armpmu_lib.h"
+#define __rdtsc() read_pmu()
+#define __rdtscp(x) read_pmu()
+#endif
+
+// NOTE: CPUID is only here to serialize the pipeline around the timed call,
+// so its outputs are discarded
+#ifdef _MSC_VER
+#define MeowSerialize() do {int CPUInfo[4]; __cpuid(CPUInfo, 0);} while(0)
+#elif __i386__
+#define MeowSerialize() __asm__ __volatile__("cpuid" : : : "eax", "ebx", "ecx", "edx")
+#elif __x86_64__
+#define MeowSerialize() __asm__ __volatile__("cpuid" : : : "rax", "rbx", "rcx", "rdx")
+#else
+#define MeowSerialize()
+#endif
+
+#include "meow_test.h"
+#include "more/megapaw_hash.h"
+#include "more/meow_kernel.h"
+
+//
+// NOTE: The configurations to sweep.  Hand-written hashes are listed with a
+// Lanes of zero, so they show up in the table for comparison.
+//
+
+struct named_kernel_type
+{
+    char *FullName;
+    int Lanes;
+    int Rounds;
+    int Width;
+    
+    meow_hash_implementation *Imp;
+};
+
+#define MEOW_KERNEL_TYPE(Lanes, Rounds, Width) \
+    {(char *)"kernel<" #Lanes ", " #Rounds ", " #Width ">", Lanes, Rounds, Width, meow_kernel<Lanes, Rounds, Width>::Hash}
+
+static named_kernel_type NamedKernelTypes[] =
+{
+    {(char *)"Meow (" MEOW_HASH_VERSION_NAME ")", 0, 2, 128, MeowHash_Accelerated},
+    {(char *)"Meow Wide (" MEOW_WIDE_HASH_VERSION_NAME ")", 0, 2, 128, MeowWideHash_Accelerated},
+    {(char *)"Megapaw 128-wide", 0, 1, 128, MegapawHash_128Wide},
+#if MEOW_HASH_INTEL
+    {(char *)"Megapaw 256-wide", 0, 1, 256, MegapawHash_256Wide},
+    {(char *)"Megapaw 512-wide", 0, 1, 512, MegapawHash_512Wide},
+#endif
+    
+    MEOW_KERNEL_TYPE(2, 2, 128),
+    MEOW_KERNEL_TYPE(4, 1, 128),
+    MEOW_KERNEL_TYPE(4, 2, 128),
+    MEOW_KERNEL_TYPE(8, 1, 128),
+    MEOW_KERNEL_TYPE(8, 2, 128),
+    MEOW_KERNEL_TYPE(16, 1, 128),
+    MEOW_KERNEL_TYPE(16, 2, 128),
+#if MEOW_HASH_INTEL
+    MEOW_KERNEL_TYPE(4, 2, 256),
+    MEOW_KERNEL_TYPE(8, 1, 256),
+    MEOW_KERNEL_TYPE(8, 2, 256),
+    MEOW_KERNEL_TYPE(16, 1, 256),
+    MEOW_KERNEL_TYPE(16, 2, 256),
+    MEOW_KERNEL_TYPE(4, 2, 512),
+    MEOW_KERNEL_TYPE(8, 2, 512),
+    MEOW_KERNEL_TYPE(16, 1, 512),
+    MEOW_KERNEL_TYPE(16, 2, 512),
+#endif
+};
+
+//
+// NOTE: Small sizes are reported as clocks per hash (latency), large sizes
+// as bytes per clock (throughput).  The large sizes are chosen to sit in L1,
+// L2 and main memory respectively on most current x64 parts.
+//
+
+static meow_u64 LatencySizes[] = {0, 16, 63, 128, 255, 1024};
+static meow_u64 ThroughputSizes[] = {16*1024, 256*1024, 64*1024*1024};
+
+static meow_u64
+MinClocks(meow_hash_implementation *Imp, meow_u64 Size, void *Buffer, int RunCount, meow_hash *FakeSlot)
+{
+    meow_u64 Result = (meow_u64)-1;
+    for(int RunIndex = 0;
+        RunIndex < RunCount;
+        ++RunIndex)
+    {
+        int unsigned Ignored2;
+        MeowSerialize();
+        meow_u64 StartClock = __rdtsc();
+        *FakeSlot = Imp(RunIndex, 0, Size, Buffer);
+        meow_u64 EndClock = __rdtscp(&Ignored2);
+        MeowSerialize();
+        
+        meow_u64 Clocks = EndClock - StartClock;
+        if(Result > Clocks)
+        {
+            Result = Clocks;
+        }
+    }
+    
+    return(Result);
+}
+
+int
+main(int ArgCount, char **Args)
+{
+#if __aarch64__
+    enable_pmu(0x008);
+#endif
+    
+    FILE *CSV = 0;
+    if(ArgCount == 2)
+    {
+        CSV = fopen(Args[1], "w");
+        if(!CSV)
+        {
+            fprintf(stderr, "    (unable to open %s for writing)\n", Args[1]);
+        }
+    }
+    
+    int CPUWidth = MegapawHashCPUWidth();
+    
+    fprintf(stdout, "\n");
+    fprintf(stdout, "meow_kernel_bench %s - RDTSC-based sweep of the Meow kernel family\n", MEOW_HASH_VERSION_NAME);
+    fprintf(stdout, "    See https://mollyrocket.com/meowhash for details\n");
+    fprintf(stdout, "    WARNING: Counts are NOT accurate if CPU power throttling is enabled\n");
+    fprintf(stdout, "             (You must turn it off in your OS if you haven't yet!)\n");
+    fprintf(stdout, "    Widest supported kernel: %d-bit\n", CPUWidth);
+    fprintf(stdout, "\n");
+    
+    meow_u64 MaxSize = ThroughputSizes[ArrayCount(ThroughputSizes) - 1];
+    meow_u8 *Buffer = (meow_u8 *)aligned_alloc(CACHE_LINE_ALIGNMENT, MaxSize);
+    if(Buffer)
+    {
+        for(meow_u64 Index = 0;
+            Index < MaxSize;
+            ++Index)
+        {
+            Buffer[Index] = (meow_u8)(13*Index + 7);
+        }
+        
+        fprintf(stdout, "%-36s", "Clocks per hash:");
+        for(meow_u32 SizeIndex = 0;
+            SizeIndex < ArrayCount(LatencySizes);
+            ++SizeIndex)
+        {
+            fprintf(stdout, " ");
+            PrintSize(stdout, (double)LatencySizes[SizeIndex], true);
+        }
+        fprintf(stdout, "  | Bytes/cycle:");
+        for(meow_u32 SizeIndex = 0;
+            SizeIndex < ArrayCount(ThroughputSizes);
+            ++SizeIndex)
+        {
+            fprintf(stdout, " ");
+            PrintSize(stdout, (double)ThroughputSizes[SizeIndex], true);
+        }
+        fprintf(stdout, "\n");
+        
+        if(CSV)
+        {
+            fprintf(CSV, "Name,Lanes,Rounds,Width");
+            for(meow_u32 SizeIndex = 0;
+                SizeIndex < ArrayCount(LatencySizes);
+                ++SizeIndex)
+            {
+                fprintf(CSV, ",%llu clocks", (long long unsigned)LatencySizes[SizeIndex]);
+            }
+            for(meow_u32 SizeIndex = 0;
+                SizeIndex < ArrayCount(ThroughputSizes);
+                ++SizeIndex)
+            {
+                fprintf(CSV, ",%llu bytes/cycle", (long long unsigned)ThroughputSizes[SizeIndex]);
+            }
+            fprintf(CSV, "\n");
+        }
+        
+        meow_hash FakeSlot;
+        for(meow_u32 TypeIndex = 0;
+            TypeIndex < ArrayCount(NamedKernelTypes);
+            ++TypeIndex)
+        {
+            named_kernel_type *Type = NamedKernelTypes + TypeIndex;
+            fprintf(stdout, "%-36s", Type->FullName);
+            if(Type->Width > CPUWidth)
+            {
+                fprintf(stdout, " (not supported on this CPU)\n");
+                continue;
+            }
+            
+            if(CSV)
+            {
+                fprintf(CSV, "\"%s\",%d,%d,%d", Type->FullName, Type->Lanes, Type->Rounds, Type->Width);
+            }
+            
+            for(meow_u32 SizeIndex = 0;
+                SizeIndex < ArrayCount(LatencySizes);
+                ++SizeIndex)
+            {
+                meow_u64 Clocks = MinClocks(Type->Imp, LatencySizes[SizeIndex], Buffer, 10000, &FakeSlot);
+                fprintf(stdout, " %8llu", (long long unsigned)Clocks);
+                if(CSV)
+                {
+                    fprintf(CSV, ",%llu", (long long unsigned)Clocks);
+                }
+            }
+            
+            fprintf(stdout, "  |             ");
+            for(meow_u32 SizeIndex = 0;
+                SizeIndex < ArrayCount(ThroughputSizes);
+                ++SizeIndex)
+            {
+                meow_u64 Size = ThroughputSizes[SizeIndex];
+                int RunCount = (Size > 1024*1024) ? 5 : 200;
+                meow_u64 Clocks = MinClocks(Type->Imp, Size, Buffer, RunCount, &FakeSlot);
+                double BPC = Clocks ? ((double)Size / (double)Clocks) : 0.0;
+                fprintf(stdout, " %8.03f", BPC);
+                if(CSV)
+                {
+                    fprintf(CSV, ",%f", BPC);
+                }
+            }
+            
+            fprintf(stdout, "\n");
+            fflush(stdout);
+            if(CSV)
+            {
+                fprintf(CSV, "\n");
+            }
+        }
+        
+        free(Buffer);
+    }
+    else
+    {
+        fprintf(stderr, "ERROR: Unable to allocate buffer for hashing\n");
+    }
+    
+    if(CSV)
+    {
+        fclose(CSV);
+    }
+
+#if __aarch64__
+    disable_pmu(0x008);
+#endif
+    
+    return(0);
+}
@@ -0,0 +1,153 @@
+/* ========================================================================
+   
+   meow_lookup.h - batched hash-then-prefetch lookups for hash tables
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Once a table is bigger than the last-level cache, a point lookup is one
+   hash followed by one or two cache misses that depend on it, and the core
+   sits idle for most of the miss.  These functions look up many keys at
+   once instead: every key in a batch is hashed and has its bucket
+   prefetched before any of them is probed, so the misses overlap rather
+   than happening one after another.
+   
+       meow::map<meow_u64, Value> Map;
+   
+       Value *Found[Count];
+       meow::LookupBatch(Map, Count, Keys, Found);        // groups of MEOW_LOOKUP_BATCH
+       meow::LookupPipelined(Map, Count, Keys, Found);    // rolling, MEOW_LOOKUP_DISTANCE ahead
+   
+   LookupBatch works a group at a time: hash and prefetch the whole group,
+   then probe the whole group.  LookupPipelined is the same idea as a
+   software pipeline over the whole stream - while key N is probed, key
+   N + Distance is hashed and prefetched - so there is no bubble at the
+   start of each group.  It is usually the faster of the two for long
+   streams; LookupBatch is simpler to fit around code that already works in
+   batches.  Results come out in the same order as the keys either way.
+   
+   Any table can be used by specializing meow::lookup_traits.  It needs the
+   three steps of a lookup, split apart:
+   
+       template<> struct meow::lookup_traits<my_table>
+       {
+           template<typename key> static meow_hash Hash(my_table const &Table, key const &Key);
+           static void Prefetch(my_table const &Table, meow_hash Hash);    // MeowPrefetch() the bucket
+           template<typename key> static my_entry *Probe(my_table &Table, meow_hash Hash, key const &Key);
+       };
+   
+   The default traits call HashOf, Prefetch and FindHashed on the table,
+   which is what meow::map (meow_map.h) provides, so it works as-is.
+   
+   Include meow_intrinsics.h, meow_hash.h, more/meow_more.h, more/meow_cpp.h
+   and the table's header first.  Needs C++17.
+   
+   ======================================================================== */
+
+#include <stddef.h>
+
+// NOTE: Enough keys in flight to cover DRAM latency without running out of line fill buffers
+#define MEOW_LOOKUP_BATCH 16
+#define MEOW_LOOKUP_DISTANCE 16
+#define MEOW_LOOKUP_MAX_DISTANCE 64
+
+namespace meow
+{
+
+template<typename table>
+struct lookup_traits
+{
+    template<typename key>
+    static meow_hash
+    Hash(table const &Table, key const &Key)
+    {
+        meow_hash Result = Table.HashOf(Key);
+        return(Result);
+    }
+    
+    static void
+    Prefetch(table const &Table, meow_hash Hash)
+    {
+        Table.Prefetch(Hash);
+    }
+    
+    template<typename key>
+    static auto
+    Probe(table &Table, meow_hash Hash, key const &Key)
+    {
+        return(Table.FindHashed(Hash, Key));
+    }
+};
+
+template<typename table, typename key, typename result, typename traits = lookup_traits<table>>
+static void
+LookupBatch(table &Table, size_t Count, key const *Keys, result *Results)
+{
+    meow_hash Hashes[MEOW_LOOKUP_BATCH];
+    for(size_t Base = 0;
+        Base < Count;
+        Base += MEOW_LOOKUP_BATCH)
+    {
+        size_t BatchCount = ((Count - Base) < MEOW_LOOKUP_BATCH) ? (Count - Base) : MEOW_LOOKUP_BATCH;
+        
+        for(size_t Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            Hashes[Index] = traits::Hash(Table, Keys[Base + Index]);
+            traits::Prefetch(Table, Hashes[Index]);
+        }
+        
+        for(size_t Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            Results[Base + Index] = traits::Probe(Table, Hashes[Index], Keys[Base + Index]);
+        }
+    }
+}
+
+template<typename table, typename key, typename result, typename traits = lookup_traits<table>>
+static void
+LookupPipelined(table &Table, size_t Count, key const *Keys, result *Results, size_t Distance = MEOW_LOOKUP_DISTANCE)
+{
+    // NOTE: The ring has to hold Distance hashes plus the one being probed
+    if(Distance >= MEOW_LOOKUP_MAX_DISTANCE)
+    {
+        Distance = MEOW_LOOKUP_MAX_DISTANCE - 1;
+    }
+    if(Distance > Count)
+    {
+        Distance = Count;
+    }
+    
+    meow_hash Hashes[MEOW_LOOKUP_MAX_DISTANCE];
+    for(size_t Index = 0;
+        Index < Distance;
+        ++Index)
+    {
+        Hashes[Index] = traits::Hash(Table, Keys[Index]);
+        traits::Prefetch(Table, Hashes[Index]);
+    }
+    
+    for(size_t Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        size_t Ahead = Index + Distance;
+        if(Ahead < Count)
+        {
+            meow_hash Hash = traits::Hash(Table, Keys[Ahead]);
+            traits::Prefetch(Table, Hash);
+            Hashes[Ahead % MEOW_LOOKUP_MAX_DISTANCE] = Hash;
+        }
+        
+        Results[Index] = traits::Probe(Table, Hashes[Index % MEOW_LOOKUP_MAX_DISTANCE], Keys[Index]);
+    }
+}
+    
+}
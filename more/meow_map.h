@@ -0,0 +1,607 @@
+/* ========================================================================
+   
+   meow_map.h - flat open-addressing hash map keyed by Meow hashes
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   meow::map is a Swiss-table style hash map.  Keys and values live in one
+   flat array of slots, with no per-entry allocation, and next to it is one
+   control byte per slot: EMPTY, DELETED, or a 7-bit tag of the key's hash.
+   Slots come in groups of 16, and a lookup compares all 16 control bytes of
+   a group against the tag with one SSE2 compare (NEON on ARM), so the keys
+   themselves are only touched on a tag match - one time in 128 for a miss.
+   
+       meow::map<std::string, int> Map;
+       Map.Insert("meow", 1);
+       ++Map["purr"];
+       int *Value = Map.Find(std::string_view("meow"));   // 0 if not there
+       Map.Erase("meow");
+       Map.ForEach([](std::string const &Key, int &Value) {...});
+   
+   Keys are hashed with meow::hasher from meow_cpp.h, so anything it can
+   hash works as a key, and any type that hashes and compares the same
+   (std::string_view or char const * for std::string keys) works as a
+   lookup.  The group comes from MeowU32From(Hash, 0) and the tag from
+   MeowU32From(Hash, 1), so they are independent bits.  MeowU32From(Hash, 3)
+   is left alone, which means a map can hold one partition of a
+   meow_partition.h split without every key landing in the same groups.
+   
+   The third template argument stores each key's full 128-bit hash next to
+   its control byte:
+   
+       meow::map<std::string, int, true> Map;
+   
+   That costs 16 bytes per slot, and buys two things: growing the table
+   never hashes a key again, and a tag match is confirmed against the full
+   hash before the (possibly expensive) key compare.  Use it for long keys,
+   leave it off for small ones.
+   
+   Pointers returned by Find, Insert and operator[] are valid until the next
+   insert that grows the table, or until the entry is erased.
+   
+   Include meow_intrinsics.h, meow_hash.h, more/meow_more.h and
+   more/meow_cpp.h first.  Needs C++17.
+   
+   ======================================================================== */
+
+#include <stddef.h>
+#include <string.h>
+#include <functional>
+#include <new>
+#include <utility>
+
+#if _MSC_VER
+#include <intrin.h>
+#endif
+
+#define MEOW_MAP_GROUP 16
+#define MEOW_MAP_EMPTY 0x80
+#define MEOW_MAP_DELETED 0xFE
+
+//
+// NOTE: Group scans.  Each returns a mask with one bit set per matching
+// control byte.  On SSE2 that is a plain movemask; NEON has no movemask, so
+// there each byte becomes a nibble and MEOW_MAP_MASK_SHIFT turns a bit index
+// back into a byte index.
+//
+
+#if MEOW_HASH_INTEL
+
+typedef meow_u32 meow_map_mask;
+#define MEOW_MAP_MASK_SHIFT 0
+#define MEOW_MAP_MASK_ALL 0xFFFF
+
+static meow_map_mask
+MeowMapMatch(meow_u8 const *Group, meow_u8 Tag)
+{
+    __m128i Control = _mm_load_si128((__m128i const *)Group);
+    meow_map_mask Result = (meow_map_mask)_mm_movemask_epi8(_mm_cmpeq_epi8(Control, _mm_set1_epi8((char)Tag)));
+    return(Result);
+}
+
+// NOTE: EMPTY and DELETED are the only control bytes with the top bit set
+static meow_map_mask
+MeowMapMatchFree(meow_u8 const *Group)
+{
+    meow_map_mask Result = (meow_map_mask)_mm_movemask_epi8(_mm_load_si128((__m128i const *)Group));
+    return(Result);
+}
+
+#elif MEOW_HASH_ARMV8
+
+typedef meow_u64 meow_map_mask;
+#define MEOW_MAP_MASK_SHIFT 2
+#define MEOW_MAP_MASK_ALL 0x8888888888888888ull
+
+static meow_map_mask
+MeowMapMask(uint8x16_t Bytes)
+{
+    meow_map_mask Result = (vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(Bytes), 4)), 0) &
+                            MEOW_MAP_MASK_ALL);
+    return(Result);
+}
+
+static meow_map_mask
+MeowMapMatch(meow_u8 const *Group, meow_u8 Tag)
+{
+    meow_map_mask Result = MeowMapMask(vceqq_u8(vld1q_u8(Group), vdupq_n_u8(Tag)));
+    return(Result);
+}
+
+static meow_map_mask
+MeowMapMatchFree(meow_u8 const *Group)
+{
+    meow_map_mask Result = MeowMapMask(vtstq_u8(vld1q_u8(Group), vdupq_n_u8(0x80)));
+    return(Result);
+}
+
+#endif
+
+static meow_map_mask
+MeowMapMatchEmpty(meow_u8 const *Group)
+{
+    meow_map_mask Result = MeowMapMatch(Group, MEOW_MAP_EMPTY);
+    return(Result);
+}
+
+static meow_map_mask
+MeowMapMatchFull(meow_u8 const *Group)
+{
+    meow_map_mask Result = ~MeowMapMatchFree(Group) & MEOW_MAP_MASK_ALL;
+    return(Result);
+}
+
+static int
+MeowMapLowestIndex(meow_map_mask Mask)
+{
+#if _MSC_VER
+    unsigned long Bit;
+#if MEOW_HASH_INTEL
+    _BitScanForward(&Bit, Mask);
+#else
+    _BitScanForward64(&Bit, Mask);
+#endif
+    int Result = (int)(Bit >> MEOW_MAP_MASK_SHIFT);
+#else
+    int Result = (int)(__builtin_ctzll(Mask) >> MEOW_MAP_MASK_SHIFT);
+#endif
+    return(Result);
+}
+
+namespace meow
+{
+
+template<typename key, typename value, bool StoreHash = false, typename key_hasher = hasher, typename key_equal = std::equal_to<>>
+class map
+{
+public:
+    struct slot
+    {
+        key Key;
+        value Value;
+    };
+    
+    struct insert_result
+    {
+        value *Value;
+        bool Inserted;
+    };
+    
+    explicit map(size_t InitialCount = 0, key_hasher HasherInit = key_hasher(), key_equal EqualInit = key_equal())
+        : Hasher(HasherInit), Equal(EqualInit)
+    {
+        Reserve(InitialCount);
+    }
+    
+    map(map &&Other) noexcept
+        : Hasher(Other.Hasher), Equal(Other.Equal)
+    {
+        Take(Other);
+    }
+    
+    map &
+    operator=(map &&Other) noexcept
+    {
+        if(this != &Other)
+        {
+            Release();
+            Hasher = Other.Hasher;
+            Equal = Other.Equal;
+            Take(Other);
+        }
+        return(*this);
+    }
+    
+    map(map const &) = delete;
+    map &operator=(map const &) = delete;
+    
+    ~map()
+    {
+        Release();
+    }
+    
+    template<typename lookup>
+    value *
+    Find(lookup const &Key)
+    {
+        size_t Index = FindIndex(Hasher(Key), Key);
+        value *Result = (Index != NotFound) ? &Slots[Index].Value : 0;
+        return(Result);
+    }
+    
+    template<typename lookup>
+    value const *
+    Find(lookup const &Key) const
+    {
+        return(const_cast<map *>(this)->Find(Key));
+    }
+
+    //
+    // NOTE: Find split into its three steps, for batched lookups (see
+    // meow_lookup.h): hash the key, prefetch where its probe will start,
+    // and only then probe
+    //
+
+    template<typename lookup>
+    meow_hash
+    HashOf(lookup const &Key) const
+    {
+        meow_hash Result = Hasher(Key);
+        return(Result);
+    }
+
+    void
+    Prefetch(meow_hash Hash) const
+    {
+        if(Capacity)
+        {
+            size_t Group = GroupOf(Hash) & ((Capacity / MEOW_MAP_GROUP) - 1);
+            MeowPrefetch(Control + Group*MEOW_MAP_GROUP);
+
+            // NOTE: Groups fill from the front, so the first line of slots is the likeliest hit
+            MeowPrefetch(Slots + Group*MEOW_MAP_GROUP);
+            if(StoreHash)
+            {
+                MeowPrefetch(Hashes + Group*MEOW_MAP_GROUP);
+            }
+        }
+    }
+
+    template<typename lookup>
+    value *
+    FindHashed(meow_hash Hash, lookup const &Key)
+    {
+        size_t Index = FindIndex(Hash, Key);
+        value *Result = (Index != NotFound) ? &Slots[Index].Value : 0;
+        return(Result);
+    }
+
+    // NOTE: Like std::unordered_map::emplace - an existing value is left alone
+    template<typename key_arg, typename... value_args>
+    insert_result
+    Insert(key_arg &&Key, value_args &&... ValueArgs)
+    {
+        meow_hash Hash = Hasher(Key);
+        insert_result Result;
+        size_t Index = FindIndex(Hash, Key);
+        Result.Inserted = (Index == NotFound);
+        if(Result.Inserted)
+        {
+            Index = Claim(Hash);
+            new(&Slots[Index]) slot{key(std::forward<key_arg>(Key)), value(std::forward<value_args>(ValueArgs)...)};
+            Fill(Index, Hash);
+        }
+        Result.Value = &Slots[Index].Value;
+        return(Result);
+    }
+    
+    template<typename key_arg>
+    value &
+    operator[](key_arg &&Key)
+    {
+        value *Result = Insert(std::forward<key_arg>(Key)).Value;
+        return(*Result);
+    }
+    
+    template<typename lookup>
+    bool
+    Erase(lookup const &Key)
+    {
+        size_t Index = FindIndex(Hasher(Key), Key);
+        bool Result = (Index != NotFound);
+        if(Result)
+        {
+            Slots[Index].~slot();
+            --Count;
+            
+            // NOTE: A probe only moves past a group that has no EMPTY bytes,
+            // so if this group still has one, nothing can be relying on this
+            // slot being taken, and it can go straight back to EMPTY
+            if(MeowMapMatchEmpty(Control + (Index & ~(size_t)(MEOW_MAP_GROUP - 1))))
+            {
+                Control[Index] = MEOW_MAP_EMPTY;
+                ++GrowthLeft;
+            }
+            else
+            {
+                Control[Index] = MEOW_MAP_DELETED;
+            }
+        }
+        
+        return(Result);
+    }
+    
+    // NOTE: Makes room for at least NeededCount entries without growing
+    void
+    Reserve(size_t NeededCount)
+    {
+        size_t NewCapacity = Capacity ? Capacity : MEOW_MAP_GROUP;
+        while(MaxLoad(NewCapacity) < NeededCount)
+        {
+            NewCapacity *= 2;
+        }
+        
+        if(NeededCount && (NewCapacity > Capacity))
+        {
+            Resize(NewCapacity);
+        }
+    }
+    
+    // NOTE: Destroys every entry but keeps the memory
+    void
+    Clear(void)
+    {
+        ForEachIndex([this](size_t Index) { Slots[Index].~slot(); });
+        if(Capacity)
+        {
+            memset(Control, MEOW_MAP_EMPTY, Capacity);
+        }
+        Count = 0;
+        GrowthLeft = MaxLoad(Capacity);
+    }
+    
+    template<typename fn>
+    void
+    ForEach(fn &&Fn)
+    {
+        ForEachIndex([&](size_t Index) { Fn(Slots[Index].Key, Slots[Index].Value); });
+    }
+    
+    size_t
+    GetCount(void) const
+    {
+        return(Count);
+    }
+    
+    size_t
+    GetCapacity(void) const
+    {
+        return(Capacity);
+    }
+
+private:
+    static constexpr size_t NotFound = ~(size_t)0;
+    
+    static size_t
+    MaxLoad(size_t ForCapacity)
+    {
+        // NOTE: 7/8 full at most, the same as the Swiss tables
+        size_t Result = ForCapacity - ForCapacity/8;
+        return(Result);
+    }
+    
+    static size_t
+    Alignment(void)
+    {
+        size_t Result = (alignof(slot) > MEOW_MAP_GROUP) ? alignof(slot) : MEOW_MAP_GROUP;
+        return(Result);
+    }
+    
+    static size_t
+    SlotOffset(size_t ForCapacity)
+    {
+        size_t Result = ForCapacity + (StoreHash ? ForCapacity*sizeof(meow_hash) : 0);
+        Result = (Result + Alignment() - 1) & ~(Alignment() - 1);
+        return(Result);
+    }
+    
+    static size_t
+    GroupOf(meow_hash Hash)
+    {
+        size_t Result = MeowU32From(Hash, 0);
+        return(Result);
+    }
+    
+    static meow_u8
+    TagOf(meow_hash Hash)
+    {
+        meow_u8 Result = (meow_u8)(MeowU32From(Hash, 1) & 0x7F);
+        return(Result);
+    }
+    
+    template<typename lookup>
+    size_t
+    FindIndex(meow_hash Hash, lookup const &Key) const
+    {
+        if(Capacity)
+        {
+            size_t GroupMask = (Capacity / MEOW_MAP_GROUP) - 1;
+            size_t Group = GroupOf(Hash) & GroupMask;
+            meow_u8 Tag = TagOf(Hash);
+            
+            // NOTE: Triangular steps over a power-of-two group count visit every group
+            for(size_t Step = 1;
+                ;
+                ++Step)
+            {
+                meow_u8 const *GroupControl = Control + Group*MEOW_MAP_GROUP;
+                for(meow_map_mask Mask = MeowMapMatch(GroupControl, Tag);
+                    Mask;
+                    Mask &= Mask - 1)
+                {
+                    size_t Index = Group*MEOW_MAP_GROUP + MeowMapLowestIndex(Mask);
+                    if((!StoreHash || MeowHashesAreEqual(Hashes[Index], Hash)) &&
+                       Equal(Slots[Index].Key, Key))
+                    {
+                        return(Index);
+                    }
+                }
+                
+                if(MeowMapMatchEmpty(GroupControl))
+                {
+                    break;
+                }
+                
+                Group = (Group + Step) & GroupMask;
+            }
+        }
+        
+        return(NotFound);
+    }
+    
+    // NOTE: First EMPTY or DELETED slot on the probe path.  There always is
+    // one, because the table is never allowed to fill up.
+    size_t
+    FindFree(meow_hash Hash) const
+    {
+        size_t GroupMask = (Capacity / MEOW_MAP_GROUP) - 1;
+        size_t Group = GroupOf(Hash) & GroupMask;
+        for(size_t Step = 1;
+            ;
+            ++Step)
+        {
+            meow_map_mask Mask = MeowMapMatchFree(Control + Group*MEOW_MAP_GROUP);
+            if(Mask)
+            {
+                size_t Result = Group*MEOW_MAP_GROUP + MeowMapLowestIndex(Mask);
+                return(Result);
+            }
+            
+            Group = (Group + Step) & GroupMask;
+        }
+    }
+    
+    // NOTE: Picks the slot for a new key, growing first if needed.  The slot
+    // is only marked full by Fill, once the entry has been constructed.
+    size_t
+    Claim(meow_hash Hash)
+    {
+        if(!GrowthLeft)
+        {
+            // NOTE: If it is mostly tombstones, clean up at the same size instead of doubling
+            size_t NewCapacity = Capacity ? Capacity : MEOW_MAP_GROUP;
+            if(Count >= MaxLoad(NewCapacity)/2)
+            {
+                NewCapacity *= 2;
+            }
+            Resize(NewCapacity);
+        }
+        
+        size_t Result = FindFree(Hash);
+        return(Result);
+    }
+    
+    void
+    Fill(size_t Index, meow_hash Hash)
+    {
+        if(Control[Index] == MEOW_MAP_EMPTY)
+        {
+            --GrowthLeft;
+        }
+        Control[Index] = TagOf(Hash);
+        if(StoreHash)
+        {
+            Hashes[Index] = Hash;
+        }
+        ++Count;
+    }
+    
+    template<typename fn>
+    void
+    ForEachIndex(fn &&Fn)
+    {
+        for(size_t Group = 0;
+            Group < Capacity;
+            Group += MEOW_MAP_GROUP)
+        {
+            for(meow_map_mask Mask = MeowMapMatchFull(Control + Group);
+                Mask;
+                Mask &= Mask - 1)
+            {
+                Fn(Group + MeowMapLowestIndex(Mask));
+            }
+        }
+    }
+    
+    void
+    Resize(size_t NewCapacity)
+    {
+        meow_u8 *OldControl = Control;
+        meow_hash *OldHashes = Hashes;
+        slot *OldSlots = Slots;
+        size_t OldCapacity = Capacity;
+        
+        meow_u8 *Block = (meow_u8 *)::operator new(SlotOffset(NewCapacity) + NewCapacity*sizeof(slot),
+                                                   std::align_val_t(Alignment()));
+        Control = Block;
+        Hashes = StoreHash ? (meow_hash *)(Block + NewCapacity) : 0;
+        Slots = (slot *)(Block + SlotOffset(NewCapacity));
+        Capacity = NewCapacity;
+        memset(Control, MEOW_MAP_EMPTY, Capacity);
+        GrowthLeft = MaxLoad(Capacity);
+        Count = 0;
+        
+        for(size_t Group = 0;
+            Group < OldCapacity;
+            Group += MEOW_MAP_GROUP)
+        {
+            for(meow_map_mask Mask = MeowMapMatchFull(OldControl + Group);
+                Mask;
+                Mask &= Mask - 1)
+            {
+                size_t OldIndex = Group + MeowMapLowestIndex(Mask);
+                meow_hash Hash = StoreHash ? OldHashes[OldIndex] : Hasher(OldSlots[OldIndex].Key);
+                size_t Index = FindFree(Hash);
+                new(&Slots[Index]) slot(std::move(OldSlots[OldIndex]));
+                OldSlots[OldIndex].~slot();
+                Fill(Index, Hash);
+            }
+        }
+        
+        if(OldControl)
+        {
+            ::operator delete(OldControl, std::align_val_t(Alignment()));
+        }
+    }
+    
+    void
+    Release(void)
+    {
+        if(Control)
+        {
+            ForEachIndex([this](size_t Index) { Slots[Index].~slot(); });
+            ::operator delete(Control, std::align_val_t(Alignment()));
+        }
+        Control = 0;
+        Hashes = 0;
+        Slots = 0;
+        Capacity = 0;
+        Count = 0;
+        GrowthLeft = 0;
+    }
+    
+    void
+    Take(map &Other)
+    {
+        Control = Other.Control;
+        Hashes = Other.Hashes;
+        Slots = Other.Slots;
+        Capacity = Other.Capacity;
+        Count = Other.Count;
+        GrowthLeft = Other.GrowthLeft;
+        
+        Other.Control = 0;
+        Other.Hashes = 0;
+        Other.Slots = 0;
+        Other.Capacity = 0;
+        Other.Count = 0;
+        Other.GrowthLeft = 0;
+    }
+    
+    meow_u8 *Control = 0;
+    meow_hash *Hashes = 0;
+    slot *Slots = 0;
+    size_t Capacity = 0;
+    size_t Count = 0;
+    size_t GrowthLeft = 0;
+    
+    key_hasher Hasher;
+    key_equal Equal;
+};
+    
+}
@@ -0,0 +1,809 @@
+/* ========================================================================
+   
+   meow_map_bench.cpp - RDTSC-based comparison of meow::map and std::unordered_map
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ======================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <algorithm>
+
+#ifdef __aarch64__
+// NOTE(mmozeiko): On ARM you normally cannot access cycle counter from user-space.
+// Download & build following kernel module that enables access to PMU cycle counter
+// from user-space code: https://github.com/zhiyisun/enable_arm_pmu
+#include <stdint.h>
+#include "enable_arm_pmu/armpmu_lib.h"
+#define __rdtsc() read_pmu()
+#endif
+
+#include "meow_test.h"
+#include "more/meow_cpp.h"
+#include "more/meow_map.h"
+#include "more/meow_lookup.h"
+#include "more/meow_fingerprint_set.h"
+#include "more/meow_perfect_hash.h"
+#include "more/meow_intern.h"
+#include "more/meow_radix.h"
+
+//
+// NOTE: Every table runs the same four phases over the same keys: insert
+// them all, look them all up, look up the same number of keys that are not
+// there, then erase them all.  The lookups also check the values, so a
+// table that gets anything wrong is reported rather than timed.
+//
+
+struct phase_clocks
+{
+    double Insert;
+    double Hit;
+    double Miss;
+    double Erase;
+    int Failed;
+};
+
+template<typename table, typename key>
+static phase_clocks
+RunPhases(std::vector<key> const &Keys, std::vector<key> const &Absent, int RunCount)
+{
+    phase_clocks Result = {1e30, 1e30, 1e30, 1e30, 0};
+    double Count = (double)Keys.size();
+    for(int RunIndex = 0;
+        RunIndex < RunCount;
+        ++RunIndex)
+    {
+        table Table;
+        
+        meow_u64 StartClock = __rdtsc();
+        for(size_t Index = 0;
+            Index < Keys.size();
+            ++Index)
+        {
+            Table[Keys[Index]] = (meow_u32)Index;
+        }
+        meow_u64 InsertClocks = __rdtsc() - StartClock;
+        
+        meow_u64 Sum = 0;
+        StartClock = __rdtsc();
+        for(size_t Index = 0;
+            Index < Keys.size();
+            ++Index)
+        {
+            auto Found = Table.find(Keys[Index]);
+            Sum += (Found != Table.end()) ? Found->second : 0;
+        }
+        meow_u64 HitClocks = __rdtsc() - StartClock;
+        
+        meow_u64 MissCount = 0;
+        StartClock = __rdtsc();
+        for(size_t Index = 0;
+            Index < Absent.size();
+            ++Index)
+        {
+            MissCount += (Table.find(Absent[Index]) == Table.end());
+        }
+        meow_u64 MissClocks = __rdtsc() - StartClock;
+        
+        StartClock = __rdtsc();
+        for(size_t Index = 0;
+            Index < Keys.size();
+            ++Index)
+        {
+            Table.erase(Keys[Index]);
+        }
+        meow_u64 EraseClocks = __rdtsc() - StartClock;
+        
+        meow_u64 ExpectedSum = (meow_u64)Keys.size()*(Keys.size() - 1)/2;
+        Result.Failed |= ((Sum != ExpectedSum) || (MissCount != Absent.size()) || !Table.empty());
+        
+        Result.Insert = ((double)InsertClocks/Count < Result.Insert) ? (double)InsertClocks/Count : Result.Insert;
+        Result.Hit = ((double)HitClocks/Count < Result.Hit) ? (double)HitClocks/Count : Result.Hit;
+        Result.Miss = ((double)MissClocks/Count < Result.Miss) ? (double)MissClocks/Count : Result.Miss;
+        Result.Erase = ((double)EraseClocks/Count < Result.Erase) ? (double)EraseClocks/Count : Result.Erase;
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Gives meow::map the handful of std::unordered_map names RunPhases uses,
+// so both kinds of table go through exactly the same loop
+//
+
+template<typename key, bool StoreHash>
+struct std_style_map
+{
+    meow::map<key, meow_u32, StoreHash> Map;
+    
+    struct found
+    {
+        meow_u32 *Value;
+        meow_u32 second;
+        bool operator!=(found const &Other) const {return(Value != Other.Value);}
+        bool operator==(found const &Other) const {return(Value == Other.Value);}
+        found const *operator->() const {return(this);}
+    };
+    
+    meow_u32 &operator[](key const &Key) {return(Map[Key]);}
+    found find(key const &Key) {meow_u32 *Value = Map.Find(Key); return(found{Value, Value ? *Value : 0});}
+    found end(void) {return(found{0, 0});}
+    void erase(key const &Key) {Map.Erase(Key);}
+    bool empty(void) const {return(Map.GetCount() == 0);}
+};
+
+static void
+PrintPhases(char const *Name, phase_clocks Clocks)
+{
+    if(Clocks.Failed)
+    {
+        fprintf(stdout, "    %-40s FAILED - lookups did not match what was inserted\n", Name);
+    }
+    else
+    {
+        fprintf(stdout, "    %-40s %8.1f %8.1f %8.1f %8.1f\n", Name, Clocks.Insert, Clocks.Hit, Clocks.Miss, Clocks.Erase);
+    }
+    fflush(stdout);
+}
+
+static meow_u64
+SplitMix(meow_u64 *State)
+{
+    meow_u64 Result = (*State += 0x9E3779B97F4A7C15ull);
+    Result = (Result ^ (Result >> 30)) * 0xBF58476D1CE4E5B9ull;
+    Result = (Result ^ (Result >> 27)) * 0x94D049BB133111EBull;
+    Result ^= (Result >> 31);
+    return(Result);
+}
+
+static std::string
+MakeStringKey(meow_u64 Value)
+{
+    // NOTE: 8 to 40 characters, like identifiers and paths
+    char Buffer[64];
+    int Length = snprintf(Buffer, sizeof(Buffer), "user/%llu/", (long long unsigned)Value);
+    int Padding = (int)(Value % 24);
+    memset(Buffer + Length, 'x', Padding);
+    std::string Result(Buffer, Length + Padding);
+    return(Result);
+}
+
+//
+// NOTE: Point lookups in a table much bigger than the cache, one at a time
+// and then batched with prefetching.  Half the keys are present.
+//
+
+enum lookup_mode
+{
+    LookupMode_OneAtATime,
+    LookupMode_Batch,
+    LookupMode_Pipelined,
+};
+
+template<bool StoreHash>
+static double
+BigLookupClocks(meow::map<meow_u64, meow_u32, StoreHash> &Map, std::vector<meow_u64> const &Keys,
+                std::vector<meow_u32 *> &Found, lookup_mode Mode, meow_u64 *Checksum)
+{
+    double Result = 1e30;
+    for(int RunIndex = 0;
+        RunIndex < 3;
+        ++RunIndex)
+    {
+        meow_u64 StartClock = __rdtsc();
+        switch(Mode)
+        {
+            case LookupMode_OneAtATime:
+            {
+                for(size_t Index = 0;
+                    Index < Keys.size();
+                    ++Index)
+                {
+                    Found[Index] = Map.Find(Keys[Index]);
+                }
+            } break;
+            
+            case LookupMode_Batch:
+            {
+                meow::LookupBatch(Map, Keys.size(), Keys.data(), Found.data());
+            } break;
+            
+            case LookupMode_Pipelined:
+            {
+                meow::LookupPipelined(Map, Keys.size(), Keys.data(), Found.data());
+            } break;
+        }
+        meow_u64 Clocks = __rdtsc() - StartClock;
+        
+        if(Result > (double)Clocks/(double)Keys.size())
+        {
+            Result = (double)Clocks/(double)Keys.size();
+        }
+    }
+    
+    meow_u64 Sum = 0;
+    for(size_t Index = 0;
+        Index < Keys.size();
+        ++Index)
+    {
+        Sum = Sum*31 + (Found[Index] ? *Found[Index] + 1 : 0);
+    }
+    *Checksum = Sum;
+    
+    return(Result);
+}
+
+template<bool StoreHash>
+static int
+BigLookups(char const *Name, size_t Count)
+{
+    meow::map<meow_u64, meow_u32, StoreHash> Map(Count);
+    meow_u64 State = 5678;
+    std::vector<meow_u64> Keys(Count);
+    for(size_t Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        meow_u64 Value = SplitMix(&State);
+        Map[Value & ~1ull] = (meow_u32)Index;
+        Keys[Index] = Value;
+    }
+    
+    std::vector<meow_u32 *> Found(Count);
+    meow_u64 Checksums[3];
+    double Clocks[3];
+    Clocks[0] = BigLookupClocks(Map, Keys, Found, LookupMode_OneAtATime, &Checksums[0]);
+    Clocks[1] = BigLookupClocks(Map, Keys, Found, LookupMode_Batch, &Checksums[1]);
+    Clocks[2] = BigLookupClocks(Map, Keys, Found, LookupMode_Pipelined, &Checksums[2]);
+    
+    int Result = ((Checksums[0] != Checksums[1]) || (Checksums[0] != Checksums[2]));
+    if(Result)
+    {
+        fprintf(stdout, "    %-40s FAILED - batched lookups did not match Find\n", Name);
+    }
+    else
+    {
+        fprintf(stdout, "    %-40s %8.1f %8.1f %8.1f   (%.1fx)\n", Name, Clocks[0], Clocks[1], Clocks[2],
+                Clocks[0] / ((Clocks[1] < Clocks[2]) ? Clocks[1] : Clocks[2]));
+    }
+    fflush(stdout);
+    
+    return(Result);
+}
+
+//
+// NOTE: Many threads deduplicating one stream of fingerprints, every one of
+// which shows up twice.  The lock-free set is compared against the obvious
+// mutex around a std::unordered_set.
+//
+
+struct fingerprint_key_hash
+{
+    size_t operator()(std::pair<meow_u64, meow_u64> const &Key) const {return((size_t)Key.first);}
+};
+
+template<typename insert_fn>
+static double
+DedupClocks(int ThreadCount, std::vector<std::pair<meow_u64, meow_u64>> const &Keys, size_t *NewCount, insert_fn Insert)
+{
+    std::atomic<size_t> TotalNew{0};
+    std::vector<std::thread> Threads;
+    meow_u64 StartClock = __rdtsc();
+    for(int ThreadIndex = 0;
+        ThreadIndex < ThreadCount;
+        ++ThreadIndex)
+    {
+        Threads.emplace_back([&, ThreadIndex]()
+        {
+            size_t New = 0;
+            for(size_t Index = ThreadIndex;
+                Index < Keys.size();
+                Index += ThreadCount)
+            {
+                New += Insert(Keys[Index]);
+            }
+            TotalNew += New;
+        });
+    }
+    for(size_t ThreadIndex = 0;
+        ThreadIndex < Threads.size();
+        ++ThreadIndex)
+    {
+        Threads[ThreadIndex].join();
+    }
+    meow_u64 Clocks = __rdtsc() - StartClock;
+    
+    *NewCount = TotalNew;
+    double Result = (double)Clocks / (double)Keys.size();
+    return(Result);
+}
+
+static int
+FingerprintDedup(size_t UniqueCount)
+{
+    int Result = 0;
+    
+    std::vector<std::pair<meow_u64, meow_u64>> Keys(2*UniqueCount);
+    for(size_t Index = 0;
+        Index < Keys.size();
+        ++Index)
+    {
+        // NOTE: Meow reads 16 bytes at a time, so the 8-byte block number sits in a 16-byte buffer
+        meow_u64 Block[2] = {(Index*2654435761ull) % UniqueCount, 0};
+        meow_hash Hash = MeowHash_Accelerated(0, 0, sizeof(Block[0]), Block);
+        Keys[Index] = std::make_pair((meow_u64)MeowU64From(Hash, 0), (meow_u64)MeowU64From(Hash, 1));
+    }
+    
+    int MaxThreads = (int)std::thread::hardware_concurrency();
+    if(MaxThreads < 4)
+    {
+        MaxThreads = 4;
+    }
+    
+    fprintf(stdout, "%llu fingerprints, %llu unique, clocks per insert (wall):   lock-free   mutex+std::unordered_set\n",
+            (long long unsigned)Keys.size(), (long long unsigned)UniqueCount);
+    for(int ThreadCount = 1;
+        ThreadCount <= MaxThreads;
+        ThreadCount *= 2)
+    {
+        size_t LockFreeNew = 0;
+        meow::fingerprint_set Set;
+        double LockFreeClocks = DedupClocks(ThreadCount, Keys, &LockFreeNew, [&](std::pair<meow_u64, meow_u64> const &Key)
+        {
+            return(Set.Insert(Meow128_Set64x2(Key.first, Key.second)));
+        });
+        
+        size_t LockedNew = 0;
+        std::mutex Mutex;
+        std::unordered_set<std::pair<meow_u64, meow_u64>, fingerprint_key_hash> LockedSet;
+        double LockedClocks = DedupClocks(ThreadCount, Keys, &LockedNew, [&](std::pair<meow_u64, meow_u64> const &Key)
+        {
+            std::lock_guard<std::mutex> Lock(Mutex);
+            return(LockedSet.insert(Key).second);
+        });
+        
+        if((LockFreeNew != UniqueCount) || (Set.GetCount() != UniqueCount) || (LockedNew != UniqueCount))
+        {
+            fprintf(stdout, "    %2d threads: FAILED - %llu new fingerprints reported, expected %llu\n",
+                    ThreadCount, (long long unsigned)LockFreeNew, (long long unsigned)UniqueCount);
+            Result = 1;
+        }
+        else
+        {
+            fprintf(stdout, "    %2d threads %51.1f %10.1f\n", ThreadCount, LockFreeClocks, LockedClocks);
+        }
+        fflush(stdout);
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Minimal perfect hashes of a static key set, at each Gamma, against
+// meow::map holding the same keys.  Every key is looked up once, in a
+// random order.
+//
+
+static int
+PerfectHashes(size_t Count)
+{
+    int Result = 0;
+    
+    meow_u64 State = 4321;
+    std::vector<meow_u64> Keys(Count);
+    std::vector<meow_u64> Order(Count);
+    for(size_t Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        Keys[Index] = SplitMix(&State);
+        Order[Index] = (Index*2654435761ull) % Count;
+    }
+    
+    std::vector<void *> KeyPointers(Count);
+    std::vector<meow_umm> Lens(Count, sizeof(meow_u64));
+    for(size_t Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        KeyPointers[Index] = &Keys[Index];
+    }
+    
+    fprintf(stdout, "%llu static keys:              bits/key  build clocks/key  lookup clocks\n", (long long unsigned)Count);
+    float Gammas[] = {1.0f, 1.5f, 2.0f};
+    for(meow_umm GammaIndex = 0;
+        GammaIndex < ArrayCount(Gammas);
+        ++GammaIndex)
+    {
+        meow_umm Size = 0;
+        meow_u64 StartClock = __rdtsc();
+        void *Blob = MeowPerfectHashBuildKeys(Count, KeyPointers.data(), Lens.data(), 1, 2, Gammas[GammaIndex], 0, &Size);
+        double BuildClocks = (double)(__rdtsc() - StartClock) / (double)Count;
+        
+        meow_perfect_hash Perfect;
+        std::vector<meow_u8> Seen(Count);
+        int Failed = !Blob || !MeowPerfectHashFromMemory(&Perfect, Blob, Size);
+        double LookupClocks = 0;
+        if(!Failed)
+        {
+            StartClock = __rdtsc();
+            for(size_t Index = 0;
+                Index < Count;
+                ++Index)
+            {
+                meow_u64 Number = MeowPerfectHashKey(&Perfect, sizeof(meow_u64), &Keys[Order[Index]]);
+                if((Number >= Count) || Seen[Number])
+                {
+                    Failed = 1;
+                }
+                else
+                {
+                    Seen[Number] = 1;
+                }
+            }
+            LookupClocks = (double)(__rdtsc() - StartClock) / (double)Count;
+        }
+        free(Blob);
+        
+        char Name[64];
+        snprintf(Name, sizeof(Name), "perfect hash, Gamma %.1f", Gammas[GammaIndex]);
+        if(Failed)
+        {
+            fprintf(stdout, "    %-26s FAILED - keys did not map one-to-one onto [0, Count)\n", Name);
+            Result = 1;
+        }
+        else
+        {
+            fprintf(stdout, "    %-26s %9.2f %17.1f %14.1f\n", Name, 8.0*(double)Size / (double)Count, BuildClocks, LookupClocks);
+        }
+        fflush(stdout);
+    }
+    
+    meow::map<meow_u64, meow_u32> Map;
+    Map.Reserve(Count);
+    meow_u64 StartClock = __rdtsc();
+    for(size_t Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        Map.Insert(Keys[Index], (meow_u32)Index);
+    }
+    double BuildClocks = (double)(__rdtsc() - StartClock) / (double)Count;
+    
+    meow_u64 Checksum = 0;
+    StartClock = __rdtsc();
+    for(size_t Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        meow_u32 *Value = Map.Find(Keys[Order[Index]]);
+        Checksum += Value ? *Value : 0;
+    }
+    double LookupClocks = (double)(__rdtsc() - StartClock) / (double)Count;
+    
+    double MapBits = 8.0*(double)Map.GetCapacity()*(1 + sizeof(std::pair<meow_u64, meow_u32>)) / (double)Count;
+    fprintf(stdout, "    %-26s %9.2f %17.1f %14.1f\n", "meow::map<u64, u32>", MapBits, BuildClocks, LookupClocks);
+    if(Checksum != (meow_u64)Count*(Count - 1)/2)
+    {
+        fprintf(stdout, "    meow::map<u64, u32>: FAILED - lookups did not match what was inserted\n");
+        Result = 1;
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Interning a stream of hostname-like strings where every distinct
+// string shows up many times, spread over threads, against a mutex around
+// a std::unordered_map<std::string, u32>.  Every id is checked against the
+// string it was interned for.
+//
+
+static int
+Interning(size_t DistinctCount, size_t StreamCount)
+{
+    int Result = 0;
+    
+    meow_u64 State = 8765;
+    std::vector<std::string> Distinct(DistinctCount);
+    size_t DistinctBytes = 0;
+    for(size_t Index = 0;
+        Index < DistinctCount;
+        ++Index)
+    {
+        char Buffer[64];
+        int Length = snprintf(Buffer, sizeof(Buffer), "node-%llu.rack-%llu.example.com",
+                              (long long unsigned)Index, (long long unsigned)(SplitMix(&State) % 512));
+        Distinct[Index] = std::string(Buffer, Length);
+        DistinctBytes += Length;
+    }
+    
+    std::vector<std::string_view> Stream(StreamCount);
+    for(size_t Index = 0;
+        Index < StreamCount;
+        ++Index)
+    {
+        Stream[Index] = (Index < DistinctCount) ? Distinct[Index] : Distinct[SplitMix(&State) % DistinctCount];
+    }
+    
+    int MaxThreads = (int)std::thread::hardware_concurrency();
+    if(MaxThreads < 4)
+    {
+        MaxThreads = 4;
+    }
+    
+    fprintf(stdout, "%llu strings, %llu distinct, clocks per string (wall):   meow::interner   mutex+std::unordered_map\n",
+            (long long unsigned)StreamCount, (long long unsigned)DistinctCount);
+    for(int ThreadCount = 1;
+        ThreadCount <= MaxThreads;
+        ThreadCount *= 2)
+    {
+        meow::interner Interner;
+        std::vector<meow_u32> Ids(StreamCount);
+        std::vector<std::thread> Threads;
+        meow_u64 StartClock = __rdtsc();
+        for(int ThreadIndex = 0;
+            ThreadIndex < ThreadCount;
+            ++ThreadIndex)
+        {
+            Threads.emplace_back([&, ThreadIndex]()
+            {
+                for(size_t Index = ThreadIndex;
+                    Index < StreamCount;
+                    Index += ThreadCount)
+                {
+                    Ids[Index] = Interner.Intern(Stream[Index]);
+                }
+            });
+        }
+        for(size_t ThreadIndex = 0;
+            ThreadIndex < Threads.size();
+            ++ThreadIndex)
+        {
+            Threads[ThreadIndex].join();
+        }
+        double InternClocks = (double)(__rdtsc() - StartClock) / (double)StreamCount;
+        
+        std::mutex Mutex;
+        std::unordered_map<std::string, meow_u32> Map;
+        Threads.clear();
+        StartClock = __rdtsc();
+        for(int ThreadIndex = 0;
+            ThreadIndex < ThreadCount;
+            ++ThreadIndex)
+        {
+            Threads.emplace_back([&, ThreadIndex]()
+            {
+                for(size_t Index = ThreadIndex;
+                    Index < StreamCount;
+                    Index += ThreadCount)
+                {
+                    std::lock_guard<std::mutex> Lock(Mutex);
+                    Map.emplace(Stream[Index], (meow_u32)Map.size());
+                }
+            });
+        }
+        for(size_t ThreadIndex = 0;
+            ThreadIndex < Threads.size();
+            ++ThreadIndex)
+        {
+            Threads[ThreadIndex].join();
+        }
+        double MapClocks = (double)(__rdtsc() - StartClock) / (double)StreamCount;
+        
+        int Failed = (Interner.GetCount() != DistinctCount) || (Map.size() != DistinctCount);
+        for(size_t Index = 0;
+            Index < StreamCount;
+            ++Index)
+        {
+            meow_u32 Found = 0;
+            Failed |= (Interner.Get(Ids[Index]) != Stream[Index]);
+            Failed |= !Interner.Find(Stream[Index], &Found) || (Found != Ids[Index]);
+        }
+        
+        if(Failed)
+        {
+            fprintf(stdout, "    %2d threads: FAILED - ids did not match the strings interned\n", ThreadCount);
+            Result = 1;
+        }
+        else
+        {
+            fprintf(stdout, "    %2d threads %56.1f %12.1f\n", ThreadCount, InternClocks, MapClocks);
+        }
+        
+        if(ThreadCount == 1)
+        {
+            Interner.FreeRetiredIndexes();
+            fprintf(stdout, "    %-40s %8.1f bytes per string on top of its %.1f\n", "meow::interner memory",
+                    (double)(Interner.GetMemoryUsed() - DistinctBytes) / (double)DistinctCount,
+                    (double)DistinctBytes / (double)DistinctCount);
+        }
+        fflush(stdout);
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Sorting hashes with payloads, as an index build or a dedup report
+// does, with std::sort and with MeowRadixSort in place and with scratch.
+// Every sort is checked against the std::sort result.
+//
+
+static int
+Sorting(size_t Count)
+{
+    int Result = 0;
+    
+    meow_u64 State = 4321;
+    std::vector<meow_radix_entry> Original(Count);
+    for(size_t Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        Original[Index].Low = SplitMix(&State);
+        Original[Index].High = SplitMix(&State);
+        Original[Index].Payload = Index;
+    }
+    
+    std::vector<meow_radix_entry> Expected(Original);
+    meow_u64 StartClock = __rdtsc();
+    std::sort(Expected.begin(), Expected.end(), [](meow_radix_entry const &A, meow_radix_entry const &B)
+    {
+        return((A.High < B.High) || ((A.High == B.High) && (A.Low < B.Low)));
+    });
+    double SortClocks = (double)(__rdtsc() - StartClock) / (double)Count;
+    
+    fprintf(stdout, "%llu hashes with payloads, clocks per hash (wall):\n", (long long unsigned)Count);
+    fprintf(stdout, "    %-40s %8.1f\n", "std::sort", SortClocks);
+    
+    int ThreadCounts[] = {1, 0};
+    std::vector<meow_radix_entry> Entries(Count);
+    std::vector<meow_radix_entry> Scratch(Count);
+    for(meow_umm ThreadIndex = 0;
+        ThreadIndex < ArrayCount(ThreadCounts);
+        ++ThreadIndex)
+    {
+        for(int UseScratch = 0;
+            UseScratch <= 1;
+            ++UseScratch)
+        {
+            char Name[64];
+            snprintf(Name, sizeof(Name), "MeowRadixSort, %s, %s", ThreadCounts[ThreadIndex] ? "1 thread" : "all threads",
+                     UseScratch ? "scratch" : "in place");
+            
+            Entries = Original;
+            StartClock = __rdtsc();
+            int Failed = !MeowRadixSort(Entries.data(), Count, UseScratch ? Scratch.data() : 0, ThreadCounts[ThreadIndex]);
+            double RadixClocks = (double)(__rdtsc() - StartClock) / (double)Count;
+            
+            for(size_t Index = 0;
+                Index < Count;
+                ++Index)
+            {
+                Failed |= (Entries[Index].Low != Expected[Index].Low) || (Entries[Index].High != Expected[Index].High);
+            }
+            
+            if(Failed)
+            {
+                fprintf(stdout, "    %-40s FAILED - order did not match std::sort\n", Name);
+                Result = 1;
+            }
+            else
+            {
+                fprintf(stdout, "    %-40s %8.1f   (%.1fx)\n", Name, RadixClocks, SortClocks / RadixClocks);
+            }
+            fflush(stdout);
+        }
+    }
+    
+    return(Result);
+}
+
+int
+main(int ArgCount, char **Args)
+{
+#if __aarch64__
+    enable_pmu(0x008);
+#endif
+    
+    fprintf(stdout, "\n");
+    fprintf(stdout, "meow_map_bench %s - RDTSC-based comparison of meow::map and std::unordered_map\n", MEOW_HASH_VERSION_NAME);
+    fprintf(stdout, "    See https://mollyrocket.com/meowhash for details\n");
+    fprintf(stdout, "    WARNING: Counts are NOT accurate if CPU power throttling is enabled\n");
+    fprintf(stdout, "             (You must turn it off in your OS if you haven't yet!)\n");
+    fprintf(stdout, "\n");
+    
+    int Result = 0;
+    size_t Counts[] = {1000, 100000, 1000000};
+    for(meow_umm CountIndex = 0;
+        CountIndex < ArrayCount(Counts);
+        ++CountIndex)
+    {
+        size_t Count = Counts[CountIndex];
+        int RunCount = (Count < 100000) ? 50 : 3;
+        
+        meow_u64 State = 1234;
+        std::vector<meow_u64> IntKeys(Count);
+        std::vector<meow_u64> AbsentIntKeys(Count);
+        std::vector<std::string> StringKeys(Count);
+        std::vector<std::string> AbsentStringKeys(Count);
+        for(size_t Index = 0;
+            Index < Count;
+            ++Index)
+        {
+            // NOTE: Even values are present and odd values absent, so the two never overlap
+            meow_u64 Value = SplitMix(&State) & ~1ull;
+            IntKeys[Index] = Value;
+            AbsentIntKeys[Index] = Value | 1;
+            StringKeys[Index] = MakeStringKey(Value);
+            AbsentStringKeys[Index] = MakeStringKey(Value | 1);
+        }
+        
+        fprintf(stdout, "%llu entries, clocks per operation:     insert      hit     miss    erase\n", (long long unsigned)Count);
+        
+        phase_clocks Clocks[8];
+        Clocks[0] = RunPhases<std_style_map<meow_u64, false>>(IntKeys, AbsentIntKeys, RunCount);
+        PrintPhases("meow::map<u64>", Clocks[0]);
+        Clocks[1] = RunPhases<std_style_map<meow_u64, true>>(IntKeys, AbsentIntKeys, RunCount);
+        PrintPhases("meow::map<u64> storing hashes", Clocks[1]);
+        Clocks[2] = RunPhases<std::unordered_map<meow_u64, meow_u32, meow::hash>>(IntKeys, AbsentIntKeys, RunCount);
+        PrintPhases("std::unordered_map<u64, meow::hash>", Clocks[2]);
+        Clocks[3] = RunPhases<std::unordered_map<meow_u64, meow_u32>>(IntKeys, AbsentIntKeys, RunCount);
+        PrintPhases("std::unordered_map<u64, std::hash>", Clocks[3]);
+        
+        Clocks[4] = RunPhases<std_style_map<std::string, false>>(StringKeys, AbsentStringKeys, RunCount);
+        PrintPhases("meow::map<string>", Clocks[4]);
+        Clocks[5] = RunPhases<std_style_map<std::string, true>>(StringKeys, AbsentStringKeys, RunCount);
+        PrintPhases("meow::map<string> storing hashes", Clocks[5]);
+        Clocks[6] = RunPhases<std::unordered_map<std::string, meow_u32, meow::hash>>(StringKeys, AbsentStringKeys, RunCount);
+        PrintPhases("std::unordered_map<string, meow::hash>", Clocks[6]);
+        Clocks[7] = RunPhases<std::unordered_map<std::string, meow_u32>>(StringKeys, AbsentStringKeys, RunCount);
+        PrintPhases("std::unordered_map<string, std::hash>", Clocks[7]);
+        
+        for(meow_umm ClockIndex = 0;
+            ClockIndex < ArrayCount(Clocks);
+            ++ClockIndex)
+        {
+            Result |= Clocks[ClockIndex].Failed;
+        }
+        fprintf(stdout, "\n");
+    }
+    
+    size_t BigCount = 8*1024*1024;
+    fprintf(stdout, "%llu entries (bigger than most caches), clocks per lookup:   one by one  batched  pipelined\n",
+            (long long unsigned)BigCount);
+    Result |= BigLookups<false>("meow::map<u64>", BigCount);
+    Result |= BigLookups<true>("meow::map<u64> storing hashes", BigCount);
+    fprintf(stdout, "\n");
+    
+    Result |= FingerprintDedup(4*1024*1024);
+    fprintf(stdout, "\n");
+    
+    Result |= PerfectHashes(8*1024*1024);
+    fprintf(stdout, "\n");
+    
+    Result |= Interning(1024*1024, 16*1024*1024);
+    fprintf(stdout, "\n");
+    
+    Result |= Sorting(16*1024*1024);
+    fprintf(stdout, "\n");
+
+#if __aarch64__
+    disable_pmu(0x008);
+#endif
+    
+    return(Result);
+}
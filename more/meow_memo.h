@@ -0,0 +1,1002 @@
+/* ========================================================================
+   
+   meow_memo.h - content-addressed memoization cache for build pipelines
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   A build step whose inputs and parameters have not changed does not need
+   to run again if its output from last time is still around.  This keys
+   outputs by a Meow hash of everything that went into them, and keeps them
+   in memory, on disk, or both:
+   
+       meow_hash Key = MeowMemoKey(InputCount, Inputs, InputSizes, sizeof(Settings), &Settings);
+   
+       meow_umm Size;
+       void *Output = MeowMemoLookup(&Memo, &Store, Key, &Size);   // NOTE: Either tier may be 0
+       if(!Output)
+       {
+           Output = RunTheStep(...);
+           MeowMemoPut(&Memo, Key, Size, Output);
+           MeowMemoStorePut(&Store, Key, Size, Output);
+       }
+   
+   The key is built with the streaming Meow (meow_more.h), one input at a
+   time, each behind its length so that moving bytes from the end of one
+   input to the start of the next changes the key.  Inputs too big to have
+   in memory at once can be fed in pieces:
+   
+       meow_hash_state State;
+       MeowMemoKeyBegin(&State, InputCount, TotalInputBytes, ParametersSize);
+       MeowMemoKeyInput(&State, FileSize, 0);                  // NOTE: Just the length...
+       MeowHashAbsorb(&State, ChunkSize, Chunk);               // NOTE: ...then the bytes, in any pieces
+       meow_hash Key = MeowMemoKeyEnd(&State, ParametersSize, Parameters);
+   
+   MEMORY TIER
+   
+   meow_memo is a fixed-size arena used as a ring: outputs are appended at
+   the head, 64-byte aligned behind a 32-byte record header, and room is
+   made by evicting from the tail.  Eviction is CLOCK - Get marks an
+   entry as referenced, and a referenced entry that reaches the tail is
+   moved to the head with its mark cleared rather than evicted, so outputs
+   that keep getting used stay while ones that do not age out.  (The move
+   is skipped if the entry would have to wrap, and it is evicted instead.)
+   Nothing is allocated after MeowMemoInit, and the caller supplies the
+   memory:
+   
+       meow_memo Memo;
+       MeowMemoInit(&Memo, malloc(MeowMemoSize(ArenaSize, MaxCount)), ArenaSize, MaxCount);
+   
+   Entries are found through an open-addressing table of 32-byte slots -
+   the whole 128-bit key, the record's position, and its size - sized for
+   MaxCount at half load, so a hit check reads one slot and nothing else.
+   MeowMemoContainsBatch checks many keys at once with their slots
+   prefetched ahead.  Pointers returned by Get and Put are good until the
+   next Put.
+   
+   DISK TIER
+   
+   meow_memo_store keeps outputs in a directory of pack files, each one
+   only ever appended to, and mapped read-only.  Where each output is
+   lives in a manifest, which is a few meow_index.h files mapping keys to
+   (pack << 40 | offset), so a lookup is an interpolation search of a few
+   mapped files and a pointer into another:
+   
+       meow_memo_store Store;
+       MeowMemoStoreOpen(&Store, "build/cache");    // NOTE: Returns 0 if the path is too long
+       void *Output = MeowMemoStoreGet(&Store, Key, &Size);
+       MeowMemoStorePut(&Store, Key, Size, Output);
+       MeowMemoStoreFlush(&Store);     // NOTE: Also done by MeowMemoStoreClose
+       MeowMemoStoreClose(&Store);
+   
+   Puts are appended to a pack file and are only found by MeowMemoStoreGet
+   after a flush.  A pack takes the puts of every flush until it is past
+   MEOW_MEMO_PACK_SIZE, so a store flushed after every build step does not
+   make a file per step.  Puts of a key that is already stored, or already
+   put since the last flush, write nothing.
+   
+   A flush writes its keys out as a new manifest level, merged with every
+   newer level that is not more than twice its size, so each level has
+   more than twice the entries of the next newer one.  There are at most
+   about log2(Count) levels, and every key is rewritten about that many
+   times in all, rather than the whole manifest being rewritten by every
+   flush.  Which levels make up the manifest is in a small root file that
+   is written next to the old one and renamed over it, so a crash leaves
+   the old manifest in place.
+   
+   Pointers returned by MeowMemoStoreGet are good until the next flush.
+   Only one process may write a store at a time.  There can be
+   MEOW_MEMO_MAX_PACKS packs, after which Store.Full is set and puts fail.
+   The disk tier is not size-bounded otherwise; delete the directory to
+   start over.
+   
+   Include meow_intrinsics.h, meow_hash.h, more/meow_more.h,
+   more/meow_radix.h and more/meow_index.h first.
+   
+   ======================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEOW_MEMO_SEED 0x4F4D454D574F454Dull // NOTE: "MEOWMEMO"
+#define MEOW_MEMO_ALIGN 64
+#define MEOW_MEMO_BATCH 16
+#define MEOW_MEMO_REFERENCED (1ull << 63)
+
+#define MEOW_MEMO_PACK_MAGIC 0x314B4150574F454Dull // NOTE: "MEOWPAK1"
+#define MEOW_MEMO_PACK_VERSION 1
+#define MEOW_MEMO_PACK_SHIFT 40
+#define MEOW_MEMO_PACK_SIZE (256ull << 20)
+#define MEOW_MEMO_MAX_PACKS (1u << (64 - MEOW_MEMO_PACK_SHIFT))
+
+#define MEOW_MEMO_ROOT_MAGIC 0x544F4F52574F454Dull // NOTE: "MEOWROOT"
+#define MEOW_MEMO_ROOT_VERSION 1
+#define MEOW_MEMO_MAX_LEVELS 64
+
+#define MEOW_MEMO_MAX_PATH 1024
+#define MEOW_MEMO_MAX_NAME 32     // NOTE: The longest file name in a store, with its slash
+
+//
+// NOTE: Keys
+//
+
+static void
+MeowMemoKeyBegin(meow_hash_state *State, meow_umm InputCount, meow_u64 InputBytes, meow_umm ParametersSize)
+{
+    meow_u64 TotalLength = 8*((meow_u64)InputCount + 1) + InputBytes + ParametersSize;
+    MeowHashBegin(State, MEOW_MEMO_SEED, MEOW_MEMO_SEED, TotalLength);
+}
+
+// NOTE: With Bytes 0, only the length goes in, and the bytes follow by MeowHashAbsorb
+static void
+MeowMemoKeyInput(meow_hash_state *State, meow_u64 Size, void *Bytes)
+{
+    MeowHashAbsorb(State, sizeof(Size), &Size);
+    if(Bytes)
+    {
+        MeowHashAbsorb(State, Size, Bytes);
+    }
+}
+
+static meow_hash
+MeowMemoKeyEnd(meow_hash_state *State, meow_umm ParametersSize, void *Parameters)
+{
+    meow_u64 Size = ParametersSize;
+    MeowHashAbsorb(State, sizeof(Size), &Size);
+    MeowHashAbsorb(State, ParametersSize, Parameters);
+    
+    meow_hash Result = MeowHashEnd(State, MEOW_MEMO_SEED, MEOW_MEMO_SEED);
+    return(Result);
+}
+
+static meow_hash
+MeowMemoKey(meow_umm InputCount, void **Inputs, meow_umm *InputSizes, meow_umm ParametersSize, void *Parameters)
+{
+    meow_u64 InputBytes = 0;
+    for(meow_umm Input = 0;
+        Input < InputCount;
+        ++Input)
+    {
+        InputBytes += InputSizes[Input];
+    }
+    
+    meow_hash_state State;
+    MeowMemoKeyBegin(&State, InputCount, InputBytes, ParametersSize);
+    for(meow_umm Input = 0;
+        Input < InputCount;
+        ++Input)
+    {
+        MeowMemoKeyInput(&State, InputSizes[Input], Inputs[Input]);
+    }
+    
+    meow_hash Result = MeowMemoKeyEnd(&State, ParametersSize, Parameters);
+    return(Result);
+}
+
+//
+// NOTE: Memory tier
+//
+
+typedef struct meow_memo_record
+{
+    meow_u64 Low;
+    meow_u64 High;
+    meow_u64 Size;          // NOTE: Output bytes, or the whole gap for padding
+    meow_u64 IsPadding;
+} meow_memo_record;
+
+typedef struct meow_memo_slot
+{
+    meow_u64 Low;
+    meow_u64 High;
+    meow_u64 Position;      // NOTE: Ring position + 1, 0 when empty, MEOW_MEMO_REFERENCED on top
+    meow_u64 Size;
+} meow_memo_slot;
+
+typedef struct meow_memo
+{
+    meow_u8 *Arena;
+    meow_u64 ArenaSize;
+    meow_memo_slot *Slots;
+    meow_u64 SlotMask;
+    
+    // NOTE: Ring positions only ever grow; the arena offset is Position % ArenaSize
+    meow_u64 Head;
+    meow_u64 Tail;
+    meow_umm Count;
+    meow_umm MaxCount;
+    
+    meow_u64 Evictions;
+    meow_u64 SecondChances;
+} meow_memo;
+
+static meow_u64
+MeowMemoAlign(meow_u64 Size)
+{
+    meow_u64 Result = (Size + (MEOW_MEMO_ALIGN - 1)) & ~(meow_u64)(MEOW_MEMO_ALIGN - 1);
+    return(Result);
+}
+
+static meow_u64
+MeowMemoSlotCount(meow_umm MaxCount)
+{
+    meow_u64 Result = 16;
+    while(Result < 2*(meow_u64)MaxCount)
+    {
+        Result *= 2;
+    }
+    return(Result);
+}
+
+static meow_umm
+MeowMemoSize(meow_u64 ArenaSize, meow_umm MaxCount)
+{
+    meow_umm Result = (meow_umm)(MEOW_MEMO_ALIGN + MeowMemoAlign(ArenaSize) + MeowMemoSlotCount(MaxCount)*sizeof(meow_memo_slot));
+    return(Result);
+}
+
+// NOTE: Memory must be MeowMemoSize(ArenaSize, MaxCount) bytes
+static void
+MeowMemoInit(meow_memo *Memo, void *Memory, meow_u64 ArenaSize, meow_umm MaxCount)
+{
+    memset(Memo, 0, sizeof(*Memo));
+    
+    meow_u8 *Base = (meow_u8 *)Memory;
+    Base += (MEOW_MEMO_ALIGN - ((meow_umm)Base % MEOW_MEMO_ALIGN)) % MEOW_MEMO_ALIGN;
+    
+    meow_u64 SlotCount = MeowMemoSlotCount(MaxCount);
+    Memo->Arena = Base;
+    Memo->ArenaSize = MeowMemoAlign(ArenaSize);
+    Memo->Slots = (meow_memo_slot *)(Base + Memo->ArenaSize);
+    Memo->SlotMask = SlotCount - 1;
+    Memo->MaxCount = MaxCount;
+    memset(Memo->Slots, 0, SlotCount*sizeof(meow_memo_slot));
+}
+
+// NOTE: The slot holding the key, or the empty slot where it would go
+static meow_memo_slot *
+MeowMemoFindSlot(meow_memo *Memo, meow_u64 Low, meow_u64 High)
+{
+    meow_u64 At = Low & Memo->SlotMask;
+    meow_memo_slot *Result = Memo->Slots + At;
+    while(Result->Position && ((Result->Low != Low) || (Result->High != High)))
+    {
+        At = (At + 1) & Memo->SlotMask;
+        Result = Memo->Slots + At;
+    }
+    
+    return(Result);
+}
+
+// NOTE: Backward-shift deletion, so linear probing never needs tombstones
+static void
+MeowMemoRemoveSlot(meow_memo *Memo, meow_memo_slot *Slot)
+{
+    meow_u64 Hole = (meow_u64)(Slot - Memo->Slots);
+    meow_u64 At = Hole;
+    for(;;)
+    {
+        At = (At + 1) & Memo->SlotMask;
+        meow_memo_slot *Next = Memo->Slots + At;
+        if(!Next->Position)
+        {
+            break;
+        }
+        
+        // NOTE: Moves back only if its home is not between the hole and where it is
+        meow_u64 Home = Next->Low & Memo->SlotMask;
+        if(((At - Home) & Memo->SlotMask) >= ((At - Hole) & Memo->SlotMask))
+        {
+            Memo->Slots[Hole] = *Next;
+            Hole = At;
+        }
+    }
+    
+    memset(Memo->Slots + Hole, 0, sizeof(meow_memo_slot));
+}
+
+static meow_memo_record *
+MeowMemoRecordAt(meow_memo *Memo, meow_u64 Position)
+{
+    meow_memo_record *Result = (meow_memo_record *)(Memo->Arena + (Position % Memo->ArenaSize));
+    return(Result);
+}
+
+// NOTE: Frees the record at the tail, or gives it its second chance
+static void
+MeowMemoAdvanceTail(meow_memo *Memo)
+{
+    meow_memo_record *Record = MeowMemoRecordAt(Memo, Memo->Tail);
+    if(Record->IsPadding)
+    {
+        Memo->Tail += Record->Size;
+    }
+    else
+    {
+        meow_u64 RecordSize = MeowMemoAlign(sizeof(meow_memo_record) + Record->Size);
+        meow_memo_slot *Slot = MeowMemoFindSlot(Memo, Record->Low, Record->High);
+        
+        meow_u64 HeadOffset = Memo->Head % Memo->ArenaSize;
+        if((Slot->Position & MEOW_MEMO_REFERENCED) &&
+           (HeadOffset + RecordSize <= Memo->ArenaSize))
+        {
+            // NOTE: The free space runs from the head up to this record, so the
+            // move only ever lands on free space and the record's own bytes
+            memmove(Memo->Arena + HeadOffset, Record, RecordSize);
+            Slot->Position = Memo->Head + 1;
+            Memo->Head += RecordSize;
+            ++Memo->SecondChances;
+        }
+        else
+        {
+            MeowMemoRemoveSlot(Memo, Slot);
+            --Memo->Count;
+            ++Memo->Evictions;
+        }
+        Memo->Tail += RecordSize;
+    }
+}
+
+static void *
+MeowMemoGet(meow_memo *Memo, meow_hash Key, meow_umm *Size)
+{
+    meow_u64 Low = MeowU64From(Key, 0);
+    meow_u64 High = MeowU64From(Key, 1);
+    
+    void *Result = 0;
+    meow_memo_slot *Slot = MeowMemoFindSlot(Memo, Low, High);
+    if(Slot->Position)
+    {
+        Slot->Position |= MEOW_MEMO_REFERENCED;
+        Result = (meow_u8 *)MeowMemoRecordAt(Memo, (Slot->Position & ~MEOW_MEMO_REFERENCED) - 1) + sizeof(meow_memo_record);
+        *Size = (meow_umm)Slot->Size;
+    }
+    
+    return(Result);
+}
+
+static int
+MeowMemoContains(meow_memo *Memo, meow_hash Key)
+{
+    meow_u64 Low = MeowU64From(Key, 0);
+    meow_u64 High = MeowU64From(Key, 1);
+    
+    int Result = (MeowMemoFindSlot(Memo, Low, High)->Position != 0);
+    return(Result);
+}
+
+// NOTE: Found[I] is 1 if Keys[I] is cached.  Nothing is marked as referenced.
+static void
+MeowMemoContainsBatch(meow_memo *Memo, meow_umm Count, meow_hash *Keys, meow_u8 *Found)
+{
+    for(meow_umm Base = 0;
+        Base < Count;
+        Base += MEOW_MEMO_BATCH)
+    {
+        meow_umm BatchCount = ((Count - Base) < MEOW_MEMO_BATCH) ? (Count - Base) : MEOW_MEMO_BATCH;
+        for(meow_umm Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            meow_u64 Low = MeowU64From(Keys[Base + Index], 0);
+            MeowPrefetch(Memo->Slots + (Low & Memo->SlotMask));
+        }
+        
+        for(meow_umm Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            Found[Base + Index] = (meow_u8)MeowMemoContains(Memo, Keys[Base + Index]);
+        }
+    }
+}
+
+// NOTE: Returns where the output now lives, or 0 if it can never fit
+static void *
+MeowMemoPut(meow_memo *Memo, meow_hash Key, meow_umm Size, void *Output)
+{
+    meow_u64 Low = MeowU64From(Key, 0);
+    meow_u64 High = MeowU64From(Key, 1);
+    meow_u64 RecordSize = MeowMemoAlign(sizeof(meow_memo_record) + (meow_u64)Size);
+    
+    void *Result = 0;
+    meow_memo_slot *Slot = MeowMemoFindSlot(Memo, Low, High);
+    if(Slot->Position)
+    {
+        // NOTE: Same key, same output - nothing to do but remember it was wanted
+        Slot->Position |= MEOW_MEMO_REFERENCED;
+        Result = (meow_u8 *)MeowMemoRecordAt(Memo, (Slot->Position & ~MEOW_MEMO_REFERENCED) - 1) + sizeof(meow_memo_record);
+    }
+    else if((RecordSize <= Memo->ArenaSize) && Memo->MaxCount)
+    {
+        for(;;)
+        {
+            if(Memo->Head == Memo->Tail)
+            {
+                // NOTE: Empty, so start the next lap at the beginning of the arena
+                Memo->Head = Memo->Tail = Memo->Head + (Memo->ArenaSize - (Memo->Head % Memo->ArenaSize)) % Memo->ArenaSize;
+            }
+            
+            meow_u64 HeadOffset = Memo->Head % Memo->ArenaSize;
+            meow_u64 Wrap = ((HeadOffset + RecordSize) > Memo->ArenaSize) ? (Memo->ArenaSize - HeadOffset) : 0;
+            meow_u64 Free = Memo->ArenaSize - (Memo->Head - Memo->Tail);
+            if((Free >= (Wrap + RecordSize)) && (Memo->Count < Memo->MaxCount))
+            {
+                if(Wrap)
+                {
+                    meow_memo_record *Padding = MeowMemoRecordAt(Memo, Memo->Head);
+                    Padding->Size = Wrap;
+                    Padding->IsPadding = 1;
+                    Memo->Head += Wrap;
+                }
+                break;
+            }
+            
+            MeowMemoAdvanceTail(Memo);
+        }
+        
+        meow_memo_record *Record = MeowMemoRecordAt(Memo, Memo->Head);
+        Record->Low = Low;
+        Record->High = High;
+        Record->Size = Size;
+        Record->IsPadding = 0;
+        Result = Record + 1;
+        memcpy(Result, Output, Size);
+        
+        // NOTE: Eviction may have moved things around, so the slot is found again
+        Slot = MeowMemoFindSlot(Memo, Low, High);
+        Slot->Low = Low;
+        Slot->High = High;
+        Slot->Position = Memo->Head + 1;
+        Slot->Size = Size;
+        
+        Memo->Head += RecordSize;
+        ++Memo->Count;
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Disk tier
+//
+
+typedef struct meow_memo_pack_header
+{
+    meow_u64 Magic;
+    meow_u32 Version;
+    meow_u32 Pack;
+} meow_memo_pack_header;
+
+// NOTE: Followed by LevelCount generations, oldest (biggest) level first
+typedef struct meow_memo_root_header
+{
+    meow_u64 Magic;
+    meow_u32 Version;
+    meow_u32 LevelCount;
+    meow_u32 NextGeneration;
+    meow_u32 Reserved;
+} meow_memo_root_header;
+
+typedef struct meow_memo_store
+{
+    char Directory[MEOW_MEMO_MAX_PATH - MEOW_MEMO_MAX_NAME];
+    
+    // NOTE: The manifest, as levels that each have more than twice the entries of the next
+    meow_index Levels[MEOW_MEMO_MAX_LEVELS];
+    meow_u32 Generations[MEOW_MEMO_MAX_LEVELS];
+    meow_u32 LevelCount;
+    meow_u32 NextGeneration;
+    
+    meow_u32 PackCount;
+    meow_u32 PackCapacity;
+    void **PackMappings;
+    meow_umm *PackSizes;
+    int Full;
+    
+    // NOTE: The pack being written, and what has gone into it since the last flush
+    FILE *Writing;
+    meow_u32 WritingPack;
+    meow_u64 WritingAt;
+    meow_umm PendingCount;
+    meow_umm PendingCapacity;
+    meow_hash *PendingKeys;
+    meow_u64 *PendingPayloads;
+    meow_u32 *PendingSlots;     // NOTE: 2*PendingCapacity of them, each a pending index + 1, or 0
+} meow_memo_store;
+
+static void
+MeowMemoStorePath(meow_memo_store *Store, char *Path, char const *Name, meow_u32 Pack)
+{
+    if(Name)
+    {
+        snprintf(Path, MEOW_MEMO_MAX_PATH, "%s/%s", Store->Directory, Name);
+    }
+    else
+    {
+        snprintf(Path, MEOW_MEMO_MAX_PATH, "%s/pack-%08u.meowpack", Store->Directory, (unsigned)Pack);
+    }
+}
+
+static void
+MeowMemoStoreLevelPath(meow_memo_store *Store, char *Path, meow_u32 Generation)
+{
+    snprintf(Path, MEOW_MEMO_MAX_PATH, "%s/manifest-%08u.meowidx", Store->Directory, (unsigned)Generation);
+}
+
+static int
+MeowMemoStoreReplace(char const *NewPath, char const *Path)
+{
+#if _WIN32
+    int Result = (MoveFileExA(NewPath, Path, MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+    int Result = (rename(NewPath, Path) == 0);
+#endif
+    
+    return(Result);
+}
+
+// NOTE: Makes the directory if it is not there (but not its parents).  An empty directory is an empty store.
+static int
+MeowMemoStoreOpen(meow_memo_store *Store, char const *Directory)
+{
+    memset(Store, 0, sizeof(*Store));
+    
+    int Result = (strlen(Directory) < sizeof(Store->Directory));
+    if(Result)
+    {
+        strcpy(Store->Directory, Directory);
+#if _WIN32
+        CreateDirectoryA(Directory, 0);
+#else
+        mkdir(Directory, 0777);
+#endif
+        
+        // NOTE: A level that is missing is just empty
+        char Path[MEOW_MEMO_MAX_PATH];
+        MeowMemoStorePath(Store, Path, "manifest.meowroot", 0);
+        FILE *Root = fopen(Path, "rb");
+        if(Root)
+        {
+            meow_memo_root_header Header;
+            if((fread(&Header, sizeof(Header), 1, Root) == 1) &&
+               (Header.Magic == MEOW_MEMO_ROOT_MAGIC) &&
+               (Header.Version == MEOW_MEMO_ROOT_VERSION) &&
+               (Header.LevelCount <= MEOW_MEMO_MAX_LEVELS) &&
+               (fread(Store->Generations, sizeof(meow_u32), Header.LevelCount, Root) == Header.LevelCount))
+            {
+                Store->LevelCount = Header.LevelCount;
+                Store->NextGeneration = Header.NextGeneration;
+                for(meow_u32 Level = 0;
+                    Level < Store->LevelCount;
+                    ++Level)
+                {
+                    MeowMemoStoreLevelPath(Store, Path, Store->Generations[Level]);
+                    MeowIndexOpen(&Store->Levels[Level], Path);
+                }
+            }
+            fclose(Root);
+        }
+        
+        // NOTE: New packs go after every pack there is, including ones a crash left out of the manifest
+        for(;;)
+        {
+            MeowMemoStorePath(Store, Path, 0, Store->PackCount);
+            FILE *Existing = fopen(Path, "rb");
+            if(!Existing)
+            {
+                break;
+            }
+            fclose(Existing);
+            ++Store->PackCount;
+        }
+    }
+    
+    return(Result);
+}
+
+static int
+MeowMemoStoreFind(meow_memo_store *Store, meow_hash Key, meow_u64 *Payload)
+{
+    int Result = 0;
+    for(meow_u32 Level = 0;
+        !Result && (Level < Store->LevelCount);
+        ++Level)
+    {
+        Result = MeowIndexFind(&Store->Levels[Level], Key, Payload);
+    }
+    
+    return(Result);
+}
+
+// NOTE: Maps the pack, or maps it again if it has grown since and the mapping is shorter than Size
+static meow_u8 *
+MeowMemoStoreMapPack(meow_memo_store *Store, meow_u32 Pack, meow_u64 Size)
+{
+    if(Pack >= Store->PackCapacity)
+    {
+        meow_u32 Capacity = Store->PackCapacity ? Store->PackCapacity : 64;
+        while(Capacity <= Pack)
+        {
+            Capacity *= 2;
+        }
+        
+        void **Mappings = (void **)realloc(Store->PackMappings, Capacity*sizeof(void *));
+        if(Mappings)
+        {
+            Store->PackMappings = Mappings;
+        }
+        meow_umm *Sizes = (meow_umm *)realloc(Store->PackSizes, Capacity*sizeof(meow_umm));
+        if(Sizes)
+        {
+            Store->PackSizes = Sizes;
+        }
+        if(Mappings && Sizes)
+        {
+            memset(Mappings + Store->PackCapacity, 0, (Capacity - Store->PackCapacity)*sizeof(void *));
+            memset(Sizes + Store->PackCapacity, 0, (Capacity - Store->PackCapacity)*sizeof(meow_umm));
+            Store->PackCapacity = Capacity;
+        }
+    }
+    
+    meow_u8 *Result = 0;
+    if(Pack < Store->PackCapacity)
+    {
+        if(Store->PackMappings[Pack] && (Store->PackSizes[Pack] < Size))
+        {
+            MeowIndexUnmapFile(Store->PackMappings[Pack], Store->PackSizes[Pack]);
+            Store->PackMappings[Pack] = 0;
+        }
+        if(!Store->PackMappings[Pack])
+        {
+            char Path[MEOW_MEMO_MAX_PATH];
+            MeowMemoStorePath(Store, Path, 0, Pack);
+            Store->PackMappings[Pack] = MeowIndexMapFile(Path, &Store->PackSizes[Pack]);
+        }
+        Result = (meow_u8 *)Store->PackMappings[Pack];
+    }
+    
+    return(Result);
+}
+
+static void *
+MeowMemoStoreGet(meow_memo_store *Store, meow_hash Key, meow_umm *Size)
+{
+    void *Result = 0;
+    
+    meow_u64 Payload;
+    if(MeowMemoStoreFind(Store, Key, &Payload))
+    {
+        meow_u32 Pack = (meow_u32)(Payload >> MEOW_MEMO_PACK_SHIFT);
+        meow_u64 Offset = Payload & (((meow_u64)1 << MEOW_MEMO_PACK_SHIFT) - 1);
+        if(Pack < Store->PackCount)
+        {
+            // NOTE: The manifest is trusted to point at records, but not past the end of them
+            meow_u64 RecordEnd = Offset + sizeof(meow_memo_record);
+            meow_u8 *Base = MeowMemoStoreMapPack(Store, Pack, RecordEnd);
+            if(Base && (RecordEnd <= Store->PackSizes[Pack]))
+            {
+                meow_u64 OutputSize = ((meow_memo_record *)(Base + Offset))->Size;
+                if(OutputSize < ((meow_u64)1 << MEOW_MEMO_PACK_SHIFT))
+                {
+                    Base = MeowMemoStoreMapPack(Store, Pack, RecordEnd + OutputSize);
+                }
+                
+                if(Base && (OutputSize <= Store->PackSizes[Pack] - RecordEnd))
+                {
+                    meow_memo_record *Record = (meow_memo_record *)(Base + Offset);
+                    if((Record->Low == (meow_u64)MeowU64From(Key, 0)) &&
+                       (Record->High == (meow_u64)MeowU64From(Key, 1)))
+                    {
+                        Result = Record + 1;
+                        *Size = (meow_umm)Record->Size;
+                    }
+                }
+            }
+        }
+    }
+    
+    return(Result);
+}
+
+// NOTE: The slot Key is in among the pending keys, or the empty one it would go in
+static meow_umm
+MeowMemoStorePendingSlot(meow_memo_store *Store, meow_hash Key)
+{
+    meow_umm Mask = 2*Store->PendingCapacity - 1;
+    meow_u64 Low = MeowU64From(Key, 0);
+    meow_u64 High = MeowU64From(Key, 1);
+    
+    meow_umm Slot = (meow_umm)High & Mask;
+    for(;;)
+    {
+        meow_u32 Index = Store->PendingSlots[Slot];
+        if(!Index ||
+           (((meow_u64)MeowU64From(Store->PendingKeys[Index - 1], 0) == Low) &&
+            ((meow_u64)MeowU64From(Store->PendingKeys[Index - 1], 1) == High)))
+        {
+            break;
+        }
+        Slot = (Slot + 1) & Mask;
+    }
+    
+    return(Slot);
+}
+
+static void
+MeowMemoStoreGrowPending(meow_memo_store *Store)
+{
+    meow_umm Capacity = Store->PendingCapacity ? 2*Store->PendingCapacity : 256;
+    meow_hash *Keys = (meow_hash *)realloc(Store->PendingKeys, Capacity*sizeof(meow_hash));
+    if(Keys)
+    {
+        Store->PendingKeys = Keys;
+    }
+    meow_u64 *Payloads = (meow_u64 *)realloc(Store->PendingPayloads, Capacity*sizeof(meow_u64));
+    if(Payloads)
+    {
+        Store->PendingPayloads = Payloads;
+    }
+    meow_u32 *Slots = (meow_u32 *)calloc(2*Capacity, sizeof(meow_u32));
+    if(Keys && Payloads && Slots && (Capacity < 0x80000000u))
+    {
+        free(Store->PendingSlots);
+        Store->PendingSlots = Slots;
+        Store->PendingCapacity = Capacity;
+        for(meow_umm Index = 0;
+            Index < Store->PendingCount;
+            ++Index)
+        {
+            Slots[MeowMemoStorePendingSlot(Store, Keys[Index])] = (meow_u32)(Index + 1);
+        }
+    }
+    else
+    {
+        free(Slots);
+    }
+}
+
+// NOTE: Returns non-zero on success, including when Key is already stored.  The output is only found
+// by MeowMemoStoreGet after a flush.
+static int
+MeowMemoStorePut(meow_memo_store *Store, meow_hash Key, meow_umm Size, void *Output)
+{
+    meow_u64 Payload;
+    int Result = MeowMemoStoreFind(Store, Key, &Payload);
+    if(!Result)
+    {
+        if(Store->PendingCount == Store->PendingCapacity)
+        {
+            MeowMemoStoreGrowPending(Store);
+        }
+        
+        // NOTE: A key put twice before a flush is only written once
+        meow_umm Slot = 0;
+        if(Store->PendingCount < Store->PendingCapacity)
+        {
+            Slot = MeowMemoStorePendingSlot(Store, Key);
+            Result = (Store->PendingSlots[Slot] != 0);
+        }
+        
+        if(!Result && !Store->Writing)
+        {
+            Store->Full = (Store->PackCount >= MEOW_MEMO_MAX_PACKS);
+            if(!Store->Full)
+            {
+                char Path[MEOW_MEMO_MAX_PATH];
+                MeowMemoStorePath(Store, Path, 0, Store->PackCount);
+                Store->Writing = fopen(Path, "wb");
+                if(Store->Writing)
+                {
+                    meow_memo_pack_header Header = {MEOW_MEMO_PACK_MAGIC, MEOW_MEMO_PACK_VERSION, Store->PackCount};
+                    Store->WritingPack = Store->PackCount++;
+                    Store->WritingAt = 0;
+                    if(!MeowIndexWriteAt(Store->Writing, &Store->WritingAt, 0, &Header, sizeof(Header)))
+                    {
+                        fclose(Store->Writing);
+                        Store->Writing = 0;
+                    }
+                }
+            }
+        }
+        
+        meow_u64 Offset = MeowMemoAlign(Store->WritingAt);
+        if(!Result && Store->Writing && (Store->PendingCount < Store->PendingCapacity) &&
+           ((Offset + sizeof(meow_memo_record) + Size) < ((meow_u64)1 << MEOW_MEMO_PACK_SHIFT)))
+        {
+            meow_memo_record Record = {(meow_u64)MeowU64From(Key, 0), (meow_u64)MeowU64From(Key, 1), Size, 0};
+            Result = (MeowIndexWriteAt(Store->Writing, &Store->WritingAt, Offset, &Record, sizeof(Record)) &&
+                      MeowIndexWriteAt(Store->Writing, &Store->WritingAt, Offset + sizeof(Record), Output, Size));
+            if(Result)
+            {
+                Store->PendingKeys[Store->PendingCount] = Key;
+                Store->PendingPayloads[Store->PendingCount] = ((meow_u64)Store->WritingPack << MEOW_MEMO_PACK_SHIFT) | Offset;
+                Store->PendingSlots[Slot] = (meow_u32)++Store->PendingCount;
+            }
+        }
+    }
+    
+    return(Result);
+}
+
+// NOTE: Writes the root file listing Count levels, and renames it over the old one
+static int
+MeowMemoStoreWriteRoot(meow_memo_store *Store, meow_u32 *Generations, meow_u32 Count, meow_u32 NextGeneration)
+{
+    char Path[MEOW_MEMO_MAX_PATH];
+    char NewPath[MEOW_MEMO_MAX_PATH];
+    MeowMemoStorePath(Store, Path, "manifest.meowroot", 0);
+    MeowMemoStorePath(Store, NewPath, "manifest.meowroot.new", 0);
+    
+    meow_memo_root_header Header = {MEOW_MEMO_ROOT_MAGIC, MEOW_MEMO_ROOT_VERSION, Count, NextGeneration, 0};
+    FILE *Root = fopen(NewPath, "wb");
+    int Result = (Root != 0);
+    if(Root)
+    {
+        Result = ((fwrite(&Header, sizeof(Header), 1, Root) == 1) &&
+                  (fwrite(Generations, sizeof(meow_u32), Count, Root) == Count));
+        Result &= (fclose(Root) == 0);
+    }
+    Result = Result && MeowMemoStoreReplace(NewPath, Path);
+    
+    return(Result);
+}
+
+// NOTE: Returns non-zero on success
+static int
+MeowMemoStoreFlush(meow_memo_store *Store)
+{
+    int Result = 1;
+    if(Store->Writing)
+    {
+        // NOTE: The pack is kept for the next batch until it is big enough
+        if(Store->WritingAt >= MEOW_MEMO_PACK_SIZE)
+        {
+            Result = (fclose(Store->Writing) == 0);
+            Store->Writing = 0;
+        }
+        else
+        {
+            Result = (fflush(Store->Writing) == 0);
+        }
+    }
+    
+    if(Result && Store->PendingCount)
+    {
+        meow_u32 MergeFrom = Store->LevelCount;
+        meow_umm Count = Store->PendingCount;
+        while(MergeFrom &&
+              ((MergeFrom == MEOW_MEMO_MAX_LEVELS) || (MeowIndexCount(&Store->Levels[MergeFrom - 1]) <= 2*Count)))
+        {
+            --MergeFrom;
+            Count += MeowIndexCount(&Store->Levels[MergeFrom]);
+        }
+        
+        // NOTE: The levels' hashes are already laid out the way meow_hash is
+        meow_hash *Keys = (meow_hash *)malloc(Count*sizeof(meow_hash));
+        meow_u64 *Payloads = (meow_u64 *)malloc(Count*sizeof(meow_u64));
+        Result = (Keys && Payloads);
+        if(Result)
+        {
+            meow_umm At = 0;
+            for(meow_u32 Level = MergeFrom;
+                Level < Store->LevelCount;
+                ++Level)
+            {
+                meow_index *Index = Store->Levels + Level;
+                meow_umm LevelCount = MeowIndexCount(Index);
+                if(LevelCount)
+                {
+                    memcpy(Keys + At, Index->Hashes, LevelCount*sizeof(meow_hash));
+                    memcpy(Payloads + At, Index->Payloads, LevelCount*sizeof(meow_u64));
+                    At += LevelCount;
+                }
+            }
+            memcpy(Keys + At, Store->PendingKeys, Store->PendingCount*sizeof(meow_hash));
+            memcpy(Payloads + At, Store->PendingPayloads, Store->PendingCount*sizeof(meow_u64));
+            
+            meow_u32 Generations[MEOW_MEMO_MAX_LEVELS];
+            memcpy(Generations, Store->Generations, MergeFrom*sizeof(meow_u32));
+            meow_u32 Generation = Generations[MergeFrom] = Store->NextGeneration;
+            
+            char Path[MEOW_MEMO_MAX_PATH];
+            MeowMemoStoreLevelPath(Store, Path, Generation);
+            Result = (MeowIndexWrite(Path, Count, Keys, Payloads, -1) &&
+                      MeowMemoStoreWriteRoot(Store, Generations, MergeFrom + 1, Generation + 1));
+            if(Result)
+            {
+                for(meow_u32 Level = MergeFrom;
+                    Level < Store->LevelCount;
+                    ++Level)
+                {
+                    MeowIndexClose(&Store->Levels[Level]);
+                    MeowMemoStoreLevelPath(Store, Path, Store->Generations[Level]);
+                    remove(Path);
+                }
+                
+                Store->Generations[MergeFrom] = Generation;
+                Store->LevelCount = MergeFrom + 1;
+                Store->NextGeneration = Generation + 1;
+                MeowMemoStoreLevelPath(Store, Path, Generation);
+                MeowIndexOpen(&Store->Levels[MergeFrom], Path);
+            }
+            else
+            {
+                remove(Path);
+            }
+        }
+        free(Payloads);
+        free(Keys);
+        
+        if(Result)
+        {
+            Store->PendingCount = 0;
+            memset(Store->PendingSlots, 0, 2*Store->PendingCapacity*sizeof(meow_u32));
+        }
+    }
+    
+    return(Result);
+}
+
+// NOTE: Flushes first, and returns whether that worked
+static int
+MeowMemoStoreClose(meow_memo_store *Store)
+{
+    int Result = MeowMemoStoreFlush(Store);
+    if(Store->Writing)
+    {
+        Result &= (fclose(Store->Writing) == 0);
+    }
+    
+    for(meow_u32 Pack = 0;
+        Pack < Store->PackCapacity;
+        ++Pack)
+    {
+        MeowIndexUnmapFile(Store->PackMappings[Pack], Store->PackSizes[Pack]);
+    }
+    for(meow_u32 Level = 0;
+        Level < Store->LevelCount;
+        ++Level)
+    {
+        MeowIndexClose(&Store->Levels[Level]);
+    }
+    free(Store->PackMappings);
+    free(Store->PackSizes);
+    free(Store->PendingKeys);
+    free(Store->PendingPayloads);
+    free(Store->PendingSlots);
+    memset(Store, 0, sizeof(*Store));
+    
+    return(Result);
+}
+
+//
+// NOTE: Both tiers
+//
+
+// NOTE: Memory first, then disk, copying disk hits into memory.  Either tier may be 0.
+static void *
+MeowMemoLookup(meow_memo *Memo, meow_memo_store *Store, meow_hash Key, meow_umm *Size)
+{
+    void *Result = Memo ? MeowMemoGet(Memo, Key, Size) : 0;
+    if(!Result && Store)
+    {
+        Result = MeowMemoStoreGet(Store, Key, Size);
+        if(Result && Memo)
+        {
+            void *Copy = MeowMemoPut(Memo, Key, *Size, Result);
+            if(Copy)
+            {
+                MeowMemoGet(Memo, Key, Size);
+                Result = Copy;
+            }
+        }
+    }
+    
+    return(Result);
+}
@@ -0,0 +1,422 @@
+/* ========================================================================
+   
+   meow_minhash.h - MinHash signatures and LSH banding for near-duplicates
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Equal Meow hashes find identical documents.  MinHash finds documents
+   that are mostly the same - logs with a few lines added, documents with
+   a few words changed - by boiling each one down to a short signature
+   whose positions agree about as often as the documents' shingle sets
+   overlap (their Jaccard similarity):
+   
+       meow_minhash MinHash;
+       MeowMinHashInit(&MinHash, 128, 16, 4, Seed1, Seed2);  // K, Bands, ShingleWords; 0 if they do not fit
+   
+       meow_u32 Signature[128];
+       MeowMinHashSignature(&MinHash, Size, Contents, Signature);
+       double Similarity = MeowMinHashSimilarity(&MinHash, SignatureA, SignatureB);
+   
+   A shingle is ShingleWords consecutive words (runs of bytes between
+   whitespace; anything longer than MEOW_MINHASH_MAX_WORD is cut up, so
+   binary files shingle too).  Each shingle's bytes are hashed once, with
+   MeowHash_Accelerated(Seed1, Seed2, ...), and the K signature positions
+   are K different permutations of that hash, four at a time in SIMD, each
+   keeping its minimum.  That is one pass over the document, with one Meow
+   call per word and K/4 vector multiplies per word.
+   
+   To find candidate pairs without comparing every pair, the signature is
+   cut into Bands bands of K/Bands rows, and each band is hashed to a
+   key.  Two documents become candidates if any band key matches, which
+   happens with probability 1 - (1 - S^Rows)^Bands for similarity S - a
+   sharp step around (1/Bands)^(1/Rows).  The default 16 bands of 8 rows
+   steps at about 0.7; more bands with fewer rows catch less similar pairs
+   at the cost of more false candidates.
+   
+       meow_u64 *BandKeys = ...;    // NOTE: DocCount*Bands
+       MeowMinHashBandKeys(&MinHash, Signature, BandKeys + Doc*MinHash.Bands);
+   
+       meow_lsh_index Index;
+       MeowLshBuild(&Index, DocCount, MinHash.Bands, BandKeys, ThreadCount);
+       MeowLshForEachPair(&Index, [&](meow_umm DocA, meow_umm DocB) {...});
+       MeowLshFree(&Index);
+   
+   The index is one sorted array of 8-byte entries per band (the top bits
+   of the band key with the document number in the low bits), built a band
+   per thread, so it is 8*Bands bytes per document - at 100M documents and
+   16 bands, 12.8GB plus the band keys.  MeowLshForEachPair reports each
+   candidate pair once, in the first band where the two collide, after
+   checking the full band keys.  Candidates are only candidates: check
+   the signatures (or the documents) before calling them duplicates.
+   
+   Include meow_intrinsics.h and meow_hash.h first.  Needs SSE4.1 on x64.
+   
+   ======================================================================== */
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define MEOW_MINHASH_MAX_K 256
+#define MEOW_MINHASH_MAX_SHINGLE_WORDS 16
+#define MEOW_MINHASH_MAX_WORD 64
+
+typedef struct meow_minhash
+{
+    meow_u32 K;             // NOTE: A multiple of 4, up to MEOW_MINHASH_MAX_K
+    meow_u32 Bands;         // NOTE: Must divide K
+    meow_u32 Rows;
+    meow_u32 ShingleWords;
+    meow_u64 Seed1;
+    meow_u64 Seed2;
+    
+    // NOTE: Permutation I is ((Low ^ Xors[I])*Multipliers[I] + High) ^ (itself >> 16)
+    meow_u32 Multipliers[MEOW_MINHASH_MAX_K];
+    meow_u32 Xors[MEOW_MINHASH_MAX_K];
+} meow_minhash;
+
+// NOTE: Returns 0, and leaves MinHash alone, unless K is a multiple of 4 from 4 to MEOW_MINHASH_MAX_K,
+// Bands divides K, and ShingleWords is from 1 to MEOW_MINHASH_MAX_SHINGLE_WORDS
+static int
+MeowMinHashInit(meow_minhash *MinHash, meow_u32 K, meow_u32 Bands, meow_u32 ShingleWords, meow_u64 Seed1, meow_u64 Seed2)
+{
+    int Result = ((K >= 4) && (K <= MEOW_MINHASH_MAX_K) && ((K % 4) == 0) &&
+                  (Bands > 0) && ((K % Bands) == 0) &&
+                  (ShingleWords >= 1) && (ShingleWords <= MEOW_MINHASH_MAX_SHINGLE_WORDS));
+    if(Result)
+    {
+        MinHash->K = K;
+        MinHash->Bands = Bands;
+        MinHash->Rows = K / Bands;
+        MinHash->ShingleWords = ShingleWords;
+        MinHash->Seed1 = Seed1;
+        MinHash->Seed2 = Seed2;
+        
+        // NOTE: The permutations come from the seeds, so signatures made with the same seeds compare
+        meow_u8 Empty[16] = {};
+        meow_hash Constants[2*MEOW_MINHASH_MAX_K / 4];
+        for(meow_u32 Index = 0;
+            Index < (sizeof(Constants) / sizeof(Constants[0]));
+            ++Index)
+        {
+            Constants[Index] = MeowHash_Accelerated(Seed1 ^ 0x6D696E68617368ull, Seed2 + Index, 0, Empty);
+        }
+        memcpy(MinHash->Multipliers, Constants, sizeof(MinHash->Multipliers));
+        memcpy(MinHash->Xors, (meow_u8 *)Constants + sizeof(MinHash->Multipliers), sizeof(MinHash->Xors));
+        for(meow_u32 Index = 0;
+            Index < MEOW_MINHASH_MAX_K;
+            ++Index)
+        {
+            MinHash->Multipliers[Index] |= 1;
+        }
+    }
+    
+    return(Result);
+}
+
+static void
+MeowMinHashAbsorb(meow_minhash *MinHash, meow_u32 *Mins, meow_u64 ShingleHash)
+{
+#if MEOW_HASH_INTEL
+    __m128i Low = _mm_set1_epi32((int)(meow_u32)ShingleHash);
+    __m128i High = _mm_set1_epi32((int)(meow_u32)(ShingleHash >> 32));
+    for(meow_u32 Index = 0;
+        Index < MinHash->K;
+        Index += 4)
+    {
+        __m128i Xors = _mm_loadu_si128((__m128i *)(MinHash->Xors + Index));
+        __m128i Multipliers = _mm_loadu_si128((__m128i *)(MinHash->Multipliers + Index));
+        __m128i Value = _mm_add_epi32(_mm_mullo_epi32(_mm_xor_si128(Low, Xors), Multipliers), High);
+        Value = _mm_xor_si128(Value, _mm_srli_epi32(Value, 16));
+        __m128i *Min = (__m128i *)(Mins + Index);
+        _mm_storeu_si128(Min, _mm_min_epu32(_mm_loadu_si128(Min), Value));
+    }
+#elif MEOW_HASH_ARMV8
+    uint32x4_t Low = vdupq_n_u32((meow_u32)ShingleHash);
+    uint32x4_t High = vdupq_n_u32((meow_u32)(ShingleHash >> 32));
+    for(meow_u32 Index = 0;
+        Index < MinHash->K;
+        Index += 4)
+    {
+        uint32x4_t Value = vmlaq_u32(High, veorq_u32(Low, vld1q_u32(MinHash->Xors + Index)), vld1q_u32(MinHash->Multipliers + Index));
+        Value = veorq_u32(Value, vshrq_n_u32(Value, 16));
+        vst1q_u32(Mins + Index, vminq_u32(vld1q_u32(Mins + Index), Value));
+    }
+#endif
+}
+
+static int
+MeowMinHashIsSpace(meow_u8 Byte)
+{
+    int Result = ((Byte == ' ') || (Byte == '\t') || (Byte == '\r') || (Byte == '\n'));
+    return(Result);
+}
+
+// NOTE: Signature needs MinHash->K entries.  An empty document's are all 0xFFFFFFFF.
+static void
+MeowMinHashSignature(meow_minhash *MinHash, meow_umm Size, void *Contents, meow_u32 *Signature)
+{
+    memset(Signature, 0xFF, MinHash->K*sizeof(meow_u32));
+    
+    // NOTE: Starts of the last ShingleWords words, as a ring
+    meow_u8 *Bytes = (meow_u8 *)Contents;
+    meow_umm Starts[MEOW_MINHASH_MAX_SHINGLE_WORDS];
+    meow_u32 Window = MinHash->ShingleWords;
+    meow_umm WordCount = 0;
+    meow_umm End = 0;
+    
+    meow_umm At = 0;
+    while(At < Size)
+    {
+        while((At < Size) && MeowMinHashIsSpace(Bytes[At]))
+        {
+            ++At;
+        }
+        if(At == Size)
+        {
+            break;
+        }
+        
+        meow_umm Start = At;
+        while((At < Size) && !MeowMinHashIsSpace(Bytes[At]) && ((At - Start) < MEOW_MINHASH_MAX_WORD))
+        {
+            ++At;
+        }
+        End = At;
+        
+        Starts[WordCount % Window] = Start;
+        ++WordCount;
+        if(WordCount >= Window)
+        {
+            meow_umm First = Starts[WordCount % Window];
+            meow_hash Hash = MeowHash_Accelerated(MinHash->Seed1, MinHash->Seed2, At - First, Bytes + First);
+            MeowMinHashAbsorb(MinHash, Signature, MeowU64From(Hash, 0));
+        }
+    }
+    
+    // NOTE: Too short for one whole shingle, so the whole thing is the shingle
+    if(WordCount && (WordCount < Window))
+    {
+        meow_umm First = Starts[0];
+        meow_hash Hash = MeowHash_Accelerated(MinHash->Seed1, MinHash->Seed2, End - First, Bytes + First);
+        MeowMinHashAbsorb(MinHash, Signature, MeowU64From(Hash, 0));
+    }
+}
+
+static double
+MeowMinHashSimilarity(meow_minhash *MinHash, meow_u32 *A, meow_u32 *B)
+{
+    meow_u32 Equal = 0;
+    for(meow_u32 Index = 0;
+        Index < MinHash->K;
+        ++Index)
+    {
+        Equal += (A[Index] == B[Index]);
+    }
+    
+    double Result = (double)Equal / (double)MinHash->K;
+    return(Result);
+}
+
+// NOTE: Keys needs MinHash->Bands entries
+static void
+MeowMinHashBandKeys(meow_minhash *MinHash, meow_u32 *Signature, meow_u64 *Keys)
+{
+    for(meow_u32 Band = 0;
+        Band < MinHash->Bands;
+        ++Band)
+    {
+        meow_hash Hash = MeowHash_Accelerated(MinHash->Seed1 + Band, MinHash->Seed2, MinHash->Rows*sizeof(meow_u32),
+                                              Signature + Band*MinHash->Rows);
+        Keys[Band] = MeowU64From(Hash, 0);
+    }
+}
+
+//
+// NOTE: LSH index
+//
+
+typedef struct meow_lsh_index
+{
+    meow_umm DocCount;
+    meow_u32 Bands;
+    meow_u32 DocBits;
+    meow_u64 *BandKeys;     // NOTE: The caller's, DocCount*Bands
+    meow_u64 *Entries;      // NOTE: Bands runs of DocCount sorted entries
+} meow_lsh_index;
+
+// NOTE: Returns 0 if the entries could not be allocated
+static int
+MeowLshBuild(meow_lsh_index *Index, meow_umm DocCount, meow_u32 Bands, meow_u64 *BandKeys, int ThreadCount)
+{
+    Index->DocCount = DocCount;
+    Index->Bands = Bands;
+    Index->BandKeys = BandKeys;
+    Index->DocBits = 1;
+    while((Index->DocBits < 63) && (((meow_u64)1 << Index->DocBits) < DocCount))
+    {
+        ++Index->DocBits;
+    }
+    Index->Entries = (meow_u64 *)malloc((DocCount ? DocCount : 1)*Bands*sizeof(meow_u64));
+    
+    int Result = (Index->Entries != 0);
+    if(Result)
+    {
+        if(ThreadCount <= 0)
+        {
+            ThreadCount = (int)std::thread::hardware_concurrency();
+        }
+        if(ThreadCount > (int)Bands)
+        {
+            ThreadCount = (int)Bands;
+        }
+        
+        // NOTE: Threads take whole bands, since every band is its own sort
+        std::atomic<meow_u32> NextBand(0);
+        auto BuildBands = [Index, &NextBand]()
+        {
+            meow_u64 DocMask = ((meow_u64)1 << Index->DocBits) - 1;
+            for(meow_u32 Band = NextBand++;
+                Band < Index->Bands;
+                Band = NextBand++)
+            {
+                meow_u64 *Entries = Index->Entries + Band*Index->DocCount;
+                for(meow_umm Doc = 0;
+                    Doc < Index->DocCount;
+                    ++Doc)
+                {
+                    Entries[Doc] = (Index->BandKeys[Doc*Index->Bands + Band] & ~DocMask) | Doc;
+                }
+                std::sort(Entries, Entries + Index->DocCount);
+            }
+        };
+        
+        std::vector<std::thread> Threads;
+        for(int Thread = 1;
+            Thread < ThreadCount;
+            ++Thread)
+        {
+            Threads.emplace_back(BuildBands);
+        }
+        BuildBands();
+        for(size_t Thread = 0;
+            Thread < Threads.size();
+            ++Thread)
+        {
+            Threads[Thread].join();
+        }
+    }
+    
+    return(Result);
+}
+
+static void
+MeowLshFree(meow_lsh_index *Index)
+{
+    free(Index->Entries);
+    Index->Entries = 0;
+}
+
+static int
+MeowLshFirstSharedBand(meow_lsh_index *Index, meow_umm DocA, meow_umm DocB, meow_u32 Band)
+{
+    meow_u64 *KeysA = Index->BandKeys + DocA*Index->Bands;
+    meow_u64 *KeysB = Index->BandKeys + DocB*Index->Bands;
+    int Result = (KeysA[Band] == KeysB[Band]);
+    for(meow_u32 Earlier = 0;
+        Result && (Earlier < Band);
+        ++Earlier)
+    {
+        Result = (KeysA[Earlier] != KeysB[Earlier]);
+    }
+    
+    return(Result);
+}
+
+// NOTE: Calls Pair(DocA, DocB), with DocA < DocB, once for every pair sharing a band key
+template<typename pair_fn>
+static void
+MeowLshForEachPair(meow_lsh_index *Index, pair_fn Pair)
+{
+    meow_u64 DocMask = ((meow_u64)1 << Index->DocBits) - 1;
+    for(meow_u32 Band = 0;
+        Band < Index->Bands;
+        ++Band)
+    {
+        meow_u64 *Entries = Index->Entries + Band*Index->DocCount;
+        meow_umm RunStart = 0;
+        while(RunStart < Index->DocCount)
+        {
+            meow_umm RunEnd = RunStart + 1;
+            while((RunEnd < Index->DocCount) && (((Entries[RunEnd] ^ Entries[RunStart]) & ~DocMask) == 0))
+            {
+                ++RunEnd;
+            }
+            
+            for(meow_umm A = RunStart;
+                A < RunEnd;
+                ++A)
+            {
+                for(meow_umm B = A + 1;
+                    B < RunEnd;
+                    ++B)
+                {
+                    // NOTE: Entries sort by document within a run, so DocA < DocB
+                    meow_umm DocA = (meow_umm)(Entries[A] & DocMask);
+                    meow_umm DocB = (meow_umm)(Entries[B] & DocMask);
+                    if(MeowLshFirstSharedBand(Index, DocA, DocB, Band))
+                    {
+                        Pair(DocA, DocB);
+                    }
+                }
+            }
+            
+            RunStart = RunEnd;
+        }
+    }
+}
+
+// NOTE: Calls Doc(Number) once for every indexed document sharing a band key with Keys
+template<typename doc_fn>
+static void
+MeowLshForEachCandidate(meow_lsh_index *Index, meow_u64 *Keys, doc_fn Doc)
+{
+    meow_u64 DocMask = ((meow_u64)1 << Index->DocBits) - 1;
+    for(meow_u32 Band = 0;
+        Band < Index->Bands;
+        ++Band)
+    {
+        meow_u64 *Entries = Index->Entries + Band*Index->DocCount;
+        meow_u64 Target = Keys[Band] & ~DocMask;
+        meow_u64 *At = std::lower_bound(Entries, Entries + Index->DocCount, Target);
+        for(;
+            (At < (Entries + Index->DocCount)) && ((*At & ~DocMask) == Target);
+            ++At)
+        {
+            meow_umm Number = (meow_umm)(*At & DocMask);
+            meow_u64 *Other = Index->BandKeys + Number*Index->Bands;
+            
+            // NOTE: Only the first band the two really share reports it
+            int First = (Other[Band] == Keys[Band]);
+            for(meow_u32 Earlier = 0;
+                First && (Earlier < Band);
+                ++Earlier)
+            {
+                First = (Other[Earlier] != Keys[Earlier]);
+            }
+            
+            if(First)
+            {
+                Doc(Number);
+            }
+        }
+    }
+}
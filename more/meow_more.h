@@ -203,6 +203,147 @@ MeowHashEnd(meow_hash_state *State, meow_u64 Seed1, meow_u64 Seed2)
     return(Result);
 }
 
+//
+// NOTE: Checkpointed construction
+//
+// For buffers whose length never changes (save files, textures, page images),
+// the Mixer folded in by MeowHashBegin stays the same from version to version,
+// so the lane state after any 64-byte boundary only depends on the bytes before
+// it.  MeowHashCheckpointed records S0..S3 every Interval bytes while doing an
+// ordinary full hash, and MeowHashRehash resumes from the last snapshot before
+// the first modified byte.  Both return exactly what MeowHash_Accelerated would
+// for the same seeds and buffer.
+//
+// The caller provides the snapshot storage: MeowHashCheckpointCount(Len, Interval)
+// snapshots of four meow_aes_128 lanes each.  Interval is rounded down to a
+// multiple of 64 bytes (minimum 64).
+//
+
+typedef struct meow_hash_checkpoints
+{
+    meow_u64 Seed1;
+    meow_u64 Seed2;
+    meow_u64 TotalLengthInBytes;
+    meow_u64 Interval;
+    meow_u64 Count;
+    meow_aes_128 *States;
+} meow_hash_checkpoints;
+
+static meow_u64
+MeowHashCheckpointInterval(meow_u64 Interval)
+{
+    Interval &= ~(meow_u64)63;
+    if(Interval == 0)
+    {
+        Interval = 64;
+    }
+    
+    return(Interval);
+}
+
+static meow_u64
+MeowHashCheckpointCount(meow_u64 TotalLengthInBytes, meow_u64 Interval)
+{
+    meow_u64 Result = (TotalLengthInBytes / MeowHashCheckpointInterval(Interval)) + 1;
+    return(Result);
+}
+
+static meow_hash
+MeowHashCheckpointRun(meow_hash_checkpoints *Checkpoints, meow_u64 Snapshot, meow_u8 *SourceInit)
+{
+    meow_hash_state State;
+    
+    meow_aes_128 *Lanes = Checkpoints->States + 4*Snapshot;
+    State.S0 = Lanes[0];
+    State.S1 = Lanes[1];
+    State.S2 = Lanes[2];
+    State.S3 = Lanes[3];
+    
+    meow_u64 Len = Checkpoints->TotalLengthInBytes;
+    meow_u64 At = Snapshot*Checkpoints->Interval;
+    meow_u64 End = (Len & ~(meow_u64)63);
+    meow_u8 *Source = SourceInit + At;
+    
+    // NOTE: Re-absorb the blocks after the snapshot, replacing every later
+    // snapshot since they now depend on the new bytes
+    while(At < End)
+    {
+        meow_u64 Advance = Checkpoints->Interval;
+        if(Advance > (End - At))
+        {
+            Advance = (End - At);
+        }
+        
+        MeowHashAbsorbBlocks(&State, Advance >> 6, Source);
+        At += Advance;
+        Source += Advance;
+        
+        if((At % Checkpoints->Interval) == 0)
+        {
+            Lanes = Checkpoints->States + 4*(At / Checkpoints->Interval);
+            Lanes[0] = State.S0;
+            Lanes[1] = State.S1;
+            Lanes[2] = State.S2;
+            Lanes[3] = State.S3;
+        }
+    }
+    
+    // NOTE: Hand the residual to the streaming finalizer
+    State.TotalLengthInBytes = Len;
+    State.BufferLen = (int unsigned)(Len - End);
+    for(int unsigned Index = 0;
+        Index < State.BufferLen;
+        ++Index)
+    {
+        State.Buffer[Index] = Source[Index];
+    }
+    
+    meow_hash Result = MeowHashEnd(&State, Checkpoints->Seed1, Checkpoints->Seed2);
+    return(Result);
+}
+
+static inline meow_hash
+MeowHashCheckpointed(meow_hash_checkpoints *Checkpoints, meow_aes_128 *States, meow_u64 Interval,
+                     meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, void *Source)
+{
+    meow_hash_state State;
+    MeowHashBegin(&State, Seed1, Seed2, TotalLengthInBytes);
+    
+    Checkpoints->Seed1 = Seed1;
+    Checkpoints->Seed2 = Seed2;
+    Checkpoints->TotalLengthInBytes = TotalLengthInBytes;
+    Checkpoints->Interval = MeowHashCheckpointInterval(Interval);
+    Checkpoints->Count = MeowHashCheckpointCount(TotalLengthInBytes, Checkpoints->Interval);
+    Checkpoints->States = States;
+    
+    States[0] = State.S0;
+    States[1] = State.S1;
+    States[2] = State.S2;
+    States[3] = State.S3;
+    
+    meow_hash Result = MeowHashCheckpointRun(Checkpoints, 0, (meow_u8 *)Source);
+    return(Result);
+}
+
+//
+// NOTE: Source must be the full buffer (of the same length) after the edit,
+// and DirtyOffset the position of the first byte that may have changed since
+// the last call.
+//
+
+static inline meow_hash
+MeowHashRehash(meow_hash_checkpoints *Checkpoints, meow_u64 DirtyOffset, void *Source)
+{
+    meow_u64 Snapshot = DirtyOffset / Checkpoints->Interval;
+    if(Snapshot >= Checkpoints->Count)
+    {
+        Snapshot = Checkpoints->Count - 1;
+    }
+    
+    meow_hash Result = MeowHashCheckpointRun(Checkpoints, Snapshot, (meow_u8 *)Source);
+    return(Result);
+}
+
 //
 // NOTE(casey): Vanilla C version
 //
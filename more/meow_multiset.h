@@ -0,0 +1,171 @@
+/* ========================================================================
+   
+   meow_multiset.h - order-independent set and multiset digests of Meow hashes
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   A multiset digest is the sum of the 128-bit Meow hashes of its elements,
+   taken modulo 2^128, plus a count of the elements.  Addition is commutative
+   and associative, so partial digests built on different threads (or from
+   different partitions of a table) can be merged in any order and still
+   produce the same result:
+   
+       meow_multiset Partial[ThreadCount];
+   
+       // NOTE: On each thread
+       MeowMultisetBegin(&Partial[ThreadIndex]);
+       for(each element) MeowMultisetInsert(&Partial[ThreadIndex], ElementHash);
+   
+       // NOTE: After the threads join, in any order
+       meow_multiset Total;
+       MeowMultisetBegin(&Total);
+       for(each thread) MeowMultisetMerge(&Total, &Partial[ThreadIndex]);
+       meow_hash Digest = MeowMultisetEnd(&Total, 0, 0);
+   
+   Inserting and removing a single element are each O(1), so a digest can be
+   kept up to date incrementally as rows are added to or deleted from a set.
+   
+   A set digest is just a multiset digest where every element is inserted
+   once.  The digest cannot tell a set from a multiset on its own, so if
+   partitions may contain the same element, it is up to the caller to make
+   sure each element is only inserted by one of them.
+   
+   The raw sum is linear in the element hashes, so it should never be
+   compared or stored directly - MeowMultisetEnd runs it (and the count)
+   through Meow to produce the final digest.  Like Meow itself, this gives
+   no protection from adversaries who can choose the elements.
+   
+   ======================================================================== */
+
+typedef struct meow_multiset
+{
+    meow_u64 Sum[2];
+    meow_u64 Count;
+} meow_multiset;
+
+static void
+MeowMultisetAdd128(meow_multiset *Set, meow_u64 Lo, meow_u64 Hi)
+{
+    meow_u64 Sum = Set->Sum[0] + Lo;
+    Set->Sum[1] += Hi + (Sum < Lo);
+    Set->Sum[0] = Sum;
+}
+
+static void
+MeowMultisetSub128(meow_multiset *Set, meow_u64 Lo, meow_u64 Hi)
+{
+    meow_u64 Borrow = (Set->Sum[0] < Lo);
+    Set->Sum[0] -= Lo;
+    Set->Sum[1] -= Hi + Borrow;
+}
+
+static void
+MeowMultisetScale128(meow_u64 *Lo, meow_u64 *Hi, meow_u64 Count)
+{
+    //
+    // NOTE: (Hi:Lo) * Count modulo 2^128, using 32-bit halves so it
+    // compiles the same way everywhere
+    //
+    
+    meow_u64 A0 = (*Lo & 0xFFFFFFFF);
+    meow_u64 A1 = (*Lo >> 32);
+    meow_u64 B0 = (Count & 0xFFFFFFFF);
+    meow_u64 B1 = (Count >> 32);
+    
+    meow_u64 P00 = A0*B0;
+    meow_u64 P01 = A0*B1;
+    meow_u64 P10 = A1*B0;
+    meow_u64 P11 = A1*B1;
+    
+    meow_u64 Middle = (P00 >> 32) + (P01 & 0xFFFFFFFF) + (P10 & 0xFFFFFFFF);
+    meow_u64 ProductHi = P11 + (P01 >> 32) + (P10 >> 32) + (Middle >> 32);
+    meow_u64 ProductLo = (Middle << 32) | (P00 & 0xFFFFFFFF);
+    
+    *Hi = ProductHi + (*Hi * Count);
+    *Lo = ProductLo;
+}
+
+static void
+MeowMultisetBegin(meow_multiset *Set)
+{
+    Set->Sum[0] = 0;
+    Set->Sum[1] = 0;
+    Set->Count = 0;
+}
+
+static void
+MeowMultisetInsert(meow_multiset *Set, meow_hash Hash)
+{
+    MeowMultisetAdd128(Set, MeowU64From(Hash, 0), MeowU64From(Hash, 1));
+    Set->Count += 1;
+}
+
+static void
+MeowMultisetRemove(meow_multiset *Set, meow_hash Hash)
+{
+    MeowMultisetSub128(Set, MeowU64From(Hash, 0), MeowU64From(Hash, 1));
+    Set->Count -= 1;
+}
+
+static void
+MeowMultisetInsertCount(meow_multiset *Set, meow_hash Hash, meow_u64 Count)
+{
+    meow_u64 Lo = MeowU64From(Hash, 0);
+    meow_u64 Hi = MeowU64From(Hash, 1);
+    MeowMultisetScale128(&Lo, &Hi, Count);
+    MeowMultisetAdd128(Set, Lo, Hi);
+    Set->Count += Count;
+}
+
+static void
+MeowMultisetRemoveCount(meow_multiset *Set, meow_hash Hash, meow_u64 Count)
+{
+    meow_u64 Lo = MeowU64From(Hash, 0);
+    meow_u64 Hi = MeowU64From(Hash, 1);
+    MeowMultisetScale128(&Lo, &Hi, Count);
+    MeowMultisetSub128(Set, Lo, Hi);
+    Set->Count -= Count;
+}
+
+//
+// NOTE: Dest = Dest + Source, ie. the union of two multisets
+//
+
+static void
+MeowMultisetMerge(meow_multiset *Dest, meow_multiset *Source)
+{
+    MeowMultisetAdd128(Dest, Source->Sum[0], Source->Sum[1]);
+    Dest->Count += Source->Count;
+}
+
+//
+// NOTE: Dest = Dest - Source, ie. removes every element of Source from Dest
+//
+
+static void
+MeowMultisetSubtract(meow_multiset *Dest, meow_multiset *Source)
+{
+    MeowMultisetSub128(Dest, Source->Sum[0], Source->Sum[1]);
+    Dest->Count -= Source->Count;
+}
+
+static int
+MeowMultisetsAreEqual(meow_multiset *A, meow_multiset *B)
+{
+    int Result = ((A->Sum[0] == B->Sum[0]) &&
+                  (A->Sum[1] == B->Sum[1]) &&
+                  (A->Count == B->Count));
+    return(Result);
+}
+
+static meow_hash
+MeowMultisetEnd(meow_multiset *Set, meow_u64 Seed1, meow_u64 Seed2)
+{
+    meow_u64 Packed[3] = {Set->Sum[0], Set->Sum[1], Set->Count};
+    meow_hash Result = MeowHash_Accelerated(Seed1, Seed2, sizeof(Packed), Packed);
+    return(Result);
+}
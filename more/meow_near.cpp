@@ -0,0 +1,180 @@
+/* ========================================================================
+   
+   meow_near.cpp - near-duplicate file search with MinHash and LSH
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ======================================================================== */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "meow_intrinsics.h"
+#include "meow_hash.h"
+#include "more/meow_walk.h"
+#include "more/meow_minhash.h"
+
+struct near_files
+{
+    std::vector<char *> Names;
+    meow_u64 AccessFailureCount;
+};
+
+static void
+AddWalkedFile(void *Context, char *FileName)
+{
+    ((near_files *)Context)->Names.push_back(FileName);
+}
+
+static void
+CountUnknownEntry(void *Context, char *)
+{
+    ++((near_files *)Context)->AccessFailureCount;
+}
+
+// NOTE: Returns 0 if the file could not be read, leaving the signature empty
+static int
+SignFile(meow_minhash *MinHash, char *FileName, meow_u32 *Signature)
+{
+    int Result = 0;
+    memset(Signature, 0xFF, MinHash->K*sizeof(meow_u32));
+    
+    FILE *File = fopen(FileName, "rb");
+    if(File)
+    {
+        fseek(File, 0, SEEK_END);
+        long Size = ftell(File);
+        fseek(File, 0, SEEK_SET);
+        
+        void *Contents = malloc(Size ? Size : 1);
+        if(Contents && ((Size == 0) || (fread(Contents, Size, 1, File) == 1)))
+        {
+            MeowMinHashSignature(MinHash, (meow_umm)Size, Contents, Signature);
+            Result = 1;
+        }
+        
+        free(Contents);
+        fclose(File);
+    }
+    
+    return(Result);
+}
+
+int main(int ArgCount, char **Args)
+{
+    int Result = -1;
+    
+    if((ArgCount == 2) || (ArgCount == 3))
+    {
+        char *RootPath = Args[1];
+        size_t RootPathLen = strlen(RootPath);
+        while(RootPathLen && ((RootPath[RootPathLen - 1] == '/') || (RootPath[RootPathLen - 1] == '\\')))
+        {
+            RootPath[--RootPathLen] = 0;
+        }
+        double Threshold = (ArgCount == 3) ? atof(Args[2]) : 0.8;
+        
+        near_files Files = {};
+        meow_walk Walk = {&Files, AddWalkedFile, CountUnknownEntry};
+        MeowWalkDirectory(&Walk, RootPath);
+        
+        meow_minhash MinHash;
+        MeowMinHashInit(&MinHash, 128, 16, 4, 0, 0);
+        
+        meow_umm FileCount = Files.Names.size();
+        std::vector<meow_u32> Signatures(FileCount*MinHash.K);
+        std::vector<meow_u64> BandKeys(FileCount*MinHash.Bands);
+        std::vector<meow_u8> Read(FileCount);
+        
+        // NOTE: Files are handed out one at a time, since their sizes are all over the place
+        int ThreadCount = (int)std::thread::hardware_concurrency();
+        std::atomic<meow_umm> NextFile(0);
+        auto SignFiles = [&]()
+        {
+            for(meow_umm FileIndex = NextFile++;
+                FileIndex < FileCount;
+                FileIndex = NextFile++)
+            {
+                meow_u32 *Signature = &Signatures[FileIndex*MinHash.K];
+                Read[FileIndex] = (meow_u8)SignFile(&MinHash, Files.Names[FileIndex], Signature);
+                MeowMinHashBandKeys(&MinHash, Signature, &BandKeys[FileIndex*MinHash.Bands]);
+            }
+        };
+        
+        std::vector<std::thread> Threads;
+        for(int Thread = 1;
+            Thread < ThreadCount;
+            ++Thread)
+        {
+            Threads.emplace_back(SignFiles);
+        }
+        SignFiles();
+        for(size_t Thread = 0;
+            Thread < Threads.size();
+            ++Thread)
+        {
+            Threads[Thread].join();
+        }
+        
+        meow_u64 ReadFailureCount = 0;
+        for(meow_umm FileIndex = 0;
+            FileIndex < FileCount;
+            ++FileIndex)
+        {
+            ReadFailureCount += !Read[FileIndex];
+        }
+        
+        meow_lsh_index Index;
+        if(MeowLshBuild(&Index, FileCount, MinHash.Bands, BandKeys.data(), ThreadCount))
+        {
+            meow_u64 CandidateCount = 0;
+            meow_u64 PairCount = 0;
+            MeowLshForEachPair(&Index, [&](meow_umm A, meow_umm B)
+            {
+                ++CandidateCount;
+                if(Read[A] && Read[B])
+                {
+                    double Similarity = MeowMinHashSimilarity(&MinHash, &Signatures[A*MinHash.K], &Signatures[B*MinHash.K]);
+                    if(Similarity >= Threshold)
+                    {
+                        printf("%0.3f %s %s\n", Similarity, Files.Names[A], Files.Names[B]);
+                        ++PairCount;
+                    }
+                }
+            });
+            MeowLshFree(&Index);
+            
+            fprintf(stderr, "meow_near: %0.0f files, %0.0f candidate pairs, %0.0f pairs at %0.2f or above\n",
+                    (double)FileCount, (double)CandidateCount, (double)PairCount, Threshold);
+            if(Files.AccessFailureCount || ReadFailureCount)
+            {
+                fprintf(stderr, "meow_near: %0.0f access failures, %0.0f read failures\n",
+                        (double)Files.AccessFailureCount, (double)ReadFailureCount);
+            }
+            Result = 0;
+        }
+        else
+        {
+            fprintf(stderr, "ERROR: Not enough memory for the index of %0.0f files.\n", (double)FileCount);
+        }
+        
+        for(meow_umm FileIndex = 0;
+            FileIndex < FileCount;
+            ++FileIndex)
+        {
+            MeowDeallocPath(Files.Names[FileIndex]);
+        }
+    }
+    else
+    {
+        printf("Usage: %s <directory to search recursively> [similarity threshold, default 0.8]\n", Args[0]);
+    }
+    
+    return(Result);
+}
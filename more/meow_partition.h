@@ -0,0 +1,447 @@
+/* ========================================================================
+   
+   meow_partition.h - radix hash-partitioning of tuples with the Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Partitioning splits an array of fixed-size tuples into 2^Bits runs by the
+   hash of their keys, the first step of a parallel radix join or group-by.
+   Keys are hashed a batch at a time with MeowHashRows (see meow_column.h),
+   and the partition comes from the TOP bits of MeowU32From(Hash, 3), so the
+   low 64 bits (what meow::hash and most tables use) stay independent of the
+   partition the tuple landed in.
+   
+   Scattering straight to 2^Bits places in memory misses the cache and the
+   TLB on almost every tuple.  Instead each partition gets a one cache line
+   write-combining buffer, which is flushed to the output with non-temporal
+   stores when it fills, so the output is written a full line at a time and
+   never read.  The buffers are 64*2^Bits bytes, so keep Bits to around 10
+   or less per pass (they should stay in L1/L2); use the multi-pass version
+   for larger fan-outs.
+   
+   The caller provides all the memory:
+   
+       meow_partition_layout Layout = {TupleSize, KeyOffset, KeyWidth, Seed1, Seed2};
+       meow_partition_buffers Buffers;
+       MeowPartitionBuffersInit(&Buffers, malloc(MeowPartitionBuffersSize(Bits)), Bits);
+   
+       meow_u32 *Hashes = ...;             // Count entries
+       meow_umm Histogram[1 << Bits];
+       MeowPartition(&Layout, Bits, Tuples, Count, Hashes, &Buffers, Output, Histogram);
+   
+   Output then holds partition 0's tuples, then partition 1's, and so on,
+   with Histogram[P] tuples in partition P.  Tuples keep their input order
+   within a partition.
+   
+   For more than one thread, each thread can partition its own slice into
+   its own output (a histogram plus contiguous runs), or all threads can
+   share one output:
+   
+       // NOTE: On each thread
+       MeowPartitionHash(&Layout, Tuples, Count, Hashes);
+       MeowPartitionHistogram(Hashes, Count, 32 - Bits, Bits, Histograms[Thread]);
+       ... wait for every thread ...
+       MeowPartitionSharedOffsets(Histograms, ThreadCount, Thread, Bits, Buffers.Offsets);
+       MeowPartitionScatter(&Layout, Tuples, Hashes, Count, 32 - Bits, Bits, &Buffers, Output);
+   
+   Every thread's part of a partition is then one run, directly after the
+   previous thread's part of the same partition.
+   
+   MeowPartitionMultiPass splits TotalBits over passes of at most PassBits
+   each, top bits first, ping-ponging between Output and a Scratch array of
+   the same size.  The tuples are only hashed once: each pass scatters the
+   hashes along with the tuples, ping-ponging between Hashes and a
+   ScratchHashes array of Count entries, so later passes read the bits they
+   need instead of rehashing.  The result is the same as one MeowPartition
+   with TotalBits, and Histogram needs 2^TotalBits entries.
+   
+   Include meow_intrinsics.h, meow_hash.h and more/meow_column.h first.
+   
+   ======================================================================== */
+
+#include <string.h>
+
+#define MEOW_PARTITION_LINE 64
+#define MEOW_PARTITION_HASH_BATCH 256
+
+#if MEOW_HASH_INTEL
+#define MeowPartitionStreamLine(Dest, Source) \
+    _mm_stream_si128((meow_u128 *)(Dest) + 0, *((meow_u128 *)(Source) + 0)); \
+    _mm_stream_si128((meow_u128 *)(Dest) + 1, *((meow_u128 *)(Source) + 1)); \
+    _mm_stream_si128((meow_u128 *)(Dest) + 2, *((meow_u128 *)(Source) + 2)); \
+    _mm_stream_si128((meow_u128 *)(Dest) + 3, *((meow_u128 *)(Source) + 3))
+#define MeowPartitionFence() _mm_sfence()
+#else
+#define MeowPartitionStreamLine(Dest, Source) memcpy((Dest), (Source), MEOW_PARTITION_LINE)
+#define MeowPartitionFence()
+#endif
+
+typedef struct meow_partition_layout
+{
+    meow_umm TupleSize;
+    meow_umm KeyOffset;
+    meow_u64 KeyWidth;
+    meow_u64 Seed1;
+    meow_u64 Seed2;
+} meow_partition_layout;
+
+typedef struct meow_partition_buffers
+{
+    meow_u32 Bits;
+    meow_u8 *Lines;      // NOTE: One cache line per partition, cache-line aligned
+    meow_u8 **Cursor;    // NOTE: Where in the output the next byte of each partition goes
+    meow_u8 **RunStart;  // NOTE: Where in the output each partition's run starts
+    meow_umm *Offsets;   // NOTE: Tuple index each partition starts at, filled in before a scatter
+} meow_partition_buffers;
+
+static meow_umm
+MeowPartitionBuffersSize(meow_u32 Bits)
+{
+    meow_umm FanOut = (meow_umm)1 << Bits;
+    meow_umm Result = (MEOW_PARTITION_LINE - 1) + FanOut*(MEOW_PARTITION_LINE + 2*sizeof(meow_u8 *) + sizeof(meow_umm));
+    return(Result);
+}
+
+static void
+MeowPartitionBuffersInit(meow_partition_buffers *Buffers, void *Memory, meow_u32 Bits)
+{
+    meow_umm FanOut = (meow_umm)1 << Bits;
+    meow_u8 *At = (meow_u8 *)((((meow_umm)Memory) + (MEOW_PARTITION_LINE - 1)) & ~(meow_umm)(MEOW_PARTITION_LINE - 1));
+    
+    Buffers->Bits = Bits;
+    Buffers->Lines = At;
+    At += FanOut*MEOW_PARTITION_LINE;
+    Buffers->Cursor = (meow_u8 **)At;
+    At += FanOut*sizeof(meow_u8 *);
+    Buffers->RunStart = (meow_u8 **)At;
+    At += FanOut*sizeof(meow_u8 *);
+    Buffers->Offsets = (meow_umm *)At;
+}
+
+//
+// NOTE: Hashes
+//
+
+static void
+MeowPartitionHash(meow_partition_layout *Layout, void *TuplesInit, meow_umm Count, meow_u32 *Hashes)
+{
+    meow_u8 *Tuples = (meow_u8 *)TuplesInit;
+    meow_hash Batch[MEOW_PARTITION_HASH_BATCH];
+    for(meow_umm BatchStart = 0;
+        BatchStart < Count;
+        BatchStart += MEOW_PARTITION_HASH_BATCH)
+    {
+        meow_umm BatchCount = Count - BatchStart;
+        if(BatchCount > MEOW_PARTITION_HASH_BATCH)
+        {
+            BatchCount = MEOW_PARTITION_HASH_BATCH;
+        }
+        
+        MeowHashRows(Layout->Seed1, Layout->Seed2, Tuples + BatchStart*Layout->TupleSize + Layout->KeyOffset,
+                     Layout->TupleSize, Layout->KeyWidth, BatchCount, 128, Batch);
+        for(meow_umm Index = 0;
+            Index < BatchCount;
+            ++Index)
+        {
+            Hashes[BatchStart + Index] = MeowU32From(Batch[Index], 3);
+        }
+    }
+}
+
+static meow_u32
+MeowPartitionOf(meow_u32 Hash, meow_u32 Shift, meow_u32 Bits)
+{
+    meow_u32 Result = (meow_u32)(((meow_u64)Hash >> Shift) & (((meow_u64)1 << Bits) - 1));
+    return(Result);
+}
+
+static void
+MeowPartitionHistogram(meow_u32 *Hashes, meow_umm Count, meow_u32 Shift, meow_u32 Bits, meow_umm *Histogram)
+{
+    meow_umm FanOut = (meow_umm)1 << Bits;
+    memset(Histogram, 0, FanOut*sizeof(meow_umm));
+    for(meow_umm Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        ++Histogram[MeowPartitionOf(Hashes[Index], Shift, Bits)];
+    }
+}
+
+//
+// NOTE: Offsets.  Exclusive prefix sums of the histogram(s), in tuples.
+//
+
+static void
+MeowPartitionLocalOffsets(meow_umm *Histogram, meow_u32 Bits, meow_umm *Offsets)
+{
+    meow_umm FanOut = (meow_umm)1 << Bits;
+    meow_umm Sum = 0;
+    for(meow_umm Partition = 0;
+        Partition < FanOut;
+        ++Partition)
+    {
+        Offsets[Partition] = Sum;
+        Sum += Histogram[Partition];
+    }
+}
+
+static void
+MeowPartitionSharedOffsets(meow_umm **Histograms, int ThreadCount, int Thread, meow_u32 Bits, meow_umm *Offsets)
+{
+    meow_umm FanOut = (meow_umm)1 << Bits;
+    meow_umm Sum = 0;
+    for(meow_umm Partition = 0;
+        Partition < FanOut;
+        ++Partition)
+    {
+        for(int Other = 0;
+            Other < ThreadCount;
+            ++Other)
+        {
+            if(Other == Thread)
+            {
+                Offsets[Partition] = Sum;
+            }
+            Sum += Histograms[Other][Partition];
+        }
+    }
+}
+
+//
+// NOTE: Scatter.  Each partition's buffer mirrors the output cache line its
+// cursor is in, so a full buffer is always exactly one aligned line.  The
+// only lines that are not streamed are the first and last of each run, which
+// may be shared with a neighbouring run and so only get their own bytes
+// written, with ordinary stores.
+//
+
+static MEOW_COLUMN_INLINE void
+MeowPartitionFlushLine(meow_partition_buffers *Buffers, meow_u32 Partition, meow_u8 *LineStart)
+{
+    meow_u8 *Line = Buffers->Lines + Partition*MEOW_PARTITION_LINE;
+    meow_u8 *RunStart = Buffers->RunStart[Partition];
+    if(LineStart >= RunStart)
+    {
+        MeowPartitionStreamLine(LineStart, Line);
+    }
+    else
+    {
+        meow_umm Skip = (meow_umm)(RunStart - LineStart);
+        memcpy(RunStart, Line + Skip, MEOW_PARTITION_LINE - Skip);
+    }
+}
+
+static MEOW_COLUMN_INLINE void
+MeowPartitionWrite(meow_partition_buffers *Buffers, meow_u32 Partition, meow_u8 *Tuple, meow_umm TupleSize)
+{
+    meow_u8 *Cursor = Buffers->Cursor[Partition];
+    meow_u8 *Line = Buffers->Lines + Partition*MEOW_PARTITION_LINE;
+    meow_umm InLine = (meow_umm)Cursor & (MEOW_PARTITION_LINE - 1);
+    if((InLine + TupleSize) <= MEOW_PARTITION_LINE)
+    {
+        memcpy(Line + InLine, Tuple, TupleSize);
+        Cursor += TupleSize;
+    }
+    else
+    {
+        // NOTE: The tuple straddles a line boundary, or several for big tuples
+        meow_umm Left = TupleSize;
+        while((InLine + Left) > MEOW_PARTITION_LINE)
+        {
+            meow_umm Part = MEOW_PARTITION_LINE - InLine;
+            memcpy(Line + InLine, Tuple, Part);
+            MeowPartitionFlushLine(Buffers, Partition, Cursor - InLine);
+            Cursor += Part;
+            Tuple += Part;
+            Left -= Part;
+            InLine = 0;
+        }
+        memcpy(Line, Tuple, Left);
+        Cursor += Left;
+    }
+    
+    if(((meow_umm)Cursor & (MEOW_PARTITION_LINE - 1)) == 0)
+    {
+        MeowPartitionFlushLine(Buffers, Partition, Cursor - MEOW_PARTITION_LINE);
+    }
+    
+    Buffers->Cursor[Partition] = Cursor;
+}
+
+static MEOW_COLUMN_INLINE void
+MeowPartitionScatterSize(meow_u8 *Tuples, meow_u32 *Hashes, meow_umm Count, meow_u32 Shift, meow_u32 Bits,
+                         meow_partition_buffers *Buffers, meow_umm TupleSize)
+{
+    // NOTE: A local copy, so the compiler knows the tuple copies cannot change the pointers
+    meow_partition_buffers Local = *Buffers;
+    for(meow_umm Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        meow_u32 Partition = MeowPartitionOf(Hashes[Index], Shift, Bits);
+        MeowPartitionWrite(&Local, Partition, Tuples + Index*TupleSize, TupleSize);
+    }
+}
+
+static void
+MeowPartitionScatter(meow_partition_layout *Layout, void *TuplesInit, meow_u32 *Hashes, meow_umm Count,
+                     meow_u32 Shift, meow_u32 Bits, meow_partition_buffers *Buffers, void *OutputInit)
+{
+    meow_u8 *Tuples = (meow_u8 *)TuplesInit;
+    meow_u8 *Output = (meow_u8 *)OutputInit;
+    meow_umm TupleSize = Layout->TupleSize;
+    meow_umm FanOut = (meow_umm)1 << Bits;
+    for(meow_umm Partition = 0;
+        Partition < FanOut;
+        ++Partition)
+    {
+        Buffers->RunStart[Partition] = Output + Buffers->Offsets[Partition]*TupleSize;
+        Buffers->Cursor[Partition] = Buffers->RunStart[Partition];
+    }
+    
+    // NOTE: Common tuple sizes get their copies inlined
+    switch(TupleSize)
+    {
+        case 8: MeowPartitionScatterSize(Tuples, Hashes, Count, Shift, Bits, Buffers, 8); break;
+        case 16: MeowPartitionScatterSize(Tuples, Hashes, Count, Shift, Bits, Buffers, 16); break;
+        case 24: MeowPartitionScatterSize(Tuples, Hashes, Count, Shift, Bits, Buffers, 24); break;
+        case 32: MeowPartitionScatterSize(Tuples, Hashes, Count, Shift, Bits, Buffers, 32); break;
+        default: MeowPartitionScatterSize(Tuples, Hashes, Count, Shift, Bits, Buffers, TupleSize); break;
+    }
+    
+    //
+    // NOTE: Whatever is left in the buffers is the last, partial line of each run
+    //
+    
+    for(meow_u32 Partition = 0;
+        Partition < FanOut;
+        ++Partition)
+    {
+        meow_u8 *Cursor = Buffers->Cursor[Partition];
+        meow_u8 *LineStart = (meow_u8 *)((meow_umm)Cursor & ~(meow_umm)(MEOW_PARTITION_LINE - 1));
+        meow_u8 *From = (LineStart > Buffers->RunStart[Partition]) ? LineStart : Buffers->RunStart[Partition];
+        if(Cursor > From)
+        {
+            meow_u8 *Line = Buffers->Lines + Partition*MEOW_PARTITION_LINE;
+            memcpy(From, Line + (From - LineStart), Cursor - From);
+        }
+    }
+    
+    // NOTE: Streaming stores are weakly ordered, so fence before anyone reads the output
+    MeowPartitionFence();
+}
+
+static void
+MeowPartition(meow_partition_layout *Layout, meow_u32 Bits, void *Tuples, meow_umm Count, meow_u32 *Hashes,
+              meow_partition_buffers *Buffers, void *Output, meow_umm *Histogram)
+{
+    MeowPartitionHash(Layout, Tuples, Count, Hashes);
+    MeowPartitionHistogram(Hashes, Count, 32 - Bits, Bits, Histogram);
+    MeowPartitionLocalOffsets(Histogram, Bits, Buffers->Offsets);
+    MeowPartitionScatter(Layout, Tuples, Hashes, Count, 32 - Bits, Bits, Buffers, Output);
+}
+
+//
+// NOTE: Multi-pass.  Partitions are numbered top bits first, so every run of
+// an earlier pass is a contiguous range of the final histogram, and each
+// pass's offsets can be read straight off it.  Buffers must be set up for
+// PassBits.
+//
+
+static void
+MeowPartitionScatterHashes(meow_u32 *Hashes, meow_umm Count, meow_u32 Shift, meow_u32 Bits,
+                           meow_umm *Offsets, meow_u32 *Output)
+{
+    // NOTE: Advances Offsets, so call it after the tuple scatter that reads them
+    for(meow_umm Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        meow_u32 Hash = Hashes[Index];
+        Output[Offsets[MeowPartitionOf(Hash, Shift, Bits)]++] = Hash;
+    }
+}
+
+static void
+MeowPartitionMultiPass(meow_partition_layout *Layout, meow_u32 TotalBits, meow_u32 PassBits,
+                       void *Tuples, meow_umm Count, meow_u32 *Hashes, meow_u32 *ScratchHashes,
+                       meow_partition_buffers *Buffers, void *Scratch, void *Output, meow_umm *Histogram)
+{
+    meow_umm TupleSize = Layout->TupleSize;
+    MeowPartitionHash(Layout, Tuples, Count, Hashes);
+    MeowPartitionHistogram(Hashes, Count, 32 - TotalBits, TotalBits, Histogram);
+    
+    meow_u32 PassCount = (TotalBits + PassBits - 1) / PassBits;
+    if(PassCount == 0)
+    {
+        PassCount = 1;
+    }
+    meow_u8 *Source = (meow_u8 *)Tuples;
+    meow_u8 *Dest = (meow_u8 *)((PassCount & 1) ? Output : Scratch);
+    meow_u32 *SourceHashes = Hashes;
+    meow_u32 *DestHashes = ScratchHashes;
+    
+    meow_u32 BitsDone = 0;
+    for(meow_u32 Pass = 0;
+        Pass < PassCount;
+        ++Pass)
+    {
+        meow_u32 LevelBits = TotalBits - BitsDone;
+        if(LevelBits > PassBits)
+        {
+            LevelBits = PassBits;
+        }
+        meow_u32 Shift = 32 - BitsDone - LevelBits;
+        meow_umm ParentCount = (meow_umm)1 << BitsDone;
+        meow_umm ChildCount = (meow_umm)1 << LevelBits;
+        meow_umm LeavesPerChild = (meow_umm)1 << (TotalBits - BitsDone - LevelBits);
+        
+        meow_umm RunStart = 0;
+        meow_umm *Leaves = Histogram;
+        for(meow_umm Parent = 0;
+            Parent < ParentCount;
+            ++Parent)
+        {
+            meow_umm RunCount = 0;
+            for(meow_umm Child = 0;
+                Child < ChildCount;
+                ++Child)
+            {
+                Buffers->Offsets[Child] = RunCount;
+                for(meow_umm Leaf = 0;
+                    Leaf < LeavesPerChild;
+                    ++Leaf)
+                {
+                    RunCount += *Leaves++;
+                }
+            }
+            
+            if(RunCount)
+            {
+                MeowPartitionScatter(Layout, Source + RunStart*TupleSize, SourceHashes + RunStart, RunCount,
+                                     Shift, LevelBits, Buffers, Dest + RunStart*TupleSize);
+                
+                // NOTE: The hashes follow their tuples, so the next pass never rehashes
+                if((Pass + 1) < PassCount)
+                {
+                    MeowPartitionScatterHashes(SourceHashes + RunStart, RunCount, Shift, LevelBits,
+                                               Buffers->Offsets, DestHashes + RunStart);
+                }
+            }
+            RunStart += RunCount;
+        }
+        
+        Source = Dest;
+        Dest = (Dest == (meow_u8 *)Output) ? (meow_u8 *)Scratch : (meow_u8 *)Output;
+        meow_u32 *SwapHashes = SourceHashes;
+        SourceHashes = DestHashes;
+        DestHashes = SwapHashes;
+        BitsDone += LevelBits;
+    }
+}
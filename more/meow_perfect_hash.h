@@ -0,0 +1,551 @@
+/* ========================================================================
+   
+   meow_perfect_hash.h - minimal perfect hashing of static key sets
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   A minimal perfect hash maps each of a fixed set of N keys to its own
+   number in [0, N), with no collisions and without storing the keys.  It
+   is for key sets that are built once and read many times (symbol tables,
+   routing tables), where it replaces a hash table's slots with a few bits
+   per key, and the values go in a plain array indexed by the result:
+   
+       meow_umm BlobSize;
+       void *Blob = MeowPerfectHashBuildKeys(Count, Keys, Lens, Seed1, Seed2, 0, 0, &BlobSize);
+       fwrite(Blob, 1, BlobSize, File);
+       free(Blob);
+   
+       // NOTE: Later, on the mmap of that file
+       meow_perfect_hash Perfect;
+       if(MeowPerfectHashFromMemory(&Perfect, Mapping, MappingSize))
+       {
+           Value *V = Values + MeowPerfectHashKey(&Perfect, Len, Key);
+       }
+   
+   The blob is position-independent and is used where it lies, so startup
+   is just mapping it.  Keys that were not in the set still get a number,
+   which will be some other key's (or MEOW_PERFECT_MISSING) - keep a
+   fingerprint next to each value if non-members have to be rejected.
+   
+   The construction is BBHash: every key is hashed once, with
+   MeowHash_Accelerated(Seed1, Seed2, ...), and the two 64-bit halves of
+   that hash give one position per level from Low + Level*High.  Level 0 is a
+   bit array of Gamma*N bits; keys that land on a bit alone set it and are
+   done, the keys that collide move on to a smaller array at level 1, and
+   so on.  A key's number is the count of set bits before its bit, across
+   all levels.  The bit arrays are stored in 64-byte blocks of one running
+   count and 448 bits, so each level a query visits costs one cache line.
+   
+   Gamma trades space against query time.  Each level catches about
+   1/e^(1/Gamma) of what reaches it, so the expected cost is:
+   
+       Gamma   bits/key   levels visited
+       1.0     3.1        2.7
+       1.5     3.3        1.9   (the default, for Gamma = 0)
+       2.0     3.8        1.6
+   
+   Building runs ThreadCount threads (0 for one per core) over two passes
+   per level, and needs about 16 bytes per key of working memory on top of
+   the blob; MeowPerfectHashBuild takes hashes that are already computed,
+   with the seeds they were computed with.  Both return 0 if two keys have
+   the same 128-bit hash, which in practice means the same key was passed
+   twice.  The blob is identical for any thread count.
+   
+   Include meow_intrinsics.h and meow_hash.h first.  Needs threads.
+   
+   ======================================================================== */
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define MEOW_PERFECT_MAGIC 0x3146485057454F4Dull // NOTE: "MEOWPHF1"
+#define MEOW_PERFECT_VERSION 1
+#define MEOW_PERFECT_BLOCK_WORDS 8
+#define MEOW_PERFECT_BLOCK_BITS 448
+#define MEOW_PERFECT_MAX_LEVELS 48
+#define MEOW_PERFECT_DEFAULT_GAMMA 1.5f
+#define MEOW_PERFECT_MISSING (~0ull)
+
+// NOTE: Below this many keys, a pass is not worth starting threads for
+#define MEOW_PERFECT_MIN_PARALLEL 65536
+
+typedef struct meow_perfect_header
+{
+    meow_u64 Magic;
+    meow_u32 Version;
+    meow_u32 LevelCount;
+    meow_u64 Count;
+    meow_u64 Seed1;
+    meow_u64 Seed2;
+    meow_u64 LevelOffset;      // NOTE: LevelCount meow_perfect_levels
+    meow_u64 BlockOffset;      // NOTE: BlockCount blocks of MEOW_PERFECT_BLOCK_WORDS meow_u64s
+    meow_u64 BlockCount;
+    meow_u64 FallbackOffset;   // NOTE: FallbackCount hashes, as sorted Low, High pairs
+    meow_u64 FallbackCount;
+    meow_u64 Size;
+} meow_perfect_header;
+
+typedef struct meow_perfect_level
+{
+    meow_u64 BitCount;
+    meow_u64 FirstBlock;
+} meow_perfect_level;
+
+typedef struct meow_perfect_hash
+{
+    meow_perfect_header *Header;
+    meow_perfect_level *Levels;
+    meow_u64 *Blocks;
+    meow_u64 *Fallback;
+} meow_perfect_hash;
+
+static meow_u64
+MeowPerfectPopCount(meow_u64 Value)
+{
+#if _MSC_VER && MEOW_HASH_INTEL && MEOW_64BIT
+    meow_u64 Result = __popcnt64(Value);
+#elif _MSC_VER && MEOW_HASH_INTEL
+    meow_u64 Result = __popcnt((meow_u32)Value) + __popcnt((meow_u32)(Value >> 32));
+#elif _MSC_VER
+    meow_u64 Result = _CountOneBits64(Value);
+#else
+    meow_u64 Result = __builtin_popcountll(Value);
+#endif
+    return(Result);
+}
+
+// NOTE: Maps a uniform 64-bit value onto [0, Range) with a multiply rather than a divide
+static meow_u64
+MeowPerfectReduce(meow_u64 Value, meow_u64 Range)
+{
+#if _MSC_VER && MEOW_64BIT
+    meow_u64 Result = __umulh(Value, Range);
+#elif MEOW_64BIT
+    meow_u64 Result = (meow_u64)(((unsigned __int128)Value * Range) >> 64);
+#else
+    meow_u64 ValueLow = (meow_u32)Value;
+    meow_u64 ValueHigh = Value >> 32;
+    meow_u64 RangeLow = (meow_u32)Range;
+    meow_u64 RangeHigh = Range >> 32;
+    meow_u64 Middle = (ValueLow*RangeLow >> 32) + (meow_u32)(ValueHigh*RangeLow) + (meow_u32)(ValueLow*RangeHigh);
+    meow_u64 Result = ValueHigh*RangeHigh + (ValueHigh*RangeLow >> 32) + (ValueLow*RangeHigh >> 32) + (Middle >> 32);
+#endif
+    return(Result);
+}
+
+// NOTE: Two keys whose hashes are close in both halves stay close along
+// Low + Level*High, so it gets a multiply-xorshift to push small
+// differences up into the top bits that MeowPerfectReduce uses
+static meow_u64
+MeowPerfectPosition(meow_u64 Low, meow_u64 High, meow_u32 Level, meow_u64 BitCount)
+{
+    meow_u64 Mixed = Low + Level*High;
+    Mixed ^= Mixed >> 32;
+    Mixed *= 0xD6E8FEB86659FD93ull;
+    Mixed ^= Mixed >> 32;
+    meow_u64 Result = MeowPerfectReduce(Mixed, BitCount);
+    return(Result);
+}
+
+static meow_u64
+MeowPerfectAlign(meow_u64 Offset)
+{
+    meow_u64 Result = (Offset + 63) & ~(meow_u64)63;
+    return(Result);
+}
+
+//
+// NOTE: Building
+//
+
+// NOTE: Runs Work(Thread, Begin, End) over ThreadCount even slices of [0, Count)
+template<typename work>
+static void
+MeowPerfectParallel(int ThreadCount, meow_umm Count, work Work)
+{
+    if(Count < MEOW_PERFECT_MIN_PARALLEL)
+    {
+        ThreadCount = 1;
+    }
+    
+    std::vector<std::thread> Threads;
+    for(int Thread = 1;
+        Thread < ThreadCount;
+        ++Thread)
+    {
+        meow_umm Begin = (meow_umm)((meow_u64)Count*Thread / ThreadCount);
+        meow_umm End = (meow_umm)((meow_u64)Count*(Thread + 1) / ThreadCount);
+        Threads.emplace_back(Work, Thread, Begin, End);
+    }
+    
+    Work(0, (meow_umm)0, (meow_umm)((meow_u64)Count / ThreadCount));
+    
+    for(size_t Thread = 0;
+        Thread < Threads.size();
+        ++Thread)
+    {
+        Threads[Thread].join();
+    }
+}
+
+static int
+MeowPerfectPairLess(meow_u64 const *A, meow_u64 const *B)
+{
+    int Result = (A[1] < B[1]) || ((A[1] == B[1]) && (A[0] < B[0]));
+    return(Result);
+}
+
+// NOTE: Pairs holds Count hashes as Low, High, and is used as scratch
+static void *
+MeowPerfectHashBuildPairs(meow_umm Count, meow_u64 *Pairs, meow_u64 Seed1, meow_u64 Seed2, float Gamma, int ThreadCount, meow_umm *Size)
+{
+    if(Gamma <= 0)
+    {
+        Gamma = MEOW_PERFECT_DEFAULT_GAMMA;
+    }
+    
+    meow_perfect_level Levels[MEOW_PERFECT_MAX_LEVELS];
+    std::vector<meow_u64> Bits;
+    std::vector<meow_umm> Survivors(ThreadCount);
+    
+    meow_u32 LevelCount = 0;
+    meow_umm Remaining = Count;
+    while(Remaining && (LevelCount < MEOW_PERFECT_MAX_LEVELS))
+    {
+        meow_u32 Level = LevelCount++;
+        meow_u64 BlockCount = ((meow_u64)((double)Gamma*(double)Remaining) + MEOW_PERFECT_BLOCK_BITS) / MEOW_PERFECT_BLOCK_BITS;
+        meow_u64 BitCount = BlockCount*MEOW_PERFECT_BLOCK_BITS;
+        meow_u64 WordCount = BitCount / 64;
+        Levels[Level].BitCount = BitCount;
+        Levels[Level].FirstBlock = Bits.size() / (MEOW_PERFECT_BLOCK_WORDS - 1);
+        
+        // NOTE: A bit that is set in Taken and not in Collided had exactly one key land on it
+        std::atomic<meow_u64> *Taken = new std::atomic<meow_u64>[WordCount]();
+        std::atomic<meow_u64> *Collided = new std::atomic<meow_u64>[WordCount]();
+        MeowPerfectParallel(ThreadCount, Remaining, [&](int, meow_umm Begin, meow_umm End)
+        {
+            for(meow_umm Index = Begin;
+                Index < End;
+                ++Index)
+            {
+                meow_u64 Position = MeowPerfectPosition(Pairs[2*Index], Pairs[2*Index + 1], Level, BitCount);
+                meow_u64 Bit = 1ull << (Position % 64);
+                if(Taken[Position / 64].fetch_or(Bit, std::memory_order_relaxed) & Bit)
+                {
+                    Collided[Position / 64].fetch_or(Bit, std::memory_order_relaxed);
+                }
+            }
+        });
+        
+        // NOTE: Each slice packs the keys that go on to the next level to its own front
+        MeowPerfectParallel(ThreadCount, Remaining, [&](int Thread, meow_umm Begin, meow_umm End)
+        {
+            meow_umm Kept = Begin;
+            for(meow_umm Index = Begin;
+                Index < End;
+                ++Index)
+            {
+                meow_u64 Position = MeowPerfectPosition(Pairs[2*Index], Pairs[2*Index + 1], Level, BitCount);
+                if(Collided[Position / 64].load(std::memory_order_relaxed) & (1ull << (Position % 64)))
+                {
+                    Pairs[2*Kept] = Pairs[2*Index];
+                    Pairs[2*Kept + 1] = Pairs[2*Index + 1];
+                    ++Kept;
+                }
+            }
+            Survivors[Thread] = Kept - Begin;
+        });
+        
+        int SliceCount = (Remaining < MEOW_PERFECT_MIN_PARALLEL) ? 1 : ThreadCount;
+        meow_umm NextRemaining = 0;
+        for(int Thread = 0;
+            Thread < SliceCount;
+            ++Thread)
+        {
+            meow_umm Begin = (meow_umm)((meow_u64)Remaining*Thread / SliceCount);
+            memmove(Pairs + 2*NextRemaining, Pairs + 2*Begin, Survivors[Thread]*2*sizeof(meow_u64));
+            NextRemaining += Survivors[Thread];
+        }
+        Remaining = NextRemaining;
+        
+        for(meow_u64 Word = 0;
+            Word < WordCount;
+            ++Word)
+        {
+            Bits.push_back(Taken[Word].load(std::memory_order_relaxed) & ~Collided[Word].load(std::memory_order_relaxed));
+        }
+        delete [] Collided;
+        delete [] Taken;
+    }
+    
+    // NOTE: Whatever is left after the last level is stored whole and binary searched
+    meow_umm FallbackCount = Remaining;
+    std::vector<meow_u64 *> Sorted(FallbackCount);
+    for(meow_umm Index = 0;
+        Index < FallbackCount;
+        ++Index)
+    {
+        Sorted[Index] = Pairs + 2*Index;
+    }
+    std::sort(Sorted.begin(), Sorted.end(), MeowPerfectPairLess);
+    for(meow_umm Index = 1;
+        Index < FallbackCount;
+        ++Index)
+    {
+        if(!MeowPerfectPairLess(Sorted[Index - 1], Sorted[Index]))
+        {
+            return(0);
+        }
+    }
+    
+    meow_perfect_header Header = {};
+    Header.Magic = MEOW_PERFECT_MAGIC;
+    Header.Version = MEOW_PERFECT_VERSION;
+    Header.LevelCount = LevelCount;
+    Header.Count = Count;
+    Header.Seed1 = Seed1;
+    Header.Seed2 = Seed2;
+    Header.LevelOffset = MeowPerfectAlign(sizeof(Header));
+    Header.BlockOffset = MeowPerfectAlign(Header.LevelOffset + LevelCount*sizeof(meow_perfect_level));
+    Header.BlockCount = Bits.size() / (MEOW_PERFECT_BLOCK_WORDS - 1);
+    Header.FallbackOffset = Header.BlockOffset + Header.BlockCount*MEOW_PERFECT_BLOCK_WORDS*sizeof(meow_u64);
+    Header.FallbackCount = FallbackCount;
+    Header.Size = Header.FallbackOffset + FallbackCount*2*sizeof(meow_u64);
+    
+    meow_u8 *Blob = (meow_u8 *)calloc(1, (size_t)Header.Size);
+    if(Blob)
+    {
+        memcpy(Blob, &Header, sizeof(Header));
+        memcpy(Blob + Header.LevelOffset, Levels, LevelCount*sizeof(meow_perfect_level));
+        
+        meow_u64 *Blocks = (meow_u64 *)(Blob + Header.BlockOffset);
+        meow_u64 Rank = 0;
+        for(meow_u64 Block = 0;
+            Block < Header.BlockCount;
+            ++Block)
+        {
+            meow_u64 *Dest = Blocks + Block*MEOW_PERFECT_BLOCK_WORDS;
+            meow_u64 const *Source = Bits.data() + Block*(MEOW_PERFECT_BLOCK_WORDS - 1);
+            Dest[0] = Rank;
+            for(int Word = 0;
+                Word < (MEOW_PERFECT_BLOCK_WORDS - 1);
+                ++Word)
+            {
+                Dest[Word + 1] = Source[Word];
+                Rank += MeowPerfectPopCount(Source[Word]);
+            }
+        }
+        
+        meow_u64 *Fallback = (meow_u64 *)(Blob + Header.FallbackOffset);
+        for(meow_umm Index = 0;
+            Index < FallbackCount;
+            ++Index)
+        {
+            Fallback[2*Index] = Sorted[Index][0];
+            Fallback[2*Index + 1] = Sorted[Index][1];
+        }
+        
+        *Size = (meow_umm)Header.Size;
+    }
+    
+    return(Blob);
+}
+
+static int
+MeowPerfectThreadCount(int ThreadCount)
+{
+    if(ThreadCount <= 0)
+    {
+        ThreadCount = (int)std::thread::hardware_concurrency();
+    }
+    int Result = (ThreadCount > 0) ? ThreadCount : 1;
+    return(Result);
+}
+
+// NOTE: Hashes must have been made with MeowHash_Accelerated(Seed1, Seed2, ...) for MeowPerfectHashKey to work
+static inline void *
+MeowPerfectHashBuild(meow_umm Count, meow_hash *Hashes, meow_u64 Seed1, meow_u64 Seed2, float Gamma, int ThreadCount, meow_umm *Size)
+{
+    void *Result = 0;
+    
+    ThreadCount = MeowPerfectThreadCount(ThreadCount);
+    meow_u64 *Pairs = (meow_u64 *)malloc((Count ? Count : 1)*2*sizeof(meow_u64));
+    if(Pairs)
+    {
+        MeowPerfectParallel(ThreadCount, Count, [&](int, meow_umm Begin, meow_umm End)
+        {
+            for(meow_umm Index = Begin;
+                Index < End;
+                ++Index)
+            {
+                Pairs[2*Index] = MeowU64From(Hashes[Index], 0);
+                Pairs[2*Index + 1] = MeowU64From(Hashes[Index], 1);
+            }
+        });
+        
+        Result = MeowPerfectHashBuildPairs(Count, Pairs, Seed1, Seed2, Gamma, ThreadCount, Size);
+        free(Pairs);
+    }
+    
+    return(Result);
+}
+
+static void *
+MeowPerfectHashBuildKeys(meow_umm Count, void **Keys, meow_umm *Lens, meow_u64 Seed1, meow_u64 Seed2, float Gamma, int ThreadCount, meow_umm *Size)
+{
+    void *Result = 0;
+    
+    ThreadCount = MeowPerfectThreadCount(ThreadCount);
+    meow_u64 *Pairs = (meow_u64 *)malloc((Count ? Count : 1)*2*sizeof(meow_u64));
+    if(Pairs)
+    {
+        MeowPerfectParallel(ThreadCount, Count, [&](int, meow_umm Begin, meow_umm End)
+        {
+            for(meow_umm Index = Begin;
+                Index < End;
+                ++Index)
+            {
+                meow_hash Hash = MeowHash_Accelerated(Seed1, Seed2, Lens[Index], Keys[Index]);
+                Pairs[2*Index] = MeowU64From(Hash, 0);
+                Pairs[2*Index + 1] = MeowU64From(Hash, 1);
+            }
+        });
+        
+        Result = MeowPerfectHashBuildPairs(Count, Pairs, Seed1, Seed2, Gamma, ThreadCount, Size);
+        free(Pairs);
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Querying
+//
+
+// NOTE: True if Count elements of ElementSize bytes starting at Offset fit
+// in Limit bytes and are 8-byte aligned, written so that nothing can overflow
+static int
+MeowPerfectFits(meow_u64 Offset, meow_u64 Count, meow_u64 ElementSize, meow_u64 Limit)
+{
+    int Result = (((Offset % sizeof(meow_u64)) == 0) &&
+                  (Offset <= Limit) &&
+                  (Count <= ((Limit - Offset) / ElementSize)));
+    return(Result);
+}
+
+static int
+MeowPerfectHashFromMemory(meow_perfect_hash *Perfect, void *Memory, meow_umm Size)
+{
+    memset(Perfect, 0, sizeof(*Perfect));
+    
+    meow_perfect_header *Header = (meow_perfect_header *)Memory;
+    int Result = (Memory &&
+                  ((((meow_umm)Memory) % sizeof(meow_u64)) == 0) &&
+                  (Size >= sizeof(meow_perfect_header)) &&
+                  (Header->Magic == MEOW_PERFECT_MAGIC) &&
+                  (Header->Version == MEOW_PERFECT_VERSION) &&
+                  (Header->LevelCount <= MEOW_PERFECT_MAX_LEVELS) &&
+                  (Header->Size <= Size) &&
+                  MeowPerfectFits(Header->LevelOffset, Header->LevelCount, sizeof(meow_perfect_level), Header->Size) &&
+                  MeowPerfectFits(Header->BlockOffset, Header->BlockCount, MEOW_PERFECT_BLOCK_WORDS*sizeof(meow_u64), Header->Size) &&
+                  MeowPerfectFits(Header->FallbackOffset, Header->FallbackCount, 2*sizeof(meow_u64), Header->Size));
+    if(Result)
+    {
+        meow_u8 *Base = (meow_u8 *)Memory;
+        meow_perfect_level *Levels = (meow_perfect_level *)(Base + Header->LevelOffset);
+        for(meow_u32 Level = 0;
+            Level < Header->LevelCount;
+            ++Level)
+        {
+            // NOTE: Every bit a level can address has to be inside the blocks
+            Result &= ((Levels[Level].BitCount % MEOW_PERFECT_BLOCK_BITS) == 0) &&
+                      (Levels[Level].FirstBlock <= Header->BlockCount) &&
+                      (Levels[Level].BitCount / MEOW_PERFECT_BLOCK_BITS <= Header->BlockCount - Levels[Level].FirstBlock);
+        }
+        
+        if(Result)
+        {
+            Perfect->Header = Header;
+            Perfect->Levels = Levels;
+            Perfect->Blocks = (meow_u64 *)(Base + Header->BlockOffset);
+            Perfect->Fallback = (meow_u64 *)(Base + Header->FallbackOffset);
+        }
+    }
+    
+    return(Result);
+}
+
+// NOTE: Returns the hash's number in [0, Count) if it was in the set, and anything otherwise
+static meow_u64
+MeowPerfectHashOf(meow_perfect_hash *Perfect, meow_hash Hash)
+{
+    meow_perfect_header *Header = Perfect->Header;
+    meow_u64 Low = MeowU64From(Hash, 0);
+    meow_u64 High = MeowU64From(Hash, 1);
+    
+    for(meow_u32 Level = 0;
+        Level < Header->LevelCount;
+        ++Level)
+    {
+        meow_perfect_level *Info = Perfect->Levels + Level;
+        meow_u64 Position = MeowPerfectPosition(Low, High, Level, Info->BitCount);
+        meow_u64 *Block = Perfect->Blocks + (Info->FirstBlock + Position / MEOW_PERFECT_BLOCK_BITS)*MEOW_PERFECT_BLOCK_WORDS;
+        meow_u32 Bit = (meow_u32)(Position % MEOW_PERFECT_BLOCK_BITS);
+        meow_u32 Word = 1 + Bit / 64;
+        meow_u64 Below = (1ull << (Bit % 64)) - 1;
+        if(Block[Word] & (Below + 1))
+        {
+            meow_u64 Result = Block[0] + MeowPerfectPopCount(Block[Word] & Below);
+            for(meow_u32 Before = 1;
+                Before < Word;
+                ++Before)
+            {
+                Result += MeowPerfectPopCount(Block[Before]);
+            }
+            return(Result);
+        }
+    }
+    
+    meow_u64 First = 0;
+    meow_u64 Last = Header->FallbackCount;
+    while(First < Last)
+    {
+        meow_u64 Middle = First + (Last - First)/2;
+        meow_u64 *Pair = Perfect->Fallback + 2*Middle;
+        if((Pair[1] < High) || ((Pair[1] == High) && (Pair[0] < Low)))
+        {
+            First = Middle + 1;
+        }
+        else
+        {
+            Last = Middle;
+        }
+    }
+    
+    meow_u64 Result = MEOW_PERFECT_MISSING;
+    if((First < Header->FallbackCount) &&
+       (Perfect->Fallback[2*First] == Low) &&
+       (Perfect->Fallback[2*First + 1] == High))
+    {
+        Result = (Header->Count - Header->FallbackCount) + First;
+    }
+    
+    return(Result);
+}
+
+static meow_u64
+MeowPerfectHashKey(meow_perfect_hash *Perfect, meow_umm Len, void *Key)
+{
+    meow_hash Hash = MeowHash_Accelerated(Perfect->Header->Seed1, Perfect->Header->Seed2, Len, Key);
+    meow_u64 Result = MeowPerfectHashOf(Perfect, Hash);
+    return(Result);
+}
@@ -0,0 +1,601 @@
+/* ========================================================================
+   
+   meow_placement.h - rendezvous, jump and ring placement of keys on nodes
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Sends each key to one of a set of nodes (shards, servers, disks) so
+   that every node gets its share and few keys move when nodes come and go.
+   
+   Rendezvous (highest random weight) hashing scores the key against every
+   node and picks the best score, so removing a node only moves the keys
+   that were on it, and adding one only takes keys from the others:
+   
+       meow_placement Placement;
+       MeowPlacementInit(&Placement, MaxNodes);
+       MeowPlacementAddNode(&Placement, NameLength, Name);  // NOTE: Returns the node's index
+       MeowPlacementEnableNode(&Placement, Index, 0);       // NOTE: Drain without renumbering
+   
+       meow_hash Key = MeowHash_Accelerated(0, 0, KeyLength, KeyBytes);
+       meow_u32 Node = MeowPlacementRendezvous(&Placement, Key);
+       MeowPlacementFree(&Placement);
+   
+   The usual way to do this hashes the key once per node.  Here the key
+   is hashed once, and each node is scored with a few 32-bit multiplies and
+   shifts of that hash against two seeds the node got from its name, 8
+   nodes at a time with AVX2 (picked at run time) and 4 with SSE4.1 or
+   NEON.  The score for a node is the same whatever width did it, and ties
+   go to the lower index, so every machine places every key the same way.
+   Scoring hundreds of nodes costs less than hashing a short key.
+   
+   Nodes are seeded from their names, not their positions, so two
+   processes that add the same names in different orders place keys the
+   same way - but indexes then differ, so map back through the names.
+   
+   MeowPlacementJump is Lamping and Veach's jump consistent hash: no
+   state, O(log N) time, and a perfectly even split, but nodes can only be
+   added or removed at the end:
+   
+       meow_u32 Bucket = MeowPlacementJump(Key, BucketCount);
+   
+   The ring is classic consistent hashing, with PointsPerNode points per
+   enabled node (times its weight, if there are weights) sorted around a
+   64-bit circle, and a key going to the first point after it.  It is a
+   binary search rather than a scan of every node, so it wins at thousands
+   of nodes, and weights are easy; it is less even than the other two
+   unless there are a lot of points:
+   
+       meow_ring Ring;
+       MeowRingBuild(&Ring, &Placement, 160, Weights);      // NOTE: Weights may be 0
+       meow_u32 Node = MeowRingLookup(&Ring, Key);
+       MeowRingFree(&Ring);
+   
+   Bounded loads (Mirrokni, Thorup and Zadimoghaddam) cap every node at
+   (1 + Epsilon) times its fair share of some number of keys.  A key goes
+   to the best node by rendezvous score, or the next point round the ring,
+   that is not full yet:
+   
+       meow_placement_loads Loads;
+       MeowPlacementLoadsInit(&Loads, &Placement, ExpectedKeys, 0.25);
+       meow_u32 Node = MeowPlacementAssign(&Placement, &Loads, Key);
+       meow_u32 Node = MeowRingAssign(&Ring, &Loads, Key);
+       MeowPlacementRelease(&Loads, Node);                  // NOTE: When a key goes away
+       MeowPlacementLoadsFree(&Loads);
+   
+   Everything returns MEOW_PLACEMENT_NONE if no node can take the key.
+   Rendezvous placement uses the whole 128-bit key hash, the ring uses the
+   high 64 bits, and jump uses the low 64 bits.
+   
+   Include meow_intrinsics.h and meow_hash.h first, and on x64 also
+   more/megapaw_hash.h, whose CPUID helpers pick the AVX2 path.  Needs
+   SSE4.1 on x64.
+   
+   ======================================================================== */
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+
+#define MEOW_PLACEMENT_NONE 0xFFFFFFFFu
+#define MEOW_PLACEMENT_WIDTH 8
+
+typedef struct meow_placement
+{
+    meow_u32 NodeCount;
+    meow_u32 MaxNodes;      // NOTE: Rounded up to MEOW_PLACEMENT_WIDTH
+    
+    // NOTE: Node I's seeds, and ~0 if it is enabled or 0 if it is not (or does not exist)
+    meow_u32 *SeedA;
+    meow_u32 *SeedB;
+    meow_u32 *Enabled;
+    
+    int UseAVX2;
+} meow_placement;
+
+typedef struct meow_placement_loads
+{
+    meow_u32 *Load;
+    meow_u32 *Open;         // NOTE: Enabled and not full, as a mask like meow_placement.Enabled
+    meow_u32 NodeCount;
+    meow_u32 Capacity;
+} meow_placement_loads;
+
+//
+// NOTE: Scoring.  A node's score is a 32-bit mix of the key's low and high
+// halves with its seeds, forced odd so that masked-off nodes (score 0)
+// never win.
+//
+
+static meow_u32
+MeowPlacementScore(meow_placement *Placement, meow_u32 Node, meow_u32 KeyA, meow_u32 KeyB)
+{
+    meow_u32 X = KeyA ^ Placement->SeedA[Node];
+    X ^= X >> 16;
+    X *= 0x85EBCA6Bu;
+    X ^= X >> 13;
+    X ^= KeyB ^ Placement->SeedB[Node];
+    X *= 0xC2B2AE35u;
+    X ^= X >> 16;
+    
+    meow_u32 Result = (X | 1) & Placement->Enabled[Node];
+    return(Result);
+}
+
+static void
+MeowPlacementKey(meow_hash Key, meow_u32 *KeyA, meow_u32 *KeyB)
+{
+    meow_u64 Low = MeowU64From(Key, 0);
+    meow_u64 High = MeowU64From(Key, 1);
+    *KeyA = (meow_u32)(Low ^ (Low >> 32));
+    *KeyB = (meow_u32)(High ^ (High >> 32));
+}
+
+// NOTE: Ties go to the lower node, the same as a scalar scan would give
+static meow_u32
+MeowPlacementPick(meow_u32 *Scores, meow_u32 *Nodes, int Count)
+{
+    meow_u32 BestScore = 0;
+    meow_u32 Result = MEOW_PLACEMENT_NONE;
+    for(int Lane = 0;
+        Lane < Count;
+        ++Lane)
+    {
+        if((Scores[Lane] > BestScore) || ((Scores[Lane] == BestScore) && BestScore && (Nodes[Lane] < Result)))
+        {
+            BestScore = Scores[Lane];
+            Result = Nodes[Lane];
+        }
+    }
+    
+    return(Result);
+}
+
+#if MEOW_HASH_INTEL
+
+#if _MSC_VER
+#define MEOW_PLACEMENT_TARGET_AVX2
+#else
+#define MEOW_PLACEMENT_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+MEOW_PLACEMENT_TARGET_AVX2 static meow_u32
+MeowPlacementBestAVX2(meow_placement *Placement, meow_u32 KeyA, meow_u32 KeyB, meow_u32 *Mask)
+{
+    __m256i A = _mm256_set1_epi32((int)KeyA);
+    __m256i B = _mm256_set1_epi32((int)KeyB);
+    __m256i Sign = _mm256_set1_epi32((int)0x80000000u);
+    __m256i BestScore = _mm256_setzero_si256();
+    __m256i BestNode = _mm256_setzero_si256();
+    __m256i Node = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i Step = _mm256_set1_epi32(8);
+    for(meow_u32 Base = 0;
+        Base < Placement->NodeCount;
+        Base += 8)
+    {
+        __m256i X = _mm256_xor_si256(A, _mm256_loadu_si256((__m256i *)(Placement->SeedA + Base)));
+        X = _mm256_xor_si256(X, _mm256_srli_epi32(X, 16));
+        X = _mm256_mullo_epi32(X, _mm256_set1_epi32((int)0x85EBCA6Bu));
+        X = _mm256_xor_si256(X, _mm256_srli_epi32(X, 13));
+        X = _mm256_xor_si256(X, _mm256_xor_si256(B, _mm256_loadu_si256((__m256i *)(Placement->SeedB + Base))));
+        X = _mm256_mullo_epi32(X, _mm256_set1_epi32((int)0xC2B2AE35u));
+        X = _mm256_xor_si256(X, _mm256_srli_epi32(X, 16));
+        X = _mm256_and_si256(_mm256_or_si256(X, _mm256_set1_epi32(1)), _mm256_loadu_si256((__m256i *)(Mask + Base)));
+        
+        __m256i Better = _mm256_cmpgt_epi32(_mm256_xor_si256(X, Sign), _mm256_xor_si256(BestScore, Sign));
+        BestScore = _mm256_max_epu32(BestScore, X);
+        BestNode = _mm256_blendv_epi8(BestNode, Node, Better);
+        Node = _mm256_add_epi32(Node, Step);
+    }
+    
+    meow_u32 Scores[8];
+    meow_u32 Nodes[8];
+    _mm256_storeu_si256((__m256i *)Scores, BestScore);
+    _mm256_storeu_si256((__m256i *)Nodes, BestNode);
+    meow_u32 Result = MeowPlacementPick(Scores, Nodes, 8);
+    return(Result);
+}
+
+static meow_u32
+MeowPlacementBest(meow_placement *Placement, meow_u32 KeyA, meow_u32 KeyB, meow_u32 *Mask)
+{
+    if(Placement->UseAVX2)
+    {
+        return(MeowPlacementBestAVX2(Placement, KeyA, KeyB, Mask));
+    }
+    
+    __m128i A = _mm_set1_epi32((int)KeyA);
+    __m128i B = _mm_set1_epi32((int)KeyB);
+    __m128i Sign = _mm_set1_epi32((int)0x80000000u);
+    __m128i BestScore = _mm_setzero_si128();
+    __m128i BestNode = _mm_setzero_si128();
+    __m128i Node = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i Step = _mm_set1_epi32(4);
+    for(meow_u32 Base = 0;
+        Base < Placement->NodeCount;
+        Base += 4)
+    {
+        __m128i X = _mm_xor_si128(A, _mm_loadu_si128((__m128i *)(Placement->SeedA + Base)));
+        X = _mm_xor_si128(X, _mm_srli_epi32(X, 16));
+        X = _mm_mullo_epi32(X, _mm_set1_epi32((int)0x85EBCA6Bu));
+        X = _mm_xor_si128(X, _mm_srli_epi32(X, 13));
+        X = _mm_xor_si128(X, _mm_xor_si128(B, _mm_loadu_si128((__m128i *)(Placement->SeedB + Base))));
+        X = _mm_mullo_epi32(X, _mm_set1_epi32((int)0xC2B2AE35u));
+        X = _mm_xor_si128(X, _mm_srli_epi32(X, 16));
+        X = _mm_and_si128(_mm_or_si128(X, _mm_set1_epi32(1)), _mm_loadu_si128((__m128i *)(Mask + Base)));
+        
+        __m128i Better = _mm_cmpgt_epi32(_mm_xor_si128(X, Sign), _mm_xor_si128(BestScore, Sign));
+        BestScore = _mm_max_epu32(BestScore, X);
+        BestNode = _mm_blendv_epi8(BestNode, Node, Better);
+        Node = _mm_add_epi32(Node, Step);
+    }
+    
+    meow_u32 Scores[4];
+    meow_u32 Nodes[4];
+    _mm_storeu_si128((__m128i *)Scores, BestScore);
+    _mm_storeu_si128((__m128i *)Nodes, BestNode);
+    meow_u32 Result = MeowPlacementPick(Scores, Nodes, 4);
+    return(Result);
+}
+
+static int
+MeowPlacementHasAVX2(void)
+{
+    // NOTE: The CPU has to have AVX2, and the OS has to save the YMM registers
+    int Result = 0;
+    
+    int unsigned Regs[4];
+    MegapawCPUID(Regs, 0, 0);
+    int unsigned MaxLeaf = Regs[0];
+    
+    MegapawCPUID(Regs, 1, 0);
+    int HasOSXSAVE = (Regs[2] >> 27) & 1;
+    int HasAVX = (Regs[2] >> 28) & 1;
+    
+    if(HasOSXSAVE && HasAVX && (MaxLeaf >= 7) && ((MegapawXCR0() & 0x6) == 0x6))
+    {
+        MegapawCPUID(Regs, 7, 0);
+        Result = (Regs[1] >> 5) & 1;
+    }
+    
+    return(Result);
+}
+
+#elif MEOW_HASH_ARMV8
+
+static meow_u32
+MeowPlacementBest(meow_placement *Placement, meow_u32 KeyA, meow_u32 KeyB, meow_u32 *Mask)
+{
+    uint32x4_t A = vdupq_n_u32(KeyA);
+    uint32x4_t B = vdupq_n_u32(KeyB);
+    uint32x4_t BestScore = vdupq_n_u32(0);
+    uint32x4_t BestNode = vdupq_n_u32(0);
+    meow_u32 FirstNodes[4] = {0, 1, 2, 3};
+    uint32x4_t Node = vld1q_u32(FirstNodes);
+    for(meow_u32 Base = 0;
+        Base < Placement->NodeCount;
+        Base += 4)
+    {
+        uint32x4_t X = veorq_u32(A, vld1q_u32(Placement->SeedA + Base));
+        X = veorq_u32(X, vshrq_n_u32(X, 16));
+        X = vmulq_n_u32(X, 0x85EBCA6Bu);
+        X = veorq_u32(X, vshrq_n_u32(X, 13));
+        X = veorq_u32(X, veorq_u32(B, vld1q_u32(Placement->SeedB + Base)));
+        X = vmulq_n_u32(X, 0xC2B2AE35u);
+        X = veorq_u32(X, vshrq_n_u32(X, 16));
+        X = vandq_u32(vorrq_u32(X, vdupq_n_u32(1)), vld1q_u32(Mask + Base));
+        
+        uint32x4_t Better = vcgtq_u32(X, BestScore);
+        BestScore = vmaxq_u32(BestScore, X);
+        BestNode = vbslq_u32(Better, Node, BestNode);
+        Node = vaddq_u32(Node, vdupq_n_u32(4));
+    }
+    
+    meow_u32 Scores[4];
+    meow_u32 Nodes[4];
+    vst1q_u32(Scores, BestScore);
+    vst1q_u32(Nodes, BestNode);
+    meow_u32 Result = MeowPlacementPick(Scores, Nodes, 4);
+    return(Result);
+}
+
+static int
+MeowPlacementHasAVX2(void)
+{
+    return(0);
+}
+
+#endif
+
+//
+// NOTE: Nodes
+//
+
+static void
+MeowPlacementInit(meow_placement *Placement, meow_u32 MaxNodes)
+{
+    memset(Placement, 0, sizeof(*Placement));
+    Placement->MaxNodes = (MaxNodes + (MEOW_PLACEMENT_WIDTH - 1)) & ~(meow_u32)(MEOW_PLACEMENT_WIDTH - 1);
+    meow_umm Size = (Placement->MaxNodes ? Placement->MaxNodes : MEOW_PLACEMENT_WIDTH)*sizeof(meow_u32);
+    Placement->SeedA = (meow_u32 *)calloc(1, Size);
+    Placement->SeedB = (meow_u32 *)calloc(1, Size);
+    Placement->Enabled = (meow_u32 *)calloc(1, Size);
+    Placement->UseAVX2 = MeowPlacementHasAVX2();
+}
+
+static void
+MeowPlacementFree(meow_placement *Placement)
+{
+    free(Placement->SeedA);
+    free(Placement->SeedB);
+    free(Placement->Enabled);
+    memset(Placement, 0, sizeof(*Placement));
+}
+
+// NOTE: Returns the new node's index, or MEOW_PLACEMENT_NONE if there are already MaxNodes
+static meow_u32
+MeowPlacementAddNode(meow_placement *Placement, meow_umm NameLength, void *Name)
+{
+    meow_u32 Result = MEOW_PLACEMENT_NONE;
+    if(Placement->NodeCount < Placement->MaxNodes)
+    {
+        meow_hash Hash = MeowHash_Accelerated(0x706C6163656D656Eull, 0, NameLength, Name);
+        Result = Placement->NodeCount++;
+        Placement->SeedA[Result] = MeowU32From(Hash, 0);
+        Placement->SeedB[Result] = MeowU32From(Hash, 1);
+        Placement->Enabled[Result] = 0xFFFFFFFFu;
+    }
+    
+    return(Result);
+}
+
+static void
+MeowPlacementEnableNode(meow_placement *Placement, meow_u32 Node, int Enabled)
+{
+    Placement->Enabled[Node] = Enabled ? 0xFFFFFFFFu : 0;
+}
+
+static meow_u32
+MeowPlacementRendezvous(meow_placement *Placement, meow_hash Key)
+{
+    meow_u32 KeyA, KeyB;
+    MeowPlacementKey(Key, &KeyA, &KeyB);
+    meow_u32 Result = MeowPlacementBest(Placement, KeyA, KeyB, Placement->Enabled);
+    return(Result);
+}
+
+//
+// NOTE: Jump consistent hash, from "A Fast, Minimal Memory, Consistent Hash
+// Algorithm" (Lamping and Veach, 2014)
+//
+
+static meow_u32
+MeowPlacementJump(meow_hash Key, meow_u32 BucketCount)
+{
+    meow_u64 State = MeowU64From(Key, 0);
+    meow_u64 Bucket = MEOW_PLACEMENT_NONE;
+    meow_u64 Next = 0;
+    while(Next < BucketCount)
+    {
+        Bucket = Next;
+        State = State*2862933555777941757ull + 1;
+        Next = (meow_u64)((double)(Bucket + 1)*((double)(1ull << 31) / (double)((State >> 33) + 1)));
+    }
+    
+    meow_u32 Result = (meow_u32)Bucket;
+    return(Result);
+}
+
+//
+// NOTE: Bounded loads
+//
+
+static void
+MeowPlacementLoadsInit(meow_placement_loads *Loads, meow_placement *Placement, meow_u64 ExpectedKeys, double Epsilon)
+{
+    meow_u32 EnabledCount = 0;
+    for(meow_u32 Node = 0;
+        Node < Placement->NodeCount;
+        ++Node)
+    {
+        EnabledCount += (Placement->Enabled[Node] != 0);
+    }
+    
+    meow_umm Size = (Placement->MaxNodes ? Placement->MaxNodes : MEOW_PLACEMENT_WIDTH)*sizeof(meow_u32);
+    Loads->Load = (meow_u32 *)calloc(1, Size);
+    Loads->Open = (meow_u32 *)malloc(Size);
+    memcpy(Loads->Open, Placement->Enabled, Size);
+    Loads->NodeCount = Placement->NodeCount;
+    
+    double Share = EnabledCount ? (double)ExpectedKeys / (double)EnabledCount : 0.0;
+    double Capacity = ceil((1.0 + Epsilon)*Share);
+    Loads->Capacity = (Capacity < 1.0) ? 1 : (Capacity > 4294967295.0) ? 0xFFFFFFFFu : (meow_u32)Capacity;
+}
+
+static void
+MeowPlacementLoadsFree(meow_placement_loads *Loads)
+{
+    free(Loads->Load);
+    free(Loads->Open);
+    memset(Loads, 0, sizeof(*Loads));
+}
+
+static void
+MeowPlacementTake(meow_placement_loads *Loads, meow_u32 Node)
+{
+    if(++Loads->Load[Node] >= Loads->Capacity)
+    {
+        Loads->Open[Node] = 0;
+    }
+}
+
+// NOTE: Only for nodes that were enabled when the loads were set up
+static void
+MeowPlacementRelease(meow_placement_loads *Loads, meow_u32 Node)
+{
+    if(Loads->Load[Node])
+    {
+        --Loads->Load[Node];
+        Loads->Open[Node] = 0xFFFFFFFFu;
+    }
+}
+
+static meow_u32
+MeowPlacementAssign(meow_placement *Placement, meow_placement_loads *Loads, meow_hash Key)
+{
+    meow_u32 KeyA, KeyB;
+    MeowPlacementKey(Key, &KeyA, &KeyB);
+    meow_u32 Result = MeowPlacementBest(Placement, KeyA, KeyB, Loads->Open);
+    if(Result != MEOW_PLACEMENT_NONE)
+    {
+        MeowPlacementTake(Loads, Result);
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Ring
+//
+
+typedef struct meow_ring_point
+{
+    meow_u64 Position;
+    meow_u32 Node;
+} meow_ring_point;
+
+typedef struct meow_ring
+{
+    meow_umm PointCount;
+    meow_u64 *Positions;    // NOTE: Sorted, with the nodes alongside so the search only reads positions
+    meow_u32 *Nodes;
+} meow_ring;
+
+static int
+MeowRingPointLess(meow_ring_point const &A, meow_ring_point const &B)
+{
+    int Result = (A.Position < B.Position) || ((A.Position == B.Position) && (A.Node < B.Node));
+    return(Result);
+}
+
+// NOTE: Weights scale each enabled node's PointsPerNode, and may be 0 for all the same
+static int
+MeowRingBuild(meow_ring *Ring, meow_placement *Placement, meow_u32 PointsPerNode, float *Weights)
+{
+    memset(Ring, 0, sizeof(*Ring));
+    
+    meow_umm Total = 0;
+    for(meow_u32 Node = 0;
+        Node < Placement->NodeCount;
+        ++Node)
+    {
+        if(Placement->Enabled[Node])
+        {
+            Total += (meow_umm)(PointsPerNode*(Weights ? Weights[Node] : 1.0f) + 0.5f);
+        }
+    }
+    
+    meow_ring_point *Points = (meow_ring_point *)malloc((Total ? Total : 1)*sizeof(meow_ring_point));
+    Ring->Positions = (meow_u64 *)malloc((Total ? Total : 1)*sizeof(meow_u64));
+    Ring->Nodes = (meow_u32 *)malloc((Total ? Total : 1)*sizeof(meow_u32));
+    int Result = (Points && Ring->Positions && Ring->Nodes);
+    if(Result)
+    {
+        meow_umm At = 0;
+        for(meow_u32 Node = 0;
+            Node < Placement->NodeCount;
+            ++Node)
+        {
+            if(Placement->Enabled[Node])
+            {
+                // NOTE: SplitMix from the node's seeds, so points follow names like scores do
+                meow_u64 State = ((meow_u64)Placement->SeedB[Node] << 32) | Placement->SeedA[Node];
+                meow_umm Count = (meow_umm)(PointsPerNode*(Weights ? Weights[Node] : 1.0f) + 0.5f);
+                for(meow_umm Point = 0;
+                    Point < Count;
+                    ++Point)
+                {
+                    meow_u64 Z = (State += 0x9E3779B97F4A7C15ull);
+                    Z = (Z ^ (Z >> 30))*0xBF58476D1CE4E5B9ull;
+                    Z = (Z ^ (Z >> 27))*0x94D049BB133111EBull;
+                    Points[At].Position = Z ^ (Z >> 31);
+                    Points[At].Node = Node;
+                    ++At;
+                }
+            }
+        }
+        std::sort(Points, Points + Total, MeowRingPointLess);
+        
+        for(meow_umm Point = 0;
+            Point < Total;
+            ++Point)
+        {
+            Ring->Positions[Point] = Points[Point].Position;
+            Ring->Nodes[Point] = Points[Point].Node;
+        }
+        Ring->PointCount = Total;
+    }
+    free(Points);
+    
+    return(Result);
+}
+
+static void
+MeowRingFree(meow_ring *Ring)
+{
+    free(Ring->Positions);
+    free(Ring->Nodes);
+    memset(Ring, 0, sizeof(*Ring));
+}
+
+// NOTE: The first point at or after the key, wrapping round
+static meow_umm
+MeowRingFirstPoint(meow_ring *Ring, meow_hash Key)
+{
+    meow_u64 Position = MeowU64From(Key, 1);
+    meow_umm Result = (meow_umm)(std::lower_bound(Ring->Positions, Ring->Positions + Ring->PointCount, Position) - Ring->Positions);
+    if(Result == Ring->PointCount)
+    {
+        Result = 0;
+    }
+    
+    return(Result);
+}
+
+static meow_u32
+MeowRingLookup(meow_ring *Ring, meow_hash Key)
+{
+    meow_u32 Result = Ring->PointCount ? Ring->Nodes[MeowRingFirstPoint(Ring, Key)] : MEOW_PLACEMENT_NONE;
+    return(Result);
+}
+
+static meow_u32
+MeowRingAssign(meow_ring *Ring, meow_placement_loads *Loads, meow_hash Key)
+{
+    meow_u32 Result = MEOW_PLACEMENT_NONE;
+    if(Ring->PointCount)
+    {
+        meow_umm Point = MeowRingFirstPoint(Ring, Key);
+        for(meow_umm Step = 0;
+            Step < Ring->PointCount;
+            ++Step)
+        {
+            meow_u32 Node = Ring->Nodes[Point];
+            if(Loads->Open[Node])
+            {
+                Result = Node;
+                MeowPlacementTake(Loads, Node);
+                break;
+            }
+            
+            Point = (Point + 1 == Ring->PointCount) ? 0 : (Point + 1);
+        }
+    }
+    
+    return(Result);
+}
@@ -0,0 +1,452 @@
+/* ========================================================================
+   
+   meow_radix.h - parallel radix sort of 128-bit Meow hashes with payloads
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Sorts an array of hashes, each with a 64-bit payload, into the same
+   order meow_index.h uses (high half, then low half, as unsigned):
+   
+       meow_radix_entry *Entries = ...;  // NOTE: Low, High, Payload
+       MeowRadixSort(Entries, Count, Scratch, ThreadCount);
+   
+   Scratch is either 0 or room for another Count entries, and ThreadCount
+   is how many threads to use, or 0 for one per core.  It returns 0 if it
+   could not allocate its per-thread buffers, in which case Entries has not
+   been touched.
+   
+   Meow output is uniform, so a most-significant-digit radix sort splits
+   it into even buckets a byte at a time, and after about log256(Count)
+   bytes every bucket is a handful of entries whose prefixes differ.  Small
+   buckets (MEOW_RADIX_FINISH entries or fewer, which fit in L1) are
+   finished with two least-significant-digit passes on their next two bytes
+   and an insertion sort, which only has to move the few entries that
+   shared those two bytes too.  Bytes every entry in a bucket shares are
+   skipped without a pass, so long common prefixes cost one counting scan
+   each rather than a permutation.
+   
+   With Scratch, the first byte is a parallel scatter from Entries to
+   Scratch, each thread moving its own slice into its own part of every
+   bucket, and the second byte scatters each of those buckets back to
+   Entries, a bucket per thread at a time.  Both scatters go through small
+   per-bucket write-combining buffers, so the 256 output streams are
+   written three cache lines at a time instead of an entry at a time, which
+   keeps TLB and cache misses on huge arrays down.  Everything after that
+   happens in place, a bucket per thread.
+   
+   Without Scratch, the first byte is counted in parallel but permuted in
+   place by one thread (American flag sort), and then buckets are sorted in
+   parallel the same way.  That needs no extra memory, but the first pass
+   runs at one core's speed.
+   
+   Which of several entries with the same hash comes first is not defined.
+   Parallel passes split on the top byte of the high half, so a million
+   entries that all share it sort on one thread.
+   
+   Include meow_intrinsics.h and meow_hash.h first.  Needs threads.
+   
+   ======================================================================== */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#define MEOW_RADIX_DIGITS 16
+#define MEOW_RADIX_INSERTION 32
+#define MEOW_RADIX_FINISH 2048
+#define MEOW_RADIX_SWC 8          // NOTE: Eight 24-byte entries are three cache lines
+#define MEOW_RADIX_SERIAL (1 << 16)
+
+typedef struct meow_radix_entry
+{
+    meow_u64 Low;
+    meow_u64 High;
+    meow_u64 Payload;
+} meow_radix_entry;
+
+typedef struct meow_radix_thread
+{
+    meow_radix_entry Buffers[256][MEOW_RADIX_SWC];
+    meow_u32 Fill[256];
+    meow_radix_entry Scratch[MEOW_RADIX_FINISH];
+} meow_radix_thread;
+
+//
+// NOTE: Digit 0 is the top byte of the high half, and digit 15 the bottom
+// byte of the low half
+//
+
+static meow_u32
+MeowRadixDigit(meow_radix_entry *Entry, meow_u32 Digit)
+{
+    meow_u64 Half = (Digit < 8) ? Entry->High : Entry->Low;
+    meow_u32 Result = (meow_u32)(Half >> (56 - 8*(Digit & 7))) & 0xFF;
+    return(Result);
+}
+
+static int
+MeowRadixLess(meow_radix_entry *A, meow_radix_entry *B)
+{
+    int Result = (A->High < B->High) || ((A->High == B->High) && (A->Low < B->Low));
+    return(Result);
+}
+
+// NOTE: The first digit at or after Digit where the entries are not all the same
+static meow_u32
+MeowRadixFirstDifference(meow_radix_entry *Entries, meow_umm Count, meow_u32 Digit)
+{
+    meow_u64 HighDifference = 0;
+    meow_u64 LowDifference = 0;
+    for(meow_umm Index = 1;
+        Index < Count;
+        ++Index)
+    {
+        HighDifference |= Entries[Index].High ^ Entries[0].High;
+        LowDifference |= Entries[Index].Low ^ Entries[0].Low;
+    }
+    
+    meow_radix_entry Difference = {LowDifference, HighDifference, 0};
+    while((Digit < MEOW_RADIX_DIGITS) && !MeowRadixDigit(&Difference, Digit))
+    {
+        ++Digit;
+    }
+    
+    return(Digit);
+}
+
+static void
+MeowRadixInsertionSort(meow_radix_entry *Entries, meow_umm Count)
+{
+    for(meow_umm Index = 1;
+        Index < Count;
+        ++Index)
+    {
+        if(MeowRadixLess(&Entries[Index], &Entries[Index - 1]))
+        {
+            meow_radix_entry Entry = Entries[Index];
+            meow_umm At = Index;
+            do
+            {
+                Entries[At] = Entries[At - 1];
+                --At;
+            } while(At && MeowRadixLess(&Entry, &Entries[At - 1]));
+            Entries[At] = Entry;
+        }
+    }
+}
+
+static void
+MeowRadixCount(meow_radix_entry *Entries, meow_umm Count, meow_u32 Digit, meow_umm *Counts)
+{
+    memset(Counts, 0, 256*sizeof(meow_umm));
+    for(meow_umm Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        ++Counts[MeowRadixDigit(Entries + Index, Digit)];
+    }
+}
+
+// NOTE: Turns counts into where each bucket starts, and returns the total
+static meow_umm
+MeowRadixStarts(meow_umm *Counts, meow_umm *Starts, meow_umm At)
+{
+    for(meow_u32 Bucket = 0;
+        Bucket < 256;
+        ++Bucket)
+    {
+        Starts[Bucket] = At;
+        At += Counts[Bucket];
+    }
+    
+    return(At);
+}
+
+//
+// NOTE: Finishing small buckets
+//
+
+static void
+MeowRadixPass(meow_radix_entry *From, meow_radix_entry *To, meow_umm Count, meow_u32 Digit)
+{
+    meow_umm Counts[256];
+    meow_umm Offsets[256];
+    MeowRadixCount(From, Count, Digit, Counts);
+    MeowRadixStarts(Counts, Offsets, 0);
+    for(meow_umm Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        To[Offsets[MeowRadixDigit(From + Index, Digit)]++] = From[Index];
+    }
+}
+
+static void
+MeowRadixFinish(meow_radix_entry *Entries, meow_umm Count, meow_u32 Digit, meow_radix_entry *Scratch)
+{
+    if(Count > MEOW_RADIX_INSERTION)
+    {
+        Digit = MeowRadixFirstDifference(Entries, Count, Digit);
+        if(Digit < (MEOW_RADIX_DIGITS - 1))
+        {
+            MeowRadixPass(Entries, Scratch, Count, Digit + 1);
+            MeowRadixPass(Scratch, Entries, Count, Digit);
+        }
+        else if(Digit == (MEOW_RADIX_DIGITS - 1))
+        {
+            MeowRadixPass(Entries, Scratch, Count, Digit);
+            memcpy(Entries, Scratch, Count*sizeof(meow_radix_entry));
+        }
+    }
+    
+    MeowRadixInsertionSort(Entries, Count);
+}
+
+//
+// NOTE: In place, most significant digit first
+//
+
+// NOTE: American flag sort: each entry is swapped straight into its bucket
+static void
+MeowRadixPermute(meow_radix_entry *Entries, meow_umm *Counts, meow_u32 Digit, meow_umm *Starts)
+{
+    meow_umm Heads[256];
+    meow_umm Ends[256];
+    MeowRadixStarts(Counts, Starts, 0);
+    for(meow_u32 Bucket = 0;
+        Bucket < 256;
+        ++Bucket)
+    {
+        Heads[Bucket] = Starts[Bucket];
+        Ends[Bucket] = Starts[Bucket] + Counts[Bucket];
+    }
+    
+    for(meow_u32 Bucket = 0;
+        Bucket < 256;
+        ++Bucket)
+    {
+        while(Heads[Bucket] < Ends[Bucket])
+        {
+            meow_radix_entry Entry = Entries[Heads[Bucket]];
+            meow_u32 To = MeowRadixDigit(&Entry, Digit);
+            while(To != Bucket)
+            {
+                meow_radix_entry Displaced = Entries[Heads[To]];
+                Entries[Heads[To]++] = Entry;
+                Entry = Displaced;
+                To = MeowRadixDigit(&Entry, Digit);
+            }
+            Entries[Heads[Bucket]++] = Entry;
+        }
+    }
+}
+
+static void
+MeowRadixSortInPlace(meow_radix_entry *Entries, meow_umm Count, meow_u32 Digit, meow_radix_entry *Scratch)
+{
+    meow_umm Counts[256];
+    while((Digit < MEOW_RADIX_DIGITS) && (Count > MEOW_RADIX_FINISH))
+    {
+        MeowRadixCount(Entries, Count, Digit, Counts);
+        if(Counts[MeowRadixDigit(Entries, Digit)] == Count)
+        {
+            ++Digit;
+        }
+        else
+        {
+            meow_umm Starts[256];
+            MeowRadixPermute(Entries, Counts, Digit, Starts);
+            for(meow_u32 Bucket = 0;
+                Bucket < 256;
+                ++Bucket)
+            {
+                MeowRadixSortInPlace(Entries + Starts[Bucket], Counts[Bucket], Digit + 1, Scratch);
+            }
+            return;
+        }
+    }
+    
+    if(Digit < MEOW_RADIX_DIGITS)
+    {
+        MeowRadixFinish(Entries, Count, Digit, Scratch);
+    }
+}
+
+//
+// NOTE: Out of place scatter through write-combining buffers.  Offsets
+// are where this thread's share of each bucket goes, and are advanced.
+//
+
+static void
+MeowRadixScatter(meow_radix_thread *Thread, meow_radix_entry *From, meow_umm Count, meow_u32 Digit,
+                 meow_radix_entry *To, meow_umm *Offsets)
+{
+    memset(Thread->Fill, 0, sizeof(Thread->Fill));
+    for(meow_umm Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        meow_u32 Bucket = MeowRadixDigit(From + Index, Digit);
+        meow_u32 Fill = Thread->Fill[Bucket];
+        Thread->Buffers[Bucket][Fill++] = From[Index];
+        if(Fill == MEOW_RADIX_SWC)
+        {
+            memcpy(To + Offsets[Bucket], Thread->Buffers[Bucket], sizeof(Thread->Buffers[Bucket]));
+            Offsets[Bucket] += MEOW_RADIX_SWC;
+            Fill = 0;
+        }
+        Thread->Fill[Bucket] = Fill;
+    }
+    
+    for(meow_u32 Bucket = 0;
+        Bucket < 256;
+        ++Bucket)
+    {
+        memcpy(To + Offsets[Bucket], Thread->Buffers[Bucket], Thread->Fill[Bucket]*sizeof(meow_radix_entry));
+        Offsets[Bucket] += Thread->Fill[Bucket];
+    }
+}
+
+template<typename work> static void
+MeowRadixRun(int ThreadCount, work Work)
+{
+    std::vector<std::thread> Threads;
+    for(int Thread = 1;
+        Thread < ThreadCount;
+        ++Thread)
+    {
+        Threads.emplace_back(Work, Thread);
+    }
+    Work(0);
+    for(size_t Thread = 0;
+        Thread < Threads.size();
+        ++Thread)
+    {
+        Threads[Thread].join();
+    }
+}
+
+static int
+MeowRadixSort(meow_radix_entry *Entries, meow_umm Count, meow_radix_entry *Scratch, int ThreadCount)
+{
+    if(ThreadCount <= 0)
+    {
+        ThreadCount = (int)std::thread::hardware_concurrency();
+    }
+    if((ThreadCount <= 0) || (Count < MEOW_RADIX_SERIAL))
+    {
+        ThreadCount = 1;
+    }
+    
+    meow_radix_thread *Threads = (meow_radix_thread *)malloc(ThreadCount*sizeof(meow_radix_thread));
+    int Result = (Threads != 0);
+    if(Result && (ThreadCount == 1) && !(Scratch && (Count >= MEOW_RADIX_SERIAL)))
+    {
+        MeowRadixSortInPlace(Entries, Count, 0, Threads->Scratch);
+    }
+    else if(Result)
+    {
+        // NOTE: Every thread counts the first digit of its own slice
+        std::vector<meow_umm> Counts(ThreadCount*256);
+        meow_umm Slice = (Count + ThreadCount - 1) / ThreadCount;
+        MeowRadixRun(ThreadCount, [&](int Thread)
+        {
+            meow_umm First = Thread*Slice;
+            meow_umm End = ((First + Slice) < Count) ? (First + Slice) : Count;
+            MeowRadixCount(Entries + First, (First < End) ? (End - First) : 0, 0, &Counts[Thread*256]);
+        });
+        
+        meow_umm BucketCounts[256] = {0};
+        for(int Thread = 0;
+            Thread < ThreadCount;
+            ++Thread)
+        {
+            for(meow_u32 Bucket = 0;
+                Bucket < 256;
+                ++Bucket)
+            {
+                BucketCounts[Bucket] += Counts[Thread*256 + Bucket];
+            }
+        }
+        meow_umm Starts[256];
+        MeowRadixStarts(BucketCounts, Starts, 0);
+        std::atomic<meow_u32> NextBucket(0);
+        
+        if(Scratch)
+        {
+            // NOTE: Each thread's share of a bucket goes after the shares of
+            // the threads before it, so the threads never write the same place
+            std::vector<meow_umm> Offsets(ThreadCount*256);
+            for(meow_u32 Bucket = 0;
+                Bucket < 256;
+                ++Bucket)
+            {
+                meow_umm At = Starts[Bucket];
+                for(int Thread = 0;
+                    Thread < ThreadCount;
+                    ++Thread)
+                {
+                    Offsets[Thread*256 + Bucket] = At;
+                    At += Counts[Thread*256 + Bucket];
+                }
+            }
+            
+            MeowRadixRun(ThreadCount, [&](int Thread)
+            {
+                meow_umm First = Thread*Slice;
+                meow_umm End = ((First + Slice) < Count) ? (First + Slice) : Count;
+                MeowRadixScatter(Threads + Thread, Entries + First, (First < End) ? (End - First) : 0, 0,
+                                 Scratch, &Offsets[Thread*256]);
+            });
+            
+            // NOTE: The second digit scatters each bucket back to where it came from
+            MeowRadixRun(ThreadCount, [&](int Thread)
+            {
+                meow_radix_thread *This = Threads + Thread;
+                for(meow_u32 Bucket = NextBucket++;
+                    Bucket < 256;
+                    Bucket = NextBucket++)
+                {
+                    meow_umm InnerCounts[256];
+                    meow_umm InnerStarts[256];
+                    meow_umm InnerOffsets[256];
+                    MeowRadixCount(Scratch + Starts[Bucket], BucketCounts[Bucket], 1, InnerCounts);
+                    MeowRadixStarts(InnerCounts, InnerStarts, Starts[Bucket]);
+                    memcpy(InnerOffsets, InnerStarts, sizeof(InnerOffsets));
+                    MeowRadixScatter(This, Scratch + Starts[Bucket], BucketCounts[Bucket], 1, Entries, InnerOffsets);
+                    for(meow_u32 Inner = 0;
+                        Inner < 256;
+                        ++Inner)
+                    {
+                        MeowRadixSortInPlace(Entries + InnerStarts[Inner], InnerCounts[Inner], 2, This->Scratch);
+                    }
+                }
+            });
+        }
+        else
+        {
+            // NOTE: Without scratch the first digit has to be permuted by one thread
+            MeowRadixPermute(Entries, BucketCounts, 0, Starts);
+            MeowRadixRun(ThreadCount, [&](int Thread)
+            {
+                for(meow_u32 Bucket = NextBucket++;
+                    Bucket < 256;
+                    Bucket = NextBucket++)
+                {
+                    MeowRadixSortInPlace(Entries + Starts[Bucket], BucketCounts[Bucket], 1, Threads[Thread].Scratch);
+                }
+            });
+        }
+    }
+    free(Threads);
+    
+    return(Result);
+}
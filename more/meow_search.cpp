@@ -12,14 +12,10 @@
 #include <string.h>
 #include <memory.h>
 #include <time.h>
-#if _WIN32
-#include <windows.h>
-#else
-#include <dirent.h>
-#endif
 
 #define MEOW_INCLUDE_TRUNCATIONS 1
 #include "meow_test.h"
+#include "more/meow_walk.h"
 
 struct test_file
 {
@@ -304,7 +300,23 @@ IngestFile(test_group *Group, char *FileName)
     FreeEntireFile(&File);
 }
 
-static void IngestDirectoriesRecursively(test_group *Group, char *Path);
+//
+// NOTE(casey): File names are never freed, because they are used in the
+// permanent structure.
+//
+
+static void
+IngestWalkedFile(void *Context, char *FileName)
+{
+    IngestFile((test_group *)Context, FileName);
+}
+
+static void
+CountUnknownEntry(void *Context, char *)
+{
+    ++((test_group *)Context)->AccessFailureCount;
+}
+
 int main(int ArgCount, char **Args)
 {
     int Result = -1;
@@ -366,7 +378,8 @@ int main(int ArgCount, char **Args)
             }
             
             // NOTE(casey): Run the search
-            IngestDirectoriesRecursively(&Group, RootPath);
+            meow_walk Walk = {&Group, IngestWalkedFile, CountUnknownEntry};
+            MeowWalkDirectory(&Walk, RootPath);
             printf("\n");
             printf("meow_search complete.\n");
             
@@ -389,106 +402,3 @@ int main(int ArgCount, char **Args)
     
     return(Result);
 }
-
-//
-// NOTE(casey) Platform-specific directory walking
-//
-
-static char *
-AllocPath(char *A, char *B)
-{
-    size_t ACount = strlen(A);
-    size_t BCount = strlen(B);
-    size_t Size = ACount + BCount + 2;
-    
-    char *Result = (char *)malloc(Size);
-    memcpy(Result, A, ACount);
-    memcpy(Result + ACount + 1, B, BCount);
-    Result[ACount] = '/';
-    Result[Size - 1] = 0;
-    
-    return(Result);
-}
-
-static void
-DeallocPath(char *A)
-{
-    if(A)
-    {
-        free(A);
-    }
-}
-
-#if _WIN32
-
-static void
-IngestDirectoriesRecursively(test_group *Group, char *Path)
-{
-    char *Wildcard = AllocPath(Path, (char *)"*");
-    
-    WIN32_FIND_DATAA FindData;
-    HANDLE SearchHandle = FindFirstFileExA(Wildcard, FindExInfoBasic, &FindData,
-                                           FindExSearchNameMatch, 0, FIND_FIRST_EX_LARGE_FETCH);
-    if(SearchHandle != INVALID_HANDLE_VALUE)
-    {
-        do
-        {
-            char *Stem = FindData.cFileName;
-            if(strcmp(Stem, ".") && strcmp(Stem, ".."))
-            {
-                char *EntryName = AllocPath(Path, Stem);
-                if(FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
-                {
-                    IngestDirectoriesRecursively(Group, EntryName);
-                }
-                else
-                {
-                    IngestFile(Group, EntryName);
-                }
-            }
-        } while(FindNextFileA(SearchHandle, &FindData));
-        
-        FindClose(SearchHandle);
-    }
-    
-    DeallocPath(Wildcard);
-}
-
-#else
-
-static void
-IngestDirectoriesRecursively(test_group *Group, char *Path)
-{
-    DIR *DirHandle = opendir(Path);
-    if(DirHandle)
-    {
-        for(dirent *Entry = readdir(DirHandle);
-            Entry;
-            Entry = readdir(DirHandle))
-        {
-            // NOTE(casey): We intentionally never free these, because they are
-            // used in the permanent structure.
-            char *Stem = Entry->d_name;
-            char *EntryName = AllocPath(Path, Stem);
-            if(strcmp(Stem, ".") && strcmp(Stem, ".."))
-            {
-                if(Entry->d_type == DT_UNKNOWN)
-                {
-                    ++Group->AccessFailureCount;
-                }
-                else if(Entry->d_type == DT_DIR)
-                {
-                    IngestDirectoriesRecursively(Group, EntryName);
-                }
-                else if(Entry->d_type == DT_REG)
-                {
-                    IngestFile(Group, EntryName);
-                }
-            }
-        }
-        
-        closedir(DirHandle);
-    }
-}
-
-#endif
@@ -0,0 +1,478 @@
+/* ========================================================================
+   
+   meow_service.h - thread-pool hashing service for the Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   meow::hash_service runs a pool of worker threads that hash (pointer,
+   length, seed) jobs submitted from any number of threads.  Results come
+   back through a std::future or a callback, and are the same values
+   MeowHash_Accelerated would return:
+   
+       meow::hash_service Service;   // NOTE: One worker per hardware thread
+   
+       meow::hash_future Hash = Service.Submit(Data, Size, Seed1, Seed2);
+   
+       Service.Submit(Data, Size, Seed1, Seed2, [](meow_hash Hash) {...});
+   
+   The memory being hashed must stay valid until the result arrives.
+   Callbacks run on a worker thread and must not throw.
+   
+   Small jobs are taken off the queues a batch at a time and hashed together
+   with MeowHashBatch (see meow_column.h), so short keys share the AES
+   pipeline instead of each running the whole reduction on their own.
+   
+   Jobs of config::LargeBytes or more go to a separate queue and are hashed
+   with the streaming construction, config::SliceBytes at a time, with the
+   small queue checked between slices.  A Meow hash is one sequential chain,
+   so a single large job cannot be spread over several cores without
+   changing its value.  What the service does instead is keep different
+   large jobs on different workers, and make sure none of them holds up the
+   small jobs behind it for longer than one slice.
+   
+   Submission is lock-free: each worker has a multi-producer, single-consumer
+   queue for small jobs and one for large jobs, and a submit is one atomic
+   exchange into one of them.  A worker with nothing in its own queues
+   steals from the others.  The only lock is the one idle workers sleep on,
+   and a submit only touches it when some worker is actually asleep.
+   
+   Destroying the service finishes every job that was already submitted.
+   
+   Include meow_intrinsics.h, meow_hash.h, more/meow_more.h and
+   more/meow_column.h first.  Needs C++17 and threads (-pthread).
+   
+   ======================================================================== */
+
+#include <stddef.h>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace meow
+{
+
+//
+// NOTE: meow_hash is a vector type, and GCC warns that its alignment attribute
+// is dropped whenever it is a template argument.  Nothing here depends on that
+// alignment, so the warning is silenced for these typedefs only.
+//
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wignored-attributes"
+#endif
+typedef std::future<meow_hash> hash_future;
+typedef std::promise<meow_hash> hash_promise;
+typedef std::function<void(meow_hash)> hash_callback;
+typedef std::vector<meow_hash> hash_vector;
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+//
+// NOTE: Intrusive multi-producer, single-consumer queue (Dmitry Vyukov's).
+// Push is one exchange and one store and never waits.  Pop is only safe on
+// one thread at a time, which is what TryLock is for: the owning worker and
+// any worker stealing from it both take it, and whoever fails to get it just
+// looks somewhere else.
+//
+
+struct mpsc_node
+{
+    std::atomic<mpsc_node *> Next{nullptr};
+};
+
+class mpsc_queue
+{
+public:
+    mpsc_queue()
+        : Head(&Stub), Tail(&Stub)
+    {
+    }
+    
+    mpsc_queue(mpsc_queue const &) = delete;
+    mpsc_queue &operator=(mpsc_queue const &) = delete;
+    
+    void
+    Push(mpsc_node *Node)
+    {
+        Node->Next.store(nullptr, std::memory_order_relaxed);
+        mpsc_node *Prev = Head.exchange(Node, std::memory_order_acq_rel);
+        Prev->Next.store(Node, std::memory_order_release);
+        Count.fetch_add(1, std::memory_order_release);
+    }
+    
+    // NOTE: Only while holding TryLock.  Returns null when empty, or when a
+    // push is halfway done (the next Pop will see it).
+    mpsc_node *
+    Pop(void)
+    {
+        mpsc_node *First = Tail;
+        mpsc_node *Next = First->Next.load(std::memory_order_acquire);
+        if(First == &Stub)
+        {
+            if(!Next)
+            {
+                return(nullptr);
+            }
+            Tail = Next;
+            First = Next;
+            Next = Next->Next.load(std::memory_order_acquire);
+        }
+        
+        if(!Next)
+        {
+            if(First != Head.load(std::memory_order_acquire))
+            {
+                return(nullptr);
+            }
+            
+            // NOTE: First is the last node, so put the stub behind it before taking it
+            Push(&Stub);
+            Count.fetch_sub(1, std::memory_order_relaxed);
+            Next = First->Next.load(std::memory_order_acquire);
+            if(!Next)
+            {
+                return(nullptr);
+            }
+        }
+        
+        Tail = Next;
+        Count.fetch_sub(1, std::memory_order_relaxed);
+        return(First);
+    }
+    
+    bool
+    TryLock(void)
+    {
+        bool Result = !Consuming.test_and_set(std::memory_order_acquire);
+        return(Result);
+    }
+    
+    void
+    Unlock(void)
+    {
+        Consuming.clear(std::memory_order_release);
+    }
+    
+    // NOTE: A hint only - it can be stale by the time the caller looks at it
+    bool
+    LooksEmpty(void) const
+    {
+        bool Result = (Count.load(std::memory_order_acquire) == 0);
+        return(Result);
+    }
+
+private:
+    std::atomic<mpsc_node *> Head;
+    mpsc_node *Tail;
+    mpsc_node Stub;
+    std::atomic<size_t> Count{0};
+    std::atomic_flag Consuming = ATOMIC_FLAG_INIT;
+};
+
+class hash_service
+{
+public:
+    struct config
+    {
+        unsigned WorkerCount = 0;       // NOTE: 0 means std::thread::hardware_concurrency()
+        size_t LargeBytes = 1 << 20;    // NOTE: Jobs this big or bigger are streamed in slices
+        size_t SliceBytes = 256 << 10;  // NOTE: How much of a large job is hashed between looks at the small queue
+        size_t BatchCount = 64;         // NOTE: Most small jobs taken off the queues at once
+    };
+    
+    hash_service()
+        : hash_service(config())
+    {
+    }
+    
+    explicit hash_service(config ConfigInit)
+        : Config(ConfigInit)
+    {
+        unsigned WorkerCount = Config.WorkerCount ? Config.WorkerCount : std::thread::hardware_concurrency();
+        if(WorkerCount == 0)
+        {
+            WorkerCount = 1;
+        }
+        if(Config.SliceBytes < 64)
+        {
+            Config.SliceBytes = 64;
+        }
+        
+        Workers.reset(new worker[WorkerCount]);
+        this->WorkerCount = WorkerCount;
+        for(unsigned WorkerIndex = 0;
+            WorkerIndex < WorkerCount;
+            ++WorkerIndex)
+        {
+            Workers[WorkerIndex].Thread = std::thread(&hash_service::Run, this, WorkerIndex);
+        }
+    }
+    
+    hash_service(hash_service const &) = delete;
+    hash_service &operator=(hash_service const &) = delete;
+    
+    ~hash_service()
+    {
+        {
+            std::lock_guard<std::mutex> Lock(SleepMutex);
+            Stopping.store(true);
+        }
+        SleepCondition.notify_all();
+        
+        for(unsigned WorkerIndex = 0;
+            WorkerIndex < WorkerCount;
+            ++WorkerIndex)
+        {
+            Workers[WorkerIndex].Thread.join();
+        }
+    }
+    
+    hash_future
+    Submit(void const *Data, size_t Size, meow_u64 Seed1 = 0, meow_u64 Seed2 = 0)
+    {
+        job *Job = new job(Data, Size, Seed1, Seed2);
+        hash_future Result = Job->Promise.get_future();
+        Enqueue(Job);
+        return(Result);
+    }
+    
+    void
+    Submit(void const *Data, size_t Size, meow_u64 Seed1, meow_u64 Seed2, hash_callback Callback)
+    {
+        job *Job = new job(Data, Size, Seed1, Seed2);
+        Job->Callback = std::move(Callback);
+        Enqueue(Job);
+    }
+    
+    unsigned
+    GetWorkerCount(void) const
+    {
+        return(WorkerCount);
+    }
+
+private:
+    struct job : mpsc_node
+    {
+        job(void const *DataInit, size_t SizeInit, meow_u64 Seed1Init, meow_u64 Seed2Init)
+            : Data(DataInit), Size(SizeInit), Seed1(Seed1Init), Seed2(Seed2Init)
+        {
+        }
+        
+        void const *Data;
+        size_t Size;
+        meow_u64 Seed1;
+        meow_u64 Seed2;
+        
+        hash_promise Promise;
+        hash_callback Callback;
+        
+        // NOTE: Large jobs only
+        meow_hash_state State;
+        size_t Done = 0;
+    };
+    
+    struct worker
+    {
+        mpsc_queue Small;
+        mpsc_queue Large;
+        std::thread Thread;
+    };
+    
+    void
+    Enqueue(job *Job)
+    {
+        // NOTE: Each submitting thread deals its jobs out round-robin, from
+        // its own starting point, so producers do not all pile onto worker 0
+        static thread_local size_t NextWorker = std::hash<std::thread::id>()(std::this_thread::get_id());
+        worker &Worker = Workers[NextWorker++ % WorkerCount];
+        if(Job->Size >= Config.LargeBytes)
+        {
+            Worker.Large.Push(Job);
+        }
+        else
+        {
+            Worker.Small.Push(Job);
+        }
+        
+        Pending.fetch_add(1);
+        if(Sleepers.load())
+        {
+            // NOTE: Taking the lock means a worker about to sleep either sees
+            // Pending or is already waiting when the notify goes out
+            {
+                std::lock_guard<std::mutex> Lock(SleepMutex);
+            }
+            SleepCondition.notify_one();
+        }
+    }
+    
+    static void
+    Complete(job *Job, meow_hash Hash)
+    {
+        if(Job->Callback)
+        {
+            Job->Callback(Hash);
+        }
+        else
+        {
+            Job->Promise.set_value(Hash);
+        }
+        delete Job;
+    }
+    
+    // NOTE: Own queue first, then steal from the others in order
+    job *
+    Take(unsigned Self, mpsc_queue worker::*Queue, size_t MaxCount, std::vector<job *> &Jobs)
+    {
+        job *Result = nullptr;
+        for(unsigned Offset = 0;
+            (Offset < WorkerCount) && !Result;
+            ++Offset)
+        {
+            mpsc_queue &Victim = Workers[(Self + Offset) % WorkerCount].*Queue;
+            if(!Victim.LooksEmpty() && Victim.TryLock())
+            {
+                while(Jobs.size() < MaxCount)
+                {
+                    job *Job = static_cast<job *>(Victim.Pop());
+                    if(!Job)
+                    {
+                        break;
+                    }
+                    Pending.fetch_sub(1);
+                    Jobs.push_back(Job);
+                    Result = Job;
+                }
+                Victim.Unlock();
+            }
+        }
+        
+        return(Result);
+    }
+    
+    void
+    Run(unsigned Self)
+    {
+        std::vector<job *> Batch;
+        std::vector<void *> Sources;
+        std::vector<meow_u64> Lens;
+        std::vector<meow_u64> Seeds1;
+        std::vector<meow_u64> Seeds2;
+        hash_vector Hashes;
+        Batch.reserve(Config.BatchCount);
+        
+        job *Large = nullptr;
+        std::vector<job *> LargeTaken;
+        for(;;)
+        {
+            bool DidWork = false;
+            
+            //
+            // NOTE: Small jobs, hashed as one batch
+            //
+            
+            Batch.clear();
+            if(Take(Self, &worker::Small, Config.BatchCount, Batch))
+            {
+                size_t Count = Batch.size();
+                Sources.resize(Count);
+                Lens.resize(Count);
+                Seeds1.resize(Count);
+                Seeds2.resize(Count);
+                Hashes.resize(Count);
+                for(size_t Index = 0;
+                    Index < Count;
+                    ++Index)
+                {
+                    Sources[Index] = (void *)Batch[Index]->Data;
+                    Lens[Index] = Batch[Index]->Size;
+                    Seeds1[Index] = Batch[Index]->Seed1;
+                    Seeds2[Index] = Batch[Index]->Seed2;
+                }
+                
+                MeowHashBatch(Count, Sources.data(), Lens.data(), Seeds1.data(), Seeds2.data(), Hashes.data());
+                
+                for(size_t Index = 0;
+                    Index < Count;
+                    ++Index)
+                {
+                    Complete(Batch[Index], Hashes[Index]);
+                }
+                DidWork = true;
+            }
+            
+            //
+            // NOTE: One slice of a large job
+            //
+            
+            if(!Large)
+            {
+                LargeTaken.clear();
+                Large = Take(Self, &worker::Large, 1, LargeTaken);
+                if(Large)
+                {
+                    MeowHashBegin(&Large->State, Large->Seed1, Large->Seed2, Large->Size);
+                }
+            }
+            
+            if(Large)
+            {
+                size_t Slice = Large->Size - Large->Done;
+                if(Slice > Config.SliceBytes)
+                {
+                    Slice = Config.SliceBytes;
+                }
+                MeowHashAbsorb(&Large->State, Slice, (meow_u8 *)Large->Data + Large->Done);
+                Large->Done += Slice;
+                
+                if(Large->Done == Large->Size)
+                {
+                    Complete(Large, MeowHashEnd(&Large->State, Large->Seed1, Large->Seed2));
+                    Large = nullptr;
+                }
+                DidWork = true;
+            }
+            
+            //
+            // NOTE: Nothing anywhere, so sleep until something is submitted
+            //
+            
+            if(!DidWork)
+            {
+                std::unique_lock<std::mutex> Lock(SleepMutex);
+                if(Stopping.load() && (Pending.load() == 0))
+                {
+                    break;
+                }
+                
+                Sleepers.fetch_add(1);
+                SleepCondition.wait(Lock, [this] { return((Pending.load() != 0) || Stopping.load()); });
+                Sleepers.fetch_sub(1);
+            }
+        }
+    }
+    
+    config Config;
+    unsigned WorkerCount;
+    std::unique_ptr<worker[]> Workers;
+    
+    std::atomic<size_t> Pending{0};   // NOTE: Submitted but not yet taken by a worker
+    std::atomic<unsigned> Sleepers{0};
+    std::atomic<bool> Stopping{false};
+    std::mutex SleepMutex;
+    std::condition_variable SleepCondition;
+};
+    
+}
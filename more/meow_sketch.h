@@ -0,0 +1,548 @@
+/* ========================================================================
+   
+   meow_sketch.h - HyperLogLog and count-min sketches of Meow hashes
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Sketches answer "how many different blocks" and "how often did this
+   block come up" over a stream far too big to keep, in a fixed few
+   kilobytes.  They take meow_hash values, so anything that produces a hash
+   feeds them - one-shot MeowHash_Accelerated, the streaming
+   MeowHashBegin/Absorb/End of meow_more.h, or a column hash:
+   
+       meow_hll Distinct;
+       MeowHllInit(&Distinct, malloc(MeowHllSize(14)), 14);            // 16KB, about 0.8% error
+   
+       meow_count_min Frequency;
+       MeowCountMinInit(&Frequency, malloc(MeowCountMinSize(16, 4)), 16, 4);
+   
+       for(each block)
+       {
+           meow_hash Hash = MeowHash_Accelerated(0, 0, BlockSize, Block);
+           MeowHllAdd(&Distinct, Hash);
+           MeowCountMinAdd(&Frequency, Hash, 1);
+       }
+   
+       double DedupRatio = (double)Frequency.Header->Total / MeowHllEstimate(&Distinct);
+       meow_u64 TimesSeen = MeowCountMinEstimate(&Frequency, Hash);    // NOTE: Never too low
+   
+   Both are mergeable, so each thread keeps its own sketch and they are
+   reduced at the end with MeowHllMerge (a max of every register) and
+   MeowCountMinMerge (a sum of every counter), 16 bytes at a time.  The
+   result is exactly the sketch one thread would have built from all of
+   the input.
+   
+   HyperLogLog: the top Precision bits of the hash's high half pick one of
+   2^Precision registers, and each register keeps the longest run of
+   leading zeros seen in the low half.  The estimate is Ertl's improved
+   estimator, which is unbiased from zero up without the empirical bias
+   tables HLL++ needs, and the 128-bit hash means there is no large-range
+   correction.  Standard error is about 1.04/sqrt(2^Precision).
+   
+   Count-min: Depth rows of 2^WidthBits 64-bit counters (so the all-zero
+   block of a petabyte scan can not wrap one round).  Row I's counter comes
+   from H1 + I*H2 with the hash's two halves as H1 and H2, so every row is
+   indexed from the one hash.  An estimate is the smallest of the key's
+   counters, which is never below the true count, and is above it by at
+   most 2*Total/2^WidthBits with probability 1 - 1/2^Depth.
+   
+   MeowHeavyHitters keeps the K hashes with the highest count-min estimates
+   seen so far, which is how to find the most frequent blocks: offer every
+   hash to it after adding it to the sketch.  After merging sketches,
+   re-offer each thread's heavy hitters to one merged list with their
+   merged estimates.
+   
+   Serialized forms: MeowHllWrite packs registers to 6 bits, so a
+   precision-14 sketch is about 12KB, and MeowHllRead unpacks them again.
+   A count-min sketch's memory is a header and the counters, and is
+   written out as-is; MeowCountMinFromMemory checks the header and uses
+   the counters where they lie.
+   
+   Include meow_intrinsics.h and meow_hash.h first.
+   
+   ======================================================================== */
+
+#include <math.h>
+#include <string.h>
+
+#define MEOW_HLL_MAGIC 0x4C4C484D // NOTE: "MHLL"
+#define MEOW_COUNT_MIN_MAGIC 0x4E4D434D // NOTE: "MCMN"
+#define MEOW_SKETCH_VERSION 1
+#define MEOW_COUNT_MIN_VERSION 2 // NOTE: Version 1 had 32-bit counters
+#define MEOW_COUNT_MIN_MAX_WIDTH_BITS 32
+#define MEOW_HLL_MIN_PRECISION 4
+#define MEOW_HLL_MAX_PRECISION 18
+
+// NOTE: The rank comes from the top 62 bits of the low half, so registers fit in 6 bits
+#define MEOW_HLL_RANK_BITS 62
+
+static int
+MeowSketchLeadingZeros(meow_u64 Value)
+{
+#if _MSC_VER && MEOW_64BIT
+    unsigned long Bit;
+    _BitScanReverse64(&Bit, Value);
+    int Result = 63 - (int)Bit;
+#elif _MSC_VER
+    unsigned long Bit;
+    int Result;
+    if(Value >> 32)
+    {
+        _BitScanReverse(&Bit, (unsigned long)(Value >> 32));
+        Result = 31 - (int)Bit;
+    }
+    else
+    {
+        _BitScanReverse(&Bit, (unsigned long)Value);
+        Result = 63 - (int)Bit;
+    }
+#else
+    int Result = __builtin_clzll(Value);
+#endif
+    return(Result);
+}
+
+//
+// NOTE: HyperLogLog
+//
+
+typedef struct meow_hll
+{
+    meow_u8 *Registers;
+    meow_u32 Precision;
+} meow_hll;
+
+static meow_umm
+MeowHllSize(meow_u32 Precision)
+{
+    meow_umm Result = (meow_umm)1 << Precision;
+    return(Result);
+}
+
+// NOTE: Returns 0 if Precision is outside MEOW_HLL_MIN_PRECISION..MEOW_HLL_MAX_PRECISION
+static int
+MeowHllInit(meow_hll *Hll, void *Memory, meow_u32 Precision)
+{
+    int Result = ((Precision >= MEOW_HLL_MIN_PRECISION) && (Precision <= MEOW_HLL_MAX_PRECISION) && Memory);
+    if(Result)
+    {
+        Hll->Registers = (meow_u8 *)Memory;
+        Hll->Precision = Precision;
+        memset(Memory, 0, MeowHllSize(Precision));
+    }
+    
+    return(Result);
+}
+
+static void
+MeowHllAdd(meow_hll *Hll, meow_hash Hash)
+{
+    meow_u64 Low = MeowU64From(Hash, 0);
+    meow_u64 High = MeowU64From(Hash, 1);
+    meow_u64 Register = High >> (64 - Hll->Precision);
+    
+    // NOTE: The low two bits are set so a zero rank field stops at MEOW_HLL_RANK_BITS
+    meow_u8 Rank = (meow_u8)(MeowSketchLeadingZeros(Low | 3) + 1);
+    if(Hll->Registers[Register] < Rank)
+    {
+        Hll->Registers[Register] = Rank;
+    }
+}
+
+// NOTE: Returns 0, and leaves Dest alone, if the precisions differ
+static int
+MeowHllMerge(meow_hll *Dest, meow_hll *Source)
+{
+    int Result = (Dest->Precision == Source->Precision);
+    if(Result)
+    {
+        meow_umm Count = MeowHllSize(Dest->Precision);
+        for(meow_umm Index = 0;
+            Index < Count;
+            Index += 16)
+        {
+#if MEOW_HASH_INTEL
+            __m128i *To = (__m128i *)(Dest->Registers + Index);
+            _mm_storeu_si128(To, _mm_max_epu8(_mm_loadu_si128(To), _mm_loadu_si128((__m128i *)(Source->Registers + Index))));
+#elif MEOW_HASH_ARMV8
+            vst1q_u8(Dest->Registers + Index, vmaxq_u8(vld1q_u8(Dest->Registers + Index), vld1q_u8(Source->Registers + Index)));
+#endif
+        }
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Ertl, "New cardinality estimation algorithms for HyperLogLog
+// sketches" (2017): the estimate is built from the histogram of register
+// values, with Sigma and Tau correcting for registers that are still zero
+// and registers that have saturated.
+//
+
+static double
+MeowHllSigma(double X)
+{
+    if(X == 1.0)
+    {
+        return(INFINITY);
+    }
+    
+    double Y = 1.0;
+    double Z = X;
+    double Previous;
+    do
+    {
+        X *= X;
+        Previous = Z;
+        Z += X*Y;
+        Y += Y;
+    } while(Z != Previous);
+    
+    return(Z);
+}
+
+static double
+MeowHllTau(double X)
+{
+    if((X == 0.0) || (X == 1.0))
+    {
+        return(0.0);
+    }
+    
+    double Y = 1.0;
+    double Z = 1.0 - X;
+    double Previous;
+    do
+    {
+        X = sqrt(X);
+        Previous = Z;
+        Y *= 0.5;
+        Z -= (1.0 - X)*(1.0 - X)*Y;
+    } while(Z != Previous);
+    
+    return(Z / 3.0);
+}
+
+static double
+MeowHllEstimate(meow_hll *Hll)
+{
+    meow_u64 Histogram[MEOW_HLL_RANK_BITS + 2] = {0};
+    meow_umm Count = MeowHllSize(Hll->Precision);
+    for(meow_umm Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        ++Histogram[Hll->Registers[Index]];
+    }
+    
+    double M = (double)Count;
+    double Z = M*MeowHllTau(1.0 - (double)Histogram[MEOW_HLL_RANK_BITS + 1] / M);
+    for(int Rank = MEOW_HLL_RANK_BITS;
+        Rank >= 1;
+        --Rank)
+    {
+        Z = 0.5*(Z + (double)Histogram[Rank]);
+    }
+    Z += M*MeowHllSigma((double)Histogram[0] / M);
+    
+    double Result = (M*M / (2.0*log(2.0))) / Z;
+    return(Result);
+}
+
+typedef struct meow_hll_header
+{
+    meow_u32 Magic;
+    meow_u16 Version;
+    meow_u16 Precision;
+} meow_hll_header;
+
+static meow_umm
+MeowHllWriteSize(meow_u32 Precision)
+{
+    meow_umm Result = sizeof(meow_hll_header) + (MeowHllSize(Precision)*6 + 7) / 8;
+    return(Result);
+}
+
+// NOTE: Dest needs MeowHllWriteSize bytes
+static void
+MeowHllWrite(meow_hll *Hll, void *Dest)
+{
+    meow_hll_header Header = {MEOW_HLL_MAGIC, MEOW_SKETCH_VERSION, (meow_u16)Hll->Precision};
+    memcpy(Dest, &Header, sizeof(Header));
+    
+    meow_u8 *Packed = (meow_u8 *)Dest + sizeof(Header);
+    meow_umm Count = MeowHllSize(Hll->Precision);
+    for(meow_umm Index = 0;
+        Index < Count;
+        Index += 4)
+    {
+        // NOTE: Four 6-bit registers to three bytes
+        meow_u32 Bits = (Hll->Registers[Index] |
+                         (Hll->Registers[Index + 1] << 6) |
+                         (Hll->Registers[Index + 2] << 12) |
+                         (Hll->Registers[Index + 3] << 18));
+        *Packed++ = (meow_u8)Bits;
+        *Packed++ = (meow_u8)(Bits >> 8);
+        *Packed++ = (meow_u8)(Bits >> 16);
+    }
+}
+
+// NOTE: Returns the precision, or 0 if Source is not a sketch.  Call with
+// Hll->Registers = 0 to get the precision, then again with MeowHllSize of it.
+static meow_u32
+MeowHllRead(meow_hll *Hll, void *Source, meow_umm Size)
+{
+    meow_hll_header Header;
+    meow_u32 Result = 0;
+    if(Size >= sizeof(Header))
+    {
+        memcpy(&Header, Source, sizeof(Header));
+        if((Header.Magic == MEOW_HLL_MAGIC) &&
+           (Header.Version == MEOW_SKETCH_VERSION) &&
+           (Header.Precision >= MEOW_HLL_MIN_PRECISION) &&
+           (Header.Precision <= MEOW_HLL_MAX_PRECISION) &&
+           (Size >= MeowHllWriteSize(Header.Precision)))
+        {
+            Result = Header.Precision;
+        }
+    }
+    
+    if(Result && Hll->Registers)
+    {
+        Hll->Precision = Result;
+        meow_u8 *Packed = (meow_u8 *)Source + sizeof(Header);
+        meow_umm Count = MeowHllSize(Result);
+        for(meow_umm Index = 0;
+            Index < Count;
+            Index += 4)
+        {
+            meow_u32 Bits = Packed[0] | (Packed[1] << 8) | (Packed[2] << 16);
+            Packed += 3;
+            Hll->Registers[Index] = (meow_u8)(Bits & 63);
+            Hll->Registers[Index + 1] = (meow_u8)((Bits >> 6) & 63);
+            Hll->Registers[Index + 2] = (meow_u8)((Bits >> 12) & 63);
+            Hll->Registers[Index + 3] = (meow_u8)((Bits >> 18) & 63);
+        }
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Count-min
+//
+
+typedef struct meow_count_min_header
+{
+    meow_u32 Magic;
+    meow_u16 Version;
+    meow_u8 WidthBits;
+    meow_u8 Depth;
+    meow_u64 Total;
+} meow_count_min_header;
+
+typedef struct meow_count_min
+{
+    meow_count_min_header *Header;
+    meow_u64 *Counters;
+    meow_u32 WidthBits;
+    meow_u32 Depth;
+} meow_count_min;
+
+static meow_umm
+MeowCountMinSize(meow_u32 WidthBits, meow_u32 Depth)
+{
+    meow_umm Result = sizeof(meow_count_min_header) + ((meow_umm)Depth << WidthBits)*sizeof(meow_u64);
+    return(Result);
+}
+
+static int
+MeowCountMinShapeIsValid(meow_u32 WidthBits, meow_u32 Depth)
+{
+    int Result = ((WidthBits >= 2) && (WidthBits <= MEOW_COUNT_MIN_MAX_WIDTH_BITS) &&
+                  (Depth >= 1) && (Depth <= 255));
+    return(Result);
+}
+
+// NOTE: Returns 0 if WidthBits is not 2..32 or Depth is not 1..255
+static int
+MeowCountMinInit(meow_count_min *Sketch, void *Memory, meow_u32 WidthBits, meow_u32 Depth)
+{
+    int Result = (MeowCountMinShapeIsValid(WidthBits, Depth) && Memory);
+    if(Result)
+    {
+        memset(Memory, 0, MeowCountMinSize(WidthBits, Depth));
+        
+        Sketch->Header = (meow_count_min_header *)Memory;
+        Sketch->Header->Magic = MEOW_COUNT_MIN_MAGIC;
+        Sketch->Header->Version = MEOW_COUNT_MIN_VERSION;
+        Sketch->Header->WidthBits = (meow_u8)WidthBits;
+        Sketch->Header->Depth = (meow_u8)Depth;
+        Sketch->Counters = (meow_u64 *)(Sketch->Header + 1);
+        Sketch->WidthBits = WidthBits;
+        Sketch->Depth = Depth;
+    }
+    
+    return(Result);
+}
+
+static meow_u64 *
+MeowCountMinCounter(meow_count_min *Sketch, meow_hash Hash, meow_u32 Row)
+{
+    meow_u64 Low = MeowU64From(Hash, 0);
+    meow_u64 High = MeowU64From(Hash, 1);
+    meow_u64 Index = (Low + Row*High) >> (64 - Sketch->WidthBits);
+    meow_u64 *Result = Sketch->Counters + ((meow_umm)Row << Sketch->WidthBits) + Index;
+    return(Result);
+}
+
+static void
+MeowCountMinAdd(meow_count_min *Sketch, meow_hash Hash, meow_u64 Count)
+{
+    for(meow_u32 Row = 0;
+        Row < Sketch->Depth;
+        ++Row)
+    {
+        *MeowCountMinCounter(Sketch, Hash, Row) += Count;
+    }
+    Sketch->Header->Total += Count;
+}
+
+static meow_u64
+MeowCountMinEstimate(meow_count_min *Sketch, meow_hash Hash)
+{
+    meow_u64 Result = ~0ull;
+    for(meow_u32 Row = 0;
+        Row < Sketch->Depth;
+        ++Row)
+    {
+        meow_u64 Counter = *MeowCountMinCounter(Sketch, Hash, Row);
+        if(Result > Counter)
+        {
+            Result = Counter;
+        }
+    }
+    
+    return(Result);
+}
+
+// NOTE: Returns 0, and leaves Dest alone, if the shapes differ
+static int
+MeowCountMinMerge(meow_count_min *Dest, meow_count_min *Source)
+{
+    int Result = ((Dest->WidthBits == Source->WidthBits) && (Dest->Depth == Source->Depth));
+    if(Result)
+    {
+        meow_umm Count = (meow_umm)Dest->Depth << Dest->WidthBits;
+        meow_umm Index = 0;
+        for(;
+            (Index + 2) <= Count;
+            Index += 2)
+        {
+#if MEOW_HASH_INTEL
+            __m128i *To = (__m128i *)(Dest->Counters + Index);
+            _mm_storeu_si128(To, _mm_add_epi64(_mm_loadu_si128(To), _mm_loadu_si128((__m128i *)(Source->Counters + Index))));
+#elif MEOW_HASH_ARMV8
+            vst1q_u64(Dest->Counters + Index, vaddq_u64(vld1q_u64(Dest->Counters + Index), vld1q_u64(Source->Counters + Index)));
+#endif
+        }
+        for(;
+            Index < Count;
+            ++Index)
+        {
+            Dest->Counters[Index] += Source->Counters[Index];
+        }
+        Dest->Header->Total += Source->Header->Total;
+    }
+    
+    return(Result);
+}
+
+static int
+MeowCountMinFromMemory(meow_count_min *Sketch, void *Memory, meow_umm Size)
+{
+    meow_count_min_header *Header = (meow_count_min_header *)Memory;
+    int Result = ((Size >= sizeof(meow_count_min_header)) &&
+                  (Header->Magic == MEOW_COUNT_MIN_MAGIC) &&
+                  (Header->Version == MEOW_COUNT_MIN_VERSION) &&
+                  MeowCountMinShapeIsValid(Header->WidthBits, Header->Depth) &&
+                  (Size >= MeowCountMinSize(Header->WidthBits, Header->Depth)));
+    if(Result)
+    {
+        Sketch->Header = Header;
+        Sketch->Counters = (meow_u64 *)(Header + 1);
+        Sketch->WidthBits = Header->WidthBits;
+        Sketch->Depth = Header->Depth;
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: Heavy hitters
+//
+
+typedef struct meow_heavy_hitter
+{
+    meow_hash Hash;
+    meow_u64 Estimate;
+} meow_heavy_hitter;
+
+typedef struct meow_heavy_hitters
+{
+    meow_heavy_hitter *Entries;
+    meow_u32 Capacity;
+    meow_u32 Count;
+} meow_heavy_hitters;
+
+static void
+MeowHeavyHittersInit(meow_heavy_hitters *Hitters, meow_heavy_hitter *Entries, meow_u32 Capacity)
+{
+    Hitters->Entries = Entries;
+    Hitters->Capacity = Capacity;
+    Hitters->Count = 0;
+}
+
+// NOTE: Keeps the Capacity highest estimates.  K is small, so this is a scan, not a heap.
+static void
+MeowHeavyHittersOffer(meow_heavy_hitters *Hitters, meow_hash Hash, meow_u64 Estimate)
+{
+    meow_u32 Lowest = 0;
+    for(meow_u32 Index = 0;
+        Index < Hitters->Count;
+        ++Index)
+    {
+        meow_heavy_hitter *Entry = Hitters->Entries + Index;
+        if(MeowHashesAreEqual(Entry->Hash, Hash))
+        {
+            if(Entry->Estimate < Estimate)
+            {
+                Entry->Estimate = Estimate;
+            }
+            return;
+        }
+        
+        if(Entry->Estimate < Hitters->Entries[Lowest].Estimate)
+        {
+            Lowest = Index;
+        }
+    }
+    
+    if(Hitters->Count < Hitters->Capacity)
+    {
+        Lowest = Hitters->Count++;
+    }
+    else if(Hitters->Entries[Lowest].Estimate >= Estimate)
+    {
+        return;
+    }
+    
+    Hitters->Entries[Lowest].Hash = Hash;
+    Hitters->Entries[Lowest].Estimate = Estimate;
+}
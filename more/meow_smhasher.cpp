@@ -9,6 +9,7 @@
 
 #include "meow_intrinsics.h"
 #include "meow_hash.h"
+#include "more/meow_wide.h"
 
 //
 // NOTE(casey): 128-bit wide implementation (Meow1)
@@ -17,21 +18,48 @@
 void
 Meow1_32(const void * key, int len, meow_u32 seed, void * out)
 {
-    meow_u128 Result = MeowHash_Accelerated(seed, len, (void *)key);
+    meow_u128 Result = MeowHash_Accelerated(seed, 0, len, (void *)key);
     *(meow_u32 *)out = MeowU32From(Result, 0);
 }
 
 void
 Meow1_64(const void * key, int len, meow_u32 seed, void * out)
 {
-    meow_u128 Result = MeowHash_Accelerated(seed, len, (void *)key);
+    meow_u128 Result = MeowHash_Accelerated(seed, 0, len, (void *)key);
     ((meow_u64 *)out)[0] = MeowU64From(Result, 0);
 }
 
 void
 Meow1_128(const void * key, int len, meow_u32 seed, void * out)
 {
-    meow_u128 Result = MeowHash_Accelerated(seed, len, (void *)key);
+    meow_u128 Result = MeowHash_Accelerated(seed, 0, len, (void *)key);
+    ((meow_u64 *)out)[0] = MeowU64From(Result, 0);
+    ((meow_u64 *)out)[1] = MeowU64From(Result, 1);
+}
+
+//
+// NOTE: Eight-lane variant (Meow Wide).  Register these next to Meow1_* in
+// smhasher's hash table to run the full suite, LongNeighbors included, on it.
+//
+
+void
+MeowWide_32(const void * key, int len, meow_u32 seed, void * out)
+{
+    meow_u128 Result = MeowWideHash_Accelerated(seed, 0, len, (void *)key);
+    *(meow_u32 *)out = MeowU32From(Result, 0);
+}
+
+void
+MeowWide_64(const void * key, int len, meow_u32 seed, void * out)
+{
+    meow_u128 Result = MeowWideHash_Accelerated(seed, 0, len, (void *)key);
+    ((meow_u64 *)out)[0] = MeowU64From(Result, 0);
+}
+
+void
+MeowWide_128(const void * key, int len, meow_u32 seed, void * out)
+{
+    meow_u128 Result = MeowWideHash_Accelerated(seed, 0, len, (void *)key);
     ((meow_u64 *)out)[0] = MeowU64From(Result, 0);
     ((meow_u64 *)out)[1] = MeowU64From(Result, 1);
 }
@@ -0,0 +1,902 @@
+/* ========================================================================
+   
+   meow_spill.h - out-of-core duplicate finding by spilling and merging
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   Finds every hash that was added more than once, with where each copy
+   was, for more hashes than fit in memory (a dedup report over every block
+   of a few petabytes), in a fixed amount of memory:
+   
+       meow_spill Spill;
+       if(MeowSpillOpen(&Spill, "dedup.tmp", 4ull << 30, 0))   // NOTE: 4GB, one thread per core
+       {
+           MeowSpillAdd(&Spill, BlockHash, BlockLocation);      // NOTE: For every block
+           MeowSpillMerge(&Spill, ReportGroup, Context);
+           MeowSpillClose(&Spill);
+       }
+   
+       static void
+       ReportGroup(void *Context, meow_hash Hash, meow_umm Count, meow_u64 *Locations) {...}
+   
+   Half the memory holds (hash, location) records as they are added.  When
+   it fills up, a background thread sorts it (MeowRadixSort, on all the
+   threads it was given) and writes it out as a sorted run file while the
+   other half fills, so adding never waits on the disk unless the disk is
+   slower than whatever produces the hashes.  Runs are compressed: sorted
+   hashes are close together, so each record is the difference from the
+   previous hash's high half as a varint, the low half as it is, and the
+   location as a varint - 18 to 21 bytes instead of 24, depending on how
+   big runs are and how big locations get.
+   
+   MeowSpillMerge merges all the runs with a loser tree, which costs one
+   comparison per level per record, and calls back once per hash that was
+   seen more than once.  Every run is read through two blocks, one being
+   decoded while the other is read by a small pool of I/O threads, so the
+   merge reads every run at once at the disk's speed.  If there are more
+   runs than the memory has room for blocks of, or than the process may
+   have files open (MEOW_SPILL_MAX_FAN_IN, or half of RLIMIT_NOFILE), the
+   oldest are merged into bigger runs first, so anything fits - it just
+   takes more passes over the disk.
+   
+   A group of more than MEOW_SPILL_GROUP_MAX copies (the hash of an empty
+   block, say) is reported in pieces of at most that many, one after
+   another, all with the same hash, so it does not have to fit in memory
+   either.  Apart from that, groups come in hash order, and the locations
+   in a group are in no particular order.  MeowSpillMerge can only be
+   called once, and deletes runs once they have been merged into a run
+   that was written out whole (or reported); MeowSpillClose deletes any
+   that are left, including after a failed merge.
+   
+   Memory is the budget, plus a MEOW_SPILL_BLOCK for the run being written
+   and MeowRadixSort's per-thread buffers.  Callback may be 0, to only
+   count (see the statistics at the end of meow_spill).  The directory is
+   made if it is not there (but not its parents), and run files in it are
+   named run-<number>.meowrun, so use a directory no other spill is using.
+   Run files are little-endian.
+   
+   Include meow_intrinsics.h, meow_hash.h and more/meow_radix.h first.
+   Needs threads.
+   
+   ======================================================================== */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#if _WIN32
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <sys/resource.h>
+#endif
+
+#define MEOW_SPILL_MAGIC 0x314E5552574F454Dull // NOTE: "MEOWRUN1"
+#define MEOW_SPILL_VERSION 1
+#define MEOW_SPILL_MAX_PATH 1024
+#define MEOW_SPILL_MAX_NAME 32     // NOTE: The longest run file name, with its slash
+#define MEOW_SPILL_BLOCK (1 << 20)
+#define MEOW_SPILL_MIN_BLOCK 4096
+#define MEOW_SPILL_MAX_RECORD 28    // NOTE: Two 10-byte varints and the 8-byte low half
+#define MEOW_SPILL_GROUP_MAX 65536
+#define MEOW_SPILL_MAX_FAN_IN 512
+#define MEOW_SPILL_IO_THREADS 4
+
+typedef void meow_spill_group(void *Context, meow_hash Hash, meow_umm Count, meow_u64 *Locations);
+
+typedef struct meow_spill_run_header
+{
+    meow_u64 Magic;
+    meow_u32 Version;
+    meow_u32 Reserved;
+    meow_u64 Count;
+} meow_spill_run_header;
+
+typedef struct meow_spill_writer
+{
+    FILE *File;
+    meow_u8 *Block;
+    meow_umm BlockSize;
+    meow_umm Used;
+    meow_u64 PreviousHigh;
+    meow_u64 Count;
+    meow_u64 Bytes;
+    int Failed;
+} meow_spill_writer;
+
+typedef struct meow_spill_reader
+{
+    FILE *File;
+    meow_u8 *Memory;        // NOTE: Two blocks, each with room in front for a record split across them,
+                            // and room after the last so a short file can not be decoded off the end
+    meow_umm BlockSize;
+    meow_u8 *At;
+    meow_u8 *End;
+    int Next;
+    struct meow_spill_io *IO;
+    int Fetching;           // NOTE: Block Next has been asked for, if there is more to read
+    int Pending;            // NOTE: ... and is not read yet.  Guarded by IO->Mutex.
+    meow_umm Fetched;
+    
+    meow_u64 Remaining;
+    meow_radix_entry Entry;
+    int Done;
+    int Failed;
+} meow_spill_reader;
+
+// NOTE: Reads blocks for every reader of a merge, which has at most one request each
+typedef struct meow_spill_io
+{
+    std::mutex Mutex;
+    std::condition_variable Requested;
+    std::condition_variable Finished;
+    meow_spill_reader **Queue;
+    meow_u32 QueueSize;
+    meow_u32 First;
+    meow_u32 Count;
+    int Stop;
+    
+    std::thread *Threads[MEOW_SPILL_IO_THREADS];
+    meow_u32 ThreadCount;
+} meow_spill_io;
+
+typedef struct meow_spill
+{
+    char Directory[MEOW_SPILL_MAX_PATH - MEOW_SPILL_MAX_NAME];
+    int ThreadCount;
+    meow_u64 MemoryBudget;
+    meow_umm BlockSize;
+    
+    // NOTE: One buffer fills while the other is sorted and written out by Writer
+    meow_radix_entry *Buffers[2];
+    meow_umm BufferCapacity;
+    meow_umm Filled;
+    int Current;
+    std::thread *Writer;
+    meow_umm WriterCount;
+    meow_u32 WriterRun;
+    meow_u64 WriterBytes;
+    int WriterFailed;
+    
+    meow_u32 *Runs;
+    meow_u32 RunCount;
+    meow_u32 RunCapacity;
+    meow_u32 NextRun;
+    
+    meow_u64 *Locations;
+    int Failed;
+    
+    // NOTE: Statistics.  Distinct, group and duplicate counts are set by MeowSpillMerge.
+    meow_u64 RecordCount;
+    meow_u64 RunsWritten;
+    meow_u64 BytesWritten;
+    meow_u64 DistinctCount;
+    meow_u64 GroupCount;
+    meow_u32 FanIn;            // NOTE: Most runs merged at once
+    meow_u64 DuplicateCount;   // NOTE: Every copy after the first of each hash
+} meow_spill;
+
+static void
+MeowSpillRunPath(meow_spill *Spill, char *Path, meow_u32 Run)
+{
+    snprintf(Path, MEOW_SPILL_MAX_PATH, "%s/run-%08u.meowrun", Spill->Directory, (unsigned)Run);
+}
+
+//
+// NOTE: Run files are a header and then records, each the high half as a
+// varint difference from the previous record's, the low half, and the
+// location as a varint
+//
+
+static meow_u8 *
+MeowSpillPutVarint(meow_u8 *At, meow_u64 Value)
+{
+    while(Value >= 0x80)
+    {
+        *At++ = (meow_u8)(Value | 0x80);
+        Value >>= 7;
+    }
+    *At++ = (meow_u8)Value;
+    
+    return(At);
+}
+
+static meow_u8 *
+MeowSpillGetVarint(meow_u8 *At, meow_u64 *Value)
+{
+    meow_u64 Result = 0;
+    int Shift = 0;
+    meow_u8 Byte;
+    do
+    {
+        Byte = *At++;
+        Result |= (meow_u64)(Byte & 0x7F) << Shift;
+        Shift += 7;
+    } while((Byte & 0x80) && (Shift < 64));
+    *Value = Result;
+    
+    return(At);
+}
+
+static int
+MeowSpillWriterOpen(meow_spill_writer *Writer, char const *Path, meow_umm BlockSize)
+{
+    memset(Writer, 0, sizeof(*Writer));
+    Writer->BlockSize = BlockSize;
+    Writer->Block = (meow_u8 *)malloc(BlockSize);
+    Writer->File = fopen(Path, "wb");
+    
+    meow_spill_run_header Header = {};
+    int Result = (Writer->Block && Writer->File && (fwrite(&Header, sizeof(Header), 1, Writer->File) == 1));
+    Writer->Bytes = sizeof(Header);
+    Writer->Failed = !Result;
+    
+    return(Result);
+}
+
+static void
+MeowSpillWriterFlush(meow_spill_writer *Writer)
+{
+    if(Writer->Used)
+    {
+        Writer->Failed |= (fwrite(Writer->Block, 1, Writer->Used, Writer->File) != Writer->Used);
+        Writer->Bytes += Writer->Used;
+        Writer->Used = 0;
+    }
+}
+
+static void
+MeowSpillWrite(meow_spill_writer *Writer, meow_radix_entry *Entry)
+{
+    if((Writer->Used + MEOW_SPILL_MAX_RECORD) > Writer->BlockSize)
+    {
+        MeowSpillWriterFlush(Writer);
+    }
+    
+    meow_u8 *At = Writer->Block + Writer->Used;
+    At = MeowSpillPutVarint(At, Entry->High - Writer->PreviousHigh);
+    memcpy(At, &Entry->Low, sizeof(Entry->Low));
+    At = MeowSpillPutVarint(At + sizeof(Entry->Low), Entry->Payload);
+    Writer->Used = (meow_umm)(At - Writer->Block);
+    Writer->PreviousHigh = Entry->High;
+    ++Writer->Count;
+}
+
+// NOTE: Goes back and fills in the count, since it is not known until the end
+static int
+MeowSpillWriterClose(meow_spill_writer *Writer)
+{
+    if(Writer->File)
+    {
+        MeowSpillWriterFlush(Writer);
+        
+        meow_spill_run_header Header = {};
+        Header.Magic = MEOW_SPILL_MAGIC;
+        Header.Version = MEOW_SPILL_VERSION;
+        Header.Count = Writer->Count;
+        Writer->Failed |= (fseek(Writer->File, 0, SEEK_SET) != 0);
+        Writer->Failed |= (fwrite(&Header, sizeof(Header), 1, Writer->File) != 1);
+        Writer->Failed |= (fclose(Writer->File) != 0);
+    }
+    free(Writer->Block);
+    
+    int Result = !Writer->Failed;
+    return(Result);
+}
+
+//
+// NOTE: Reading runs back
+//
+
+static meow_u8 *
+MeowSpillReaderBlock(meow_spill_reader *Reader, int Block)
+{
+    meow_u8 *Result = Reader->Memory + Block*(MEOW_SPILL_MAX_RECORD + Reader->BlockSize) + MEOW_SPILL_MAX_RECORD;
+    return(Result);
+}
+
+static void
+MeowSpillIOThread(meow_spill_io *IO)
+{
+    std::unique_lock<std::mutex> Lock(IO->Mutex);
+    for(;;)
+    {
+        IO->Requested.wait(Lock, [IO]() {return(IO->Count || IO->Stop);});
+        if(IO->Count == 0)
+        {
+            break;
+        }
+        
+        meow_spill_reader *Reader = IO->Queue[IO->First];
+        IO->First = (IO->First + 1) % IO->QueueSize;
+        --IO->Count;
+        meow_u8 *Block = MeowSpillReaderBlock(Reader, Reader->Next);
+        
+        Lock.unlock();
+        meow_umm Fetched = fread(Block, 1, Reader->BlockSize, Reader->File);
+        Lock.lock();
+        
+        Reader->Fetched = Fetched;
+        Reader->Pending = 0;
+        IO->Finished.notify_all();
+    }
+}
+
+// NOTE: Returns 0 if there is not enough memory
+static meow_spill_io *
+MeowSpillIOStart(meow_u32 ReaderCount)
+{
+    meow_spill_io *IO = new meow_spill_io();
+    IO->QueueSize = ReaderCount;
+    IO->Queue = (meow_spill_reader **)malloc(ReaderCount*sizeof(meow_spill_reader *));
+    if(IO->Queue)
+    {
+        IO->ThreadCount = (ReaderCount < MEOW_SPILL_IO_THREADS) ? ReaderCount : MEOW_SPILL_IO_THREADS;
+        for(meow_u32 Thread = 0;
+            Thread < IO->ThreadCount;
+            ++Thread)
+        {
+            IO->Threads[Thread] = new std::thread(MeowSpillIOThread, IO);
+        }
+    }
+    else
+    {
+        delete IO;
+        IO = 0;
+    }
+    
+    return(IO);
+}
+
+// NOTE: Every reader must be closed first, so nothing is left in the queue
+static void
+MeowSpillIOStop(meow_spill_io *IO)
+{
+    if(IO)
+    {
+        {
+            std::lock_guard<std::mutex> Lock(IO->Mutex);
+            IO->Stop = 1;
+        }
+        IO->Requested.notify_all();
+        
+        for(meow_u32 Thread = 0;
+            Thread < IO->ThreadCount;
+            ++Thread)
+        {
+            IO->Threads[Thread]->join();
+            delete IO->Threads[Thread];
+        }
+        free(IO->Queue);
+        delete IO;
+    }
+}
+
+static void
+MeowSpillReaderFetch(meow_spill_reader *Reader)
+{
+    meow_spill_io *IO = Reader->IO;
+    {
+        std::lock_guard<std::mutex> Lock(IO->Mutex);
+        Reader->Pending = 1;
+        IO->Queue[(IO->First + IO->Count++) % IO->QueueSize] = Reader;
+    }
+    IO->Requested.notify_one();
+    Reader->Fetching = 1;
+}
+
+static void
+MeowSpillReaderWait(meow_spill_reader *Reader)
+{
+    meow_spill_io *IO = Reader->IO;
+    std::unique_lock<std::mutex> Lock(IO->Mutex);
+    IO->Finished.wait(Lock, [Reader]() {return(!Reader->Pending);});
+    Reader->Fetching = 0;
+}
+
+// NOTE: Decodes the next record into Entry, or sets Done
+static void
+MeowSpillReaderAdvance(meow_spill_reader *Reader)
+{
+    if(Reader->Remaining == 0)
+    {
+        Reader->Done = 1;
+    }
+    else
+    {
+        // NOTE: Whatever is left of this block goes in front of the next one
+        if(((meow_umm)(Reader->End - Reader->At) < MEOW_SPILL_MAX_RECORD) && Reader->Fetching)
+        {
+            MeowSpillReaderWait(Reader);
+            
+            meow_umm Left = (meow_umm)(Reader->End - Reader->At);
+            meow_u8 *Block = MeowSpillReaderBlock(Reader, Reader->Next);
+            memmove(Block - Left, Reader->At, Left);
+            Reader->At = Block - Left;
+            Reader->End = Block + Reader->Fetched;
+            Reader->Next ^= 1;
+            if(Reader->Fetched == Reader->BlockSize)
+            {
+                MeowSpillReaderFetch(Reader);
+            }
+        }
+        
+        // NOTE: A record can not be longer than MEOW_SPILL_MAX_RECORD, so a short read means a short file
+        meow_u64 Difference;
+        meow_u8 *At = MeowSpillGetVarint(Reader->At, &Difference);
+        memcpy(&Reader->Entry.Low, At, sizeof(Reader->Entry.Low));
+        At = MeowSpillGetVarint(At + sizeof(Reader->Entry.Low), &Reader->Entry.Payload);
+        Reader->Entry.High += Difference;
+        Reader->At = At;
+        --Reader->Remaining;
+        
+        if(Reader->At > Reader->End)
+        {
+            Reader->Failed = 1;
+            Reader->Done = 1;
+        }
+    }
+}
+
+static int
+MeowSpillReaderOpen(meow_spill_reader *Reader, char const *Path, meow_umm BlockSize, meow_spill_io *IO)
+{
+    memset(Reader, 0, sizeof(*Reader));
+    Reader->IO = IO;
+    Reader->BlockSize = BlockSize;
+    Reader->Memory = (meow_u8 *)calloc(1, 2*(MEOW_SPILL_MAX_RECORD + BlockSize) + MEOW_SPILL_MAX_RECORD);
+    Reader->File = fopen(Path, "rb");
+    
+    meow_spill_run_header Header = {};
+    int Result = (Reader->Memory && Reader->File &&
+                  (fread(&Header, sizeof(Header), 1, Reader->File) == 1) &&
+                  (Header.Magic == MEOW_SPILL_MAGIC) &&
+                  (Header.Version == MEOW_SPILL_VERSION));
+    if(Result)
+    {
+        Reader->Remaining = Header.Count;
+        Reader->At = Reader->End = MeowSpillReaderBlock(Reader, 0);
+        MeowSpillReaderFetch(Reader);
+        MeowSpillReaderAdvance(Reader);
+    }
+    else
+    {
+        Reader->Failed = 1;
+        Reader->Done = 1;
+    }
+    
+    return(Result);
+}
+
+static int
+MeowSpillReaderClose(meow_spill_reader *Reader)
+{
+    if(Reader->Fetching)
+    {
+        MeowSpillReaderWait(Reader);
+    }
+    if(Reader->File)
+    {
+        fclose(Reader->File);
+    }
+    free(Reader->Memory);
+    
+    int Result = !Reader->Failed;
+    return(Result);
+}
+
+//
+// NOTE: Loser tree.  Leaves are K..2K-1 and Tree[1..K-1] hold the loser at
+// each internal node, so any K works.  The overall winner is not stored in
+// the tree (Tree[0] is unused); Build and Replay return it.
+//
+
+static int
+MeowSpillReaderLess(meow_spill_reader *Readers, meow_u32 A, meow_u32 B)
+{
+    meow_spill_reader *RA = Readers + A;
+    meow_spill_reader *RB = Readers + B;
+    int Result;
+    if(RA->Done || RB->Done)
+    {
+        Result = !RA->Done || (RB->Done && (A < B));
+    }
+    else
+    {
+        Result = ((RA->Entry.High < RB->Entry.High) ||
+                  ((RA->Entry.High == RB->Entry.High) &&
+                   ((RA->Entry.Low < RB->Entry.Low) || ((RA->Entry.Low == RB->Entry.Low) && (A < B)))));
+    }
+    
+    return(Result);
+}
+
+static meow_u32
+MeowSpillTreeBuild(meow_spill_reader *Readers, meow_u32 *Tree, meow_u32 K, meow_u32 Node)
+{
+    meow_u32 Result;
+    if(Node >= K)
+    {
+        Result = Node - K;
+    }
+    else
+    {
+        meow_u32 Left = MeowSpillTreeBuild(Readers, Tree, K, 2*Node);
+        meow_u32 Right = MeowSpillTreeBuild(Readers, Tree, K, 2*Node + 1);
+        int LeftWins = MeowSpillReaderLess(Readers, Left, Right);
+        Tree[Node] = LeftWins ? Right : Left;
+        Result = LeftWins ? Left : Right;
+    }
+    
+    return(Result);
+}
+
+// NOTE: After the winner's reader has moved on, plays it back up its path
+static meow_u32
+MeowSpillTreeReplay(meow_spill_reader *Readers, meow_u32 *Tree, meow_u32 K, meow_u32 Winner)
+{
+    for(meow_u32 Node = (Winner + K) >> 1;
+        Node >= 1;
+        Node >>= 1)
+    {
+        if(MeowSpillReaderLess(Readers, Tree[Node], Winner))
+        {
+            meow_u32 Loser = Winner;
+            Winner = Tree[Node];
+            Tree[Node] = Loser;
+        }
+    }
+    
+    return(Winner);
+}
+
+static void
+MeowSpillEmit(meow_spill *Spill, meow_radix_entry *Group, meow_umm Count,
+              meow_spill_group *Callback, void *Context)
+{
+    meow_u64 Halves[2] = {Group->Low, Group->High};
+    meow_hash Hash;
+    memcpy(&Hash, Halves, sizeof(Hash));
+    if(Callback)
+    {
+        Callback(Context, Hash, Count, Spill->Locations);
+    }
+}
+
+// NOTE: Merges runs either into Output, or into groups for Callback.  The
+// runs are left alone; the caller deletes them once it knows the merge worked.
+static int
+MeowSpillMergeRuns(meow_spill *Spill, meow_u32 *Runs, meow_u32 K, meow_spill_writer *Output,
+                   meow_spill_group *Callback, void *Context)
+{
+    meow_spill_reader *Readers = (meow_spill_reader *)calloc(K, sizeof(meow_spill_reader));
+    meow_u32 *Tree = (meow_u32 *)malloc(K*sizeof(meow_u32));
+    meow_spill_io *IO = (Readers && Tree) ? MeowSpillIOStart(K) : 0;
+    int Result = (IO != 0);
+    if(Result)
+    {
+        char Path[MEOW_SPILL_MAX_PATH];
+        for(meow_u32 Run = 0;
+            Run < K;
+            ++Run)
+        {
+            MeowSpillRunPath(Spill, Path, Runs[Run]);
+            Result &= MeowSpillReaderOpen(Readers + Run, Path, Spill->BlockSize, IO);
+        }
+        
+        meow_radix_entry Group = {};
+        meow_umm GroupCount = 0;
+        meow_u64 GroupTotal = 0;
+        for(meow_u32 Winner = MeowSpillTreeBuild(Readers, Tree, K, 1);
+            Result && !Readers[Winner].Done;
+            Winner = MeowSpillTreeReplay(Readers, Tree, K, Winner))
+        {
+            meow_radix_entry *Entry = &Readers[Winner].Entry;
+            if(Output)
+            {
+                MeowSpillWrite(Output, Entry);
+            }
+            else
+            {
+                if(GroupTotal && ((Entry->High != Group.High) || (Entry->Low != Group.Low)))
+                {
+                    if(GroupTotal > 1)
+                    {
+                        MeowSpillEmit(Spill, &Group, GroupCount, Callback, Context);
+                        ++Spill->GroupCount;
+                        Spill->DuplicateCount += GroupTotal - 1;
+                    }
+                    GroupCount = 0;
+                    GroupTotal = 0;
+                }
+                if(GroupTotal == 0)
+                {
+                    Group = *Entry;
+                    ++Spill->DistinctCount;
+                }
+                else if(GroupCount == MEOW_SPILL_GROUP_MAX)
+                {
+                    MeowSpillEmit(Spill, &Group, GroupCount, Callback, Context);
+                    GroupCount = 0;
+                }
+                
+                Spill->Locations[GroupCount++] = Entry->Payload;
+                ++GroupTotal;
+            }
+            
+            MeowSpillReaderAdvance(Readers + Winner);
+        }
+        
+        if(Result && (GroupTotal > 1))
+        {
+            MeowSpillEmit(Spill, &Group, GroupCount, Callback, Context);
+            ++Spill->GroupCount;
+            Spill->DuplicateCount += GroupTotal - 1;
+        }
+        
+        for(meow_u32 Run = 0;
+            Run < K;
+            ++Run)
+        {
+            Result &= MeowSpillReaderClose(Readers + Run);
+        }
+    }
+    MeowSpillIOStop(IO);
+    free(Tree);
+    free(Readers);
+    
+    return(Result);
+}
+
+static void
+MeowSpillRemoveRuns(meow_spill *Spill, meow_u32 *Runs, meow_u32 Count)
+{
+    char Path[MEOW_SPILL_MAX_PATH];
+    for(meow_u32 Run = 0;
+        Run < Count;
+        ++Run)
+    {
+        MeowSpillRunPath(Spill, Path, Runs[Run]);
+        remove(Path);
+    }
+}
+
+// NOTE: Every run being merged holds a file open, so leave half of what the process may open for everything else
+static meow_u32
+MeowSpillMaxFanIn(void)
+{
+    meow_u64 Result = MEOW_SPILL_MAX_FAN_IN;
+#if _WIN32
+    meow_u64 Limit = (meow_u64)_getmaxstdio() / 2;
+    Result = (Limit < Result) ? Limit : Result;
+#else
+    struct rlimit Limit;
+    if((getrlimit(RLIMIT_NOFILE, &Limit) == 0) && (Limit.rlim_cur != RLIM_INFINITY))
+    {
+        Result = ((Limit.rlim_cur / 2) < Result) ? (Limit.rlim_cur / 2) : Result;
+    }
+#endif
+    Result = (Result < 2) ? 2 : Result;
+    
+    return((meow_u32)Result);
+}
+
+//
+// NOTE: Spilling
+//
+
+static int
+MeowSpillAddRun(meow_spill *Spill, meow_u32 Run)
+{
+    if(Spill->RunCount == Spill->RunCapacity)
+    {
+        meow_u32 Capacity = Spill->RunCapacity ? 2*Spill->RunCapacity : 64;
+        meow_u32 *Runs = (meow_u32 *)realloc(Spill->Runs, Capacity*sizeof(meow_u32));
+        if(Runs)
+        {
+            Spill->Runs = Runs;
+            Spill->RunCapacity = Capacity;
+        }
+    }
+    
+    int Result = (Spill->RunCount < Spill->RunCapacity);
+    if(Result)
+    {
+        Spill->Runs[Spill->RunCount++] = Run;
+    }
+    
+    return(Result);
+}
+
+static void
+MeowSpillWaitForWriter(meow_spill *Spill)
+{
+    if(Spill->Writer)
+    {
+        Spill->Writer->join();
+        delete Spill->Writer;
+        Spill->Writer = 0;
+        Spill->BytesWritten += Spill->WriterBytes;
+        Spill->Failed |= Spill->WriterFailed || !MeowSpillAddRun(Spill, Spill->WriterRun);
+    }
+}
+
+// NOTE: Hands the filled buffer to a thread to sort and write, and switches to the other one
+static void
+MeowSpillFlushBuffer(meow_spill *Spill)
+{
+    MeowSpillWaitForWriter(Spill);
+    if(Spill->Filled)
+    {
+        Spill->WriterCount = Spill->Filled;
+        Spill->WriterRun = Spill->NextRun++;
+        meow_radix_entry *Buffer = Spill->Buffers[Spill->Current];
+        Spill->Writer = new std::thread([Spill, Buffer]()
+        {
+            int Failed = !MeowRadixSort(Buffer, Spill->WriterCount, 0, Spill->ThreadCount);
+            
+            char Path[MEOW_SPILL_MAX_PATH];
+            MeowSpillRunPath(Spill, Path, Spill->WriterRun);
+            meow_spill_writer Writer;
+            Failed |= !MeowSpillWriterOpen(&Writer, Path, Spill->BlockSize);
+            for(meow_umm Index = 0;
+                !Failed && (Index < Spill->WriterCount);
+                ++Index)
+            {
+                MeowSpillWrite(&Writer, Buffer + Index);
+            }
+            Failed |= !MeowSpillWriterClose(&Writer);
+            
+            // NOTE: Only read by the adding thread after it joins this one
+            Spill->WriterBytes = Writer.Bytes;
+            Spill->WriterFailed = Failed;
+        });
+        
+        ++Spill->RunsWritten;
+        Spill->Current ^= 1;
+        Spill->Filled = 0;
+    }
+}
+
+// NOTE: Returns 0 if the directory path is too long or there is not enough memory
+static int
+MeowSpillOpen(meow_spill *Spill, char const *Directory, meow_u64 MemoryBudget, int ThreadCount)
+{
+    memset(Spill, 0, sizeof(*Spill));
+    
+    int Result = (strlen(Directory) < sizeof(Spill->Directory));
+    if(Result)
+    {
+        strcpy(Spill->Directory, Directory);
+#if _WIN32
+        CreateDirectoryA(Directory, 0);
+#else
+        mkdir(Directory, 0777);
+#endif
+        
+        Spill->ThreadCount = ThreadCount;
+        Spill->MemoryBudget = MemoryBudget;
+        Spill->BlockSize = MEOW_SPILL_BLOCK;
+        while((Spill->BlockSize > MEOW_SPILL_MIN_BLOCK) && ((Spill->BlockSize*64) > MemoryBudget))
+        {
+            Spill->BlockSize >>= 1;
+        }
+        
+        Spill->BufferCapacity = (meow_umm)(MemoryBudget / (2*sizeof(meow_radix_entry)));
+        Spill->Buffers[0] = (meow_radix_entry *)malloc(Spill->BufferCapacity*sizeof(meow_radix_entry));
+        Spill->Buffers[1] = (meow_radix_entry *)malloc(Spill->BufferCapacity*sizeof(meow_radix_entry));
+        Result = (Spill->BufferCapacity > 0) && Spill->Buffers[0] && Spill->Buffers[1];
+        if(!Result)
+        {
+            free(Spill->Buffers[0]);
+            free(Spill->Buffers[1]);
+            Spill->Buffers[0] = Spill->Buffers[1] = 0;
+        }
+    }
+    
+    return(Result);
+}
+
+// NOTE: Returns 0 if writing a run has failed, in which case the merge will too
+static int
+MeowSpillAdd(meow_spill *Spill, meow_hash Hash, meow_u64 Location)
+{
+    meow_radix_entry *Entry = Spill->Buffers[Spill->Current] + Spill->Filled++;
+    Entry->Low = MeowU64From(Hash, 0);
+    Entry->High = MeowU64From(Hash, 1);
+    Entry->Payload = Location;
+    ++Spill->RecordCount;
+    
+    if(Spill->Filled == Spill->BufferCapacity)
+    {
+        MeowSpillFlushBuffer(Spill);
+    }
+    
+    int Result = !Spill->Failed;
+    return(Result);
+}
+
+// NOTE: Returns non-zero if every run was written and read back whole
+static int
+MeowSpillMerge(meow_spill *Spill, meow_spill_group *Callback, void *Context)
+{
+    MeowSpillFlushBuffer(Spill);
+    MeowSpillWaitForWriter(Spill);
+    
+    // NOTE: The record buffers are done with, and their memory goes to the merge's blocks
+    free(Spill->Buffers[0]);
+    free(Spill->Buffers[1]);
+    Spill->Buffers[0] = Spill->Buffers[1] = 0;
+    
+    meow_u64 ReaderSize = 2*(MEOW_SPILL_MAX_RECORD + Spill->BlockSize);
+    meow_u64 LocationsSize = MEOW_SPILL_GROUP_MAX*sizeof(meow_u64);
+    meow_u64 FanIn = (Spill->MemoryBudget > LocationsSize) ? ((Spill->MemoryBudget - LocationsSize) / ReaderSize) : 0;
+    meow_u64 MaxFanIn = MeowSpillMaxFanIn();
+    FanIn = (FanIn < 2) ? 2 : (FanIn > MaxFanIn) ? MaxFanIn : FanIn;
+    Spill->FanIn = (meow_u32)FanIn;
+    
+    Spill->Locations = (meow_u64 *)malloc(LocationsSize);
+    int Result = !Spill->Failed && (Spill->Locations != 0);
+    
+    // NOTE: Oldest runs first, so every record goes through about the same number of merges
+    while(Result && (Spill->RunCount > FanIn))
+    {
+        meow_u32 Run = Spill->NextRun++;
+        char Path[MEOW_SPILL_MAX_PATH];
+        MeowSpillRunPath(Spill, Path, Run);
+        
+        meow_spill_writer Writer;
+        Result = (MeowSpillWriterOpen(&Writer, Path, Spill->BlockSize) &&
+                  MeowSpillMergeRuns(Spill, Spill->Runs, (meow_u32)FanIn, &Writer, 0, 0));
+        Result &= MeowSpillWriterClose(&Writer);
+        Spill->BytesWritten += Writer.Bytes;
+        ++Spill->RunsWritten;
+        
+        // NOTE: The merged runs only go once the new one is closed and whole; otherwise MeowSpillClose deletes them
+        if(Result)
+        {
+            MeowSpillRemoveRuns(Spill, Spill->Runs, (meow_u32)FanIn);
+            Spill->RunCount -= (meow_u32)FanIn;
+            memmove(Spill->Runs, Spill->Runs + FanIn, Spill->RunCount*sizeof(meow_u32));
+            Spill->Runs[Spill->RunCount++] = Run;
+        }
+        else
+        {
+            remove(Path);
+        }
+    }
+    
+    if(Result && Spill->RunCount)
+    {
+        Result = MeowSpillMergeRuns(Spill, Spill->Runs, Spill->RunCount, 0, Callback, Context);
+        if(Result)
+        {
+            MeowSpillRemoveRuns(Spill, Spill->Runs, Spill->RunCount);
+            Spill->RunCount = 0;
+        }
+    }
+    
+    return(Result);
+}
+
+static void
+MeowSpillClose(meow_spill *Spill)
+{
+    MeowSpillWaitForWriter(Spill);
+    MeowSpillRemoveRuns(Spill, Spill->Runs, Spill->RunCount);
+    
+    free(Spill->Buffers[0]);
+    free(Spill->Buffers[1]);
+    free(Spill->Runs);
+    free(Spill->Locations);
+    memset(Spill, 0, sizeof(*Spill));
+}
@@ -11,6 +11,13 @@
 #include <stdlib.h>
 #include <memory.h>
 
+#if _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #undef MEOW_INCLUDE_C
 #undef MEOW_INCLUDE_TRUNCATIONS
 #undef MEOW_INCLUDE_OTHER_HASHES
@@ -20,6 +27,25 @@
 #define MEOW_INCLUDE_OTHER_HASHES 0
 
 #include "meow_test.h"
+#include "more/meow_multiset.h"
+#include "more/megapaw_hash.h"
+#include "more/meow_kernel.h"
+#include "more/meow_constexpr.h"
+#include "more/meow_column.h"
+#include "more/meow_partition.h"
+#include "more/meow_radix.h"
+#include "more/meow_index.h"
+#include "more/meow_perfect_hash.h"
+#include "more/meow_bloom.h"
+#include "more/meow_sketch.h"
+#include "more/meow_minhash.h"
+#include "more/meow_memo.h"
+#include "more/meow_placement.h"
+#include "more/meow_spill.h"
+#include "more/meow_cpp.h"
+#include "more/meow_map.h"
+#include "more/meow_fingerprint_set.h"
+#include "more/meow_intern.h"
 
 //
 // NOTE(casey): Minimalist code for Meow testing.
@@ -29,6 +55,579 @@
 // working correctly.
 //
 
+//
+// NOTE: Checks one kernel configuration's one-shot, streaming and ANSI-C
+// versions against each other, returning non-zero on any mismatch
+//
+
+template<int Lanes, int Rounds, int Width>
+static int
+KernelDisagrees(meow_u8 *BufferEnd)
+{
+    typedef meow_kernel<Lanes, Rounds, Width> kernel;
+    
+    int Result = 0;
+    for(meow_u32 Size = 0;
+        Size <= 700;
+        ++Size)
+    {
+        meow_u8 *Source = BufferEnd - Size;
+        meow_u64 Seed1 = rand();
+        meow_u64 Seed2 = rand();
+        meow_hash Reference = meow_kernel<Lanes, Rounds, 128, meow_kernel_c>::Hash(Seed1, Seed2, Size, Source);
+        Result |= !MeowHashesAreEqual(Reference, kernel::Hash(Seed1, Seed2, Size, Source));
+        
+        typename kernel::state State;
+        kernel::Begin(&State, Seed1, Seed2, Size);
+        meow_u64 At = 0;
+        while(At < Size)
+        {
+            meow_u64 Len = rand() % 300;
+            if(Len > (Size - At))
+            {
+                Len = Size - At;
+            }
+            kernel::Absorb(&State, Len, Source + At);
+            At += Len;
+        }
+        Result |= !MeowHashesAreEqual(Reference, kernel::End(&State, Seed1, Seed2));
+    }
+    
+    return(Result);
+}
+
+//
+// NOTE: smhasher's LongNeighbors, in small: a long random key and every
+// key one or two bit flips away from it, with the flips among the first
+// 16 bits of each 16-byte lane of the first 128 bytes, so that flips in
+// different lanes at the same offset get every chance to cancel when the
+// lanes are folded.  Returns how many of those keys collide in the low
+// 64 bits, which for a good hash is 0 with overwhelming probability.
+//
+
+static meow_umm
+LongNeighborCollisions(meow_hash_implementation *Imp, meow_umm Len, meow_u64 Seed)
+{
+    int const BitCount = 128;
+    meow_umm Count = 1 + BitCount + BitCount*(BitCount - 1)/2;
+    meow_radix_entry *Entries = (meow_radix_entry *)malloc(Count*sizeof(meow_radix_entry));
+    meow_u8 *Key = (meow_u8 *)malloc(Len);
+    for(meow_umm ByteIndex = 0;
+        ByteIndex < Len;
+        ++ByteIndex)
+    {
+        Key[ByteIndex] = (meow_u8)rand();
+    }
+    
+    // NOTE: Flip BitCount stands for no flip, so (A, BitCount) is a single flip and (BitCount, BitCount) none
+    meow_umm At = 0;
+    for(int A = 0;
+        A <= BitCount;
+        ++A)
+    {
+        for(int B = A;
+            B <= BitCount;
+            ++B)
+        {
+            if((A == B) && (A < BitCount))
+            {
+                continue;
+            }
+            
+            int Flips[2] = {A, B};
+            for(int Flip = 0;
+                Flip < 2;
+                ++Flip)
+            {
+                if(Flips[Flip] < BitCount)
+                {
+                    Key[16*(Flips[Flip] / 16) + (Flips[Flip] % 16) / 8] ^= (meow_u8)(1 << (Flips[Flip] % 8));
+                }
+            }
+            
+            meow_hash Hash = Imp(Seed, Seed, Len, Key);
+            Entries[At].Low = 0;
+            Entries[At].High = MeowU64From(Hash, 0);
+            Entries[At].Payload = At;
+            ++At;
+            
+            for(int Flip = 0;
+                Flip < 2;
+                ++Flip)
+            {
+                if(Flips[Flip] < BitCount)
+                {
+                    Key[16*(Flips[Flip] / 16) + (Flips[Flip] % 16) / 8] ^= (meow_u8)(1 << (Flips[Flip] % 8));
+                }
+            }
+        }
+    }
+    
+    MeowRadixSort(Entries, Count, 0, 1);
+    meow_umm Result = 0;
+    for(meow_umm Index = 1;
+        Index < Count;
+        ++Index)
+    {
+        Result += (Entries[Index].High == Entries[Index - 1].High);
+    }
+    
+    free(Key);
+    free(Entries);
+    
+    return(Result);
+}
+
+//
+// NOTE: Memory that ends right where a page that can not be touched
+// starts, so reading even one byte past the end of it faults
+//
+
+static meow_umm
+GuardedPageSize(void)
+{
+#if _WIN32
+    SYSTEM_INFO Info;
+    GetSystemInfo(&Info);
+    meow_umm Result = Info.dwPageSize;
+#else
+    meow_umm Result = (meow_umm)sysconf(_SC_PAGESIZE);
+#endif
+    
+    return(Result);
+}
+
+static meow_u8 *
+GuardedAlloc(meow_umm Size)
+{
+    meow_umm PageSize = GuardedPageSize();
+    meow_umm Pages = (Size + PageSize - 1) / PageSize;
+    meow_umm MappingSize = (Pages + 1)*PageSize;
+    
+    meow_u8 *Result = 0;
+#if _WIN32
+    meow_u8 *Mapping = (meow_u8 *)VirtualAlloc(0, MappingSize, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE);
+    DWORD OldProtect;
+    if(Mapping && VirtualProtect(Mapping + Pages*PageSize, PageSize, PAGE_NOACCESS, &OldProtect))
+    {
+        Result = Mapping + Pages*PageSize - Size;
+    }
+#else
+    meow_u8 *Mapping = (meow_u8 *)mmap(0, MappingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if((Mapping != MAP_FAILED) && (mprotect(Mapping + Pages*PageSize, PageSize, PROT_NONE) == 0))
+    {
+        Result = Mapping + Pages*PageSize - Size;
+    }
+#endif
+    
+    return(Result);
+}
+
+static void
+GuardedFree(meow_u8 *Memory, meow_umm Size)
+{
+    if(Memory)
+    {
+        meow_umm PageSize = GuardedPageSize();
+        meow_umm Pages = (Size + PageSize - 1) / PageSize;
+        meow_u8 *Mapping = Memory + Size - Pages*PageSize;
+#if _WIN32
+        VirtualFree(Mapping, 0, MEM_RELEASE);
+#else
+        munmap(Mapping, (Pages + 1)*PageSize);
+#endif
+    }
+}
+
+//
+// NOTE: Meow reads whole 16-byte lanes, past the end of short inputs (it only
+// avoids crossing a page), so an 8-byte key is hashed from a 16-byte buffer
+// rather than straight off the stack
+//
+
+static meow_hash
+HashOfU64(meow_u64 Seed1, meow_u64 Seed2, meow_u64 Value)
+{
+    meow_u8 Buffer[16] = {};
+    memcpy(Buffer, &Value, sizeof(Value));
+    meow_hash Result = MeowHash_Accelerated(Seed1, Seed2, sizeof(Value), Buffer);
+    return(Result);
+}
+
+//
+// NOTE: Checks the duplicate groups MeowSpillMerge reports against how the
+// spill test made its records: record I has key I % 300000, except the last
+// 70000, which all have key 1000000
+//
+
+struct spill_test
+{
+    meow_u64 BigTotal;
+    meow_u64 GroupCount;
+    int Failed;
+};
+
+static void
+CheckSpillGroup(void *Context, meow_hash Hash, meow_umm Count, meow_u64 *Locations)
+{
+    spill_test *Test = (spill_test *)Context;
+    
+    meow_u64 Key = (Locations[0] >= 330000) ? 1000000 : (Locations[0] % 300000);
+    meow_hash Expected = HashOfU64(0, 0, Key);
+    Test->Failed |= !MeowHashesAreEqual(Hash, Expected);
+    if(Key == 1000000)
+    {
+        Test->BigTotal += Count;
+        Test->Failed |= (Count > MEOW_SPILL_GROUP_MAX);
+        for(meow_umm Index = 0;
+            Index < Count;
+            ++Index)
+        {
+            Test->Failed |= (Locations[Index] < 330000) || (Locations[Index] >= 400000);
+        }
+    }
+    else
+    {
+        ++Test->GroupCount;
+        Test->Failed |= (Count != 2) || (Locations[0] + Locations[1] != 2*Key + 300000);
+    }
+}
+
+//
+// NOTE: Runs one meow::map through insert, find, miss, erase, re-insert and
+// growth.  It fills to exactly the 7/8 load the table grows at, so plenty
+// of groups are full and erasing from them leaves DELETED tombstones that
+// the re-inserts have to probe past and reuse.
+//
+
+template<bool StoreHash>
+static int
+MapCheck(void)
+{
+    int Failed = 0;
+    
+    int const Count = 1792;
+    meow::map<std::string, int, StoreHash> Map;
+    size_t FirstCapacity = 0;
+    for(int Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        auto Inserted = Map.Insert("key" + std::to_string(Index), Index);
+        Failed |= !Inserted.Inserted || (*Inserted.Value != Index);
+        if(Index == 0)
+        {
+            FirstCapacity = Map.GetCapacity();
+        }
+    }
+    Failed |= (Map.GetCount() != (size_t)Count);
+    Failed |= (Map.GetCapacity() != 2048) || (FirstCapacity >= Map.GetCapacity());
+    
+    // NOTE: Inserting a key that is there already leaves its value alone
+    auto Again = Map.Insert(std::string("key7"), -1);
+    Failed |= Again.Inserted || (*Again.Value != 7);
+    ++Map["key7"];
+    Failed |= (*Map.Find(std::string_view("key7")) != 8);
+    --Map["key7"];
+    
+    for(int Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        std::string Key = "key" + std::to_string(Index);
+        int *Value = Map.Find(Key);
+        Failed |= !Value || (*Value != Index);
+        
+        std::string Miss = "miss" + std::to_string(Index);
+        Failed |= (Map.Find(std::string_view(Miss)) != 0);
+    }
+    
+    for(int Index = 0;
+        Index < Count;
+        Index += 2)
+    {
+        std::string Key = "key" + std::to_string(Index);
+        Failed |= !Map.Erase(Key);
+        Failed |= Map.Erase(Key);
+    }
+    Failed |= (Map.GetCount() != (size_t)(Count / 2));
+    
+    for(int Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        int *Value = Map.Find("key" + std::to_string(Index));
+        Failed |= (Index & 1) ? (!Value || (*Value != Index)) : (Value != 0);
+    }
+    
+    // NOTE: Re-inserting the erased keys has to find the odd ones past the
+    // tombstones, and must not need to grow the table
+    for(int Index = 0;
+        Index < Count;
+        Index += 2)
+    {
+        auto Inserted = Map.Insert("key" + std::to_string(Index), Index + Count);
+        Failed |= !Inserted.Inserted;
+    }
+    Failed |= (Map.GetCount() != (size_t)Count) || (Map.GetCapacity() != 2048);
+    
+    for(int Index = 0;
+        Index < Count;
+        ++Index)
+    {
+        int *Value = Map.Find("key" + std::to_string(Index));
+        Failed |= !Value || (*Value != ((Index & 1) ? Index : (Index + Count)));
+    }
+    
+    // NOTE: One more key grows the table, and everything has to survive the move
+    Map.Insert(std::string("one more"), -1);
+    Failed |= (Map.GetCapacity() != 4096) || (Map.GetCount() != (size_t)(Count + 1));
+    
+    int Seen = 0;
+    Map.ForEach([&](std::string const &Key, int &Value)
+    {
+        if(Key != "one more")
+        {
+            int Index = atoi(Key.c_str() + 3);
+            Failed |= (Value != ((Index & 1) ? Index : (Index + Count)));
+        }
+        ++Seen;
+    });
+    Failed |= (Seen != (Count + 1));
+    
+    return(Failed);
+}
+
+//
+// NOTE: Races fingerprint_set inserts of the same fingerprints from several
+// threads, starting from the smallest table so that migrations are running
+// the whole time.  Every fingerprint has to be reported new exactly once.
+//
+
+#define FINGERPRINT_TEST_THREADS 4
+#define FINGERPRINT_TEST_COUNT 200000
+
+static meow_hash
+FingerprintTestHash(meow_u64 Index)
+{
+    // NOTE: The two fingerprints the set has to keep out of its slots
+    meow_hash Result;
+    if(Index == 0)
+    {
+        Meow128_CopyToHash(Meow128_Set64x2(0, 0), Result);
+    }
+    else if(Index == 1)
+    {
+        Meow128_CopyToHash(Meow128_Set64x2(~0ull, ~0ull), Result);
+    }
+    else
+    {
+        Result = HashOfU64(0, 0, Index);
+    }
+    return(Result);
+}
+
+static int
+FingerprintSetCheck(void)
+{
+    int Failed = 0;
+    
+    meow::fingerprint_set::config Config;
+    Config.InitialCapacity = 0;
+    meow::fingerprint_set Set(Config);
+    size_t FirstCapacity = Set.GetCapacity();
+    
+    std::atomic<int> *Wins = new std::atomic<int>[FINGERPRINT_TEST_COUNT]();
+    std::thread Threads[FINGERPRINT_TEST_THREADS];
+    for(int Thread = 0;
+        Thread < FINGERPRINT_TEST_THREADS;
+        ++Thread)
+    {
+        Threads[Thread] = std::thread([&Set, Wins, Thread]()
+        {
+            // NOTE: Each thread starts somewhere else and goes round, half of them backwards
+            for(meow_u64 Step = 0;
+                Step < FINGERPRINT_TEST_COUNT;
+                ++Step)
+            {
+                meow_u64 Index = (Step + Thread*(FINGERPRINT_TEST_COUNT / FINGERPRINT_TEST_THREADS)) % FINGERPRINT_TEST_COUNT;
+                if(Thread & 1)
+                {
+                    Index = FINGERPRINT_TEST_COUNT - 1 - Index;
+                }
+                if(Set.Insert(FingerprintTestHash(Index)))
+                {
+                    Wins[Index].fetch_add(1);
+                }
+            }
+        });
+    }
+    for(int Thread = 0;
+        Thread < FINGERPRINT_TEST_THREADS;
+        ++Thread)
+    {
+        Threads[Thread].join();
+    }
+    
+    for(meow_u64 Index = 0;
+        Index < FINGERPRINT_TEST_COUNT;
+        ++Index)
+    {
+        Failed |= (Wins[Index].load() != 1);
+        Failed |= !Set.Contains(FingerprintTestHash(Index));
+    }
+    
+    Failed |= Set.Contains(HashOfU64(0, 0, FINGERPRINT_TEST_COUNT));
+    Failed |= (Set.GetCount() != FINGERPRINT_TEST_COUNT);
+    Failed |= (Set.GetCapacity() <= FirstCapacity);
+    
+    delete [] Wins;
+    return(Failed);
+}
+
+//
+// NOTE: Interns the same strings from several threads into an interner with
+// small pages, so strings land in many pages and the indexes grow several
+// times.  A string has to get one id whoever interns it, and neither the id
+// nor the bytes behind Get may change as more strings go in.
+//
+
+#define INTERN_TEST_THREADS 4
+#define INTERN_TEST_COUNT 20000
+
+static std::string
+InternTestString(int Index)
+{
+    // NOTE: Mostly short names, with the empty string and lengths around the 1-byte length limit
+    std::string Result;
+    if(Index == 0)
+    {
+        Result = "";
+    }
+    else if(Index < 4)
+    {
+        Result = std::string(253 + Index, (char)('a' + Index));
+    }
+    else if(Index == 4)
+    {
+        Result = std::string(10000, 'x');
+    }
+    else
+    {
+        Result = "host-" + std::to_string(Index) + ".example.com";
+    }
+    return(Result);
+}
+
+static int
+InternCheck(void)
+{
+    int Failed = 0;
+    
+    meow::interner::config Config;
+    Config.ShardBits = 2;
+    Config.PageSize = 4096;
+    meow::interner Interner(Config);
+    
+    std::string *Strings = new std::string[INTERN_TEST_COUNT];
+    for(int Index = 0;
+        Index < INTERN_TEST_COUNT;
+        ++Index)
+    {
+        Strings[Index] = InternTestString(Index);
+    }
+    
+    // NOTE: The first half goes in on one thread, and everything it gives back is kept
+    int const Half = INTERN_TEST_COUNT / 2;
+    meow_u32 *Ids = new meow_u32[INTERN_TEST_COUNT];
+    char const **Data = new char const *[INTERN_TEST_COUNT];
+    for(int Index = 0;
+        Index < Half;
+        ++Index)
+    {
+        Ids[Index] = Interner.Intern(Strings[Index]);
+        Data[Index] = Interner.Get(Ids[Index]).data();
+        Failed |= (Interner.Get(Ids[Index]) != Strings[Index]);
+    }
+    
+    meow_u32 Missing;
+    Failed |= Interner.Find("not interned", &Missing);
+    
+    // NOTE: Then every thread interns everything, the first half again and the second half racing
+    meow_u32 *ThreadIds = new meow_u32[INTERN_TEST_THREADS*INTERN_TEST_COUNT];
+    std::thread Threads[INTERN_TEST_THREADS];
+    for(int Thread = 0;
+        Thread < INTERN_TEST_THREADS;
+        ++Thread)
+    {
+        Threads[Thread] = std::thread([&Interner, Strings, ThreadIds, Thread]()
+        {
+            for(int Step = 0;
+                Step < INTERN_TEST_COUNT;
+                ++Step)
+            {
+                int Index = (Thread & 1) ? (INTERN_TEST_COUNT - 1 - Step) : Step;
+                ThreadIds[Thread*INTERN_TEST_COUNT + Index] = Interner.Intern(Strings[Index]);
+            }
+        });
+    }
+    for(int Thread = 0;
+        Thread < INTERN_TEST_THREADS;
+        ++Thread)
+    {
+        Threads[Thread].join();
+    }
+    
+    for(int Index = 0;
+        Index < INTERN_TEST_COUNT;
+        ++Index)
+    {
+        if(Index >= Half)
+        {
+            Ids[Index] = ThreadIds[Index];
+        }
+        for(int Thread = 0;
+            Thread < INTERN_TEST_THREADS;
+            ++Thread)
+        {
+            Failed |= (ThreadIds[Thread*INTERN_TEST_COUNT + Index] != Ids[Index]);
+        }
+        
+        std::string_view Name = Interner.Get(Ids[Index]);
+        Failed |= (Name != Strings[Index]);
+        Failed |= (Index < Half) && (Name.data() != Data[Index]);
+        
+        meow_u32 Found = 0;
+        Failed |= !Interner.Find(Strings[Index], &Found) || (Found != Ids[Index]);
+    }
+    Failed |= (Interner.GetCount() != INTERN_TEST_COUNT);
+    
+    // NOTE: Distinct strings get distinct ids
+    std::sort(Ids, Ids + INTERN_TEST_COUNT);
+    for(int Index = 1;
+        Index < INTERN_TEST_COUNT;
+        ++Index)
+    {
+        Failed |= (Ids[Index] == Ids[Index - 1]);
+    }
+    
+    // NOTE: Dropping the outgrown indexes must not lose anything either
+    Interner.FreeRetiredIndexes();
+    for(int Index = 0;
+        Index < INTERN_TEST_COUNT;
+        ++Index)
+    {
+        meow_u32 Found = 0;
+        Failed |= !Interner.Find(Strings[Index], &Found) || (Interner.Get(Found) != Strings[Index]);
+    }
+    
+    delete [] ThreadIds;
+    delete [] Data;
+    delete [] Ids;
+    delete [] Strings;
+    return(Failed);
+}
+
 int
 main(int ArgCount, char **Args)
 {
@@ -92,7 +691,8 @@ main(int ArgCount, char **Args)
                     meow_u8 FlipBit = (1 << (Flip % 8));
                     *FlipByte |= FlipBit;
                     
-                    meow_hash Canonical = MeowHash_C(Seed, Seed, BufferSize, Buffer);
+                    meow_hash_implementation *Reference = Type->Reference ? Type->Reference : MeowHash_C;
+                    meow_hash Canonical = Reference(Seed, Seed, BufferSize, Buffer);
                     if(Guard)
                     {
                         memset(Allocation, 0xFF, CACHE_LINE_ALIGNMENT);
@@ -193,5 +793,2041 @@ main(int ArgCount, char **Args)
         printf("\n");
     }
     
+    printf("Meow checkpointed rehash: ");
+    {
+        int Errors = 0;
+        int Sizes[] = {1, 63, 64, 65, 1000, 4096, 10000, 65537};
+        for(meow_u32 SizeIndex = 0;
+            SizeIndex < ArrayCount(Sizes);
+            ++SizeIndex)
+        {
+            int Size = Sizes[SizeIndex];
+            meow_u64 Interval = 256;
+            meow_u8 *Buffer = (meow_u8 *)aligned_alloc(CACHE_LINE_ALIGNMENT, Size + CACHE_LINE_ALIGNMENT);
+            meow_aes_128 *States = (meow_aes_128 *)aligned_alloc(CACHE_LINE_ALIGNMENT,
+                                                                 4*sizeof(meow_aes_128)*MeowHashCheckpointCount(Size, Interval));
+            for(int Index = 0;
+                Index < Size;
+                ++Index)
+            {
+                Buffer[Index] = (meow_u8)rand();
+            }
+            
+            meow_hash_checkpoints Checkpoints;
+            meow_hash Hash = MeowHashCheckpointed(&Checkpoints, States, Interval, 1, 2, Size, Buffer);
+            if(!MeowHashesAreEqual(Hash, MeowHash_C(1, 2, Size, Buffer)))
+            {
+                ++Errors;
+            }
+            
+            for(int Edit = 0;
+                Edit < 8;
+                ++Edit)
+            {
+                int Offset = rand() % Size;
+                Buffer[Offset] ^= (meow_u8)(1 + (rand() % 255));
+                
+                Hash = MeowHashRehash(&Checkpoints, Offset, Buffer);
+                if(!MeowHashesAreEqual(Hash, MeowHash_C(1, 2, Size, Buffer)))
+                {
+                    ++Errors;
+                }
+            }
+            
+            free(States);
+            free(Buffer);
+        }
+        
+        if(Errors)
+        {
+            printf("FAILED [%d]", Errors);
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow multiset digest: ");
+    {
+        meow_u8 Elements[64][24];
+        meow_hash Hashes[ArrayCount(Elements)];
+        for(meow_u32 ElementIndex = 0;
+            ElementIndex < ArrayCount(Elements);
+            ++ElementIndex)
+        {
+            for(meow_u32 ByteIndex = 0;
+                ByteIndex < sizeof(Elements[0]);
+                ++ByteIndex)
+            {
+                Elements[ElementIndex][ByteIndex] = (meow_u8)rand();
+            }
+            Hashes[ElementIndex] = MeowHash_Accelerated(0, 0, sizeof(Elements[0]), Elements[ElementIndex]);
+        }
+        
+        meow_multiset Ordered;
+        MeowMultisetBegin(&Ordered);
+        for(meow_u32 ElementIndex = 0;
+            ElementIndex < ArrayCount(Elements);
+            ++ElementIndex)
+        {
+            MeowMultisetInsert(&Ordered, Hashes[ElementIndex]);
+        }
+        
+        // NOTE: Same elements, scattered over four partials in reverse order,
+        // with one extra element that gets inserted three times and removed again
+        meow_multiset Partials[4];
+        for(meow_u32 PartialIndex = 0;
+            PartialIndex < ArrayCount(Partials);
+            ++PartialIndex)
+        {
+            MeowMultisetBegin(&Partials[PartialIndex]);
+        }
+        for(int ElementIndex = ArrayCount(Elements) - 1;
+            ElementIndex >= 0;
+            --ElementIndex)
+        {
+            MeowMultisetInsert(&Partials[rand() % ArrayCount(Partials)], Hashes[ElementIndex]);
+        }
+        meow_hash Extra = MeowHash_Accelerated(0, 0, 3, (void *)"cat");
+        MeowMultisetInsertCount(&Partials[1], Extra, 3);
+        MeowMultisetRemove(&Partials[2], Extra);
+        MeowMultisetRemove(&Partials[3], Extra);
+        MeowMultisetRemove(&Partials[0], Extra);
+        
+        meow_multiset Merged;
+        MeowMultisetBegin(&Merged);
+        for(int PartialIndex = ArrayCount(Partials) - 1;
+            PartialIndex >= 0;
+            --PartialIndex)
+        {
+            MeowMultisetMerge(&Merged, &Partials[PartialIndex]);
+        }
+        
+        meow_multiset Doubled = Ordered;
+        MeowMultisetMerge(&Doubled, &Ordered);
+        
+        // NOTE: Taking a whole multiset (or several copies of one element) back
+        // out should land exactly where it started
+        meow_multiset Undone = Doubled;
+        MeowMultisetSubtract(&Undone, &Ordered);
+        MeowMultisetInsertCount(&Undone, Extra, 5);
+        MeowMultisetRemoveCount(&Undone, Extra, 5);
+        
+        if(MeowMultisetsAreEqual(&Ordered, &Merged) &&
+           MeowMultisetsAreEqual(&Ordered, &Undone) &&
+           MeowHashesAreEqual(MeowMultisetEnd(&Ordered, 0, 0), MeowMultisetEnd(&Merged, 0, 0)) &&
+           !MeowHashesAreEqual(MeowMultisetEnd(&Ordered, 0, 0), MeowMultisetEnd(&Doubled, 0, 0)))
+        {
+            printf("PASSED");
+        }
+        else
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+    }
+    printf("\n");
+    
+    printf("Megapaw widths and streaming: ");
+    {
+        int Width = MegapawHashCPUWidth();
+        meow_u8 *Buffer = (meow_u8 *)aligned_alloc(MEOW_PAGESIZE, 4096);
+        for(int ByteIndex = 0;
+            ByteIndex < 4096;
+            ++ByteIndex)
+        {
+            Buffer[ByteIndex] = (meow_u8)rand();
+        }
+        
+        int Failed = 0;
+        for(meow_u32 Size = 0;
+            Size <= 2100;
+            ++Size)
+        {
+            // NOTE: Hash from the end of the buffer so the partial load runs up to the page boundary
+            meow_u8 *Source = Buffer + 4096 - Size;
+            meow_u64 Seed1 = rand();
+            meow_u64 Seed2 = rand();
+            meow_hash Reference = MegapawHash_128Wide(Seed1, Seed2, Size, Source);
+            
+            megapaw_absorb_implementation *Absorbs[3] = {MegapawHashAbsorb1};
+            int AbsorbCount = 1;
+#if MEOW_HASH_INTEL
+            if(Width >= 256)
+            {
+                Absorbs[AbsorbCount++] = MegapawHashAbsorb256;
+            }
+            if(Width >= 512)
+            {
+                Absorbs[AbsorbCount++] = MegapawHashAbsorb512;
+            }
+#endif
+            Failed |= (MegapawHashAbsorbForCPU() != Absorbs[AbsorbCount - 1]);
+            
+            for(int AbsorbIndex = 0;
+                AbsorbIndex < AbsorbCount;
+                ++AbsorbIndex)
+            {
+                megapaw_hash_state State;
+                MegapawHashBegin(&State, Seed1, Seed2, Size);
+                meow_u64 At = 0;
+                while(At < Size)
+                {
+                    meow_u64 Len = rand() % 700;
+                    if(Len > (Size - At))
+                    {
+                        Len = Size - At;
+                    }
+                    Absorbs[AbsorbIndex](&State, Len, Source + At);
+                    At += Len;
+                }
+                Failed |= !MeowHashesAreEqual(Reference, MegapawHashEnd(&State, Seed1, Seed2));
+            }
+            
+#if MEOW_HASH_INTEL
+            if(Width >= 256)
+            {
+                Failed |= !MeowHashesAreEqual(Reference, MegapawHash_256Wide(Seed1, Seed2, Size, Source));
+            }
+            if(Width >= 512)
+            {
+                Failed |= !MeowHashesAreEqual(Reference, MegapawHash_512Wide(Seed1, Seed2, Size, Source));
+            }
+#endif
+        }
+        free(Buffer);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED (%d-bit)", Width);
+        }
+    }
+    printf("\n");
+    
+    printf("Meow Wide one-shot, streaming and ANSI-C: ");
+    {
+        meow_u8 *Buffer = (meow_u8 *)aligned_alloc(MEOW_PAGESIZE, 4096);
+        for(int ByteIndex = 0;
+            ByteIndex < 4096;
+            ++ByteIndex)
+        {
+            Buffer[ByteIndex] = (meow_u8)rand();
+        }
+        
+        int Failed = 0;
+        for(meow_u32 Size = 0;
+            Size <= 1100;
+            ++Size)
+        {
+            // NOTE: Hash from the end of the buffer so the partial load runs up to the page boundary
+            meow_u8 *Source = Buffer + 4096 - Size;
+            meow_u64 Seed1 = rand();
+            meow_u64 Seed2 = rand();
+            meow_hash Reference = MeowWideHash_C(Seed1, Seed2, Size, Source);
+            Failed |= !MeowHashesAreEqual(Reference, MeowWideHash_Accelerated(Seed1, Seed2, Size, Source));
+            
+            meow_wide_hash_state State;
+            MeowWideHashBegin(&State, Seed1, Seed2, Size);
+            meow_u64 At = 0;
+            while(At < Size)
+            {
+                meow_u64 Len = rand() % 300;
+                if(Len > (Size - At))
+                {
+                    Len = Size - At;
+                }
+                MeowWideHashAbsorb(&State, Len, Source + At);
+                At += Len;
+            }
+            Failed |= !MeowHashesAreEqual(Reference, MeowWideHashEnd(&State, Seed1, Seed2));
+            
+            // NOTE: Meow Wide is its own hash, even where it runs Meow's code path
+            Failed |= MeowHashesAreEqual(Reference, MeowHash_C(Seed1, Seed2, Size, Source));
+        }
+        free(Buffer);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow kernel family: ");
+    {
+        meow_u8 *Buffer = (meow_u8 *)aligned_alloc(MEOW_PAGESIZE, 4096);
+        for(int ByteIndex = 0;
+            ByteIndex < 4096;
+            ++ByteIndex)
+        {
+            Buffer[ByteIndex] = (meow_u8)rand();
+        }
+        meow_u8 *BufferEnd = Buffer + 4096;
+        
+        // NOTE: <4, 2> is defined to be Meow itself
+        int Failed = 0;
+        for(int Size = 0;
+            Size <= 700;
+            ++Size)
+        {
+            meow_hash Meow = MeowHash_Accelerated(Size, ~Size, Size, BufferEnd - Size);
+            meow_hash Kernel = meow_kernel<4, 2>::Hash(Size, ~Size, Size, BufferEnd - Size);
+            Failed |= !MeowHashesAreEqual(Meow, Kernel);
+        }
+        
+        Failed |= KernelDisagrees<2, 1, 128>(BufferEnd);
+        Failed |= KernelDisagrees<4, 2, 128>(BufferEnd);
+        Failed |= KernelDisagrees<8, 2, 128>(BufferEnd);
+        Failed |= KernelDisagrees<16, 1, 128>(BufferEnd);
+        
+        int Width = MegapawHashCPUWidth();
+#if MEOW_HASH_INTEL
+        if(Width >= 256)
+        {
+            Failed |= KernelDisagrees<4, 2, 256>(BufferEnd);
+            Failed |= KernelDisagrees<8, 3, 256>(BufferEnd);
+            Failed |= KernelDisagrees<16, 1, 256>(BufferEnd);
+        }
+        if(Width >= 512)
+        {
+            Failed |= KernelDisagrees<4, 2, 512>(BufferEnd);
+            Failed |= KernelDisagrees<16, 1, 512>(BufferEnd);
+        }
+#endif
+        free(Buffer);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED (%d-bit)", Width);
+        }
+    }
+    printf("\n");
+    
+    printf("Meow constexpr: ");
+    {
+        // NOTE: These are evaluated by the compiler
+        constexpr meow_constexpr_hash Empty = MeowHashLiteral_Constexpr(0, 0, "");
+        constexpr meow_constexpr_hash Text = MeowHashLiteral_Constexpr(1, 2, "The quick brown fox jumps over the lazy dog, then naps in the sun.");
+        static_assert(MeowHashLiteral64_Constexpr("meow") != MeowHashLiteral64_Constexpr("purr"), "constexpr Meow must not be constant");
+        
+        meow_hash EmptyHash = MeowHash_Accelerated(0, 0, 0, (void *)"");
+        char const *TextString = "The quick brown fox jumps over the lazy dog, then naps in the sun.";
+        meow_hash TextHash = MeowHash_Accelerated(1, 2, strlen(TextString), (void *)TextString);
+        
+        int Failed = 0;
+        for(int Index = 0;
+            Index < 4;
+            ++Index)
+        {
+            Failed |= (Empty.u32[Index] != MeowU32From(EmptyHash, Index));
+            Failed |= (Text.u32[Index] != MeowU32From(TextHash, Index));
+        }
+        
+        char const *Name = "normal";
+        switch(MeowU64From(MeowHash_Accelerated(0, 0, strlen(Name), (void *)Name), 0))
+        {
+            case MeowHashLiteral64_Constexpr("position"): Failed = 1; break;
+            case MeowHashLiteral64_Constexpr("normal"): break;
+            default: Failed = 1; break;
+        }
+        
+        // NOTE: The same code also runs at runtime, which covers every tail length
+        meow_u8 Buffer[300];
+        for(meow_u32 ByteIndex = 0;
+            ByteIndex < sizeof(Buffer);
+            ++ByteIndex)
+        {
+            Buffer[ByteIndex] = (meow_u8)rand();
+        }
+        for(meow_u32 Size = 0;
+            Size <= sizeof(Buffer);
+            ++Size)
+        {
+            meow_constexpr_hash Constexpr = MeowHash_Constexpr(Size, 3, Size, Buffer);
+            meow_hash Accelerated = MeowHash_Accelerated(Size, 3, Size, Buffer);
+            for(int Index = 0;
+                Index < 4;
+                ++Index)
+            {
+                Failed |= (Constexpr.u32[Index] != MeowU32From(Accelerated, Index));
+            }
+        }
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow row hashing: ");
+    {
+        // NOTE: The last row ends right before a guard page, so any over-read past it faults
+        meow_u8 *Buffer = GuardedAlloc(2*MEOW_PAGESIZE);
+        int Failed = (Buffer == 0);
+        for(int ByteIndex = 0;
+            !Failed && (ByteIndex < 2*MEOW_PAGESIZE);
+            ++ByteIndex)
+        {
+            Buffer[ByteIndex] = (meow_u8)rand();
+        }
+        
+        int const Count = 37;
+        meow_hash Hashes[Count];
+        meow_u64 Hashes64[Count];
+        meow_u32 Hashes32[Count];
+        for(int Width = 0;
+            !Failed && (Width <= 100);
+            ++Width)
+        {
+            int Strides[] = {Width, Width + 3, 32, 128};
+            for(meow_u32 StrideIndex = 0;
+                StrideIndex < ArrayCount(Strides);
+                ++StrideIndex)
+            {
+                int Stride = Strides[StrideIndex];
+                if(Stride < Width)
+                {
+                    continue;
+                }
+                
+                meow_u8 *Base = Buffer + 2*MEOW_PAGESIZE - ((Count - 1)*Stride + Width);
+                meow_u64 Seed1 = rand();
+                meow_u64 Seed2 = rand();
+                MeowHashRows(Seed1, Seed2, Base, Stride, Width, Count, 128, Hashes);
+                MeowHashRows(Seed1, Seed2, Base, Stride, Width, Count, 64, Hashes64);
+                MeowHashRows(Seed1, Seed2, Base, Stride, Width, Count, 32, Hashes32);
+                for(int Row = 0;
+                    Row < Count;
+                    ++Row)
+                {
+                    meow_hash Reference = MeowHash_Accelerated(Seed1, Seed2, Width, Base + Row*Stride);
+                    Failed |= !MeowHashesAreEqual(Reference, Hashes[Row]);
+                    Failed |= (Hashes64[Row] != MeowU64From(Reference, 0));
+                    Failed |= (Hashes32[Row] != MeowU32From(Reference, 0));
+                }
+            }
+        }
+        GuardedFree(Buffer, 2*MEOW_PAGESIZE);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow string column hashing: ");
+    {
+        // NOTE: The data ends right before a guard page, like the row test
+        int const Count = 500;
+        meow_u32 Offsets32[Count + 1];
+        meow_u64 Offsets64[Count + 1];
+        meow_u32 Lens[Count];
+        meow_u32 DataSize = 0;
+        for(int Index = 0;
+            Index < Count;
+            ++Index)
+        {
+            // NOTE: Mostly short strings, with the odd empty or long one
+            Lens[Index] = (rand() % 10) ? (rand() % 64) : (rand() % 200);
+            DataSize += Lens[Index];
+        }
+        
+        meow_u8 *Data = GuardedAlloc(DataSize);
+        int Failed = (Data == 0);
+        for(meow_u32 ByteIndex = 0;
+            !Failed && (ByteIndex < DataSize);
+            ++ByteIndex)
+        {
+            Data[ByteIndex] = (meow_u8)rand();
+        }
+        
+        meow_u32 Offset = 0;
+        for(int Index = 0;
+            Index <= Count;
+            ++Index)
+        {
+            Offsets32[Index] = Offset;
+            Offsets64[Index] = Offset;
+            if(Index < Count)
+            {
+                Offset += Lens[Index];
+            }
+        }
+        
+        if(Data)
+        {
+            meow_hash Hashes[Count];
+            meow_u64 Hashes64[Count];
+            meow_u32 Hashes32[Count];
+            MeowHashStringColumn32(1, 2, Offsets32, Data, Count, 128, Hashes);
+            MeowHashStringColumn64(1, 2, Offsets64, Data, Count, 64, Hashes64);
+            MeowHashStringColumn32(1, 2, Offsets32, Data, Count, 32, Hashes32);
+            
+            for(int Index = 0;
+                Index < Count;
+                ++Index)
+            {
+                meow_hash Reference = MeowHash_Accelerated(1, 2, Lens[Index], Data + Offsets32[Index]);
+                Failed |= !MeowHashesAreEqual(Reference, Hashes[Index]);
+                Failed |= (Hashes64[Index] != MeowU64From(Reference, 0));
+                Failed |= (Hashes32[Index] != MeowU32From(Reference, 0));
+            }
+        }
+        GuardedFree(Data, DataSize);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow batch hashing: ");
+    {
+        // NOTE: Every length up to 200 (empty, odd, whole and partial blocks, and past the
+        // batched classes), a few times over, from anywhere in a buffer or right up against
+        // a guard page, with a seed pair per item
+        int const Count = 1000;
+        meow_umm const Spread = 64*1024;
+        meow_u8 *Bytes = (meow_u8 *)malloc(Spread + 256);
+        meow_u8 *Guarded = GuardedAlloc(256);
+        int Failed = (Bytes == 0) || (Guarded == 0);
+        
+        void *Sources[Count];
+        meow_u64 Lens[Count];
+        meow_u64 Seeds1[Count];
+        meow_u64 Seeds2[Count];
+        meow_hash Hashes[Count];
+        if(!Failed)
+        {
+            for(meow_umm ByteIndex = 0;
+                ByteIndex < (Spread + 256);
+                ++ByteIndex)
+            {
+                Bytes[ByteIndex] = (meow_u8)rand();
+            }
+            for(int ByteIndex = 0;
+                ByteIndex < 256;
+                ++ByteIndex)
+            {
+                Guarded[ByteIndex] = (meow_u8)rand();
+            }
+            
+            for(int Index = 0;
+                Index < Count;
+                ++Index)
+            {
+                Lens[Index] = Index % 201;
+                Sources[Index] = (Index % 3) ? (Bytes + (rand() % Spread)) : (Guarded + 256 - Lens[Index]);
+                Seeds1[Index] = rand();
+                Seeds2[Index] = rand();
+            }
+            
+            MeowHashBatch(Count, Sources, Lens, Seeds1, Seeds2, Hashes);
+            for(int Index = 0;
+                Index < Count;
+                ++Index)
+            {
+                meow_hash Reference = MeowHash_Accelerated(Seeds1[Index], Seeds2[Index], Lens[Index], Sources[Index]);
+                Failed |= !MeowHashesAreEqual(Reference, Hashes[Index]);
+            }
+            
+            // NOTE: An empty batch touches nothing
+            MeowHashBatch(0, 0, 0, 0, 0, 0);
+        }
+        GuardedFree(Guarded, 256);
+        free(Bytes);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow radix partitioning: ");
+    {
+        // NOTE: Each tuple carries its own index after the key, so the output
+        // can be checked for being a stable permutation of the input
+        int Failed = 0;
+        int TupleSizes[] = {8, 24, 20, 100};
+        for(meow_u32 SizeIndex = 0;
+            SizeIndex < ArrayCount(TupleSizes);
+            ++SizeIndex)
+        {
+            meow_umm TupleSize = TupleSizes[SizeIndex];
+            meow_umm Count = 3001;
+            meow_partition_layout Layout = {TupleSize, 0, TupleSize - 4, 5, 6};
+            
+            meow_u8 *Tuples = (meow_u8 *)malloc(Count*TupleSize);
+            meow_u8 *Output = (meow_u8 *)malloc(Count*TupleSize);
+            meow_u8 *Scratch = (meow_u8 *)malloc(Count*TupleSize);
+            meow_u32 *Hashes = (meow_u32 *)malloc(Count*sizeof(meow_u32));
+            meow_u32 *ScratchHashes = (meow_u32 *)malloc(Count*sizeof(meow_u32));
+            meow_u32 *Reference = (meow_u32 *)malloc(Count*sizeof(meow_u32));
+            for(meow_umm Index = 0;
+                Index < Count;
+                ++Index)
+            {
+                meow_u8 *Tuple = Tuples + Index*TupleSize;
+                for(meow_umm Byte = 0;
+                    Byte < (TupleSize - 4);
+                    ++Byte)
+                {
+                    // NOTE: Some repeated keys, so partitions get runs of equal keys
+                    Tuple[Byte] = (meow_u8)((rand() % 4) ? (Index*7 + Byte) : rand());
+                }
+                memcpy(Tuple + TupleSize - 4, &Index, 4);
+            }
+            MeowPartitionHash(&Layout, Tuples, Count, Reference);
+            
+            meow_u32 BitCounts[] = {0, 1, 6, 11};
+            for(meow_u32 BitIndex = 0;
+                BitIndex < ArrayCount(BitCounts);
+                ++BitIndex)
+            {
+                meow_u32 Bits = BitCounts[BitIndex];
+                meow_umm *Histogram = (meow_umm *)malloc(sizeof(meow_umm) << Bits);
+                void *BufferMemory = malloc(MeowPartitionBuffersSize(4));
+                meow_partition_buffers Buffers;
+                for(int Multi = 0;
+                    Multi < 2;
+                    ++Multi)
+                {
+                    memset(Output, 0xCD, Count*TupleSize);
+                    if(Multi)
+                    {
+                        MeowPartitionBuffersInit(&Buffers, BufferMemory, 4);
+                        MeowPartitionMultiPass(&Layout, Bits, 4, Tuples, Count, Hashes, ScratchHashes, &Buffers, Scratch, Output, Histogram);
+                    }
+                    else
+                    {
+                        free(BufferMemory);
+                        BufferMemory = malloc(MeowPartitionBuffersSize(Bits));
+                        MeowPartitionBuffersInit(&Buffers, BufferMemory, Bits);
+                        MeowPartition(&Layout, Bits, Tuples, Count, Hashes, &Buffers, Output, Histogram);
+                    }
+                    
+                    meow_umm At = 0;
+                    for(meow_umm Partition = 0;
+                        Partition < ((meow_umm)1 << Bits);
+                        ++Partition)
+                    {
+                        meow_u32 Previous = 0;
+                        for(meow_umm Member = 0;
+                            Member < Histogram[Partition];
+                            ++Member, ++At)
+                        {
+                            meow_u32 Index;
+                            memcpy(&Index, Output + At*TupleSize + TupleSize - 4, 4);
+                            Failed |= (Index >= Count);
+                            if(Index < Count)
+                            {
+                                Failed |= (memcmp(Output + At*TupleSize, Tuples + Index*TupleSize, TupleSize) != 0);
+                                Failed |= (MeowPartitionOf(Reference[Index], 32 - Bits, Bits) != Partition);
+                                Failed |= (Member && (Index <= Previous));
+                            }
+                            Previous = Index;
+                        }
+                    }
+                    Failed |= (At != Count);
+                }
+                free(BufferMemory);
+                free(Histogram);
+            }
+            
+            // NOTE: Two "threads" sharing one output
+            meow_u32 Bits = 5;
+            meow_umm Half = Count / 2;
+            meow_umm HistogramA[32];
+            meow_umm HistogramB[32];
+            meow_umm *Histograms[] = {HistogramA, HistogramB};
+            void *BufferMemory = malloc(MeowPartitionBuffersSize(Bits));
+            meow_partition_buffers Buffers;
+            MeowPartitionBuffersInit(&Buffers, BufferMemory, Bits);
+            MeowPartitionHistogram(Reference, Half, 32 - Bits, Bits, HistogramA);
+            MeowPartitionHistogram(Reference + Half, Count - Half, 32 - Bits, Bits, HistogramB);
+            MeowPartitionSharedOffsets(Histograms, 2, 1, Bits, Buffers.Offsets);
+            MeowPartitionScatter(&Layout, Tuples + Half*TupleSize, Reference + Half, Count - Half, 32 - Bits, Bits, &Buffers, Output);
+            MeowPartitionSharedOffsets(Histograms, 2, 0, Bits, Buffers.Offsets);
+            MeowPartitionScatter(&Layout, Tuples, Reference, Half, 32 - Bits, Bits, &Buffers, Output);
+            memcpy(Hashes, Reference, Count*sizeof(meow_u32));
+            MeowPartitionBuffersInit(&Buffers, BufferMemory, Bits);
+            meow_umm Histogram[32];
+            MeowPartition(&Layout, Bits, Tuples, Count, Hashes, &Buffers, Scratch, Histogram);
+            Failed |= (memcmp(Output, Scratch, Count*TupleSize) != 0);
+            free(BufferMemory);
+            
+            free(Reference);
+            free(Hashes);
+            free(ScratchHashes);
+            free(Scratch);
+            free(Output);
+            free(Tuples);
+        }
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow fingerprint index: ");
+    {
+        // NOTE: Hashes of the odd numbers go in, with their number as the
+        // payload, so the even numbers are known misses
+        int Failed = 0;
+        char const *FileName = "meow_index_test.tmp";
+        meow_umm Counts[] = {0, 1, 7, 5000};
+        int DirectoryBits[] = {-1, 0, 3, 12};
+        for(meow_u32 CountIndex = 0;
+            CountIndex < ArrayCount(Counts);
+            ++CountIndex)
+        {
+            for(meow_u32 BitsIndex = 0;
+                BitsIndex < ArrayCount(DirectoryBits);
+                ++BitsIndex)
+            {
+                for(int WithPayloads = 0;
+                    WithPayloads < 2;
+                    ++WithPayloads)
+                {
+                    meow_umm Count = Counts[CountIndex];
+                    meow_umm ProbeCount = 2*Count + 1;
+                    meow_hash *Hashes = (meow_hash *)malloc(ProbeCount*sizeof(meow_hash));
+                    meow_u64 *Numbers = (meow_u64 *)malloc(ProbeCount*sizeof(meow_u64));
+                    meow_u64 *Payloads = (meow_u64 *)malloc(ProbeCount*sizeof(meow_u64));
+                    meow_u8 *Found = (meow_u8 *)malloc(ProbeCount);
+                    for(meow_umm Index = 0;
+                        Index < ProbeCount;
+                        ++Index)
+                    {
+                        Numbers[Index] = Index;
+                        Hashes[Index] = MeowHash_Accelerated(0, 0, sizeof(meow_u64), Numbers + Index);
+                    }
+                    
+                    // NOTE: The odd numbers, each twice, so duplicates get collapsed
+                    meow_hash *Inputs = (meow_hash *)malloc((2*Count + 1)*sizeof(meow_hash));
+                    meow_u64 *InputPayloads = (meow_u64 *)malloc((2*Count + 1)*sizeof(meow_u64));
+                    for(meow_umm Index = 0;
+                        Index < 2*Count;
+                        ++Index)
+                    {
+                        meow_umm Probe = 2*(Index % Count) + 1;
+                        Inputs[Index] = Hashes[Probe];
+                        InputPayloads[Index] = Numbers[Probe];
+                    }
+                    
+                    Failed |= !MeowIndexWrite(FileName, 2*Count, Inputs, WithPayloads ? InputPayloads : 0, DirectoryBits[BitsIndex]);
+                    
+                    meow_index Table;
+                    if(MeowIndexOpen(&Table, FileName))
+                    {
+                        Failed |= (MeowIndexCount(&Table) != Count);
+                        
+                        for(meow_umm Probe = 0;
+                            Probe < ProbeCount;
+                            ++Probe)
+                        {
+                            int Expected = (int)(Numbers[Probe] % 2);
+                            meow_u64 Payload = ~0ull;
+                            int Hit = MeowIndexFind(&Table, Hashes[Probe], &Payload);
+                            Failed |= (Hit != Expected);
+                            Failed |= (Hit && (Payload != (WithPayloads ? Numbers[Probe] : 0)));
+                        }
+                        
+                        MeowIndexFindBatch(&Table, ProbeCount, Hashes, Found, Payloads);
+                        for(meow_umm Probe = 0;
+                            Probe < ProbeCount;
+                            ++Probe)
+                        {
+                            int Expected = (int)(Numbers[Probe] % 2);
+                            Failed |= (Found[Probe] != Expected);
+                            Failed |= (Payloads[Probe] != ((Expected && WithPayloads) ? Numbers[Probe] : 0));
+                        }
+                        
+                        MeowIndexClose(&Table);
+                    }
+                    else
+                    {
+                        Failed = 1;
+                    }
+                    
+                    free(InputPayloads);
+                    free(Inputs);
+                    free(Found);
+                    free(Payloads);
+                    free(Numbers);
+                    free(Hashes);
+                }
+            }
+        }
+        
+        // NOTE: Truncated and foreign files must not open
+        meow_hash One = MeowHash_Accelerated(0, 0, 4, (void *)"meow");
+        MeowIndexWrite(FileName, 1, &One, 0, 4);
+        FILE *File = fopen(FileName, "rb");
+        if(File)
+        {
+            alignas(8) meow_u8 Bytes[4096];
+            meow_umm Size = fread(Bytes, 1, sizeof(Bytes), File);
+            fclose(File);
+            
+            meow_index Table;
+            Failed |= !MeowIndexFromMemory(&Table, Bytes, Size);
+            Failed |= !MeowIndexFind(&Table, One, 0);
+            Failed |= MeowIndexFromMemory(&Table, Bytes, Size - 1);
+            Failed |= MeowIndexFromMemory(&Table, Bytes + 1, Size - 1);
+            Bytes[0] ^= 1;
+            Failed |= MeowIndexFromMemory(&Table, Bytes, Size);
+            Bytes[0] ^= 1;
+            
+            // NOTE: Offsets whose sums wrap round, or that are not aligned
+            meow_index_header *Header = (meow_index_header *)Bytes;
+            meow_index_header Good = *Header;
+            meow_u64 Bad[] = {~0ull - 7, ~0ull - 15, Good.FileSize + 8, 12};
+            for(meow_u32 BadIndex = 0;
+                BadIndex < ArrayCount(Bad);
+                ++BadIndex)
+            {
+                *Header = Good;
+                Header->DirectoryOffset = Bad[BadIndex];
+                Failed |= MeowIndexFromMemory(&Table, Bytes, Size);
+                
+                *Header = Good;
+                Header->HashOffset = Bad[BadIndex];
+                Failed |= MeowIndexFromMemory(&Table, Bytes, Size);
+                
+                *Header = Good;
+                Header->PayloadOffset = Bad[BadIndex];
+                Failed |= MeowIndexFromMemory(&Table, Bytes, Size);
+            }
+            
+            *Header = Good;
+            Header->Count = ~0ull / 8;
+            Failed |= MeowIndexFromMemory(&Table, Bytes, Size);
+            
+            // NOTE: Directory entries past Count are clamped, so they miss rather than read past the hashes
+            *Header = Good;
+            meow_u64 *Directory = (meow_u64 *)(Bytes + Good.DirectoryOffset);
+            for(meow_u64 Bucket = 0;
+                Bucket <= ((meow_u64)1 << Good.DirectoryBits);
+                ++Bucket)
+            {
+                Directory[Bucket] = ~0ull - Bucket;
+            }
+            Failed |= !MeowIndexFromMemory(&Table, Bytes, Size);
+            Failed |= MeowIndexFind(&Table, One, 0);
+            meow_u8 BatchFound = 1;
+            MeowIndexFindBatch(&Table, 1, &One, &BatchFound, 0);
+            Failed |= (BatchFound != 0);
+        }
+        else
+        {
+            Failed = 1;
+        }
+        remove(FileName);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow minimal perfect hash: ");
+    {
+        // NOTE: Enough keys to go through the threaded passes, and a few
+        // set sizes around one block
+        int Failed = 0;
+        meow_umm Counts[] = {0, 1, 447, 449, 100000};
+        for(meow_u32 CountIndex = 0;
+            CountIndex < ArrayCount(Counts);
+            ++CountIndex)
+        {
+            meow_umm Count = Counts[CountIndex];
+            meow_u64 *Values = (meow_u64 *)malloc((Count + 1)*sizeof(meow_u64));
+            void **Keys = (void **)malloc((Count + 1)*sizeof(void *));
+            meow_umm *Lens = (meow_umm *)malloc((Count + 1)*sizeof(meow_umm));
+            meow_hash *Hashes = (meow_hash *)malloc((Count + 1)*sizeof(meow_hash));
+            meow_u8 *Seen = (meow_u8 *)malloc(Count + 1);
+            for(meow_umm Index = 0;
+                Index < Count;
+                ++Index)
+            {
+                Values[Index] = Index*0x9E3779B97F4A7C15ull;
+                Keys[Index] = Values + Index;
+                Lens[Index] = sizeof(meow_u64);
+                Hashes[Index] = MeowHash_Accelerated(3, 4, sizeof(meow_u64), Values + Index);
+            }
+            
+            float Gammas[] = {0, 1.0f, 2.0f};
+            for(meow_u32 GammaIndex = 0;
+                GammaIndex < ArrayCount(Gammas);
+                ++GammaIndex)
+            {
+                meow_umm SizeA = 0;
+                meow_umm SizeB = 0;
+                void *BlobA = MeowPerfectHashBuildKeys(Count, Keys, Lens, 3, 4, Gammas[GammaIndex], 1, &SizeA);
+                void *BlobB = MeowPerfectHashBuild(Count, Hashes, 3, 4, Gammas[GammaIndex], 4, &SizeB);
+                
+                // NOTE: Same blob from keys and from hashes, on one thread or four
+                Failed |= (!BlobA || !BlobB || (SizeA != SizeB) || memcmp(BlobA, BlobB, SizeA));
+                
+                meow_perfect_hash Perfect;
+                if(BlobA && MeowPerfectHashFromMemory(&Perfect, BlobA, SizeA))
+                {
+                    memset(Seen, 0, Count + 1);
+                    for(meow_umm Index = 0;
+                        Index < Count;
+                        ++Index)
+                    {
+                        meow_u64 Number = MeowPerfectHashKey(&Perfect, sizeof(meow_u64), Values + Index);
+                        Failed |= (Number != MeowPerfectHashOf(&Perfect, Hashes[Index]));
+                        if((Number < Count) && !Seen[Number])
+                        {
+                            Seen[Number] = 1;
+                        }
+                        else
+                        {
+                            Failed = 1;
+                        }
+                    }
+                    
+                    Failed |= MeowPerfectHashFromMemory(&Perfect, BlobA, SizeA - 1);
+                    Failed |= MeowPerfectHashFromMemory(&Perfect, (meow_u8 *)BlobB + 4, SizeB - 4);
+                    
+                    // NOTE: Offsets past the end, unaligned, or big enough that offset + size wraps
+                    meow_perfect_header *Header = (meow_perfect_header *)BlobB;
+                    meow_perfect_header Good = *Header;
+                    meow_u64 Bad[] = {Good.Size + 8, 4, ~0ull - 7};
+                    meow_perfect_hash Corrupt;
+                    for(meow_u32 BadIndex = 0;
+                        BadIndex < ArrayCount(Bad);
+                        ++BadIndex)
+                    {
+                        *Header = Good;
+                        Header->LevelOffset = Bad[BadIndex];
+                        Failed |= MeowPerfectHashFromMemory(&Corrupt, BlobB, SizeB);
+                        
+                        *Header = Good;
+                        Header->BlockOffset = Bad[BadIndex];
+                        Failed |= MeowPerfectHashFromMemory(&Corrupt, BlobB, SizeB);
+                        
+                        *Header = Good;
+                        Header->FallbackOffset = Bad[BadIndex];
+                        Failed |= MeowPerfectHashFromMemory(&Corrupt, BlobB, SizeB);
+                    }
+                    
+                    // NOTE: Blocks that end exactly at 2^64, which the old check let through
+                    if(Good.BlockCount)
+                    {
+                        *Header = Good;
+                        Header->BlockOffset = 0 - Good.BlockCount*MEOW_PERFECT_BLOCK_WORDS*sizeof(meow_u64);
+                        Failed |= MeowPerfectHashFromMemory(&Corrupt, BlobB, SizeB);
+                    }
+                    *Header = Good;
+                    Failed |= !MeowPerfectHashFromMemory(&Corrupt, BlobB, SizeB);
+                }
+                else
+                {
+                    Failed = 1;
+                }
+                
+                free(BlobA);
+                free(BlobB);
+            }
+            
+            // NOTE: A key given twice can not be given its own number
+            if(Count)
+            {
+                meow_umm Size;
+                Hashes[Count] = Hashes[0];
+                void *Blob = MeowPerfectHashBuild(Count + 1, Hashes, 3, 4, 0, 1, &Size);
+                Failed |= (Blob != 0);
+                free(Blob);
+            }
+            
+            free(Seen);
+            free(Hashes);
+            free(Lens);
+            free(Keys);
+            free(Values);
+        }
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow blocked Bloom filter: ");
+    {
+        int Failed = 0;
+        meow_umm Count = 10000;
+        meow_umm BlockCount = MeowBloomBlockCount(Count, 10);
+        meow_umm Size = MeowBloomSize(BlockCount);
+        void *MemoryA = malloc(Size);
+        void *MemoryB = malloc(Size);
+        meow_hash *Hashes = (meow_hash *)malloc(2*Count*sizeof(meow_hash));
+        meow_u8 *Results = (meow_u8 *)malloc(2*Count);
+        for(meow_umm Index = 0;
+            Index < 2*Count;
+            ++Index)
+        {
+            Hashes[Index] = HashOfU64(5, 6, Index);
+        }
+        
+        // NOTE: One key in an empty filter sets exactly its probes' bits
+        meow_bloom A;
+        MeowBloomInit(&A, MemoryA, BlockCount, 5, 6);
+        MeowBloomInsert(&A, Hashes[0]);
+        {
+            meow_u32 Expected[16] = {0};
+            meow_u32 H1 = MeowU32From(Hashes[0], 2);
+            meow_u32 H2 = MeowU32From(Hashes[0], 3);
+            for(meow_u32 Probe = 0;
+                Probe < MEOW_BLOOM_PROBES;
+                ++Probe)
+            {
+                meow_u32 Value = H1 + Probe*H2;
+                Expected[2*Probe + (Value >> 31)] |= 1u << ((Value >> 26) & 31);
+            }
+            
+            meow_u8 *Block = MeowBloomBlock(&A, Hashes[0]);
+            Failed |= (memcmp(Block, Expected, sizeof(Expected)) != 0);
+            for(meow_umm At = 0;
+                At < BlockCount*MEOW_BLOOM_BLOCK;
+                ++At)
+            {
+                meow_u8 *Byte = A.Blocks + At;
+                Failed |= (((Byte < Block) || (Byte >= Block + MEOW_BLOOM_BLOCK)) && *Byte);
+            }
+        }
+        
+        // NOTE: Even hashes into A one at a time, odd hashes into B as a batch
+        for(meow_umm Index = 0;
+            Index < Count;
+            ++Index)
+        {
+            MeowBloomInsert(&A, Hashes[2*Index]);
+        }
+        meow_bloom B;
+        MeowBloomInit(&B, MemoryB, BlockCount, 5, 6);
+        meow_hash *Odd = (meow_hash *)malloc(Count*sizeof(meow_hash));
+        for(meow_umm Index = 0;
+            Index < Count;
+            ++Index)
+        {
+            Odd[Index] = Hashes[2*Index + 1];
+        }
+        MeowBloomInsertBatch(&B, Count, Odd);
+        
+        meow_umm FalsePositives = 0;
+        MeowBloomContainsBatch(&A, 2*Count, Hashes, Results);
+        for(meow_umm Index = 0;
+            Index < 2*Count;
+            ++Index)
+        {
+            Failed |= (Results[Index] != MeowBloomContains(&A, Hashes[Index]));
+            if(Index % 2)
+            {
+                FalsePositives += Results[Index];
+            }
+            else
+            {
+                Failed |= !Results[Index];
+            }
+        }
+        
+        // NOTE: About 1% at 10 bits per key
+        Failed |= (FalsePositives > Count / 50);
+        
+        meow_umm Key[2] = {2*Count + 7, 0};
+        MeowBloomInsertKey(&B, sizeof(Key[0]), Key);
+        Failed |= !MeowBloomContains(&B, HashOfU64(5, 6, Key[0]));
+        Failed |= !MeowBloomContainsKey(&B, sizeof(Key[0]), Key);
+        
+        // NOTE: The union, read back out of a copy of its memory
+        Failed |= !MeowBloomMerge(&A, &B);
+        void *Copy = malloc(Size);
+        memcpy(Copy, MemoryA, Size);
+        meow_bloom C;
+        Failed |= !MeowBloomFromMemory(&C, Copy, Size);
+        Failed |= MeowBloomFromMemory(&C, Copy, Size - 1);
+        MeowBloomFromMemory(&C, Copy, Size);
+        MeowBloomContainsBatch(&C, 2*Count, Hashes, Results);
+        for(meow_umm Index = 0;
+            Index < 2*Count;
+            ++Index)
+        {
+            Failed |= !Results[Index];
+        }
+        Failed |= !MeowBloomContainsKey(&C, sizeof(Key[0]), Key);
+        
+        meow_bloom D;
+        MeowBloomInit(&D, MemoryB, BlockCount, 5, 7);
+        Failed |= MeowBloomMerge(&A, &D);
+        
+        free(Copy);
+        free(Odd);
+        free(Results);
+        free(Hashes);
+        free(MemoryB);
+        free(MemoryA);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow HyperLogLog and count-min sketches: ");
+    {
+        // NOTE: Two "threads", each seeing every block of its half twice and
+        // block 0 a thousand times
+        int Failed = 0;
+        meow_umm Distinct = 200000;
+        meow_u32 Precision = 12;
+        
+        meow_hll Hlls[2];
+        meow_count_min Sketches[2];
+        for(int Thread = 0;
+            Thread < 2;
+            ++Thread)
+        {
+            Failed |= !MeowHllInit(&Hlls[Thread], malloc(MeowHllSize(Precision)), Precision);
+            Failed |= !MeowCountMinInit(&Sketches[Thread], malloc(MeowCountMinSize(12, 4)), 12, 4);
+        }
+        
+        Failed |= (MeowHllEstimate(&Hlls[0]) != 0.0);
+        
+        meow_hash Zero = MeowHash_Accelerated(0, 0, sizeof(meow_umm), &Distinct);
+        for(meow_umm Block = 0;
+            Block < Distinct;
+            ++Block)
+        {
+            int Thread = (int)(Block % 2);
+            meow_hash Hash;
+            if(Block < 1000)
+            {
+                Hash = Zero;
+            }
+            else
+            {
+                // NOTE: Through the streaming API, as a block scan would
+                meow_hash_state State;
+                MeowHashBegin(&State, 0, 0, sizeof(Block));
+                MeowHashAbsorb(&State, sizeof(Block), &Block);
+                Hash = MeowHashEnd(&State, 0, 0);
+            }
+            
+            for(int Repeat = 0;
+                Repeat < ((Block < 1000) ? 1 : 2);
+                ++Repeat)
+            {
+                MeowHllAdd(&Hlls[Thread], Hash);
+                MeowCountMinAdd(&Sketches[Thread], Hash, 1);
+            }
+        }
+        
+        // NOTE: 199001 distinct blocks, and a standard error of 1.6% at precision 12
+        Failed |= !MeowHllMerge(&Hlls[0], &Hlls[1]);
+        double Estimate = MeowHllEstimate(&Hlls[0]);
+        double Expected = (double)(Distinct - 999);
+        Failed |= ((Estimate < 0.94*Expected) || (Estimate > 1.06*Expected));
+        
+        Failed |= !MeowCountMinMerge(&Sketches[0], &Sketches[1]);
+        Failed |= (Sketches[0].Header->Total != 2*Distinct - 1000);
+        Failed |= (MeowCountMinEstimate(&Sketches[0], Zero) < 1000);
+        Failed |= (MeowCountMinEstimate(&Sketches[0], Zero) > 1000 + 2*Sketches[0].Header->Total / 4096);
+        
+        meow_heavy_hitter Entries[4];
+        meow_heavy_hitters Hitters;
+        MeowHeavyHittersInit(&Hitters, Entries, 4);
+        for(meow_umm Block = 1000;
+            Block < 1100;
+            ++Block)
+        {
+            meow_hash Hash = HashOfU64(0, 0, Block);
+            MeowHeavyHittersOffer(&Hitters, Hash, MeowCountMinEstimate(&Sketches[0], Hash));
+        }
+        MeowHeavyHittersOffer(&Hitters, Zero, MeowCountMinEstimate(&Sketches[0], Zero));
+        MeowHeavyHittersOffer(&Hitters, Zero, MeowCountMinEstimate(&Sketches[0], Zero));
+        int ZeroCount = 0;
+        for(meow_u32 Index = 0;
+            Index < Hitters.Count;
+            ++Index)
+        {
+            ZeroCount += MeowHashesAreEqual(Entries[Index].Hash, Zero);
+        }
+        Failed |= (Hitters.Count != 4) || (ZeroCount != 1);
+        
+        // NOTE: Small sets are counted almost exactly
+        meow_hll Small = {};
+        Failed |= !MeowHllInit(&Small, malloc(MeowHllSize(Precision)), Precision);
+        for(meow_umm Block = 0;
+            Block < 10;
+            ++Block)
+        {
+            MeowHllAdd(&Small, HashOfU64(0, 0, Block));
+        }
+        Failed |= (MeowHllEstimate(&Small) < 9.5) || (MeowHllEstimate(&Small) > 10.5);
+        
+        // NOTE: Serialized forms
+        meow_umm WriteSize = MeowHllWriteSize(Precision);
+        void *Written = malloc(WriteSize);
+        MeowHllWrite(&Hlls[0], Written);
+        meow_hll Read = {};
+        Failed |= (MeowHllRead(&Read, Written, WriteSize) != Precision);
+        Failed |= (MeowHllRead(&Read, Written, WriteSize - 1) != 0);
+        Read.Registers = (meow_u8 *)malloc(MeowHllSize(Precision));
+        MeowHllRead(&Read, Written, WriteSize);
+        Failed |= (memcmp(Read.Registers, Hlls[0].Registers, MeowHllSize(Precision)) != 0);
+        
+        meow_umm SketchSize = MeowCountMinSize(12, 4);
+        void *Copy = malloc(SketchSize);
+        memcpy(Copy, Sketches[0].Header, SketchSize);
+        meow_count_min ReadSketch;
+        Failed |= !MeowCountMinFromMemory(&ReadSketch, Copy, SketchSize);
+        Failed |= MeowCountMinFromMemory(&ReadSketch, Copy, SketchSize - 1);
+        MeowCountMinFromMemory(&ReadSketch, Copy, SketchSize);
+        Failed |= (ReadSketch.Header->Total != Sketches[0].Header->Total);
+        Failed |= (MeowCountMinEstimate(&ReadSketch, Zero) != MeowCountMinEstimate(&Sketches[0], Zero));
+        
+        // NOTE: Counters go past 2^32, through both Add and Merge, without wrapping
+        meow_count_min Hot[2];
+        for(int Thread = 0;
+            Thread < 2;
+            ++Thread)
+        {
+            Failed |= !MeowCountMinInit(&Hot[Thread], malloc(MeowCountMinSize(4, 2)), 4, 2);
+            MeowCountMinAdd(&Hot[Thread], Zero, 0xFFFFFFFFull);
+        }
+        MeowCountMinAdd(&Hot[0], Zero, 2);
+        Failed |= (MeowCountMinEstimate(&Hot[0], Zero) != 0x100000001ull);
+        Failed |= !MeowCountMinMerge(&Hot[0], &Hot[1]);
+        Failed |= (MeowCountMinEstimate(&Hot[0], Zero) != 0x200000000ull);
+        free(Hot[0].Header);
+        free(Hot[1].Header);
+        
+        // NOTE: Shapes that would shift by 64 or more are refused
+        meow_u8 Spare[64];
+        meow_count_min Bad;
+        meow_hll BadHll;
+        Failed |= MeowCountMinInit(&Bad, Spare, 0, 1);
+        Failed |= MeowCountMinInit(&Bad, Spare, 33, 1);
+        Failed |= MeowCountMinInit(&Bad, Spare, 2, 0);
+        Failed |= MeowHllInit(&BadHll, Spare, MEOW_HLL_MIN_PRECISION - 1);
+        Failed |= MeowHllInit(&BadHll, Spare, MEOW_HLL_MAX_PRECISION + 1);
+        
+        free(Copy);
+        free(Read.Registers);
+        free(Written);
+        free(Small.Registers);
+        for(int Thread = 0;
+            Thread < 2;
+            ++Thread)
+        {
+            free(Hlls[Thread].Registers);
+            free(Sketches[Thread].Header);
+        }
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow MinHash and LSH: ");
+    {
+        int Failed = 0;
+        
+        meow_minhash MinHash;
+        Failed |= !MeowMinHashInit(&MinHash, 128, 16, 4, 1, 2);
+        
+        // NOTE: Shapes the SIMD loops and the shingle ring can not handle are refused
+        meow_minhash Bad;
+        Failed |= MeowMinHashInit(&Bad, 0, 1, 4, 1, 2);
+        Failed |= MeowMinHashInit(&Bad, 130, 13, 4, 1, 2);
+        Failed |= MeowMinHashInit(&Bad, MEOW_MINHASH_MAX_K + 4, 4, 4, 1, 2);
+        Failed |= MeowMinHashInit(&Bad, 128, 0, 4, 1, 2);
+        Failed |= MeowMinHashInit(&Bad, 128, 12, 4, 1, 2);
+        Failed |= MeowMinHashInit(&Bad, 128, 16, 0, 1, 2);
+        Failed |= MeowMinHashInit(&Bad, 128, 16, MEOW_MINHASH_MAX_SHINGLE_WORDS + 1, 1, 2);
+        
+        // NOTE: 0 and 1 differ by one word in 300, 2 shares none of their words, 3 is empty
+        char *Docs[4];
+        meow_umm DocSizes[4] = {};
+        for(int Doc = 0;
+            Doc < 4;
+            ++Doc)
+        {
+            Docs[Doc] = (char *)malloc(4096);
+            for(int Word = 0;
+                (Doc != 3) && (Word < 300);
+                ++Word)
+            {
+                int Number = ((Doc == 1) && (Word == 150)) ? 9999 : Word;
+                DocSizes[Doc] += sprintf(Docs[Doc] + DocSizes[Doc], "%s%d%s", (Doc == 2) ? "x" : "w", Number, (Word % 10) == 9 ? "\n" : " ");
+            }
+        }
+        
+        meow_u32 Signatures[4][128];
+        meow_u64 BandKeys[4*16];
+        for(int Doc = 0;
+            Doc < 4;
+            ++Doc)
+        {
+            MeowMinHashSignature(&MinHash, DocSizes[Doc], Docs[Doc], Signatures[Doc]);
+            MeowMinHashBandKeys(&MinHash, Signatures[Doc], BandKeys + Doc*16);
+        }
+        
+        Failed |= (MeowMinHashSimilarity(&MinHash, Signatures[0], Signatures[1]) < 0.8);
+        Failed |= (MeowMinHashSimilarity(&MinHash, Signatures[0], Signatures[2]) > 0.1);
+        Failed |= (MeowMinHashSimilarity(&MinHash, Signatures[0], Signatures[0]) != 1.0);
+        for(int Row = 0;
+            Row < 128;
+            ++Row)
+        {
+            Failed |= (Signatures[3][Row] != 0xFFFFFFFF);
+        }
+        
+        // NOTE: A document shorter than one shingle is a single shingle, so its
+        // signature is just the permutations of its hash
+        char Short[] = "  meow  hash ";
+        meow_u32 ShortSignature[128];
+        MeowMinHashSignature(&MinHash, sizeof(Short) - 1, Short, ShortSignature);
+        meow_u64 ShortHash = MeowU64From(MeowHash_Accelerated(1, 2, 10, Short + 2), 0);
+        for(meow_u32 Row = 0;
+            Row < 128;
+            ++Row)
+        {
+            meow_u32 Value = ((((meow_u32)ShortHash ^ MinHash.Xors[Row])*MinHash.Multipliers[Row]) +
+                              (meow_u32)(ShortHash >> 32));
+            Failed |= (ShortSignature[Row] != (Value ^ (Value >> 16)));
+        }
+        
+        meow_lsh_index Index;
+        Failed |= !MeowLshBuild(&Index, 4, 16, BandKeys, 2);
+        int PairCount = 0;
+        MeowLshForEachPair(&Index, [&](meow_umm A, meow_umm B)
+        {
+            Failed |= (A != 0) || (B != 1);
+            ++PairCount;
+        });
+        Failed |= (PairCount != 1);
+        
+        int CandidateCount = 0;
+        MeowLshForEachCandidate(&Index, BandKeys + 16, [&](meow_umm Doc)
+        {
+            Failed |= (Doc > 1);
+            ++CandidateCount;
+        });
+        Failed |= (CandidateCount != 2);
+        MeowLshFree(&Index);
+        
+        for(int Doc = 0;
+            Doc < 4;
+            ++Doc)
+        {
+            free(Docs[Doc]);
+        }
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow memo cache: ");
+    {
+        int Failed = 0;
+        
+        // NOTE: Keys see the input boundaries, and the streamed form matches
+        char Bytes[] = "abcdef";
+        void *SplitA[2] = {Bytes, Bytes + 2};
+        meow_umm SizesA[2] = {2, 4};
+        void *SplitB[2] = {Bytes, Bytes + 3};
+        meow_umm SizesB[2] = {3, 3};
+        int Quality = 3;
+        meow_hash KeyA = MeowMemoKey(2, SplitA, SizesA, sizeof(Quality), &Quality);
+        meow_hash KeyB = MeowMemoKey(2, SplitB, SizesB, sizeof(Quality), &Quality);
+        meow_hash KeyAgain = MeowMemoKey(2, SplitA, SizesA, sizeof(Quality), &Quality);
+        Failed |= MeowHashesAreEqual(KeyA, KeyB);
+        Failed |= !MeowHashesAreEqual(KeyA, KeyAgain);
+        
+        meow_hash_state State;
+        MeowMemoKeyBegin(&State, 2, 6, sizeof(Quality));
+        MeowMemoKeyInput(&State, 2, Bytes);
+        MeowMemoKeyInput(&State, 4, 0);
+        MeowHashAbsorb(&State, 1, Bytes + 2);
+        MeowHashAbsorb(&State, 3, Bytes + 3);
+        meow_hash Streamed = MeowMemoKeyEnd(&State, sizeof(Quality), &Quality);
+        Failed |= !MeowHashesAreEqual(KeyA, Streamed);
+        
+        // NOTE: Outputs of 0 to 300 bytes, far more than fit, with output 0 used all the time
+        meow_u64 ArenaSize = 8192;
+        meow_umm MaxCount = 64;
+        void *Memory = malloc(MeowMemoSize(ArenaSize, MaxCount));
+        meow_memo Memo;
+        MeowMemoInit(&Memo, Memory, ArenaSize, MaxCount);
+        
+        meow_u8 Output[300];
+        meow_hash Keys[1000];
+        for(int Step = 0;
+            Step < 1000;
+            ++Step)
+        {
+            Keys[Step] = MeowMemoKey(0, 0, 0, sizeof(Step), &Step);
+            memset(Output, Step & 0xFF, sizeof(Output));
+            meow_umm Size = (Step*37) % 301;
+            meow_u8 *Stored = (meow_u8 *)MeowMemoPut(&Memo, Keys[Step], Size, Output);
+            Failed |= !Stored || (Size && ((Stored[0] != (Step & 0xFF)) || (Stored[Size - 1] != (Step & 0xFF))));
+            
+            meow_umm Got = 1;
+            Failed |= !MeowMemoGet(&Memo, Keys[0], &Got) || (Got != 0);
+            Failed |= (Memo.Count > MaxCount) || ((Memo.Head - Memo.Tail) > ArenaSize);
+        }
+        Failed |= (Memo.Evictions == 0) || (Memo.SecondChances == 0);
+        Failed |= MeowMemoContains(&Memo, Keys[1]);
+        
+        meow_u8 Found[1000];
+        MeowMemoContainsBatch(&Memo, 1000, Keys, Found);
+        meow_umm FoundCount = 0;
+        for(int Step = 0;
+            Step < 1000;
+            ++Step)
+        {
+            Failed |= (Found[Step] != MeowMemoContains(&Memo, Keys[Step]));
+            FoundCount += Found[Step];
+        }
+        Failed |= (FoundCount != Memo.Count);
+        
+        meow_hash TooBig = MeowMemoKey(1, SplitA, SizesA, 0, 0);
+        Failed |= (MeowMemoPut(&Memo, TooBig, (meow_umm)ArenaSize, Memory) != 0);
+        
+        // NOTE: The disk tier, across a close and reopen, and through both tiers at once
+        char const *Directory = "meow_memo_test.tmp";
+        meow_memo_store Store;
+        Failed |= !MeowMemoStoreOpen(&Store, Directory);
+        for(int Step = 0;
+            Step < 100;
+            ++Step)
+        {
+            memset(Output, Step, sizeof(Output));
+            Failed |= !MeowMemoStorePut(&Store, Keys[Step], Step, Output);
+        }
+        meow_umm Size = 0;
+        Failed |= (MeowMemoStoreGet(&Store, Keys[5], &Size) != 0);
+        
+        // NOTE: A key put again before the flush is not written again
+        meow_u64 WrittenBefore = Store.WritingAt;
+        Failed |= !MeowMemoStorePut(&Store, Keys[7], 7, Output);
+        Failed |= (Store.WritingAt != WrittenBefore) || (Store.PendingCount != 100);
+        Failed |= !MeowMemoStoreClose(&Store);
+        
+        Failed |= !MeowMemoStoreOpen(&Store, Directory);
+        Failed |= !MeowMemoStorePut(&Store, Keys[100], 100, Output);
+        Failed |= !MeowMemoStoreFlush(&Store);
+        for(int Step = 0;
+            Step <= 100;
+            ++Step)
+        {
+            meow_u8 *Stored = (meow_u8 *)MeowMemoStoreGet(&Store, Keys[Step], &Size);
+            Failed |= !Stored || (Size != (meow_umm)Step) || (Step && (Stored[Step - 1] != (meow_u8)((Step == 100) ? 99 : Step)));
+        }
+        Failed |= (MeowMemoStoreGet(&Store, Keys[101], &Size) != 0);
+        
+        MeowMemoInit(&Memo, Memory, ArenaSize, MaxCount);
+        Failed |= (MeowMemoLookup(&Memo, &Store, Keys[50], &Size) == 0) || (Size != 50);
+        Failed |= !MeowMemoContains(&Memo, Keys[50]);
+        Failed |= (MeowMemoLookup(&Memo, &Store, Keys[101], &Size) != 0);
+        
+        // NOTE: Flushing after every put keeps adding to one pack, and only to a few manifest levels
+        for(int Step = 101;
+            Step < 1000;
+            ++Step)
+        {
+            meow_u64 Extra = Step;
+            meow_hash ExtraKey = MeowMemoKey(0, 0, 0, sizeof(Extra), &Extra);
+            Failed |= !MeowMemoStorePut(&Store, ExtraKey, sizeof(Extra), &Extra);
+            Failed |= !MeowMemoStoreFlush(&Store);
+            
+            meow_u64 *Stored = (meow_u64 *)MeowMemoStoreGet(&Store, ExtraKey, &Size);
+            Failed |= !Stored || (Size != sizeof(Extra)) || (*Stored != Extra);
+            Failed |= (Store.LevelCount > 11);
+        }
+        Failed |= (Store.PackCount != 2);
+        for(int Step = 0;
+            Step <= 100;
+            ++Step)
+        {
+            Failed |= (MeowMemoStoreGet(&Store, Keys[Step], &Size) == 0) || (Size != (meow_umm)Step);
+        }
+        
+        // NOTE: Running out of pack numbers is reported rather than silently failing every put
+        meow_u32 PackCount = Store.PackCount;
+        MeowMemoStoreFlush(&Store);
+        fclose(Store.Writing);
+        Store.Writing = 0;
+        Store.PackCount = MEOW_MEMO_MAX_PACKS;
+        Failed |= MeowMemoStorePut(&Store, Keys[101], 101, Output) || !Store.Full;
+        Store.PackCount = PackCount;
+        
+        meow_u32 Generations = Store.NextGeneration;
+        meow_u32 LevelCount = Store.LevelCount;
+        Failed |= !MeowMemoStoreClose(&Store);
+        
+        char Path[MEOW_MEMO_MAX_PATH];
+        for(meow_u32 Pack = 0;
+            Pack < PackCount;
+            ++Pack)
+        {
+            snprintf(Path, sizeof(Path), "%s/pack-%08u.meowpack", Directory, (unsigned)Pack);
+            Failed |= (remove(Path) != 0);
+        }
+        
+        // NOTE: Merged levels have been deleted, and only the ones in use are left
+        meow_u32 LevelsLeft = 0;
+        for(meow_u32 Generation = 0;
+            Generation < Generations;
+            ++Generation)
+        {
+            snprintf(Path, sizeof(Path), "%s/manifest-%08u.meowidx", Directory, (unsigned)Generation);
+            LevelsLeft += (remove(Path) == 0);
+        }
+        Failed |= (LevelsLeft != LevelCount);
+        snprintf(Path, sizeof(Path), "%s/manifest.meowroot", Directory);
+        Failed |= (remove(Path) != 0);
+#if _WIN32
+        RemoveDirectoryA(Directory);
+#else
+        rmdir(Directory);
+#endif
+        free(Memory);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow placement: ");
+    {
+        int Failed = 0;
+        
+        meow_u32 const NodeCount = 100;
+        meow_u32 const KeyCount = 50000;
+        meow_placement Placement;
+        MeowPlacementInit(&Placement, NodeCount + 1);
+        for(meow_u32 Node = 0;
+            Node < NodeCount;
+            ++Node)
+        {
+            char Name[32];
+            int NameLength = snprintf(Name, sizeof(Name), "node-%u", (unsigned)Node);
+            Failed |= (MeowPlacementAddNode(&Placement, NameLength, Name) != Node);
+        }
+        
+        meow_hash *Keys = (meow_hash *)malloc(KeyCount*sizeof(meow_hash));
+        meow_u32 *Homes = (meow_u32 *)malloc(KeyCount*sizeof(meow_u32));
+        meow_u32 Counts[NodeCount + 1];
+        memset(Counts, 0, sizeof(Counts));
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            Keys[KeyIndex] = HashOfU64(0, 0, KeyIndex);
+            Homes[KeyIndex] = MeowPlacementRendezvous(&Placement, Keys[KeyIndex]);
+            
+            // NOTE: Every width must agree with a plain scan
+            meow_u32 KeyA, KeyB;
+            MeowPlacementKey(Keys[KeyIndex], &KeyA, &KeyB);
+            meow_u32 Expected = 0;
+            meow_u32 ExpectedScore = 0;
+            for(meow_u32 Node = 0;
+                Node < NodeCount;
+                ++Node)
+            {
+                meow_u32 Score = MeowPlacementScore(&Placement, Node, KeyA, KeyB);
+                if(Score > ExpectedScore)
+                {
+                    Expected = Node;
+                    ExpectedScore = Score;
+                }
+            }
+            Failed |= (Homes[KeyIndex] != Expected);
+            int UseAVX2 = Placement.UseAVX2;
+            Placement.UseAVX2 = 0;
+            Failed |= (MeowPlacementRendezvous(&Placement, Keys[KeyIndex]) != Expected);
+            Placement.UseAVX2 = UseAVX2;
+            
+            ++Counts[Homes[KeyIndex]];
+        }
+        for(meow_u32 Node = 0;
+            Node < NodeCount;
+            ++Node)
+        {
+            Failed |= (Counts[Node] < 400) || (Counts[Node] > 600);
+        }
+        
+        // NOTE: Draining a node only moves its own keys, and adding one only takes keys
+        MeowPlacementEnableNode(&Placement, 7, 0);
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            meow_u32 Node = MeowPlacementRendezvous(&Placement, Keys[KeyIndex]);
+            Failed |= (Node == 7) || ((Homes[KeyIndex] != 7) && (Node != Homes[KeyIndex]));
+        }
+        MeowPlacementEnableNode(&Placement, 7, 1);
+        Failed |= (MeowPlacementAddNode(&Placement, 5, (void *)"extra") != NodeCount);
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            meow_u32 Node = MeowPlacementRendezvous(&Placement, Keys[KeyIndex]);
+            Failed |= (Node != NodeCount) && (Node != Homes[KeyIndex]);
+        }
+        MeowPlacementEnableNode(&Placement, NodeCount, 0);
+        
+        // NOTE: Jump
+        memset(Counts, 0, sizeof(Counts));
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            meow_u32 Bucket = MeowPlacementJump(Keys[KeyIndex], NodeCount);
+            meow_u32 Grown = MeowPlacementJump(Keys[KeyIndex], NodeCount + 1);
+            Failed |= (Bucket >= NodeCount) || ((Grown != Bucket) && (Grown != NodeCount));
+            if(Bucket < NodeCount)
+            {
+                ++Counts[Bucket];
+            }
+        }
+        for(meow_u32 Node = 0;
+            Node < NodeCount;
+            ++Node)
+        {
+            Failed |= (Counts[Node] < 400) || (Counts[Node] > 600);
+        }
+        Failed |= (MeowPlacementJump(Keys[0], 0) != MEOW_PLACEMENT_NONE);
+        
+        // NOTE: Ring
+        meow_ring Ring;
+        Failed |= !MeowRingBuild(&Ring, &Placement, 160, 0);
+        memset(Counts, 0, sizeof(Counts));
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            Homes[KeyIndex] = MeowRingLookup(&Ring, Keys[KeyIndex]);
+            Failed |= (Homes[KeyIndex] >= NodeCount);
+            if(Homes[KeyIndex] < NodeCount)
+            {
+                ++Counts[Homes[KeyIndex]];
+            }
+        }
+        for(meow_u32 Node = 0;
+            Node < NodeCount;
+            ++Node)
+        {
+            Failed |= (Counts[Node] < 250) || (Counts[Node] > 750);
+        }
+        MeowRingFree(&Ring);
+        
+        MeowPlacementEnableNode(&Placement, 7, 0);
+        Failed |= !MeowRingBuild(&Ring, &Placement, 160, 0);
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            meow_u32 Node = MeowRingLookup(&Ring, Keys[KeyIndex]);
+            Failed |= (Node == 7) || ((Homes[KeyIndex] != 7) && (Node != Homes[KeyIndex]));
+        }
+        MeowRingFree(&Ring);
+        MeowPlacementEnableNode(&Placement, 7, 1);
+        Failed |= !MeowRingBuild(&Ring, &Placement, 160, 0);
+        
+        // NOTE: Bounded loads never go over capacity, and everything fits
+        meow_placement_loads Loads;
+        MeowPlacementLoadsInit(&Loads, &Placement, KeyCount, 0.1);
+        Failed |= (Loads.Capacity != 550);
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            Failed |= (MeowPlacementAssign(&Placement, &Loads, Keys[KeyIndex]) >= NodeCount);
+        }
+        for(meow_u32 Node = 0;
+            Node < NodeCount;
+            ++Node)
+        {
+            Failed |= (Loads.Load[Node] > Loads.Capacity);
+        }
+        MeowPlacementLoadsFree(&Loads);
+        
+        MeowPlacementLoadsInit(&Loads, &Placement, KeyCount, 0.1);
+        for(meow_u32 KeyIndex = 0;
+            KeyIndex < KeyCount;
+            ++KeyIndex)
+        {
+            Failed |= (MeowRingAssign(&Ring, &Loads, Keys[KeyIndex]) >= NodeCount);
+        }
+        for(meow_u32 Node = 0;
+            Node < NodeCount;
+            ++Node)
+        {
+            Failed |= (Loads.Load[Node] > Loads.Capacity);
+        }
+        meow_u32 Load = Loads.Load[3];
+        MeowPlacementRelease(&Loads, 3);
+        Failed |= (Loads.Load[3] != Load - 1) || !Loads.Open[3];
+        MeowPlacementLoadsFree(&Loads);
+        MeowRingFree(&Ring);
+        
+        free(Homes);
+        free(Keys);
+        MeowPlacementFree(&Placement);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow radix sort: ");
+    {
+        int Failed = 0;
+        
+        meow_umm const MaxCount = 300000;
+        meow_radix_entry *Original = (meow_radix_entry *)malloc(MaxCount*sizeof(meow_radix_entry));
+        meow_radix_entry *Entries = (meow_radix_entry *)malloc(MaxCount*sizeof(meow_radix_entry));
+        meow_radix_entry *Scratch = (meow_radix_entry *)malloc(MaxCount*sizeof(meow_radix_entry));
+        meow_u8 *Seen = (meow_u8 *)malloc(MaxCount);
+        
+        // NOTE: Uniform hashes, then hashes with long shared prefixes and duplicates
+        for(int Shape = 0;
+            Shape < 2;
+            ++Shape)
+        {
+            for(meow_umm Index = 0;
+                Index < MaxCount;
+                ++Index)
+            {
+                meow_hash Hash = HashOfU64(Shape, 0, Index);
+                Original[Index].Low = MeowU64From(Hash, 0);
+                Original[Index].High = MeowU64From(Hash, 1);
+                Original[Index].Payload = Index;
+                if(Shape)
+                {
+                    Original[Index].High = (Original[Index].High & 0xFF00000000000003ull) | 0x00ABCDEF00000000ull;
+                    Original[Index].Low &= 0xFFFF0000000000FFull;
+                }
+            }
+            
+            meow_umm Counts[] = {0, 1, 5, 33, 2049, 70000, MaxCount};
+            for(meow_u32 CountIndex = 0;
+                CountIndex < ArrayCount(Counts);
+                ++CountIndex)
+            {
+                for(int Mode = 0;
+                    Mode < 3;
+                    ++Mode)
+                {
+                    meow_umm Count = Counts[CountIndex];
+                    memcpy(Entries, Original, Count*sizeof(meow_radix_entry));
+                    Failed |= !MeowRadixSort(Entries, Count, (Mode == 2) ? Scratch : 0, (Mode == 0) ? 1 : 4);
+                    
+                    memset(Seen, 0, Count);
+                    for(meow_umm Index = 0;
+                        Index < Count;
+                        ++Index)
+                    {
+                        meow_u64 Payload = Entries[Index].Payload;
+                        Failed |= (Payload >= Count) || Seen[Payload];
+                        if(Payload < Count)
+                        {
+                            Seen[Payload] = 1;
+                            Failed |= (Entries[Index].Low != Original[Payload].Low) || (Entries[Index].High != Original[Payload].High);
+                        }
+                        Failed |= Index && MeowRadixLess(&Entries[Index], &Entries[Index - 1]);
+                    }
+                }
+            }
+        }
+        
+        free(Seen);
+        free(Scratch);
+        free(Entries);
+        free(Original);
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow spill and merge: ");
+    {
+        int Failed = 0;
+        
+        // NOTE: 1MB of memory makes 19 runs and room to merge 15 at once (fewer if few files may be open),
+        // so there is at least one extra merge pass
+        char const *Directory = "meow_spill_test.tmp";
+        meow_spill Spill;
+        Failed |= !MeowSpillOpen(&Spill, Directory, 1024*1024, 2);
+        for(meow_u64 Record = 0;
+            Record < 400000;
+            ++Record)
+        {
+            meow_u64 Key = (Record >= 330000) ? 1000000 : (Record % 300000);
+            Failed |= !MeowSpillAdd(&Spill, HashOfU64(0, 0, Key), Record);
+        }
+        
+        spill_test Test = {};
+        Failed |= !MeowSpillMerge(&Spill, CheckSpillGroup, &Test);
+        Failed |= Test.Failed || (Test.GroupCount != 30000) || (Test.BigTotal != 70000);
+        Failed |= (Spill.RecordCount != 400000) || (Spill.DistinctCount != 300001);
+        Failed |= (Spill.GroupCount != 30001) || (Spill.DuplicateCount != (30000 + 69999));
+        meow_u64 RunsLeft = 19;
+        meow_u64 RunsExpected = 19;
+        while(RunsLeft > Spill.FanIn)
+        {
+            RunsLeft -= Spill.FanIn - 1;
+            ++RunsExpected;
+        }
+        Failed |= (Spill.FanIn < 2) || (Spill.FanIn > 15) || (Spill.RunsWritten != RunsExpected);
+        MeowSpillClose(&Spill);
+        
+        // NOTE: A merge that can not read one of its runs leaves the others for MeowSpillClose
+        char Path[MEOW_SPILL_MAX_PATH];
+        Failed |= !MeowSpillOpen(&Spill, Directory, 1024*1024, 1);
+        for(meow_u64 Record = 0;
+            Record < 30000;
+            ++Record)
+        {
+            Failed |= !MeowSpillAdd(&Spill, HashOfU64(0, 0, Record), Record);
+        }
+        MeowSpillWaitForWriter(&Spill);
+        snprintf(Path, sizeof(Path), "%s/run-%08u.meowrun", Directory, 0u);
+        Failed |= (remove(Path) != 0);
+        Failed |= MeowSpillMerge(&Spill, 0, 0);
+        snprintf(Path, sizeof(Path), "%s/run-%08u.meowrun", Directory, 1u);
+        FILE *Kept = fopen(Path, "rb");
+        Failed |= (Kept == 0);
+        if(Kept)
+        {
+            fclose(Kept);
+        }
+        MeowSpillClose(&Spill);
+        
+        // NOTE: Every run should be gone
+        for(meow_u32 Run = 0;
+            Run < RunsExpected;
+            ++Run)
+        {
+            snprintf(Path, sizeof(Path), "%s/run-%08u.meowrun", Directory, (unsigned)Run);
+            FILE *Left = fopen(Path, "rb");
+            Failed |= (Left != 0);
+            if(Left)
+            {
+                fclose(Left);
+                remove(Path);
+            }
+        }
+#if _WIN32
+        RemoveDirectoryA(Directory);
+#else
+        rmdir(Directory);
+#endif
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Long-key neighbors: ");
+    {
+        int Failed = 0;
+        
+        meow_umm Lens[] = {128, 200, 1024, 4096};
+        for(meow_u32 TypeIndex = 0;
+            TypeIndex < ArrayCount(NamedHashTypes);
+            ++TypeIndex)
+        {
+            for(meow_u32 LenIndex = 0;
+                LenIndex < ArrayCount(Lens);
+                ++LenIndex)
+            {
+                Failed |= (LongNeighborCollisions(NamedHashTypes[TypeIndex].Imp, Lens[LenIndex], rand()) != 0);
+            }
+        }
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow map: ");
+    {
+        int Failed = MapCheck<false>() | MapCheck<true>();
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow fingerprint set: ");
+    {
+        int Failed = 0;
+        for(int Run = 0;
+            Run < 4;
+            ++Run)
+        {
+            Failed |= FingerprintSetCheck();
+        }
+        
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
+    printf("Meow interning: ");
+    {
+        int Failed = InternCheck();
+        if(Failed)
+        {
+            printf("FAILED");
+            Result = -1;
+        }
+        else
+        {
+            printf("PASSED");
+        }
+    }
+    printf("\n");
+    
     return(Result);
 }
@@ -42,6 +42,7 @@ static void* aligned_alloc(size_t alignment, size_t size)
 
 #include "meow_hash.h"
 #include "more/meow_more.h"
+#include "more/meow_wide.h"
 
 #define ArrayCount(Array) (sizeof(Array)/sizeof((Array)[0]))
 
@@ -197,32 +198,36 @@ struct named_hash_type
     
     meow_hash_implementation *Imp;
     meow_absorb_implementation *Absorb;
+    meow_hash_implementation *Reference;    // NOTE: What Imp must match, if that is not MeowHash_C
 };
 
 static named_hash_type NamedHashTypes[] =
 {
 #define MEOW_HASH_TEST_INDEX_128 0
-    {(char *)"Meow128", (char *)"Meow 128-bit AES-NI 128-wide", MeowHash_Accelerated, MeowHashAbsorb},
+    {(char *)"Meow128", (char *)"Meow 128-bit AES-NI 128-wide", MeowHash_Accelerated, MeowHashAbsorb, 0},
 #if MEOW_INCLUDE_C
-    {(char *)"MeowC", (char *)"Meow 128-bit ANSI-C", MeowHash_C},
+    {(char *)"MeowC", (char *)"Meow 128-bit ANSI-C", MeowHash_C, 0, 0},
+    {(char *)"MeowWide", (char *)"Meow Wide 128-bit AES-NI 8-lane", MeowWideHash_Accelerated, 0, MeowWideHash_C},
+#else
+    {(char *)"MeowWide", (char *)"Meow Wide 128-bit AES-NI 8-lane", MeowWideHash_Accelerated, 0, 0},
 #endif
 #if MEOW_INCLUDE_TRUNCATIONS
-    {(char *)"Meow64", (char *)"Meow 64-bit AES-NI 128-wide", MeowHashTruncate64},
-    {(char *)"Meow32", (char *)"Meow 32-bit AES-NI 128-wide", MeowHashTruncate32},
+    {(char *)"Meow64", (char *)"Meow 64-bit AES-NI 128-wide", MeowHashTruncate64, 0, 0},
+    {(char *)"Meow32", (char *)"Meow 32-bit AES-NI 128-wide", MeowHashTruncate32, 0, 0},
 #endif
 
 #if MEOW_INCLUDE_OTHER_HASHES
-    {(char *)"t1ha64", (char *)"t1ha 64-bit", t1ha64},
-    {(char *)"Falk128", (char *)"Falk Hash 128-bit", FalkHash128},
-    {(char *)"xx64", (char *)"xxHash 64-bit", xxHash64},
-    {(char *)"Met128", (char *)"Metro Hash 128-bit", MetroHash128},
-    {(char *)"City128", (char *)"City Hash 128-bit", CityHash128},
-    {(char *)"Farm", (char *)"Farm Hash 128-bit", FarmHash128},
-    {(char *)"CL", (char *)"CLHash 64-bit", CLHash64},
+    {(char *)"t1ha64", (char *)"t1ha 64-bit", t1ha64, 0, 0},
+    {(char *)"Falk128", (char *)"Falk Hash 128-bit", FalkHash128, 0, 0},
+    {(char *)"xx64", (char *)"xxHash 64-bit", xxHash64, 0, 0},
+    {(char *)"Met128", (char *)"Metro Hash 128-bit", MetroHash128, 0, 0},
+    {(char *)"City128", (char *)"City Hash 128-bit", CityHash128, 0, 0},
+    {(char *)"Farm", (char *)"Farm Hash 128-bit", FarmHash128, 0, 0},
+    {(char *)"CL", (char *)"CLHash 64-bit", CLHash64, 0, 0},
     
     // NOTE(casey): Highway Hash is disabled until someone provides a usable ~4 file implementation
     // that is optimized.
-//    {(char *)"High128", (char *)"Highway Hash 128-bit", HighwayHash128},
+//    {(char *)"High128", (char *)"Highway Hash 128-bit", HighwayHash128, 0, 0},
 #endif
 };
 
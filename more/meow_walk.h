@@ -0,0 +1,148 @@
+/* ========================================================================
+   
+   meow_walk.h - recursive directory walking for the Meow tools
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   The front end shared by tools that hash every file under a directory
+   (meow_search, meow_near):
+   
+       static void OnFile(void *Context, char *FileName) {...}
+   
+       meow_walk Walk = {Context, OnFile, OnUnknown};   // NOTE: OnUnknown may be 0
+       MeowWalkDirectory(&Walk, RootPath);
+   
+   File gets called for every regular file, in directory order, with a
+   path made of the root path and the names below it, joined with '/'.
+   The path belongs to the callback from then on - tools that keep file
+   names around keep it, and others MeowDeallocPath it.  Unknown gets
+   called for entries whose type can not be found out without a stat
+   (POSIX file systems that do not fill in d_type), which the tools count
+   as access failures; that path is only good for the call.
+   
+   ======================================================================== */
+
+#include <stdlib.h>
+#include <string.h>
+#if _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+typedef void meow_walk_callback(void *Context, char *Path);
+
+typedef struct meow_walk
+{
+    void *Context;
+    meow_walk_callback *File;
+    meow_walk_callback *Unknown;
+} meow_walk;
+
+static char *
+MeowAllocPath(char *A, char *B)
+{
+    size_t ACount = strlen(A);
+    size_t BCount = strlen(B);
+    size_t Size = ACount + BCount + 2;
+    
+    char *Result = (char *)malloc(Size);
+    memcpy(Result, A, ACount);
+    memcpy(Result + ACount + 1, B, BCount);
+    Result[ACount] = '/';
+    Result[Size - 1] = 0;
+    
+    return(Result);
+}
+
+static void
+MeowDeallocPath(char *A)
+{
+    if(A)
+    {
+        free(A);
+    }
+}
+
+#if _WIN32
+
+static void
+MeowWalkDirectory(meow_walk *Walk, char *Path)
+{
+    char *Wildcard = MeowAllocPath(Path, (char *)"*");
+    
+    WIN32_FIND_DATAA FindData;
+    HANDLE SearchHandle = FindFirstFileExA(Wildcard, FindExInfoBasic, &FindData,
+                                           FindExSearchNameMatch, 0, FIND_FIRST_EX_LARGE_FETCH);
+    if(SearchHandle != INVALID_HANDLE_VALUE)
+    {
+        do
+        {
+            char *Stem = FindData.cFileName;
+            if(strcmp(Stem, ".") && strcmp(Stem, ".."))
+            {
+                char *EntryName = MeowAllocPath(Path, Stem);
+                if(FindData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+                {
+                    MeowWalkDirectory(Walk, EntryName);
+                    MeowDeallocPath(EntryName);
+                }
+                else
+                {
+                    Walk->File(Walk->Context, EntryName);
+                }
+            }
+        } while(FindNextFileA(SearchHandle, &FindData));
+        
+        FindClose(SearchHandle);
+    }
+    
+    MeowDeallocPath(Wildcard);
+}
+
+#else
+
+static void
+MeowWalkDirectory(meow_walk *Walk, char *Path)
+{
+    DIR *DirHandle = opendir(Path);
+    if(DirHandle)
+    {
+        for(dirent *Entry = readdir(DirHandle);
+            Entry;
+            Entry = readdir(DirHandle))
+        {
+            char *Stem = Entry->d_name;
+            if(strcmp(Stem, ".") && strcmp(Stem, ".."))
+            {
+                char *EntryName = MeowAllocPath(Path, Stem);
+                if(Entry->d_type == DT_DIR)
+                {
+                    MeowWalkDirectory(Walk, EntryName);
+                    MeowDeallocPath(EntryName);
+                }
+                else if(Entry->d_type == DT_REG)
+                {
+                    Walk->File(Walk->Context, EntryName);
+                }
+                else
+                {
+                    if((Entry->d_type == DT_UNKNOWN) && Walk->Unknown)
+                    {
+                        Walk->Unknown(Walk->Context, EntryName);
+                    }
+                    MeowDeallocPath(EntryName);
+                }
+            }
+        }
+        
+        closedir(DirHandle);
+    }
+}
+
+#endif
@@ -0,0 +1,540 @@
+/* ========================================================================
+   
+   meow_wide.h - eight-lane variant of the Meow hash
+   (C) Copyright 2018 by Molly Rocket, Inc. (https://mollyrocket.com)
+   
+   See https://mollyrocket.com/meowhash for details.
+   
+   ========================================================================
+   
+   USAGE
+   
+   The aesdecx2 Meow runs two dependent AESDECs per 16 bytes on each of its
+   four lanes.  With a four cycle AESDEC latency, that is one 64-byte block
+   every eight cycles no matter how many AES units the core has.  Meow Wide
+   keeps the same two rounds per 16 bytes but runs eight lanes over 128-byte
+   blocks, so a core that issues two AESDECs per cycle can keep both busy.
+   
+   Inputs shorter than one 128-byte block never touch the extra lanes and
+   run exactly the same instructions as MeowHash_Accelerated, so small
+   hashes cost the same as they do with Meow.  Longer inputs fold the upper
+   four lanes into the lower four before the usual Meow reduction.
+   
+   Meow Wide is a DIFFERENT hash from Meow (its lanes start from different
+   constants), so its values must not be mixed with Meow values.  The API
+   mirrors meow_hash.h and meow_more.h:
+   
+       #include "meow_intrinsics.h"
+       #include "meow_hash.h"
+       #include "more/meow_more.h" // NOTE: Only needed for MeowWideHash_C
+       #include "more/meow_wide.h"
+   
+       meow_hash Hash = MeowWideHash_Accelerated(Seed1, Seed2, Len, Source);
+   
+       meow_wide_hash_state State;
+       MeowWideHashBegin(&State, Seed1, Seed2, Len);
+       for(each chunk) MeowWideHashAbsorb(&State, ChunkLen, Chunk);
+       meow_hash Hash = MeowWideHashEnd(&State, Seed1, Seed2);
+   
+   ======================================================================== */
+
+#define MEOW_WIDE_HASH_VERSION_NAME "0.4/aesdecx2-wide8"
+#define MEOW_WIDE_HASH_BLOCK_SIZE_SHIFT 7
+
+#define MEOW_WIDE_S0_INIT { 64, 65, 66, 67,  68, 69, 70, 71,  72, 73, 74, 75,  76, 77, 78, 79}
+#define MEOW_WIDE_S1_INIT { 80, 81, 82, 83,  84, 85, 86, 87,  88, 89, 90, 91,  92, 93, 94, 95}
+#define MEOW_WIDE_S2_INIT { 96, 97, 98, 99, 100,101,102,103, 104,105,106,107, 108,109,110,111}
+#define MEOW_WIDE_S3_INIT {112,113,114,115, 116,117,118,119, 120,121,122,123, 124,125,126,127}
+#define MEOW_WIDE_S4_INIT {128,129,130,131, 132,133,134,135, 136,137,138,139, 140,141,142,143}
+#define MEOW_WIDE_S5_INIT {144,145,146,147, 148,149,150,151, 152,153,154,155, 156,157,158,159}
+#define MEOW_WIDE_S6_INIT {160,161,162,163, 164,165,166,167, 168,169,170,171, 172,173,174,175}
+#define MEOW_WIDE_S7_INIT {176,177,178,179, 180,181,182,183, 184,185,186,187, 188,189,190,191}
+static const unsigned char MeowWideS0Init[] = MEOW_WIDE_S0_INIT;
+static const unsigned char MeowWideS1Init[] = MEOW_WIDE_S1_INIT;
+static const unsigned char MeowWideS2Init[] = MEOW_WIDE_S2_INIT;
+static const unsigned char MeowWideS3Init[] = MEOW_WIDE_S3_INIT;
+static const unsigned char MeowWideS4Init[] = MEOW_WIDE_S4_INIT;
+static const unsigned char MeowWideS5Init[] = MEOW_WIDE_S5_INIT;
+static const unsigned char MeowWideS6Init[] = MEOW_WIDE_S6_INIT;
+static const unsigned char MeowWideS7Init[] = MEOW_WIDE_S7_INIT;
+
+//
+// NOTE: 128-wide AES-NI Meow Wide (eight independent AESDECx2 chains)
+//
+
+static meow_hash
+MeowWideHash_Accelerated(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, void *SourceInit)
+{
+    //
+    // NOTE(casey): Initialize the four AES streams and the mixer
+    //
+    
+    meow_aes_128 S0 = Meow128_GetAESConstant(MeowWideS0Init);
+    meow_aes_128 S1 = Meow128_GetAESConstant(MeowWideS1Init);
+    meow_aes_128 S2 = Meow128_GetAESConstant(MeowWideS2Init);
+    meow_aes_128 S3 = Meow128_GetAESConstant(MeowWideS3Init);
+    
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - TotalLengthInBytes,
+                                      Seed2 + TotalLengthInBytes + 1);
+    S0 ^= Mixer;
+    S1 ^= Mixer;
+    S2 ^= Mixer;
+    S3 ^= Mixer;
+    
+    meow_u8 *Source = (meow_u8 *)SourceInit;
+    meow_u64 Len = TotalLengthInBytes;
+    int unsigned Len8 = Len & 15;
+    int unsigned Len128 = Len & 48;
+    
+    //
+    // NOTE: Handle as many full 128-byte blocks as possible on eight lanes,
+    // then fold the upper four lanes back into the lower four
+    //
+    
+    if(Len >= 128)
+    {
+        meow_aes_128 S4 = Meow128_GetAESConstant(MeowWideS4Init);
+        meow_aes_128 S5 = Meow128_GetAESConstant(MeowWideS5Init);
+        meow_aes_128 S6 = Meow128_GetAESConstant(MeowWideS6Init);
+        meow_aes_128 S7 = Meow128_GetAESConstant(MeowWideS7Init);
+        S4 ^= Mixer;
+        S5 ^= Mixer;
+        S6 ^= Mixer;
+        S7 ^= Mixer;
+        
+        do
+        {
+            S0 = Meow128_AESDEC_Memx2(S0, Source);
+            S1 = Meow128_AESDEC_Memx2(S1, Source + 16);
+            S2 = Meow128_AESDEC_Memx2(S2, Source + 32);
+            S3 = Meow128_AESDEC_Memx2(S3, Source + 48);
+            S4 = Meow128_AESDEC_Memx2(S4, Source + 64);
+            S5 = Meow128_AESDEC_Memx2(S5, Source + 80);
+            S6 = Meow128_AESDEC_Memx2(S6, Source + 96);
+            S7 = Meow128_AESDEC_Memx2(S7, Source + 112);
+            
+            Len -= 128;
+            Source += 128;
+        } while(Len >= 128);
+        
+        S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S4));
+        S1 = Meow128_AESDEC(S1, Meow128_AESDEC_Finalize(S5));
+        S2 = Meow128_AESDEC(S2, Meow128_AESDEC_Finalize(S6));
+        S3 = Meow128_AESDEC(S3, Meow128_AESDEC_Finalize(S7));
+    }
+    
+    //
+    // NOTE: From here on this is exactly Meow: a possible 64-byte half block
+    // on the lower four lanes, then the overhang and the four-lane reduction
+    //
+    
+    if(Len >= 64)
+    {
+        S0 = Meow128_AESDEC_Memx2(S0, Source);
+        S1 = Meow128_AESDEC_Memx2(S1, Source + 16);
+        S2 = Meow128_AESDEC_Memx2(S2, Source + 32);
+        S3 = Meow128_AESDEC_Memx2(S3, Source + 48);
+        
+        Len -= 64;
+        Source += 64;
+    }
+    
+    //
+    // NOTE(casey): Overhanging individual bytes
+    //
+    
+    if(Len8)
+    {
+        meow_u8 *Overhang = Source + Len128;
+        int Align = ((int)(meow_umm)Overhang) & 15;
+        if(Align)
+        {
+            int End = ((int)(meow_umm)Overhang) & (MEOW_PAGESIZE - 1);
+            
+            // NOTE(jeffr): If we are nowhere near the page end, use full unaligned load (cmov to set)
+            if (End <= (MEOW_PAGESIZE - 16))
+            {
+                Align = 0;
+            }
+            
+            // NOTE(jeffr): If we will read over the page end, use a full unaligned load (cmov to set)
+            if ((End + Len8) > MEOW_PAGESIZE)
+            {
+                Align = 0;
+            }
+            
+            meow_u128 Partial = Meow128_Shuffle_Mem(Overhang - Align, &MeowShiftAdjust[Align]);
+            
+            Partial = Meow128_And_Mem( Partial, &MeowMaskLen[16 - Len8] );
+            S3 = Meow128_AESDECx2(S3, Partial);
+        }
+        else
+        {
+            // NOTE(casey): We don't have to do Jeff's heroics when we know the
+            // buffer is aligned, since we cannot span a memory page (by definition).
+            meow_u128 Partial = Meow128_And_Mem(*(meow_u128 *)Overhang, &MeowMaskLen[16 - Len8]);
+            S3 = Meow128_AESDECx2(S3, Partial);
+        }
+    }
+    
+    //
+    // NOTE(casey): Overhanging full 128-bit lanes
+    //
+    
+    switch(Len128)
+    {
+        case 48: S2 = Meow128_AESDEC_Memx2(S2, Source + 32);
+        case 32: S1 = Meow128_AESDEC_Memx2(S1, Source + 16);
+        case 16: S0 = Meow128_AESDEC_Memx2(S0, Source);
+    }
+    
+    //
+    // NOTE(casey): Mix the four lanes down to one 128-bit hash
+    //
+    
+    S3 = Meow128_AESDEC(S3, Mixer);
+    S2 = Meow128_AESDEC(S2, Mixer);
+    S1 = Meow128_AESDEC(S1, Mixer);
+    S0 = Meow128_AESDEC(S0, Mixer);
+    
+    S2 = Meow128_AESDEC(S2, Meow128_AESDEC_Finalize(S3));
+    S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S1));
+    
+    S2 = Meow128_AESDEC(S2, Mixer);
+    
+    S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S2));
+    S0 = Meow128_AESDEC(S0, Mixer);
+    
+    meow_hash Result;
+    Meow128_CopyToHash(Meow128_AESDEC_Finalize(S0), Result);
+    
+    return(Result);
+}
+
+//
+// NOTE(casey): Streaming construction
+//
+
+typedef struct meow_wide_hash_state
+{
+    meow_aes_128 S0;
+    meow_aes_128 S1;
+    meow_aes_128 S2;
+    meow_aes_128 S3;
+    meow_aes_128 S4;
+    meow_aes_128 S5;
+    meow_aes_128 S6;
+    meow_aes_128 S7;
+    
+    meow_u64 TotalLengthInBytes;
+    
+    meow_u8 Buffer[1 << MEOW_WIDE_HASH_BLOCK_SIZE_SHIFT];
+    int unsigned BufferLen;
+} meow_wide_hash_state;
+
+static inline void
+MeowWideHashBegin(meow_wide_hash_state *State, meow_u64 Seed1, meow_u64 Seed2,
+                  meow_u64 length)
+{
+    State->S0 = Meow128_GetAESConstant(MeowWideS0Init);
+    State->S1 = Meow128_GetAESConstant(MeowWideS1Init);
+    State->S2 = Meow128_GetAESConstant(MeowWideS2Init);
+    State->S3 = Meow128_GetAESConstant(MeowWideS3Init);
+    State->S4 = Meow128_GetAESConstant(MeowWideS4Init);
+    State->S5 = Meow128_GetAESConstant(MeowWideS5Init);
+    State->S6 = Meow128_GetAESConstant(MeowWideS6Init);
+    State->S7 = Meow128_GetAESConstant(MeowWideS7Init);
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - length, Seed2 + length + 1);
+    State->S0 ^= Mixer;
+    State->S1 ^= Mixer;
+    State->S2 ^= Mixer;
+    State->S3 ^= Mixer;
+    State->S4 ^= Mixer;
+    State->S5 ^= Mixer;
+    State->S6 ^= Mixer;
+    State->S7 ^= Mixer;
+    State->TotalLengthInBytes = 0;
+    State->BufferLen = 0;
+}
+
+static void
+MeowWideHashAbsorbBlocks(meow_wide_hash_state *State, meow_u64 BlockCount, meow_u8 *Source)
+{
+    meow_aes_128 S0 = State->S0;
+    meow_aes_128 S1 = State->S1;
+    meow_aes_128 S2 = State->S2;
+    meow_aes_128 S3 = State->S3;
+    meow_aes_128 S4 = State->S4;
+    meow_aes_128 S5 = State->S5;
+    meow_aes_128 S6 = State->S6;
+    meow_aes_128 S7 = State->S7;
+    
+    while(BlockCount--)
+    {
+        S0 = Meow128_AESDEC_Memx2(S0, Source);
+        S1 = Meow128_AESDEC_Memx2(S1, Source + 16);
+        S2 = Meow128_AESDEC_Memx2(S2, Source + 32);
+        S3 = Meow128_AESDEC_Memx2(S3, Source + 48);
+        S4 = Meow128_AESDEC_Memx2(S4, Source + 64);
+        S5 = Meow128_AESDEC_Memx2(S5, Source + 80);
+        S6 = Meow128_AESDEC_Memx2(S6, Source + 96);
+        S7 = Meow128_AESDEC_Memx2(S7, Source + 112);
+        
+        Source += (1 << MEOW_WIDE_HASH_BLOCK_SIZE_SHIFT);
+    }
+    
+    State->S0 = S0;
+    State->S1 = S1;
+    State->S2 = S2;
+    State->S3 = S3;
+    State->S4 = S4;
+    State->S5 = S5;
+    State->S6 = S6;
+    State->S7 = S7;
+}
+
+static inline void
+MeowWideHashAbsorb(meow_wide_hash_state *State, meow_u64 Len, void *SourceInit)
+{
+    State->TotalLengthInBytes += Len;
+    meow_u8 *Source = (meow_u8 *)SourceInit;
+    
+    // NOTE(casey): Handle any buffered residual
+    if(State->BufferLen)
+    {
+        int unsigned Fill = (sizeof(State->Buffer) - State->BufferLen);
+        if(Fill > Len)
+        {
+            Fill = (int unsigned)Len;
+        }
+        
+        Len -= Fill;
+        while(Fill--)
+        {
+            State->Buffer[State->BufferLen++] = *Source++;
+        }
+        
+        if(State->BufferLen == sizeof(State->Buffer))
+        {
+            MeowWideHashAbsorbBlocks(State, 1, State->Buffer);
+            State->BufferLen = 0;
+        }
+    }
+    
+    // NOTE(casey): Handle any full blocks
+    meow_u64 BlockCount = (Len >> MEOW_WIDE_HASH_BLOCK_SIZE_SHIFT);
+    meow_u64 Advance = (BlockCount << MEOW_WIDE_HASH_BLOCK_SIZE_SHIFT);
+    MeowWideHashAbsorbBlocks(State, BlockCount, Source);
+    
+    Len -= Advance;
+    Source += Advance;
+    
+    // NOTE(casey): Store residual
+    while(Len--)
+    {
+        State->Buffer[State->BufferLen++] = *Source++;
+    }
+}
+
+static inline meow_hash
+MeowWideHashEnd(meow_wide_hash_state *State, meow_u64 Seed1, meow_u64 Seed2)
+{
+    meow_aes_128 S0 = State->S0;
+    meow_aes_128 S1 = State->S1;
+    meow_aes_128 S2 = State->S2;
+    meow_aes_128 S3 = State->S3;
+    
+    // NOTE: The upper lanes only count once a full 128-byte block went through them
+    if(State->TotalLengthInBytes >= 128)
+    {
+        S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(State->S4));
+        S1 = Meow128_AESDEC(S1, Meow128_AESDEC_Finalize(State->S5));
+        S2 = Meow128_AESDEC(S2, Meow128_AESDEC_Finalize(State->S6));
+        S3 = Meow128_AESDEC(S3, Meow128_AESDEC_Finalize(State->S7));
+    }
+    
+    meow_u8 *Source = State->Buffer;
+    int unsigned Len = State->BufferLen;
+    int unsigned Len8 = Len & 15;
+    int unsigned Len128 = Len & 48;
+    
+    if(Len >= 64)
+    {
+        S0 = Meow128_AESDEC_Memx2(S0, Source);
+        S1 = Meow128_AESDEC_Memx2(S1, Source + 16);
+        S2 = Meow128_AESDEC_Memx2(S2, Source + 32);
+        S3 = Meow128_AESDEC_Memx2(S3, Source + 48);
+        
+        Len -= 64;
+        Source += 64;
+    }
+    
+    //
+    // NOTE(casey): Overhanging individual bytes
+    //
+    
+    if(Len8)
+    {
+        // NOTE: The residual lives in State->Buffer, so the full 16-byte load
+        // cannot run off the end of a page
+        meow_u8 *Overhang = Source + Len128;
+        meow_u128 Partial = Meow128_Shuffle_Mem(Overhang, &MeowShiftAdjust[0]);
+        
+        Partial = Meow128_And_Mem( Partial, &MeowMaskLen[16 - Len8] );
+        S3 = Meow128_AESDECx2(S3, Partial);
+    }
+    
+    //
+    // NOTE(casey): Overhanging full 128-bit lanes
+    //
+    
+    switch(Len128)
+    {
+        case 48: S2 = Meow128_AESDEC_Memx2(S2, Source + 32);
+        case 32: S1 = Meow128_AESDEC_Memx2(S1, Source + 16);
+        case 16: S0 = Meow128_AESDEC_Memx2(S0, Source);
+    }
+    
+    meow_u128 Mixer = Meow128_Set64x2(Seed1 - State->TotalLengthInBytes,
+                                      Seed2 + State->TotalLengthInBytes + 1);
+    
+    S3 = Meow128_AESDEC(S3, Mixer);
+    S2 = Meow128_AESDEC(S2, Mixer);
+    S1 = Meow128_AESDEC(S1, Mixer);
+    S0 = Meow128_AESDEC(S0, Mixer);
+    
+    S2 = Meow128_AESDEC(S2, Meow128_AESDEC_Finalize(S3));
+    S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S1));
+    
+    S2 = Meow128_AESDEC(S2, Mixer);
+    
+    S0 = Meow128_AESDEC(S0, Meow128_AESDEC_Finalize(S2));
+    S0 = Meow128_AESDEC(S0, Mixer);
+    
+    meow_hash Result;
+    Meow128_CopyToHash(Meow128_AESDEC_Finalize(S0), Result);
+    
+    return(Result);
+}
+
+//
+// NOTE(casey): Vanilla C version
+//
+// NOTE: This uses the AES tables and helpers from meow_more.h, so include
+// that first.
+//
+
+#if MEOW_INCLUDE_C
+
+static meow_hash
+MeowWideHash_C(meow_u64 Seed1, meow_u64 Seed2, meow_u64 TotalLengthInBytes, void *SourceInit)
+{
+    meow_u8 D0[] = MEOW_WIDE_S0_INIT;
+    meow_u8 D1[] = MEOW_WIDE_S1_INIT;
+    meow_u8 D2[] = MEOW_WIDE_S2_INIT;
+    meow_u8 D3[] = MEOW_WIDE_S3_INIT;
+    meow_u8 D4[] = MEOW_WIDE_S4_INIT;
+    meow_u8 D5[] = MEOW_WIDE_S5_INIT;
+    meow_u8 D6[] = MEOW_WIDE_S6_INIT;
+    meow_u8 D7[] = MEOW_WIDE_S7_INIT;
+    
+    meow_u32 *S0 = (meow_u32 *)D0;
+    meow_u32 *S1 = (meow_u32 *)D1;
+    meow_u32 *S2 = (meow_u32 *)D2;
+    meow_u32 *S3 = (meow_u32 *)D3;
+    meow_u32 *S4 = (meow_u32 *)D4;
+    meow_u32 *S5 = (meow_u32 *)D5;
+    meow_u32 *S6 = (meow_u32 *)D6;
+    meow_u32 *S7 = (meow_u32 *)D7;
+    
+    meow_u64 Mixer[2] = {Seed1 - TotalLengthInBytes, Seed2 + TotalLengthInBytes + 1};
+    Meow128_Cxor( (void *) S0, (void *) Mixer );
+    Meow128_Cxor( (void *) S1, (void *) Mixer );
+    Meow128_Cxor( (void *) S2, (void *) Mixer );
+    Meow128_Cxor( (void *) S3, (void *) Mixer );
+    Meow128_Cxor( (void *) S4, (void *) Mixer );
+    Meow128_Cxor( (void *) S5, (void *) Mixer );
+    Meow128_Cxor( (void *) S6, (void *) Mixer );
+    Meow128_Cxor( (void *) S7, (void *) Mixer );
+    
+    meow_u8 *Source = (meow_u8 *)SourceInit;
+    meow_u64 Len = TotalLengthInBytes;
+    meow_u64 BlockCount = (Len >> 7);
+    Len -= (BlockCount << 7);
+    while(BlockCount--)
+    {
+        Meow128_AESDEC_Cx2(S0, Source);
+        Meow128_AESDEC_Cx2(S1, Source + 16);
+        Meow128_AESDEC_Cx2(S2, Source + 32);
+        Meow128_AESDEC_Cx2(S3, Source + 48);
+        Meow128_AESDEC_Cx2(S4, Source + 64);
+        Meow128_AESDEC_Cx2(S5, Source + 80);
+        Meow128_AESDEC_Cx2(S6, Source + 96);
+        Meow128_AESDEC_Cx2(S7, Source + 112);
+        
+        Source += 128;
+    }
+    
+    if(TotalLengthInBytes >= 128)
+    {
+        Meow128_AESDEC_C(S0, S4);
+        Meow128_AESDEC_C(S1, S5);
+        Meow128_AESDEC_C(S2, S6);
+        Meow128_AESDEC_C(S3, S7);
+    }
+    
+    if(Len >= 64)
+    {
+        Meow128_AESDEC_Cx2(S0, Source);
+        Meow128_AESDEC_Cx2(S1, Source + 16);
+        Meow128_AESDEC_Cx2(S2, Source + 32);
+        Meow128_AESDEC_Cx2(S3, Source + 48);
+        
+        Len -= 64;
+        Source += 64;
+    }
+    
+    switch(Len >> 4)
+    {
+        case  3: Meow128_AESDEC_Cx2(S2, Source + 32);
+        case  2: Meow128_AESDEC_Cx2(S1, Source + 16);
+        case  1: Meow128_AESDEC_Cx2(S0, Source);
+    }
+    Source += (Len & 0xF0);
+    
+    if(Len & 15)
+    {
+        Len &= 15;
+        meow_u8 Buffer[16] = {};
+        meow_u8 *Dest = Buffer;
+        while(Len--)
+        {
+            Dest[Len] = Source[Len];
+        }
+        
+        Meow128_AESDEC_Cx2(S3, Buffer);
+    }
+    
+    Meow128_AESDEC_C(S3, Mixer);
+    Meow128_AESDEC_C(S2, Mixer);
+    Meow128_AESDEC_C(S1, Mixer);
+    Meow128_AESDEC_C(S0, Mixer);
+    
+    Meow128_AESDEC_C(S2, S3);
+    Meow128_AESDEC_C(S0, S1);
+    
+    Meow128_AESDEC_C(S2, Mixer);
+    
+    Meow128_AESDEC_C(S0, S2);
+    Meow128_AESDEC_C(S0, Mixer);
+    
+    meow_hash Result;
+    Result.u32[0] = S0[0];
+    Result.u32[1] = S0[1];
+    Result.u32[2] = S0[2];
+    Result.u32[3] = S0[3];
+    
+    return(Result);
+}
+
+#endif